@@ -0,0 +1,156 @@
+/**
+ * Tests that the results of read-only aggregations are served from the aggregation result cache
+ * until a collection or view they read from is written to, and that the aggregations which do not
+ * read only the data they are run over are never cached.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod(
+    {setParameter: {internalQueryAggregationResultCacheMaxSizeBytes: 1024 * 1024}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.aggregation_result_cache;
+const foreign = db.aggregation_result_cache_foreign;
+coll.drop();
+foreign.drop();
+
+for (let i = 0; i < 10; ++i) {
+    assert.commandWorked(coll.insert({_id: i, a: i % 3, b: i}));
+    assert.commandWorked(foreign.insert({_id: i % 3, name: "name" + i % 3}));
+}
+
+function getCacheMetrics() {
+    return db.serverStatus().metrics.query.aggregationResultCache;
+}
+
+// A stage which passes every document through, but which prevents the pipeline it is in from being
+// cached.
+const uncachedMatch = {$match: {$expr: {$lt: [{$rand: {}}, 2]}}};
+
+/**
+ * Runs 'pipeline' on 'collName', and checks that it was served from the cache if 'expectHit', that
+ * it missed the cache if 'expectMiss', and that it returned the same results as the pipeline does
+ * when it is not cached.
+ */
+function runAndCheck(pipeline, {
+    collName = coll.getName(),
+    expectHit,
+    expectMiss = !expectHit,
+    checkResults = true,
+    options = {}
+}) {
+    const before = getCacheMetrics();
+    const results = db[collName].aggregate(pipeline, options).toArray();
+    const after = getCacheMetrics();
+    assert.eq(before.hits + (expectHit ? 1 : 0), after.hits, {pipeline, before, after});
+    assert.eq(before.misses + (expectMiss ? 1 : 0), after.misses, {pipeline, before, after});
+
+    if (checkResults) {
+        const expected =
+            db[collName].aggregate(pipeline.concat([uncachedMatch]), options).toArray();
+        assert.eq(after, getCacheMetrics());
+        assert.eq(expected, results, pipeline);
+    }
+}
+
+const groupPipeline = [{$group: {_id: "$a", total: {$sum: "$b"}}}, {$sort: {_id: 1}}];
+runAndCheck(groupPipeline, {expectHit: false});
+runAndCheck(groupPipeline, {expectHit: true});
+
+// A write to the collection invalidates the results read from it, whether or not it changes them.
+assert.commandWorked(coll.insert({_id: 10, a: 0, b: 10}));
+runAndCheck(groupPipeline, {expectHit: false});
+runAndCheck(groupPipeline, {expectHit: true});
+assert.commandWorked(coll.update({_id: 10}, {$set: {c: 1}}));
+runAndCheck(groupPipeline, {expectHit: false});
+assert.commandWorked(coll.remove({_id: 10}));
+runAndCheck(groupPipeline, {expectHit: false});
+runAndCheck(groupPipeline, {expectHit: true});
+
+// A write to another collection does not.
+assert.commandWorked(db.unrelated.insert({}));
+runAndCheck(groupPipeline, {expectHit: true});
+
+// Nor does explain, which is never cached.
+assert.commandWorked(coll.explain().aggregate(groupPipeline));
+runAndCheck(groupPipeline, {expectHit: true});
+
+// The results of pipelines which are the same once optimized are shared.
+runAndCheck([{$match: {}}].concat(groupPipeline), {expectHit: true});
+
+// A write to a collection the pipeline looks up from invalidates its results.
+const lookupPipeline = [
+    {$lookup: {from: foreign.getName(), localField: "a", foreignField: "_id", as: "f"}},
+    {$sort: {_id: 1}},
+];
+runAndCheck(lookupPipeline, {expectHit: false});
+runAndCheck(lookupPipeline, {expectHit: true});
+assert.commandWorked(foreign.update({_id: 1}, {$set: {name: "renamed"}}));
+runAndCheck(lookupPipeline, {expectHit: false});
+
+// An aggregation on a view is cached with the pipeline it resolves to, so changing the view's
+// definition changes what it is cached under.
+assert.commandWorked(db.createView("view", coll.getName(), [{$match: {a: 1}}]));
+runAndCheck(groupPipeline, {collName: "view", expectHit: false});
+runAndCheck(groupPipeline, {collName: "view", expectHit: true});
+assert.commandWorked(
+    db.runCommand({collMod: "view", viewOn: coll.getName(), pipeline: [{$match: {a: 2}}]}));
+runAndCheck(groupPipeline, {collName: "view", expectHit: false});
+runAndCheck(groupPipeline, {collName: "view", expectHit: true});
+
+// Renaming or dropping the collection invalidates its results.
+assert.commandWorked(coll.renameCollection("renamed"));
+assert.commandWorked(db.renamed.renameCollection(coll.getName()));
+runAndCheck(groupPipeline, {expectHit: false});
+
+// So does a collMod of the collection.
+runAndCheck(groupPipeline, {expectHit: true});
+assert.commandWorked(db.runCommand({collMod: coll.getName(), validator: {b: {$exists: true}}}));
+runAndCheck(groupPipeline, {expectHit: false});
+
+// Dropping the database of a collection invalidates its results.
+const otherDB = db.getSiblingDB("aggregation_result_cache_other");
+assert.commandWorked(otherDB.coll.insert({_id: 0, a: 0, b: 0}));
+assert.eq(1, otherDB.coll.aggregate(groupPipeline).itcount());
+const hitsBeforeDrop = getCacheMetrics().hits;
+assert.eq(1, otherDB.coll.aggregate(groupPipeline).itcount());
+assert.eq(hitsBeforeDrop + 1, getCacheMetrics().hits);
+assert.commandWorked(otherDB.dropDatabase());
+assert.eq(0, otherDB.coll.aggregate(groupPipeline).itcount());
+assert.eq(hitsBeforeDrop + 1, getCacheMetrics().hits);
+
+// The pipelines which depend on more than the data they read are never cached, including through
+// their let parameters.
+for (let pipeline of [[{$sample: {size: 3}}], [{$project: {now: {$gt: ["$$NOW", new Date(0)]}}}]]) {
+    runAndCheck(pipeline, {expectHit: false, expectMiss: false, checkResults: false});
+    runAndCheck(pipeline, {expectHit: false, expectMiss: false, checkResults: false});
+}
+for (let let_ of [{now: "$$NOW"}, {r: {$rand: {}}}]) {
+    const pipeline = [{$project: {v: "$$" + Object.keys(let_)[0]}}];
+    const options = {let: let_};
+    runAndCheck(pipeline, {expectHit: false, expectMiss: false, checkResults: false, options});
+    runAndCheck(pipeline, {expectHit: false, expectMiss: false, checkResults: false, options});
+}
+
+// Neither are the results which do not fit in the first batch.
+runAndCheck([{$sort: {_id: 1}}], {expectHit: false, options: {cursor: {batchSize: 2}}});
+runAndCheck([{$sort: {_id: 1}}], {expectHit: false, options: {cursor: {batchSize: 2}}});
+
+// Nor are those of pipelines which write.
+assert.eq(0, coll.aggregate([{$out: "out"}]).itcount());
+assert.eq(0, coll.aggregate([{$out: "out"}]).itcount());
+assert.eq(coll.find().sort({_id: 1}).toArray(), db.out.find().sort({_id: 1}).toArray());
+
+// Changing the size of the cache empties it, and a size of 0 disables it.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryAggregationResultCacheMaxSizeBytes: 0}));
+runAndCheck(groupPipeline, {expectHit: false, expectMiss: false});
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryAggregationResultCacheMaxSizeBytes: 1024 * 1024}));
+runAndCheck(groupPipeline, {expectHit: false});
+runAndCheck(groupPipeline, {expectHit: true});
+
+MongoRunner.stopMongod(conn);
+})();
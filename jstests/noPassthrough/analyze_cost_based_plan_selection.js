@@ -0,0 +1,126 @@
+/**
+ * Tests that the statistics gathered by the 'analyze' command let the planner discard candidate
+ * plans which are much more expensive than the others without racing them, and that it races them
+ * again once the statistics are stale.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");
+
+const conn =
+    MongoRunner.runMongod({setParameter: {internalQueryEnableCostBasedPlanSelection: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.analyze_cost_based_plan_selection;
+coll.drop();
+
+// 'a' is unique, while nine documents out of ten share the same 'b'.
+const kNumDocs = 10000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: i, b: i % 10 == 0 ? i : 1});
+}
+assert.commandWorked(bulk.execute());
+assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}]));
+
+const query = {
+    a: {$lt: 10},
+    b: 1
+};
+// Clear the plan cache first, so that the candidate plans are always enumerated afresh.
+const explainQuery = (limit = 0) => {
+    coll.getPlanCache().clear();
+    return coll.find(query).limit(limit).explain("queryPlanner");
+};
+
+// Without statistics, both index scans are raced.
+let explain = explainQuery();
+assert.eq(1, getRejectedPlans(explain).length, explain);
+
+let res = assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "a"}));
+assert.eq(kNumDocs, res.numRecords, res);
+assert.eq(kNumDocs, res.numValues, res);
+assert.close(kNumDocs, res.distinctEstimate, "", -2);
+res = assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "b", numberBuckets: 10}));
+assert.lte(res.numberBuckets, 10, res);
+
+const stats = db.system.statistics.findOne({_id: coll.getName() + ".b"});
+assert.neq(null, stats);
+assert.eq("b", stats.path, stats);
+assert.eq(kNumDocs, stats.numRecords, stats);
+
+// Only the 'analyze' command writes the statistics.
+assert.commandFailedWithCode(db.system.statistics.insert({_id: "other.b"}),
+                             ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(
+    db.system.statistics.update({_id: stats._id}, {$set: {numRecords: 1}}),
+    ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(db.system.statistics.remove({_id: stats._id}),
+                             ErrorCodes.InvalidNamespace);
+
+// The scan of the 'b' index is estimated to be far more expensive, so it is not raced.
+explain = explainQuery();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+assert(isIxscan(db, explain.queryPlanner.winningPlan), explain);
+assert.eq({a: 1}, getPlanStage(explain.queryPlanner.winningPlan, "IXSCAN").keyPattern, explain);
+assert.eq(10, coll.find(query).itcount());
+
+// Queries with a limit are still raced, since the plans yielding results first win.
+explain = explainQuery(1);
+assert.eq(1, getRejectedPlans(explain).length, explain);
+
+// The statistics are only trusted while the number of documents does not change too much.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryCollectionStatisticsStalenessRatio: 0.2}));
+const moreDocs = coll.initializeUnorderedBulkOp();
+for (let i = kNumDocs; i < 2 * kNumDocs; ++i) {
+    moreDocs.insert({_id: i, a: i, b: 1});
+}
+assert.commandWorked(moreDocs.execute());
+explain = explainQuery();
+assert.eq(1, getRejectedPlans(explain).length, explain);
+
+// The statistics can be refreshed by analyzing the fields again.
+assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "a"}));
+assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "b"}));
+explain = explainQuery();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+
+// Scans of a compound index which are bounded on more than its leading field are not estimated, so
+// they are raced against the cheapest plan.
+assert.commandWorked(coll.createIndex({b: 1, a: 1}));
+explain = explainQuery();
+assert.eq(1, getRejectedPlans(explain).length, explain);
+assert.commandWorked(coll.dropIndex({b: 1, a: 1}));
+
+// Nor are scans of a multikey index, whose keys are not the values the statistics count.
+assert.commandWorked(coll.insert({_id: -1, a: [-1, -2], b: -1}));
+explain = explainQuery();
+assert.eq(1, getRejectedPlans(explain).length, explain);
+assert.commandWorked(coll.remove({_id: -1}));
+assert.commandWorked(coll.dropIndex({a: 1}));
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(db.runCommand({analyze: coll.getName(), key: "a"}));
+explain = explainQuery();
+assert.eq(0, getRejectedPlans(explain).length, explain);
+
+// Cost-based selection can be turned off.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryEnableCostBasedPlanSelection: false}));
+explain = explainQuery();
+assert.eq(1, getRejectedPlans(explain).length, explain);
+
+// Invalid requests.
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName()}), 5300805);
+assert.commandFailedWithCode(db.runCommand({analyze: coll.getName(), key: "$a"}), 5300805);
+assert.commandFailedWithCode(
+    db.runCommand({analyze: coll.getName(), key: "a", numberBuckets: 1}), 5300804);
+assert.commandFailedWithCode(
+    db.runCommand({analyze: coll.getName(), key: "a", sampleSize: "all"}), 5300803);
+assert.commandFailedWithCode(db.runCommand({analyze: "missing", key: "a"}),
+                             ErrorCodes.NamespaceNotFound);
+
+MongoRunner.stopMongod(conn);
+})();
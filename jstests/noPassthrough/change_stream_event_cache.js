@@ -0,0 +1,86 @@
+/**
+ * Tests that, once the cache is enabled, the change events transformed from the oplog entries by
+ * one change stream are rebuilt from the cache by the other streams open on the node, and that the
+ * events read through the cache are the same as those which are transformed by the stream itself,
+ * whatever options the streams were opened with.
+ *
+ * @tags: [uses_change_streams, requires_replication]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const db = rst.getPrimary().getDB(jsTestName());
+const coll = db.coll;
+assert.commandWorked(db.createCollection(coll.getName(), {recordPreImages: true}));
+
+function getCacheMetrics() {
+    return db.serverStatus().metrics.changeStreams.eventCache;
+}
+
+const startAtOperationTime =
+    assert.commandWorked(db.runCommand({insert: coll.getName(), documents: [{_id: "start"}]}))
+        .operationTime;
+for (let i = 0; i < 20; ++i) {
+    assert.commandWorked(coll.insert({_id: i, a: i, b: {c: [1, 2, 3]}}));
+}
+assert.commandWorked(coll.update({_id: 1}, {$set: {a: -1, "b.d": 1}, $unset: {c: ""}}));
+assert.commandWorked(coll.update({_id: 2}, {$pop: {"b.c": 1}}));
+assert.commandWorked(coll.update({_id: 3}, {replaced: true}));
+assert.commandWorked(coll.remove({_id: 4}));
+assert.commandWorked(coll.insert({_id: "last"}));
+
+/**
+ * Opens a change stream with 'options' from the start of the writes above, and returns it along
+ * with all of the events it reads.
+ */
+function readAllEvents(options) {
+    const cursor = coll.watch([], Object.assign({startAtOperationTime}, options));
+    const events = [];
+    assert.soon(() => {
+        while (cursor.hasNext()) {
+            events.push(cursor.next());
+            if (events[events.length - 1].documentKey._id === "last") {
+                return true;
+            }
+        }
+        return false;
+    });
+    return {cursor, events};
+}
+
+for (let options of [{},
+                     {fullDocument: "updateLookup"},
+                     {fullDocumentBeforeChange: "whenAvailable"}]) {
+    // The first stream is the only one open while it reads, so it transforms every event itself.
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalChangeStreamEventCacheMaxSizeBytes: 0}));
+    const expected = readAllEvents(options);
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalChangeStreamEventCacheMaxSizeBytes: 32 * 1024 * 1024}));
+
+    // The second fills the cache with the events it transforms, which the third then reads.
+    const before = getCacheMetrics();
+    const second = readAllEvents(options);
+    const afterSecond = getCacheMetrics();
+    const third = readAllEvents(options);
+    const afterThird = getCacheMetrics();
+
+    assert.eq(before.hits, afterSecond.hits, {before, afterSecond});
+    assert.gte(afterSecond.misses - before.misses, 25, {before, afterSecond});
+    assert.gte(afterThird.hits - afterSecond.hits, 25, {afterSecond, afterThird});
+
+    // The events are the same, down to the order of their fields.
+    assert.eq(tojson(expected.events), tojson(second.events), options);
+    assert.eq(tojson(expected.events), tojson(third.events), options);
+
+    for (let stream of [expected, second, third]) {
+        stream.cursor.close();
+    }
+}
+
+rst.stopSet();
+})();
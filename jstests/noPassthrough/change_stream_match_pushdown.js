@@ -0,0 +1,88 @@
+/**
+ * Tests that a $match on the 'operationType', 'ns' and 'documentKey' of change events, which is
+ * pushed down into the scan of the oplog, returns the same events as when it is applied to the
+ * events themselves, including when the stream resumes from an event which the $match rejects.
+ *
+ * @tags: [uses_change_streams, requires_replication]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 1});
+rst.startSet();
+rst.initiate();
+
+const db = rst.getPrimary().getDB(jsTestName());
+const coll = db.coll;
+const otherColl = db.otherColl;
+assert.commandWorked(db.createCollection(coll.getName()));
+assert.commandWorked(db.createCollection(otherColl.getName()));
+
+const startAtOperationTime =
+    assert.commandWorked(db.runCommand({insert: coll.getName(), documents: [{_id: "start"}]}))
+        .operationTime;
+for (let i = 0; i < 10; ++i) {
+    assert.commandWorked(coll.insert({_id: i, a: i}));
+    assert.commandWorked(otherColl.insert({_id: i, a: i}));
+}
+assert.commandWorked(coll.update({_id: 1}, {$set: {a: -1}}));
+assert.commandWorked(coll.update({_id: 2}, {replaced: true}));
+assert.commandWorked(otherColl.update({_id: 2}, {$inc: {a: 1}}));
+assert.commandWorked(coll.remove({_id: 3}));
+assert.commandWorked(otherColl.remove({_id: 2}));
+const session = db.getMongo().startSession();
+session.startTransaction();
+assert.commandWorked(session.getDatabase(db.getName()).coll.insert({_id: "txn"}));
+assert.commandWorked(session.getDatabase(db.getName()).coll.remove({_id: 4}));
+assert.commandWorked(session.commitTransaction_forTesting());
+assert.commandWorked(db.runCommand({insert: coll.getName(), documents: [{_id: "last"}]}));
+
+// Reads the events of a whole-database change stream followed by 'userStages', up to the insert
+// of the last document.
+function readAllEvents(userStages, options = {startAtOperationTime}) {
+    const cursor = db.aggregate([{$changeStream: options}].concat(userStages));
+    const events = [];
+    assert.soon(() => {
+        while (cursor.hasNext()) {
+            const event = cursor.next();
+            if (event.documentKey._id === "last") {
+                return true;
+            }
+            events.push(event);
+        }
+        return false;
+    });
+    cursor.close();
+    return events;
+}
+
+function getIds(events) {
+    return events.map((event) => tojson(event._id));
+}
+
+const everyEvent = readAllEvents([]);
+for (let filter of [{operationType: "insert"},
+                    {operationType: {$in: ["update", "replace"]}},
+                    {operationType: "delete", "ns.coll": coll.getName()},
+                    {ns: {db: db.getName(), coll: otherColl.getName()}},
+                    {"documentKey._id": {$in: [2, "txn"]}, "fullDocument.a": {$exists: false}},
+                    {$or: [{"ns.db": db.getName(), "documentKey._id": 1}, {operationType: "drop"}]},
+                    {$or: [{operationType: "insert"}, {"fullDocument.a": {$gt: 5}}]}]) {
+    const match = {$match: {$or: [filter, {"documentKey._id": "last"}]}};
+
+    // A $match which does not directly follow the $changeStream is applied to the events as they
+    // are, rather than pushed down into the oplog scan.
+    const expected = readAllEvents([{$replaceRoot: {newRoot: "$$ROOT"}}, match]);
+    assert.gt(expected.length, 0, filter);
+    assert.eq(getIds(expected), getIds(readAllEvents([match])), filter);
+
+    // Resume from the first event which the $match rejects.
+    const resumeAfter =
+        everyEvent.find((event) => !getIds(expected).includes(tojson(event._id)))._id;
+    assert.eq(getIds(expected.filter((event) => bsonWoCompare(event._id, resumeAfter) > 0)),
+              getIds(readAllEvents([match], {resumeAfter})),
+              filter);
+}
+
+rst.stopSet();
+})();
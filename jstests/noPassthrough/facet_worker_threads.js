@@ -0,0 +1,60 @@
+/**
+ * Tests that the sub-pipelines of a $facet which run concurrently on worker threads return the same
+ * results as when they run one after another, including when the input spans several batches of
+ * the buffer the sub-pipelines are fed from, and when one of them reads from another collection.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({setParameter: {internalQueryFacetBufferSizeBytes: 4096}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.facet_worker_threads;
+const foreign = db.facet_worker_threads_foreign;
+coll.drop();
+foreign.drop();
+
+const docs = [];
+for (let i = 0; i < 1000; ++i) {
+    docs.push({_id: i, a: i % 10, b: "some padding " + i});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(foreign.insert([{_id: 0, a: 0}, {_id: 1, a: 1}]));
+
+const pipelines = [
+    [{
+        $facet: {
+            byA: [{$group: {_id: "$a", n: {$sum: 1}}}, {$sort: {_id: 1}}],
+            top: [{$sort: {_id: -1}}, {$limit: 5}],
+            skipped: [{$skip: 990}, {$project: {b: 0}}],
+            count: [{$count: "n"}],
+            first: [{$limit: 1}],
+        }
+    }],
+    [{
+        $facet: {
+            joined: [
+                {$limit: 3},
+                {
+                    $lookup:
+                        {from: foreign.getName(), localField: "a", foreignField: "a", as: "matches"}
+                }
+            ],
+            count: [{$count: "n"}],
+        }
+    }],
+];
+
+for (const pipeline of pipelines) {
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryFacetMaxWorkerThreads: 1}));
+    const expected = coll.aggregate(pipeline).toArray();
+
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryFacetMaxWorkerThreads: 4}));
+    assert.eq(expected, coll.aggregate(pipeline).toArray(), pipeline);
+}
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,56 @@
+/**
+ * Tests that a FETCH stage reading its documents in batches returns the same results, in the same
+ * order, as one reading them one index entry at a time.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage().
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: false,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.fetch_batch_size;
+coll.drop();
+
+// Index keys whose order has no relation to the order the documents were inserted in.
+const kNumDocs = 300;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: (i * 7919) % kNumDocs, b: i % 2});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+
+const query = {
+    a: {$gte: 10},
+    b: 0
+};
+const expected = coll.find(query).sort({a: 1}).toArray();
+assert.eq(expected.length, docs.filter(doc => doc.a >= 10 && doc.b == 0).length);
+
+const kBatchSize = 16;
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryFetchBatchSize: kBatchSize}));
+assert.eq(expected, coll.find(query).sort({a: 1}).toArray());
+assert.eq(expected.slice().reverse(), coll.find(query).sort({a: -1}).toArray());
+
+const explain = coll.find(query).sort({a: 1}).explain("executionStats");
+const fetchStage = getPlanStage(explain.executionStats.executionStages, "FETCH");
+assert.neq(null, fetchStage, explain);
+assert.eq(Math.ceil((kNumDocs - 10) / kBatchSize), fetchStage.batchesFetched, fetchStage);
+assert.eq(kNumDocs - 10, fetchStage.docsExamined, fetchStage);
+
+// Batches of a single document are the default, unbatched reads.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryFetchBatchSize: 1}));
+const unbatchedExplain = coll.find(query).sort({a: 1}).explain("executionStats");
+const unbatchedFetchStage =
+    getPlanStage(unbatchedExplain.executionStats.executionStages, "FETCH");
+assert(!unbatchedFetchStage.hasOwnProperty("batchesFetched"), unbatchedFetchStage);
+
+MongoRunner.stopMongod(conn);
+})();
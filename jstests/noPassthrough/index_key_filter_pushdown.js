@@ -0,0 +1,59 @@
+/**
+ * Tests that predicates of a query which only reference the fields of a non-multikey index are
+ * evaluated on the index keys, before the documents are fetched, and that both execution engines
+ * return the same results with and without doing so.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage().
+
+const conn = MongoRunner.runMongod();
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.index_key_filter_pushdown;
+coll.drop();
+
+const kNumDocs = 200;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 20, b: i % 3, c: "str" + (i % 7), d: i});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, b: 1, c: 1}));
+
+const query = {
+    a: {$gte: 5},
+    $nor: [{b: 1}, {c: /3$/}]
+};
+const expected = docs.filter(doc => doc.a >= 5 && doc.b != 1 && !/3$/.test(doc.c));
+assert.gt(expected.length, 0);
+
+function runQuery() {
+    return coll.find(query).sort({_id: 1}).hint({a: 1, b: 1, c: 1}).toArray();
+}
+
+for (let sbe of [false, true]) {
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: sbe}));
+    for (let pushdown of [true, false]) {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalQueryPlannerEnableIndexKeyFilterPushdown: pushdown}));
+        assert.eq(expected, runQuery(), {sbe: sbe, pushdown: pushdown});
+    }
+}
+
+// With the classic engine, only the documents whose index key passes the predicates are fetched.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: false}));
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryPlannerEnableIndexKeyFilterPushdown: true}));
+const explain = coll.find(query).hint({a: 1, b: 1, c: 1}).explain("executionStats");
+const ixscan = getPlanStage(explain.executionStats.executionStages, "IXSCAN");
+assert.neq(null, ixscan, explain);
+assert(ixscan.hasOwnProperty("filter"), ixscan);
+assert.eq(expected.length, explain.executionStats.totalDocsExamined, explain);
+
+MongoRunner.stopMongod(conn);
+})();
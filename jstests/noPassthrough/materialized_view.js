@@ -0,0 +1,133 @@
+/**
+ * Tests that a materialized view returns the same results as its pipeline run over the collection
+ * it is defined on as that collection is inserted into, updated and deleted from, that its sums
+ * are kept exact, and that the collection holding its result is internal, replicated and dropped
+ * along with it.
+ *
+ * @tags: [requires_replication]
+ */
+(function() {
+"use strict";
+
+const rst = new ReplSetTest({nodes: 2});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+const db = primary.getDB("test");
+const source = db.source;
+
+const viewPipeline = [
+    {$match: {status: "active"}},
+    {$group: {_id: "$region", n: {$sum: 1}, total: {$sum: "$amount"}}},
+    {$sort: {_id: 1}},
+];
+
+function assertViewMatchesPipeline(testDB) {
+    assert.eq(testDB.view.find().toArray(), testDB.source.aggregate(viewPipeline).toArray());
+}
+
+// A materialized view can only be kept up to date on a collection which records its pre-images.
+assert.commandWorked(db.createCollection("noPreImages"));
+assert.commandFailedWithCode(
+    db.createView("view", "noPreImages", viewPipeline, {materialized: true}),
+    ErrorCodes.InvalidOptions);
+
+assert.commandWorked(db.createCollection(source.getName(), {recordPreImages: true}));
+const docs = [];
+for (let i = 0; i < 100; ++i) {
+    docs.push({_id: i, region: i % 5, status: i % 3 ? "active" : "closed", amount: i});
+}
+assert.commandWorked(source.insert(docs));
+
+// Only $match stages followed by a $group whose accumulators are all $sum can be maintained.
+for (let pipeline of [[{$sort: {a: 1}}, {$group: {_id: "$a"}}],
+                      [{$group: {_id: "$a", m: {$max: "$b"}}}]]) {
+    assert.commandFailedWithCode(
+        db.createView("view", source.getName(), pipeline, {materialized: true}),
+        ErrorCodes.OptionNotSupportedOnView);
+}
+
+// Nor can a view whose sums would be doubles over the documents already in the collection.
+assert.commandWorked(db.createCollection("doubles", {recordPreImages: true}));
+assert.commandWorked(db.doubles.insert({region: 1, status: "active", amount: 0.5}));
+assert.commandFailedWithCode(db.createView("view", "doubles", viewPipeline, {materialized: true}),
+                             5302203);
+
+// The view is populated from the documents already in the collection.
+assert.commandWorked(db.createView("view", source.getName(), viewPipeline, {materialized: true}));
+assertViewMatchesPipeline(db);
+
+const collInfos = db.getCollectionInfos({name: "view"});
+assert.eq(1, collInfos.length, collInfos);
+assert.eq(true, collInfos[0].options.materialized, collInfos);
+
+// The collection holding the groups is only written to by the writes to the source collection.
+const groups = db.getCollection("system.materialized.view");
+assert.commandFailedWithCode(groups.insert({_id: 7, n: 1}), ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(groups.update({_id: 1}, {$inc: {n: 1}}), ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(groups.remove({_id: 1}), ErrorCodes.InvalidNamespace);
+assert.commandFailedWithCode(db.createCollection("system.materialized.other"),
+                             ErrorCodes.InvalidNamespace);
+assertViewMatchesPipeline(db);
+
+// Inserts, including of documents which do not pass the $match or which open a new group.
+assert.commandWorked(source.insert([
+    {_id: 100, region: 1, status: "active", amount: 7},
+    {_id: 101, region: 2, status: "closed", amount: 9},
+    {_id: 102, region: 6, status: "active", amount: 3},
+    {_id: 103, status: "active", amount: 4},
+]));
+assertViewMatchesPipeline(db);
+
+// Updates in place, which move documents between groups and in and out of the $match.
+assert.commandWorked(source.updateMany({region: 0}, {$inc: {amount: 10}}));
+assertViewMatchesPipeline(db);
+assert.commandWorked(source.updateMany({_id: {$lt: 20}}, {$set: {region: 3}}));
+assertViewMatchesPipeline(db);
+assert.commandWorked(source.updateMany({_id: {$gte: 80}}, {$set: {status: "closed"}}));
+assertViewMatchesPipeline(db);
+assert.commandWorked(source.updateOne({_id: 1}, {$set: {note: "does not affect the view"}}));
+assertViewMatchesPipeline(db);
+
+// Replacements, and updates through findAndModify.
+assert.commandWorked(
+    source.replaceOne({_id: 2}, {region: 4, status: "active", amount: NumberDecimal("1.5")}));
+assertViewMatchesPipeline(db);
+source.findAndModify({query: {_id: 4}, update: {$inc: {amount: 2}}});
+assertViewMatchesPipeline(db);
+
+// The sums are kept exact, so the writes which would sum doubles, or overflow an integer sum to a
+// double, fail rather than let the groups drift away from the pipeline run over the collection.
+assert.commandFailedWithCode(source.insert({_id: 104, region: 1, status: "active", amount: 0.1}),
+                             5302203);
+assert.commandFailedWithCode(source.updateOne({_id: 5}, {$set: {amount: 2.5}}), 5302203);
+const maxLong = NumberLong("9223372036854775807");
+assert.commandFailedWithCode(
+    source.insert({_id: 105, region: 1, status: "active", amount: maxLong}), 5302203);
+assert.commandWorked(source.insert({_id: 106, region: 1, status: "closed", amount: 0.1}));
+assertViewMatchesPipeline(db);
+
+// Deletes, including of every document in a group.
+assert.commandWorked(source.deleteMany({region: 6}));
+assertViewMatchesPipeline(db);
+assert.commandWorked(source.deleteMany({_id: {$mod: [4, 0]}}));
+assertViewMatchesPipeline(db);
+
+// The collection holding the groups of the view is replicated, so the view reads the same on
+// secondaries.
+rst.awaitReplication();
+const secondaryDB = rst.getSecondary().getDB("test");
+secondaryDB.getMongo().setSecondaryOk();
+assertViewMatchesPipeline(secondaryDB);
+
+// The pipeline of a materialized view cannot be changed, and dropping the view drops the groups.
+assert.commandFailedWithCode(
+    db.runCommand({collMod: "view", viewOn: source.getName(), pipeline: viewPipeline}),
+    ErrorCodes.OptionNotSupportedOnView);
+assert(db.view.drop());
+assert.eq(0, db.getCollectionInfos({name: "system.materialized.view"}).length);
+assert.commandWorked(source.insert({_id: 200, region: 1, status: "active", amount: 1}));
+
+rst.stopSet();
+})();
@@ -0,0 +1,92 @@
+/**
+ * Tests that a limited sort over an $or some of whose branches are in index order is planned as a
+ * merge of the branches, that it returns the same results as a sort of the whole $or, and that
+ * the branch which is in order stops being scanned once the limit is reached.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage().
+
+const conn = MongoRunner.runMongod({});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.merge_limited_sort_of_or_branches;
+coll.drop();
+
+const kNumDocs = 1000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 2, b: i % 5, c: (i * 7919) % kNumDocs});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, c: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+const filter = {
+    $or: [{a: 1}, {b: 2}]
+};
+
+function runTest(sort, skip, limit) {
+    const direction = sort.c;
+    const expected = docs.filter((doc) => doc.a === 1 || doc.b === 2)
+                         .sort((lhs, rhs) => direction * (lhs.c - rhs.c))
+                         .slice(skip, skip + limit);
+    assert.eq(expected, coll.find(filter).sort(sort).skip(skip).limit(limit).toArray());
+
+    const explain =
+        coll.find(filter).sort(sort).skip(skip).limit(limit).explain("executionStats");
+    const mergeStage = getPlanStage(explain.executionStats.executionStages, "SORT_MERGE");
+    assert.neq(null, mergeStage, explain);
+
+    // The scan of the branch in index order stops shortly after the limit, rather than reading all
+    // of the documents it matches.
+    const ixscans = getPlanStages(explain.executionStats.executionStages, "IXSCAN");
+    const sortedScan = ixscans.find((stage) => stage.indexName === "a_1_c_1");
+    assert.neq(undefined, sortedScan, explain);
+    assert.lte(sortedScan.keysExamined, skip + limit + 2, sortedScan);
+}
+
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryPlannerMergeLimitedSortOfOrBranches: true}));
+runTest({c: 1}, 0, 10);
+runTest({c: -1}, 0, 10);
+runTest({c: 1}, 5, 10);
+
+// Without the rewrite, the whole $or is sorted, with the same results.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryPlannerMergeLimitedSortOfOrBranches: false}));
+const explain = coll.find(filter).sort({c: 1}).limit(10).explain("executionStats");
+assert.eq(null, getPlanStage(explain.executionStats.executionStages, "SORT_MERGE"), explain);
+const expected = docs.filter((doc) => doc.a === 1 || doc.b === 2)
+                     .sort((lhs, rhs) => lhs.c - rhs.c)
+                     .slice(0, 10);
+assert.eq(expected, coll.find(filter).sort({c: 1}).limit(10).toArray());
+
+// A SORT orders an array by its smallest element, the merge would compare it as a whole. When the
+// sort field may be an array, here because the index which provides the sort is partial, the
+// whole $or is sorted instead of being merged.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryPlannerMergeLimitedSortOfOrBranches: true}));
+const arrayColl = db.merge_limited_sort_of_or_branches_array;
+arrayColl.drop();
+assert.commandWorked(arrayColl.insert([
+    {_id: 0, a: 1, c: 2},
+    {_id: 1, a: 1, c: 4},
+    {_id: 2, b: 2, c: [5, 1]},
+    {_id: 3, b: 2, c: [3, 6]},
+]));
+assert.commandWorked(
+    arrayColl.createIndex({a: 1, c: 1}, {partialFilterExpression: {a: {$exists: true}}}));
+assert.commandWorked(arrayColl.createIndex({b: 1}));
+
+const arrayExplain = arrayColl.find(filter).sort({c: 1}).limit(3).explain();
+assert.eq(null, getPlanStage(arrayExplain.queryPlanner.winningPlan, "SORT_MERGE"), arrayExplain);
+assert.eq([{_id: 2}, {_id: 0}, {_id: 3}],
+          arrayColl.find(filter, {_id: 1}).sort({c: 1}).limit(3).toArray());
+assert.eq([{_id: 3}, {_id: 2}, {_id: 1}],
+          arrayColl.find(filter, {_id: 1}).sort({c: -1}).limit(3).toArray());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,97 @@
+/**
+ * Tests that a collection scan whose filter is evaluated a block of rows at a time by the
+ * slot-based execution engine returns the same documents as one filtering a row at a time.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQuerySlotBasedExecutionBlockSize: 0,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_block_filter;
+coll.drop();
+
+const kNumDocs = 5000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    // Besides numbers of several types, the compared field holds arrays, nested arrays, strings,
+    // nulls and objects, or is missing.
+    let a;
+    switch (i % 10) {
+        case 0:
+            a = [i % 100, -1];
+            break;
+        case 1:
+            a = [[i % 100]];
+            break;
+        case 2:
+            a = String(i % 100);
+            break;
+        case 3:
+            a = null;
+            break;
+        case 4:
+            a = {x: i % 100};
+            break;
+        case 5:
+            a = NumberLong(i % 100);
+            break;
+        case 6:
+            a = NumberDecimal(i % 100);
+            break;
+        case 7:
+            a = (i % 100) + 0.5;
+            break;
+        case 8:
+            a = NaN;
+            break;
+        default:
+            a = NumberInt(i % 100);
+    }
+    const doc = {_id: i, b: i % 7};
+    if (i % 11 != 0) {
+        doc.a = a;
+    }
+    bulk.insert(doc);
+}
+assert.commandWorked(bulk.execute());
+
+const setBlockSize = blockSize => assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQuerySlotBasedExecutionBlockSize: blockSize}));
+
+const filters = [
+    {a: 42},
+    {a: {$lt: 10}},
+    {a: {$lte: 10.5}},
+    {a: {$gt: NumberLong(90)}},
+    {a: {$gte: NumberDecimal("95")}},
+    {a: {$gt: 20}, b: {$lt: 3}},
+    {$or: [{a: {$lt: 5}}, {b: 6}]},
+    {a: {$not: {$gt: 50}}},
+    {$and: [{a: {$gte: 10}}, {$or: [{a: {$lte: 20}}, {b: {$gte: 5}}]}]},
+    // Filters which do not only compare top-level fields with numbers are applied a row at a time.
+    {a: "42"},
+    {"a.x": {$lt: 10}},
+];
+const runQueries = () => filters.map(filter => coll.find(filter).sort({_id: 1}).toArray());
+
+const expected = runQueries();
+assert.lt(0, expected[0].length);
+
+for (let blockSize of [1, 7, 256, 1024]) {
+    setBlockSize(blockSize);
+    assert.eq(expected, runQueries(), "block size: " + blockSize);
+}
+
+const explain = tojson(coll.find({a: {$gt: 20}, b: {$lt: 3}}).explain());
+assert(explain.includes("unblock"), explain);
+assert(!tojson(coll.find({a: "42"}).explain()).includes("unblock"));
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,89 @@
+/**
+ * Tests that a slot-based execution plan drawn from the plan cache keeps being checked after its
+ * trial period, and that its cache entry is deactivated once the plan needs many more reads per
+ * result than it did when it was cached, without failing the query at hand.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQueryEnableCachedPlanRuntimeFeedback: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_cached_plan_runtime_feedback;
+coll.drop();
+
+// Enough matching documents for the query to keep running well past its trial period.
+const kNumDocs = 2000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 10, b: i % 3});
+}
+assert.commandWorked(coll.insert(docs));
+
+// Two indexes make the planner race the plans of the query, and thus cache the winner.
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({b: 1}));
+
+const query = {
+    a: {$gte: 0},
+    b: {$gte: 0}
+};
+
+function getCacheEntry() {
+    const entries = coll.aggregate([
+                            {$planCacheStats: {}},
+                            {$match: {createdFromQuery: {query: query, sort: {}, projection: {}}}}
+                        ])
+                        .toArray();
+    assert.eq(entries.length, 1, entries);
+    return entries[0];
+}
+
+const getDeactivations = () =>
+    db.serverStatus().metrics.query.sbe.planCache.feedbackDeactivations;
+
+// Create and activate the cache entry of the query.
+for (let i = 0; i < 2; ++i) {
+    assert.eq(kNumDocs, coll.find(query).itcount());
+}
+let entry = getCacheEntry();
+assert(entry.isActive, entry);
+
+// A cached plan performing as anticipated keeps its entry active.
+let deactivations = getDeactivations();
+assert.eq(kNumDocs, coll.find(query).itcount());
+assert(getCacheEntry().isActive, getCacheEntry());
+assert.eq(deactivations, getDeactivations());
+
+// With no tolerance for extra reads, the reads done past the trial period deactivate the entry,
+// which keeps the reads observed per trial period as its works value. The query still returns all
+// of its results.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCacheEvictionRatio: 0}));
+assert.eq(kNumDocs, coll.find(query).itcount());
+const deactivatedEntry = getCacheEntry();
+assert(!deactivatedEntry.isActive, deactivatedEntry);
+assert.gte(deactivatedEntry.works, entry.works, deactivatedEntry);
+assert.eq(deactivations + 1, getDeactivations());
+
+// The next query of the shape is replanned, and caches its winner as an active entry.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCacheEvictionRatio: 10}));
+assert.eq(kNumDocs, coll.find(query).itcount());
+assert(getCacheEntry().isActive, getCacheEntry());
+
+// Without runtime feedback, the entry is left alone.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQueryEnableCachedPlanRuntimeFeedback: false}));
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCacheEvictionRatio: 0}));
+deactivations = getDeactivations();
+assert.eq(kNumDocs, coll.find(query).itcount());
+assert(getCacheEntry().isActive, getCacheEntry());
+assert.eq(deactivations, getDeactivations());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,98 @@
+/**
+ * Tests that a $group at the front of a pipeline is pushed down into the slot-based execution
+ * engine as a hash aggregation when its group key and accumulators are supported there, and that
+ * it returns the same results as the $group stage of the pipeline.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getAggPlanStage().
+
+const conn = MongoRunner.runMongod(
+    {setParameter: {internalQueryEnableSlotBasedExecutionEngine: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_group_pushdown;
+coll.drop();
+
+const docs = [];
+for (let i = 0; i < 200; ++i) {
+    const doc = {_id: i, a: i % 7, b: i % 3, c: i};
+    if (i % 5 === 0) {
+        doc.d = "str" + i;
+    } else if (i % 5 === 1) {
+        doc.d = null;
+    } else if (i % 5 !== 2) {
+        doc.d = i / 2;
+    }
+    docs.push(doc);
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1}));
+
+function runPipeline(pipeline, pushedDown) {
+    const explain = coll.explain().aggregate(pipeline);
+    assert.eq(pushedDown, getAggPlanStage(explain, "GROUP") !== null, explain);
+    return coll.aggregate(pipeline).toArray();
+}
+
+const pipelines = [
+    [{$group: {_id: "$a", n: {$sum: 1}, total: {$sum: "$c"}, avg: {$avg: "$d"}}}],
+    [{$group: {_id: {a: "$a", b: "$b"}, lo: {$min: "$d"}, hi: {$max: "$d"}}}],
+    [{$group: {_id: "$missing", n: {$sum: 1}, avg: {$avg: "$missing"}, lo: {$min: "$missing"}}}],
+    [{$match: {a: {$gte: 3}}}, {$group: {_id: "$b", cs: {$addToSet: "$a"}, ds: {$push: "$d"}}}],
+    [{$sort: {c: 1}}, {$group: {_id: "$b", first: {$first: "$d"}, last: {$last: "$d"}}}],
+    [{$group: {_id: null, n: {$sum: 1}}}],
+    // Sums of doubles are compensated, and sums of integers turn into doubles on overflow.
+    [{
+        $group: {
+            _id: "$b",
+            tenths: {$sum: 0.1},
+            avgTenth: {$avg: 0.1},
+            big: {$sum: NumberLong("9223372036854775807")}
+        }
+    }],
+];
+
+for (const pipeline of pipelines) {
+    const fullPipeline = pipeline.concat([{$sort: {_id: 1}}]);
+    const pushedDownResults = runPipeline(fullPipeline, true);
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: false}));
+    const expectedResults = runPipeline(fullPipeline, false);
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: true}));
+
+    // The elements of a $addToSet, and of a $push over unsorted input, are in no particular order.
+    const normalize = (results) => results.map((doc) => {
+        for (const field of ["cs", "ds"]) {
+            if (doc[field]) {
+                doc[field] = doc[field].map(tojson).sort();
+            }
+        }
+        return doc;
+    });
+    assert.eq(normalize(expectedResults), normalize(pushedDownResults), pipeline);
+}
+
+// A $group with an accumulator or group key which the slot-based engine does not support is left
+// in the pipeline.
+runPipeline([{$group: {_id: {$add: ["$a", 1]}, n: {$sum: 1}}}], false);
+runPipeline([{$group: {_id: "$a", sd: {$stdDevPop: "$c"}}}], false);
+
+// The arrays built by $push are accounted for as they grow, and a group which does not fit in
+// memory cannot be spilled. A pushed down $group is bounded by the memory limit of the slot-based
+// hash aggregation.
+assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionHashAggMaxMemoryBytes: 1024}));
+const res = db.runCommand({
+    aggregate: coll.getName(),
+    pipeline: [{$group: {_id: null, cs: {$push: "$c"}}}],
+    allowDiskUse: true,
+    cursor: {}
+});
+assert.commandFailedWithCode(res, ErrorCodes.ExceededMemoryLimit);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,59 @@
+/**
+ * Tests that index intersection plans and _id point lookups can be executed by the slot-based
+ * execution engine and return the same results as the classic engine.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQueryForceIntersectionPlans: true,
+        internalQueryPlannerEnableHashIntersection: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_index_intersection_and_idhack;
+coll.drop();
+
+for (let i = 0; i < 100; ++i) {
+    assert.commandWorked(coll.insert({_id: i, a: i % 10, b: i % 7, c: [i, i + 1]}));
+}
+assert.commandWorked(coll.createIndexes([{a: 1}, {b: 1}, {c: 1}]));
+
+const setSBE = enabled => assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: enabled}));
+
+const runQueries = () => [
+    coll.find({a: 3, b: 4}).sort({_id: 1}).toArray(),
+    coll.find({a: {$gte: 8}, b: {$lte: 1}}).sort({_id: 1}).toArray(),
+    coll.find({a: 5, c: {$in: [15, 26]}}).sort({_id: 1}).toArray(),
+    coll.find({a: 2, b: 2, c: 72}, {_id: 0, c: 1}).toArray(),
+    coll.find({_id: 42}).toArray(),
+    coll.find({_id: 42}, {a: 1}).toArray(),
+    coll.find({_id: 42}).returnKey().toArray(),
+    coll.find({_id: 1000}).toArray(),
+];
+
+setSBE(false);
+const classicResults = runQueries();
+setSBE(true);
+const sbeResults = runQueries();
+
+assert.eq(classicResults, sbeResults);
+assert.eq([{_id: 4, a: 4, b: 4, c: [4, 5]}], coll.find({a: 4, b: 4, _id: {$lt: 10}}).toArray());
+assert.eq([{_id: 42, a: 2}], coll.find({_id: 42}, {a: 1}).toArray());
+
+// Intersections of point lookups (AND_SORTED) stream their inputs through a merge join, so they
+// don't depend on the memory limit of the hash join.
+assert.commandWorked(db.adminCommand({
+    setParameter: 1,
+    internalQueryPlannerEnableHashIntersection: false,
+    internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes: 1,
+}));
+assert.eq(classicResults[0], coll.find({a: 3, b: 4}).sort({_id: 1}).allowDiskUse(false).toArray());
+
+MongoRunner.stopMongod(conn);
+}());
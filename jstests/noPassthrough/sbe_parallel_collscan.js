@@ -0,0 +1,76 @@
+/**
+ * Tests that a collection scan split across worker threads by the slot-based execution engine
+ * returns the same documents as a scan on the calling thread.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQuerySlotBasedExecutionParallelScanDegree: 1,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_parallel_collscan;
+coll.drop();
+
+// Large enough for the collection to be split into several RecordId ranges.
+const kNumDocs = 50000;
+const bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: i % 100, b: "x".repeat(i % 7)});
+}
+assert.commandWorked(bulk.execute());
+
+const setDegree = degree => assert.commandWorked(db.adminCommand(
+    {setParameter: 1, internalQuerySlotBasedExecutionParallelScanDegree: degree}));
+
+const sortById = docs => docs.sort((lhs, rhs) => lhs._id - rhs._id);
+const runQueries = () => [
+    sortById(coll.find().toArray()),
+    sortById(coll.find({a: {$lt: 10}}).toArray()),
+    sortById(coll.find({a: 42}, {_id: 1, b: 1}).toArray()),
+    coll.find({a: {$gte: 90}}).sort({_id: -1}).toArray(),
+    coll.aggregate([{$match: {a: {$in: [1, 2, 3]}}}, {$group: {_id: "$a", n: {$sum: 1}}}])
+        .toArray()
+        .sort((lhs, rhs) => lhs._id - rhs._id),
+    // Queries whose results depend on the scan order are not split.
+    coll.find().limit(5).toArray(),
+    coll.find().sort({$natural: 1}).skip(10).limit(5).toArray(),
+    // Nor are reads with a read concern other than "local".
+    sortById(coll.find({a: {$lt: 10}}).readConcern("available").toArray()),
+];
+
+const expected = runQueries();
+assert.eq(kNumDocs, expected[0].length);
+
+for (let degree of [2, 8]) {
+    setDegree(degree);
+    assert.eq(expected, runQueries(), "degree of parallelism: " + degree);
+}
+
+// Producers wait for the global lock as long as the query does, so concurrent writes do not make a
+// split scan fail with LockTimeout.
+const writer = startParallelShell(() => {
+    const coll = db.getSiblingDB("test").sbe_parallel_collscan_writes;
+    for (let i = 0; i < 2000; ++i) {
+        assert.commandWorked(coll.insert({_id: i}));
+    }
+}, conn.port);
+for (let i = 0; i < 5; ++i) {
+    assert.eq(expected[1], sortById(coll.find({a: {$lt: 10}}).toArray()));
+}
+writer();
+
+// Producers inherit the time limit of the query.
+assert.commandWorked(
+    db.adminCommand({configureFailPoint: "maxTimeAlwaysTimeOut", mode: "alwaysOn"}));
+assert.throwsWithCode(() => coll.find({a: {$lt: 10}}).maxTimeMS(60 * 1000).itcount(),
+                      ErrorCodes.MaxTimeMSExpired);
+assert.commandWorked(db.adminCommand({configureFailPoint: "maxTimeAlwaysTimeOut", mode: "off"}));
+
+MongoRunner.stopMongod(conn);
+})();
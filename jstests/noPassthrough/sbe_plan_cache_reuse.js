@@ -0,0 +1,83 @@
+/**
+ * Tests that the slot-based execution plans kept in the plan cache are reused by queries of the
+ * same shape with different constants, and that they return the results of these queries.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        internalQueryCacheSbePlans: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_plan_cache_reuse;
+coll.drop();
+
+const kNumDocs = 1000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % 100, b: i % 7, c: "str" + (i % 10)});
+}
+assert.commandWorked(coll.insert(docs));
+
+// Two indexes on 'a' make the planner race the plans of these queries, and thus cache the winner.
+assert.commandWorked(coll.createIndex({a: 1}));
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+const getCacheMetrics = () => db.serverStatus().metrics.query.sbe.planCache;
+
+const sortById = results => results.sort((lhs, rhs) => lhs._id - rhs._id);
+const expectedDocs = predicate => sortById(docs.filter(predicate));
+
+function runShape(makeQuery, makePredicate, values) {
+    // Activate the cache entry of the shape, then build the plan kept along with it.
+    for (let i = 0; i < 3; ++i) {
+        coll.find(makeQuery(values[0])).toArray();
+    }
+
+    const before = getCacheMetrics();
+    for (let value of values) {
+        assert.eq(expectedDocs(makePredicate(value)),
+                  sortById(coll.find(makeQuery(value)).toArray()),
+                  tojson(makeQuery(value)));
+    }
+    const after = getCacheMetrics();
+    assert.gte(after.hits - before.hits, values.length - 1, {before: before, after: after});
+}
+
+// Point queries on the index.
+runShape(v => ({a: v}), v => doc => doc.a === v, [1, 2, 42, 99, 100]);
+
+// Range queries, whose bounds are rebound for each query.
+runShape(v => ({a: {$gte: v, $lt: v + 3}}),
+         v => doc => doc.a >= v && doc.a < v + 3,
+         [10, 20, 97, -5]);
+
+// Predicates evaluated by the fetch, whose constants are read from the runtime environment.
+runShape(v => ({a: v, c: "str" + (v % 10)}),
+         v => doc => doc.a === v && doc.c === "str" + (v % 10),
+         [3, 13, 57]);
+
+// A point query with an $or, which is planned as a union of index scans.
+runShape(v => ({a: v, $or: [{b: 1}, {b: {$gt: v % 7}}]}),
+         v => doc => doc.a === v && (doc.b === 1 || doc.b > v % 7),
+         [5, 6, 70]);
+
+// Constants of another type are bound to the same plan, while comparisons to null are not
+// parameterized and need a plan of their own.
+assert.eq([], coll.find({a: "1"}).toArray());
+assert.eq([], coll.find({a: null}).toArray());
+assert.eq(expectedDocs(doc => doc.a === 1), sortById(coll.find({a: 1}).toArray()));
+
+// Rebuilding the plan for each query returns the same results.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryCacheSbePlans: false}));
+const before = getCacheMetrics();
+assert.eq(expectedDocs(doc => doc.a === 7), sortById(coll.find({a: 7}).toArray()));
+assert.eq(before.hits, getCacheMetrics().hits);
+
+MongoRunner.stopMongod(conn);
+})();
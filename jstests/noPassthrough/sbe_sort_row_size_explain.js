@@ -0,0 +1,57 @@
+/**
+ * Tests that the explain output of a slot-based sort reports how much data it sorted and how much
+ * memory each sorted row took, and that sorts buffering compact rows return the same results,
+ * whether or not they spill.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage().
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalQueryEnableSlotBasedExecutionEngine: true,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sbe_sort_row_size_explain;
+coll.drop();
+
+const kNumDocs = 500;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({
+        _id: i,
+        a: (i * 7919) % kNumDocs,
+        s: "a string long enough not to fit in a value " + i,
+        d: NumberDecimal(i),
+        arr: [i, {b: i}],
+    });
+}
+assert.commandWorked(coll.insert(docs));
+
+const expected = docs.slice().sort((lhs, rhs) => lhs.a - rhs.a);
+assert.eq(expected, coll.find().sort({a: 1}).toArray());
+
+const explain = coll.find().sort({a: 1}).explain("executionStats");
+const sortStage = getPlanStage(explain.executionStats.executionStages, "SORT");
+assert.neq(null, sortStage, explain);
+assert(!sortStage.usedDisk, sortStage);
+assert.gt(sortStage.totalDataSizeSorted, 0, sortStage);
+assert.gt(sortStage.memUsagePerSortedRow, 0, sortStage);
+assert.eq(Math.floor(sortStage.totalDataSizeSorted / kNumDocs),
+          sortStage.memUsagePerSortedRow,
+          sortStage);
+
+// A sort which spills its rows to disk returns the same results.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalQueryMaxBlockingSortMemoryUsageBytes: 10 * 1024}));
+assert.eq(expected, coll.find().sort({a: 1}).allowDiskUse().toArray());
+const spillingExplain = coll.find().sort({a: 1}).allowDiskUse().explain("executionStats");
+const spillingSortStage = getPlanStage(spillingExplain.executionStats.executionStages, "SORT");
+assert(spillingSortStage.usedDisk, spillingSortStage);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,56 @@
+/**
+ * Tests that a compound index whose leading field a query does not constrain can be skip scanned
+ * for the query's predicates on its other fields, examining a few keys per distinct value of the
+ * leading field rather than the whole index, and that it returns the same results as a
+ * collection scan.
+ */
+(function() {
+"use strict";
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage(), getWinningPlan() and isCollscan().
+
+const conn = MongoRunner.runMongod({setParameter: {internalQueryPlannerEnableSkipScan: true}});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.skip_scan;
+coll.drop();
+
+const kNumLeadingValues = 4;
+const kNumDocs = 4000;
+const docs = [];
+for (let i = 0; i < kNumDocs; ++i) {
+    docs.push({_id: i, a: i % kNumLeadingValues, b: Math.floor(i / kNumLeadingValues), c: i % 7});
+}
+assert.commandWorked(coll.insert(docs));
+assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+function assertSkipScan(explain, maxKeysExamined) {
+    const ixscan = getPlanStage(explain.executionStats.executionStages, "IXSCAN");
+    assert.neq(null, ixscan, explain);
+    assert.eq({a: 1, b: 1}, ixscan.keyPattern, ixscan);
+    assert.lte(ixscan.keysExamined, maxKeysExamined, ixscan);
+}
+
+// Each value of 'a' takes a seek to each interval of 'b' and a seek past the last of them.
+const query = {
+    b: {$in: [10, 500]},
+    c: {$gte: 0}
+};
+const expected = docs.filter((doc) => doc.b === 10 || doc.b === 500);
+assert.sameMembers(expected, coll.find(query).toArray());
+assertSkipScan(coll.find(query).explain("executionStats"), 6 * kNumLeadingValues);
+
+// A hinted index is skip scanned rather than scanned whole.
+assert.sameMembers(expected, coll.find(query).hint({a: 1, b: 1}).toArray());
+assertSkipScan(coll.find(query).hint({a: 1, b: 1}).explain("executionStats"),
+               6 * kNumLeadingValues);
+
+// Without skip scans, the query is answered by a collection scan with the same results.
+assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryPlannerEnableSkipScan: false}));
+const explain = coll.find(query).explain();
+assert(isCollscan(db, getWinningPlan(explain.queryPlanner)), explain);
+assert.sameMembers(expected, coll.find(query).toArray());
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,67 @@
+/**
+ * Tests that index builds, and the sorts of both execution engines and of $sort, whose runs are
+ * sorted and merged on several worker threads return the same results as when they are sorted on a
+ * single thread, both when the data fits in memory and when it is spilled to disk.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({
+    setParameter: {
+        internalSorterMaxWorkerThreads: 4,
+        internalQueryEnableSlotBasedExecutionEngine: true,
+        maxIndexBuildMemoryUsageMegabytes: 50,
+    }
+});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.sorter_worker_threads;
+coll.drop();
+
+const kNumDocs = 20000;
+const padding = "x".repeat(4000);
+let bulk = coll.initializeUnorderedBulkOp();
+for (let i = 0; i < kNumDocs; ++i) {
+    bulk.insert({_id: i, a: (i * 7919) % 1000, b: (i * 104729) % kNumDocs, padding: padding});
+}
+assert.commandWorked(bulk.execute());
+
+// The index build spills several runs, each of which is sorted on the worker threads.
+assert.commandWorked(coll.createIndex({a: 1, padding: 1}));
+assert.commandWorked(coll.validate({full: true}));
+assert.eq(kNumDocs, coll.find({a: {$gte: 0}}).hint({a: 1, padding: 1}).itcount());
+
+// Sorts all of the documents in memory, and then with a memory limit low enough for several runs
+// to be spilled, with both execution engines. The $sort after $unwind compares sort keys which
+// share their storage with those of other documents.
+function runSorts() {
+    const results = [];
+    for (let sbe of [true, false]) {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalQueryEnableSlotBasedExecutionEngine: sbe}));
+        for (let memLimit of [100 * 1024 * 1024, 256 * 1024]) {
+            assert.commandWorked(db.adminCommand(
+                {setParameter: 1, internalQueryMaxBlockingSortMemoryUsageBytes: memLimit}));
+            results.push(
+                coll.find({}, {a: 1, b: 1}).sort({a: 1, b: -1}).allowDiskUse(true).toArray());
+            results.push(coll.find({}, {a: 1, b: 1}).sort({b: 1}).allowDiskUse(true).toArray());
+            results.push(coll.aggregate(
+                                 [
+                                     {$project: {b: 1, k: {x: {$mod: ["$b", 13]}}, arr: [1, 2]}},
+                                     {$unwind: "$arr"},
+                                     {$sort: {k: 1, arr: -1, b: 1}},
+                                 ],
+                                 {allowDiskUse: true})
+                             .toArray());
+        }
+    }
+    return results;
+}
+
+const onWorkerThreads = runSorts();
+assert.commandWorked(db.adminCommand({setParameter: 1, internalSorterMaxWorkerThreads: 1}));
+assert.eq(runSorts(), onWorkerThreads);
+
+MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,55 @@
+/**
+ * Tests that a $group whose input is sorted on its group key streams its groups out one run of
+ * equal keys at a time, so that it needs memory for one run rather than for every group, and that
+ * it returns the same results as a $group over unsorted input.
+ */
+(function() {
+"use strict";
+
+const conn = MongoRunner.runMongod({});
+assert.neq(null, conn, "mongod was unable to start up");
+
+const db = conn.getDB("test");
+const coll = db.streaming_group;
+coll.drop();
+
+const kNumGroups = 200;
+const kDocsPerGroup = 5;
+const docs = [];
+for (let i = 0; i < kNumGroups * kDocsPerGroup; ++i) {
+    docs.push({_id: i, a: i % kNumGroups, b: "padding to make each group take some memory " + i});
+}
+assert.commandWorked(coll.insert(docs));
+
+const group = {$group: {_id: "$a", n: {$sum: 1}, bs: {$push: "$b"}}};
+const sortedPipeline = [{$sort: {a: 1}}, group, {$project: {n: 1}}];
+const unsortedPipeline = [group, {$project: {n: 1}}, {$sort: {_id: 1}}];
+
+const expected = [];
+for (let i = 0; i < kNumGroups; ++i) {
+    expected.push({_id: i, n: kDocsPerGroup});
+}
+assert.eq(expected, coll.aggregate(sortedPipeline).toArray());
+assert.eq(expected, coll.aggregate(unsortedPipeline).toArray());
+
+// With too little memory to hold every group, only the $group over sorted input succeeds without
+// spilling to disk.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: 16 * 1024}));
+assert.eq(expected, coll.aggregate(sortedPipeline, {allowDiskUse: false}).toArray());
+assert.commandFailedWithCode(
+    db.runCommand(
+        {aggregate: coll.getName(), pipeline: unsortedPipeline, cursor: {}, allowDiskUse: false}),
+    ErrorCodes.QueryExceededMemoryLimitNoDiskUseAllowed);
+
+// Without streaming, the $group over sorted input has to hold every group as well.
+assert.commandWorked(
+    db.adminCommand({setParameter: 1, internalDocumentSourceGroupEnableStreaming: false}));
+assert.commandFailedWithCode(
+    db.runCommand(
+        {aggregate: coll.getName(), pipeline: sortedPipeline, cursor: {}, allowDiskUse: false}),
+    ErrorCodes.QueryExceededMemoryLimitNoDiskUseAllowed);
+assert.eq(expected, coll.aggregate(sortedPipeline, {allowDiskUse: true}).toArray());
+
+MongoRunner.stopMongod(conn);
+})();
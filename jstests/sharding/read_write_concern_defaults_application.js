@@ -154,6 +154,15 @@ let testCases = {
         checkReadConcern: true,
         checkWriteConcern: true,
     },
+    analyze: {
+        setUp: function(conn) {
+            assert.commandWorked(conn.getCollection(nss).insert({x: 1}, {writeConcern: {w: 1}}));
+        },
+        command: {analyze: coll, key: "x"},
+        checkReadConcern: false,
+        checkWriteConcern: true,
+        target: "replset",
+    },
     appendOplogNote: {
         command: {appendOplogNote: 1, data: {foo: 1}},
         checkReadConcern: false,
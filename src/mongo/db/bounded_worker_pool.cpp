@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/bounded_worker_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "mongo/db/client.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+const auto getBoundedWorkerPool = ServiceContext::declareDecoration<BoundedWorkerPool>();
+
+}  // namespace
+
+BoundedWorkerPool::Reservation::Reservation(Reservation&& other)
+    : _pool(std::exchange(other._pool, nullptr)),
+      _kind(std::move(other._kind)),
+      _numWorkers(std::exchange(other._numWorkers, 0)) {}
+
+BoundedWorkerPool::Reservation& BoundedWorkerPool::Reservation::operator=(Reservation&& other) {
+    if (this != &other) {
+        _release();
+        _pool = std::exchange(other._pool, nullptr);
+        _kind = std::move(other._kind);
+        _numWorkers = std::exchange(other._numWorkers, 0);
+    }
+    return *this;
+}
+
+BoundedWorkerPool::Reservation::~Reservation() {
+    _release();
+}
+
+void BoundedWorkerPool::Reservation::schedule(ThreadPool::Task task) {
+    invariant(_pool && _numWorkers > 0);
+    _pool->_schedule(std::move(task));
+}
+
+void BoundedWorkerPool::Reservation::_release() {
+    if (_pool && _numWorkers > 0) {
+        _pool->_release(_kind, _numWorkers);
+    }
+    _pool = nullptr;
+    _numWorkers = 0;
+}
+
+BoundedWorkerPool::~BoundedWorkerPool() {
+    shutdown();
+}
+
+BoundedWorkerPool* BoundedWorkerPool::get(ServiceContext* serviceContext) {
+    return &getBoundedWorkerPool(serviceContext);
+}
+
+BoundedWorkerPool::Reservation BoundedWorkerPool::reserve(StringData kind,
+                                                          int maxWorkers,
+                                                          size_t wanted,
+                                                          size_t minWorkers) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_inShutdown) {
+        return {};
+    }
+
+    auto& reservedForKind = _reservedByKind[kind];
+    const auto available = std::min(std::max(maxWorkers - reservedForKind, 0),
+                                    std::max(kMaxThreads - _reserved, 0));
+    const auto numWorkers = std::min(wanted, static_cast<size_t>(available));
+    if (numWorkers == 0 || numWorkers < minWorkers) {
+        return {};
+    }
+
+    reservedForKind += numWorkers;
+    _reserved += numWorkers;
+    return Reservation(this, kind.toString(), static_cast<int>(numWorkers));
+}
+
+void BoundedWorkerPool::shutdown() {
+    ThreadPool* pool;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_inShutdown) {
+            return;
+        }
+        _inShutdown = true;
+        pool = _pool.get();
+    }
+
+    if (pool) {
+        pool->shutdown();
+        pool->join();
+    }
+}
+
+void BoundedWorkerPool::_schedule(ThreadPool::Task task) {
+    stdx::unique_lock<Latch> lk(_mutex);
+    if (!_pool && !_inShutdown) {
+        ThreadPool::Options options;
+        options.poolName = "BoundedWorkerPool";
+        options.threadNamePrefix = "BoundedWorker-";
+        options.minThreads = 0;
+        options.maxThreads = kMaxThreads;
+        options.onCreateThread = [serviceContext = getBoundedWorkerPool.owner(this)](
+                                     const std::string& threadName) {
+            Client::initThread(threadName, serviceContext, nullptr);
+        };
+        _pool = std::make_unique<ThreadPool>(options);
+        _pool->startup();
+    }
+    if (!_pool) {
+        lk.unlock();
+        task(Status(ErrorCodes::ShutdownInProgress, "The bounded worker pool is shut down"));
+        return;
+    }
+
+    // A pool which has been shut down since runs the task right away with an error status.
+    _pool->schedule(std::move(task));
+}
+
+void BoundedWorkerPool::_release(StringData kind, int numWorkers) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _reservedByKind.find(kind);
+    invariant(it != _reservedByKind.end() && it->second >= numWorkers);
+    it->second -= numWorkers;
+    _reserved -= numWorkers;
+}
+
+}  // namespace mongo
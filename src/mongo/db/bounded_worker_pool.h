@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "mongo/base/string_data.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * A pool of worker threads owned by the ServiceContext, shared by the operations which split their
+ * work among several threads, such as sorts and $facet stages. Its threads are started lazily and
+ * are given a Client, so that the work may create operations of its own.
+ *
+ * Workers must be reserved before work is scheduled on them. A reservation counts against the
+ * limit of its kind of work, such as internalSorterMaxWorkerThreads for sorts, and against
+ * kMaxThreads across all kinds. As no more work is scheduled at a time than there are workers
+ * reserved, scheduled work starts right away. An operation waiting for the work it scheduled
+ * therefore never waits for another one, even if that work reserves workers of its own.
+ */
+class BoundedWorkerPool {
+public:
+    // The most workers the pool has, across all kinds of work.
+    static constexpr int kMaxThreads = 64;
+
+    /**
+     * Workers reserved from the pool, which are given back when the reservation is destroyed.
+     */
+    class Reservation {
+    public:
+        Reservation() = default;
+        Reservation(Reservation&& other);
+        Reservation& operator=(Reservation&& other);
+        ~Reservation();
+
+        /**
+         * The number of workers reserved, which may be 0.
+         */
+        int size() const {
+            return _numWorkers;
+        }
+
+        /**
+         * Runs 'task' on one of the reserved workers. The caller must not have more tasks running
+         * at a time than there are workers reserved. If the pool is shut down, 'task' is called
+         * right away with an error status instead.
+         */
+        void schedule(ThreadPool::Task task);
+
+    private:
+        friend class BoundedWorkerPool;
+
+        Reservation(BoundedWorkerPool* pool, std::string kind, int numWorkers)
+            : _pool(pool), _kind(std::move(kind)), _numWorkers(numWorkers) {}
+
+        void _release();
+
+        BoundedWorkerPool* _pool = nullptr;
+        std::string _kind;
+        int _numWorkers = 0;
+    };
+
+    ~BoundedWorkerPool();
+
+    static BoundedWorkerPool* get(ServiceContext* serviceContext);
+
+    /**
+     * Reserves up to 'wanted' workers for the work of the given 'kind', so that no more than
+     * 'maxWorkers' workers are ever reserved for that kind of work at once. Returns an empty
+     * reservation if fewer than 'minWorkers' workers are available or if the pool is shut down.
+     */
+    Reservation reserve(StringData kind, int maxWorkers, size_t wanted, size_t minWorkers = 1);
+
+    /**
+     * Waits for the work scheduled on the pool to finish, and runs the work scheduled later on with
+     * an error status. Reservations made from now on are empty.
+     */
+    void shutdown();
+
+private:
+    void _schedule(ThreadPool::Task task);
+    void _release(StringData kind, int numWorkers);
+
+    Mutex _mutex = MONGO_MAKE_LATCH("BoundedWorkerPool::_mutex");
+    std::unique_ptr<ThreadPool> _pool;
+
+    // The number of workers reserved for each kind of work, and for all of them together.
+    StringMap<int> _reservedByKind;
+    int _reserved = 0;
+
+    bool _inShutdown = false;
+};
+
+}  // namespace mongo
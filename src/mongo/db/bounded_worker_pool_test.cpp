@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/bounded_worker_pool.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/notification.h"
+
+namespace mongo {
+namespace {
+
+class BoundedWorkerPoolTest : public ServiceContextTest {
+protected:
+    BoundedWorkerPool* pool() {
+        return BoundedWorkerPool::get(getServiceContext());
+    }
+};
+
+TEST_F(BoundedWorkerPoolTest, ReservesNoMoreThanTheLimitOfTheKind) {
+    auto reservation = pool()->reserve("a", 3, 5);
+    ASSERT_EQ(3, reservation.size());
+    ASSERT_EQ(0, pool()->reserve("a", 3, 1).size());
+
+    // Other kinds of work have limits of their own.
+    ASSERT_EQ(2, pool()->reserve("b", 3, 2).size());
+
+    reservation = {};
+    ASSERT_EQ(3, pool()->reserve("a", 3, 5).size());
+}
+
+TEST_F(BoundedWorkerPoolTest, ReservesNoMoreThanTheThreadsOfThePool) {
+    auto reservation = pool()->reserve("a", BoundedWorkerPool::kMaxThreads + 1, 100);
+    ASSERT_EQ(BoundedWorkerPool::kMaxThreads, reservation.size());
+    ASSERT_EQ(0, pool()->reserve("b", 4, 1).size());
+}
+
+TEST_F(BoundedWorkerPoolTest, ReservesNothingWhenFewerThanTheMinimumAreAvailable) {
+    auto reservation = pool()->reserve("a", 4, 3);
+    ASSERT_EQ(3, reservation.size());
+    ASSERT_EQ(0, pool()->reserve("a", 4, 4, 2).size());
+    ASSERT_EQ(1, pool()->reserve("a", 4, 4, 1).size());
+}
+
+TEST_F(BoundedWorkerPoolTest, RunsScheduledTasksOnThreadsWithAClient) {
+    auto reservation = pool()->reserve("a", 2, 2);
+    ASSERT_EQ(2, reservation.size());
+
+    Notification<bool> first;
+    Notification<bool> second;
+    reservation.schedule([&](Status status) { first.set(status.isOK() && haveClient()); });
+    reservation.schedule([&](Status status) { second.set(status.isOK() && haveClient()); });
+    ASSERT_TRUE(first.get());
+    ASSERT_TRUE(second.get());
+}
+
+TEST_F(BoundedWorkerPoolTest, RunsTasksWithAnErrorAfterShutdown) {
+    auto reservation = pool()->reserve("a", 1, 1);
+    ASSERT_EQ(1, reservation.size());
+
+    pool()->shutdown();
+    ASSERT_EQ(0, pool()->reserve("a", 2, 1).size());
+
+    bool ran = false;
+    reservation.schedule([&](Status status) {
+        ASSERT_EQ(ErrorCodes::ShutdownInProgress, status);
+        ran = true;
+    });
+    ASSERT_TRUE(ran);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -196,6 +196,8 @@ StatusWith<CollectionOptions> CollectionOptions::parse(const BSONObj& options, P
             }
 
             collectionOptions.pipeline = e.Obj().getOwned();
+        } else if (fieldName == "materialized") {
+            collectionOptions.materialized = e.trueValue();
         } else if (fieldName == "idIndex" && kind == parseForCommand) {
             if (e.type() != mongo::Object) {
                 return Status(ErrorCodes::TypeMismatch, "'idIndex' has to be an object.");
@@ -230,6 +232,10 @@ StatusWith<CollectionOptions> CollectionOptions::parse(const BSONObj& options, P
         return Status(ErrorCodes::BadValue, "'pipeline' cannot be specified without 'viewOn'");
     }
 
+    if (collectionOptions.viewOn.empty() && collectionOptions.materialized) {
+        return Status(ErrorCodes::BadValue, "'materialized' cannot be specified without 'viewOn'");
+    }
+
     return collectionOptions;
 }
 
@@ -274,6 +280,9 @@ CollectionOptions CollectionOptions::parse(const CreateCommand& cmd) {
         }
         options.pipeline = std::move(builder.arr());
     }
+    if (auto materialized = cmd.getMaterialized()) {
+        options.materialized = *materialized;
+    }
     if (auto collation = cmd.getCollation()) {
         options.collation = std::move(*collation);
     }
@@ -351,6 +360,10 @@ void CollectionOptions::appendBSON(BSONObjBuilder* builder) const {
         builder->appendArray("pipeline", pipeline);
     }
 
+    if (materialized) {
+        builder->appendBool("materialized", true);
+    }
+
     if (!idIndex.isEmpty()) {
         builder->append("idIndex", idIndex);
     }
@@ -426,6 +439,10 @@ bool CollectionOptions::matchesStorageOptions(const CollectionOptions& other,
         return false;
     }
 
+    if (materialized != other.materialized) {
+        return false;
+    }
+
     if ((timeseries && other.timeseries &&
          timeseries->toBSON().woCompare(other.timeseries->toBSON()) != 0) ||
         (timeseries == boost::none) != (other.timeseries == boost::none)) {
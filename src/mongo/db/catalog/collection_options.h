@@ -141,6 +141,8 @@ struct CollectionOptions {
     std::string viewOn;
     // The aggregation pipeline that defines this view.
     BSONObj pipeline;
+    // Whether the result of the pipeline is stored and kept up to date as 'viewOn' changes.
+    bool materialized = false;
 
     // The options that define the time-series collection, or boost::none if not a time-series
     // collection.
@@ -46,6 +46,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/ops/insert.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/views/materialized_view.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/idl/command_generic_argument.h"
 #include "mongo/logv2/log.h"
@@ -179,6 +180,101 @@ Status _createTimeseries(OperationContext* opCtx,
     });
 }
 
+Status _createMaterializedView(OperationContext* opCtx,
+                               const NamespaceString& ns,
+                               CollectionOptions&& options) {
+    return writeConflictRetry(opCtx, "create", ns.ns(), [&]() -> Status {
+        AutoGetCollection autoColl(opCtx, ns, MODE_IX);
+        // The collection the view is defined on is locked in MODE_S until the view is populated,
+        // since the writes to it which would keep the view up to date are not observed before the
+        // view exists.
+        const NamespaceString sourceNs(ns.db(), options.viewOn);
+        Lock::CollectionLock sourceCollLock(opCtx, sourceNs, MODE_S);
+        const auto materializedNs = ns.makeMaterializedViewNamespace();
+        Lock::CollectionLock materializedCollLock(opCtx, materializedNs, MODE_IX);
+        Lock::CollectionLock systemDotViewsLock(
+            opCtx,
+            NamespaceString(ns.db(), NamespaceString::kSystemDotViewsCollectionName),
+            MODE_X);
+
+        if (opCtx->writesAreReplicated() &&
+            !repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx, ns)) {
+            return {ErrorCodes::NotWritablePrimary,
+                    str::stream() << "Not primary while creating collection " << ns};
+        }
+
+        const auto& sourceColl =
+            CollectionCatalog::get(opCtx).lookupCollectionByNamespace(opCtx, sourceNs);
+        if (!sourceColl) {
+            return {ErrorCodes::NamespaceNotFound,
+                    str::stream() << "A materialized view must be defined on an existing "
+                                     "collection, but "
+                                  << sourceNs << " does not exist"};
+        }
+
+        // Updates applied in place only report the document they change when the collection
+        // records its pre-images.
+        if (!sourceColl->getRecordPreImages()) {
+            return {ErrorCodes::InvalidOptions,
+                    str::stream() << "A materialized view can only be defined on a collection "
+                                     "created with recordPreImages, but "
+                                  << sourceNs << " was not"};
+        }
+
+        auto db = autoColl.ensureDbExists();
+        _createSystemDotViewsIfNecessary(opCtx, db);
+
+        WriteUnitOfWork wuow(opCtx);
+
+        AutoStatsTracker statsTracker(
+            opCtx,
+            ns,
+            Top::LockType::NotLocked,
+            AutoStatsTracker::LogMode::kUpdateTopAndCurOp,
+            CollectionCatalog::get(opCtx).getDatabaseProfileLevel(ns.db()));
+
+        AutoStatsTracker materializedStatsTracker(
+            opCtx,
+            materializedNs,
+            Top::LockType::NotLocked,
+            AutoStatsTracker::LogMode::kUpdateTopAndCurOp,
+            CollectionCatalog::get(opCtx).getDatabaseProfileLevel(ns.db()));
+
+        // If the view and the collection holding its result roll back, ensure that their Top
+        // entries are deleted.
+        opCtx->recoveryUnit()->onRollback(
+            [serviceContext = opCtx->getServiceContext(), &ns, &materializedNs]() {
+                Top::get(serviceContext).collectionDropped(ns);
+                Top::get(serviceContext).collectionDropped(materializedNs);
+            });
+
+        // Even though 'options' is passed by rvalue reference, it is not safe to move because
+        // 'userCreateNS' may throw a WriteConflictException.
+        auto status = db->userCreateNS(opCtx, ns, options);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        // The groups are stored with the collation of the view, so that they are told apart the
+        // same way as when the pipeline of the view runs.
+        CollectionOptions materializedOptions;
+        materializedOptions.collation = options.collation;
+        CollectionPtr materializedColl(
+            db->createCollection(opCtx, materializedNs, materializedOptions));
+        invariant(materializedColl,
+                  str::stream() << "Failed to create collection " << materializedNs
+                                << " for materialized view " << ns);
+
+        auto view = ViewCatalog::get(db)->lookup(opCtx, ns.ns());
+        invariant(view);
+        populateMaterializedView(opCtx, *view, sourceColl, materializedColl);
+
+        wuow.commit();
+
+        return Status::OK();
+    });
+}
+
 Status _createCollection(OperationContext* opCtx,
                          const NamespaceString& nss,
                          CollectionOptions&& collectionOptions,
@@ -248,6 +344,9 @@ Status createCollection(OperationContext* opCtx,
                 str::stream() << "Cannot create a view in a multi-document "
                                  "transaction.",
                 !opCtx->inMultiDocumentTransaction());
+        if (options.materialized) {
+            return _createMaterializedView(opCtx, ns, std::move(options));
+        }
         return _createView(opCtx, ns, std::move(options), idIndex);
     } else if (options.timeseries) {
         uassert(ErrorCodes::OperationNotSupportedInTransaction,
@@ -322,15 +322,19 @@ Status dropCollection(OperationContext* opCtx,
                 return Status(ErrorCodes::NamespaceNotFound, "ns not found");
             }
 
-            if (!view->isTimeseries()) {
+            if (!view->isTimeseries() && !view->isMaterialized()) {
                 return _dropView(opCtx, db, collectionName, &result);
             }
 
+            // The buckets collection of a time-series collection, and the collection holding the
+            // result of a materialized view, are dropped along with the view.
+            const NamespaceString backingNs =
+                view->isTimeseries() ? view->viewOn() : view->materializedNss();
             return _abortIndexBuildsAndDrop(
                 opCtx,
                 std::move(autoDb),
-                view->viewOn(),
-                [opCtx, &collectionName, &result](Database* db, const NamespaceString& bucketsNs) {
+                backingNs,
+                [opCtx, &collectionName, &result](Database* db, const NamespaceString& backingNs) {
                     WriteUnitOfWork wuow(opCtx);
                     auto status = _dropView(opCtx, db, collectionName, &result);
                     if (!status.isOK()) {
@@ -338,11 +342,11 @@ Status dropCollection(OperationContext* opCtx,
                     }
                     wuow.commit();
 
-                    // Drop the buckets collection in its own writeConflictRetry so that
-                    // if it throws a WCE, only the buckets collection drop is retried.
-                    writeConflictRetry(opCtx, "drop", bucketsNs.ns(), [opCtx, db, &bucketsNs] {
+                    // Drop the backing collection in its own writeConflictRetry so that
+                    // if it throws a WCE, only the backing collection drop is retried.
+                    writeConflictRetry(opCtx, "drop", backingNs.ns(), [opCtx, db, &backingNs] {
                         WriteUnitOfWork wuow(opCtx);
-                        db->dropCollectionEvenIfSystem(opCtx, bucketsNs).ignore();
+                        db->dropCollectionEvenIfSystem(opCtx, backingNs).ignore();
                         wuow.commit();
                     });
 
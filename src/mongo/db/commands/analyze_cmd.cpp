@@ -0,0 +1,173 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace {
+
+constexpr StringData kKeyField = "key"_sd;
+constexpr StringData kNumberBucketsField = "numberBuckets"_sd;
+constexpr StringData kSampleSizeField = "sampleSize"_sd;
+
+constexpr long long kDefaultNumberBuckets = 100;
+constexpr long long kMaxNumberBuckets = 1000;
+constexpr long long kDefaultSampleSize = 100'000;
+constexpr long long kMaxSampleSize = 10'000'000;
+
+long long parseBoundedLong(const BSONObj& cmdObj,
+                           StringData fieldName,
+                           long long defaultValue,
+                           long long min,
+                           long long max) {
+    auto elem = cmdObj[fieldName];
+    if (elem.eoo()) {
+        return defaultValue;
+    }
+    uassert(5300803,
+            str::stream() << "'" << fieldName << "' must be a number",
+            elem.isNumber());
+    auto value = elem.safeNumberLong();
+    uassert(5300804,
+            str::stream() << "'" << fieldName << "' must be between " << min << " and " << max,
+            value >= min && value <= max);
+    return value;
+}
+
+/**
+ * The 'analyze' command gathers statistics about the values of a field of a collection, which the
+ * query planner uses to estimate the cost of the candidate plans of queries on the collection:
+ *
+ *    {
+ *        analyze: <collection>,
+ *        key: <path>,
+ *        numberBuckets: <maximum number of histogram buckets>,
+ *        sampleSize: <maximum number of values the histogram is built from>
+ *    }
+ *
+ * The statistics are stored in the 'system.statistics' collection of the database, and replace
+ * those previously gathered for the same field.
+ */
+class AnalyzeCommand final : public BasicCommand {
+public:
+    AnalyzeCommand() : BasicCommand("analyze") {}
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return true;
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    std::string help() const override {
+        return "Gathers statistics about the values of a field of a collection for the query "
+               "planner.";
+    }
+
+    Status checkAuthForCommand(Client* client,
+                               const std::string& dbname,
+                               const BSONObj& cmdObj) const override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+        auto authzSession = AuthorizationSession::get(client);
+        if (authzSession->isAuthorizedForActionsOnNamespace(
+                nss, ActionSet{ActionType::find, ActionType::planCacheWrite}) &&
+            authzSession->isAuthorizedForActionsOnNamespace(
+                NamespaceString(dbname, NamespaceString::kSystemDotStatisticsCollectionName),
+                ActionSet{ActionType::insert, ActionType::update})) {
+            return Status::OK();
+        }
+        return Status(ErrorCodes::Unauthorized, "unauthorized");
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+        uassert(ErrorCodes::InvalidNamespace,
+                str::stream() << "Cannot analyze system collection " << nss,
+                !nss.isSystem());
+
+        auto keyElem = cmdObj[kKeyField];
+        uassert(5300805,
+                "'key' must be a non-empty field path",
+                keyElem.type() == BSONType::String && !keyElem.valueStringData().empty() &&
+                    keyElem.valueStringData()[0] != '$');
+        const auto numberBuckets = parseBoundedLong(
+            cmdObj, kNumberBucketsField, kDefaultNumberBuckets, 2, kMaxNumberBuckets);
+        const auto sampleSize =
+            parseBoundedLong(cmdObj, kSampleSizeField, kDefaultSampleSize, 1, kMaxSampleSize);
+
+        std::shared_ptr<const FieldStatistics> stats;
+        {
+            AutoGetCollectionForReadCommand collection(opCtx, nss);
+            uassert(ErrorCodes::NamespaceNotFound,
+                    str::stream() << "Collection " << nss << " does not exist",
+                    collection.getCollection());
+
+            stats = std::make_shared<const FieldStatistics>(
+                FieldStatistics::gather(opCtx,
+                                        collection.getCollection(),
+                                        keyElem.valueStringData(),
+                                        numberBuckets,
+                                        sampleSize));
+        }
+
+        persistFieldStatistics(opCtx, nss, stats);
+
+        LOGV2(5300806,
+              "Analyzed field",
+              "namespace"_attr = nss,
+              "path"_attr = stats->path,
+              "numRecords"_attr = stats->numRecords,
+              "numValues"_attr = stats->numValues);
+
+        result.append("numRecords", stats->numRecords);
+        result.append("numValues", stats->numValues);
+        result.append("distinctEstimate", stats->sketch.estimate());
+        result.append("numberBuckets", static_cast<long long>(stats->histogram.buckets().size()));
+        return true;
+    }
+} analyzeCommand;
+
+}  // namespace
+}  // namespace mongo
@@ -379,6 +379,18 @@ public:
                     cmd.getViewOn());
         }
 
+        // The collection holding the groups of a materialized view is only created along with it.
+        uassert(ErrorCodes::InvalidNamespace,
+                str::stream() << "Cannot create the collection " << nsToCreate
+                              << ", whose name is reserved for materialized views",
+                !nsToCreate.isMaterializedViewCollection());
+
+        if (cmd.getMaterialized()) {
+            uassert(ErrorCodes::InvalidOptions,
+                    "'materialized' requires 'viewOn' to also be specified",
+                    cmd.getViewOn());
+        }
+
         if (auto timeseries = cmd.getTimeseries()) {
             uassert(ErrorCodes::InvalidOptions,
                     "Time-series collection is not enabled",
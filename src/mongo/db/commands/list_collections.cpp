@@ -152,6 +152,9 @@ BSONObj buildViewBson(const ViewDefinition& view, bool nameOnly) {
     if (view.defaultCollator()) {
         optionsBuilder.append("collation", view.defaultCollator()->getSpec().toBSON());
     }
+    if (view.isMaterialized()) {
+        optionsBuilder.append("materialized", true);
+    }
     optionsBuilder.doneFast();
 
     BSONObj info = BSON("readOnly" << true);
@@ -47,6 +47,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/aggregation_result_cache.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
@@ -111,7 +112,8 @@ bool canOptimizeAwayPipeline(const Pipeline* pipeline,
  * Returns true if we need to keep a ClientCursor saved for this pipeline (for future getMore
  * requests). Otherwise, returns false. The passed 'nsForCursor' is only used to determine the
  * namespace used in the returned cursor, which will be registered with the global cursor manager,
- * and thus will be different from that in 'request'.
+ * and thus will be different from that in 'request'. If 'firstBatch' is not null, the documents
+ * returned in the first batch are also added to it.
  */
 bool handleCursorCommand(OperationContext* opCtx,
                          boost::intrusive_ptr<ExpressionContext> expCtx,
@@ -119,7 +121,8 @@ bool handleCursorCommand(OperationContext* opCtx,
                          std::vector<ClientCursor*> cursors,
                          const AggregationRequest& request,
                          const BSONObj& cmdObj,
-                         rpc::ReplyBuilderInterface* result) {
+                         rpc::ReplyBuilderInterface* result,
+                         std::vector<BSONObj>* firstBatch) {
     invariant(!cursors.empty());
     long long batchSize = request.getBatchSize();
 
@@ -221,6 +224,9 @@ bool handleCursorCommand(OperationContext* opCtx,
         // If this executor produces a postBatchResumeToken, add it to the cursor response.
         responseBuilder.setPostBatchResumeToken(exec->getPostBatchResumeToken());
         responseBuilder.append(nextDoc);
+        if (firstBatch) {
+            firstBatch->push_back(nextDoc.getOwned());
+        }
     }
 
     if (cursor) {
@@ -470,6 +476,146 @@ std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> createExchangePipelinesI
 
     return pipelines;
 }
+
+/**
+ * Returns true if 'spec', part of the specification of a pipeline, refers to a stage, expression
+ * or variable whose results may differ between runs over the same data.
+ */
+bool isNondeterministic(const BSONObj& spec) {
+    static const StringDataSet kNondeterministicNames{"$sample",
+                                                      "$sampleRate",
+                                                      "$rand",
+                                                      "$function",
+                                                      "$accumulator",
+                                                      "$where",
+                                                      "$collStats",
+                                                      "$indexStats",
+                                                      "$planCacheStats"};
+    for (auto&& elem : spec) {
+        if (kNondeterministicNames.count(elem.fieldNameStringData())) {
+            return true;
+        }
+        if (elem.type() == BSONType::String &&
+            (elem.valueStringData().startsWith("$$NOW") ||
+             elem.valueStringData().startsWith("$$CLUSTER_TIME"))) {
+            return true;
+        }
+        if (elem.isABSONObj() && isNondeterministic(elem.Obj())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool isNondeterministic(const std::vector<BSONObj>& pipeline) {
+    return std::any_of(pipeline.begin(), pipeline.end(), [](const BSONObj& stage) {
+        return isNondeterministic(stage);
+    });
+}
+
+/**
+ * Returns true if the results of 'request' may be served from, and added to, the
+ * AggregationResultCache. Only the aggregations over a collection which read its latest data
+ * outside of a transaction, and whose pipelines do not write or otherwise depend on anything other
+ * than that data, are cached. Whether the storage snapshot is of the latest data is only known
+ * once it is opened, and is checked then.
+ */
+bool canUseAggregationResultCache(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  const AggregationRequest& request,
+                                  const LiteParsedPipeline& liteParsedPipeline) {
+    if (!AggregationResultCache::isEnabled()) {
+        return false;
+    }
+
+    if (request.getExplain() || request.getExchangeSpec() || request.isFromMongos() ||
+        request.needsMerge() || request.getBatchSize() == 0 ||
+        opCtx->inMultiDocumentTransaction() || liteParsedPipeline.hasChangeStream()) {
+        return false;
+    }
+
+    // The writes to the oplog, and to most system collections, are not seen by OpObservers.
+    if (nss.isCollectionlessAggregateNS() || nss.isOnInternalDb() ||
+        (nss.isSystem() && !nss.isMaterializedViewCollection())) {
+        return false;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    if (readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsAfterClusterTime() || readConcernArgs.getArgsAtClusterTime() ||
+        readConcernArgs.getArgsOpTime()) {
+        return false;
+    }
+
+    // The let parameters are evaluated once per aggregation, so '$$NOW' or '$rand' in them would
+    // make the results differ between runs just as in the pipeline.
+    return !isNondeterministic(request.getPipeline()) &&
+        !isNondeterministic(request.getLetParameters());
+}
+
+/**
+ * Returns the key under which the results of 'pipeline', optimized but not yet given its input,
+ * are cached in the AggregationResultCache.
+ */
+std::string makeAggregationResultCacheKey(const NamespaceString& origNss,
+                                          const boost::optional<UUID>& uuid,
+                                          const AggregationRequest& request,
+                                          const ExpressionContext& expCtx,
+                                          const Pipeline& pipeline) {
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("ns", origNss.ns());
+    keyBuilder.append("executionNs", request.getNamespaceString().ns());
+    if (uuid) {
+        uuid->appendToBuilder(&keyBuilder, "uuid");
+    }
+    keyBuilder.append("collation", expCtx.getCollatorBSON());
+    keyBuilder.append("hint", request.getHint());
+    keyBuilder.append("let", request.getLetParameters());
+    keyBuilder.append("batchSize", request.getBatchSize());
+    keyBuilder.append("pipeline", pipeline.serializeToBson());
+    auto key = keyBuilder.done();
+    return std::string(key.objdata(), key.objsize());
+}
+
+/**
+ * Returns the namespaces which the results of an aggregation on 'nss' are read from, including
+ * the views it refers to and the collections they are defined on, or boost::none if a view it
+ * refers to cannot be cached.
+ */
+boost::optional<std::vector<NamespaceString>> getAggregationResultCacheDependencies(
+    const NamespaceString& nss, const ExpressionContext& expCtx) {
+    std::vector<NamespaceString> dependencies{
+        nss, NamespaceString(nss.db(), NamespaceString::kSystemDotViewsCollectionName)};
+    for (auto&& [coll, resolvedNs] : expCtx.getResolvedNamespaces()) {
+        if (isNondeterministic(resolvedNs.pipeline)) {
+            return boost::none;
+        }
+        dependencies.emplace_back(nss.db(), coll);
+        dependencies.push_back(resolvedNs.ns);
+    }
+    return dependencies;
+}
+
+/**
+ * Responds to the aggregation with 'results' from the AggregationResultCache, all in the first
+ * batch of an exhausted cursor.
+ */
+void appendCachedResults(OperationContext* opCtx,
+                         const NamespaceString& nsForCursor,
+                         const std::vector<BSONObj>& results,
+                         rpc::ReplyBuilderInterface* result) {
+    CursorResponseBuilder::Options options;
+    options.isInitialResponse = true;
+    CursorResponseBuilder responseBuilder(result, options);
+    for (auto&& doc : results) {
+        responseBuilder.append(doc);
+    }
+    responseBuilder.done(0LL, nsForCursor.ns());
+
+    auto curOp = CurOp::get(opCtx);
+    curOp->debug().nreturned = results.size();
+    curOp->debug().cursorExhausted = true;
+}
 }  // namespace
 
 Status runAggregate(OperationContext* opCtx,
@@ -506,6 +652,17 @@ Status runAggregate(OperationContext* opCtx,
     std::vector<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> execs;
     boost::intrusive_ptr<ExpressionContext> expCtx;
     auto curOp = CurOp::get(opCtx);
+
+    // If set, the results of this aggregation may be served from, and added to, the
+    // AggregationResultCache. The write sequence number is taken before the collection is locked,
+    // so that every write the aggregation may not see is ordered after it.
+    boost::optional<uint64_t> resultCacheReadSequence;
+    std::string resultCacheKey;
+    std::vector<NamespaceString> resultCacheDependencies;
+    if (canUseAggregationResultCache(opCtx, nss, request, liteParsedPipeline)) {
+        resultCacheReadSequence = AggregationResultCache::get(opCtx)->getReadSequence(opCtx);
+    }
+
     {
         // If we are in a transaction, check whether the parsed pipeline supports
         // being in a transaction.
@@ -648,6 +805,32 @@ Status runAggregate(OperationContext* opCtx,
 
         pipeline->optimizePipeline();
 
+        // A snapshot at a timestamp, such as those read from on secondaries, may not include the
+        // writes which have already been noted in the cache. Nor are the pipelines which write,
+        // ending in $out or $merge, cached.
+        boost::optional<std::vector<NamespaceString>> resultCacheDependenciesIfCacheable;
+        if (resultCacheReadSequence &&
+            opCtx->recoveryUnit()->getTimestampReadSource() ==
+                RecoveryUnit::ReadSource::kNoTimestamp &&
+            (pipeline->getSources().empty() ||
+             !pipeline->getSources().back()->constraints().writesPersistentData())) {
+            resultCacheDependenciesIfCacheable =
+                getAggregationResultCacheDependencies(nss, *expCtx);
+        }
+
+        if (resultCacheDependenciesIfCacheable) {
+            resultCacheKey =
+                makeAggregationResultCacheKey(origNss, uuid, request, *expCtx, *pipeline);
+            resultCacheDependencies = std::move(*resultCacheDependenciesIfCacheable);
+            if (auto cachedResults = AggregationResultCache::get(opCtx)->lookup(resultCacheKey)) {
+                appendCachedResults(opCtx, origNss, *cachedResults, result);
+                liteParsedPipeline.tickGlobalStageCounters();
+                return Status::OK();
+            }
+        } else {
+            resultCacheReadSequence = boost::none;
+        }
+
         // Check if the pipeline has a $geoNear stage, as it will be ripped away during the build
         // query executor phase below (to be replaced with a $geoNearCursorStage later during the
         // executor attach phase).
@@ -778,10 +961,24 @@ Status runAggregate(OperationContext* opCtx,
         }
     } else {
         // Cursor must be specified, if explain is not.
-        const bool keepCursor = handleCursorCommand(
-            opCtx, expCtx, origNss, std::move(cursors), request, cmdObj, result);
+        std::vector<BSONObj> firstBatch;
+        const bool keepCursor = handleCursorCommand(opCtx,
+                                                    expCtx,
+                                                    origNss,
+                                                    std::move(cursors),
+                                                    request,
+                                                    cmdObj,
+                                                    result,
+                                                    resultCacheReadSequence ? &firstBatch
+                                                                            : nullptr);
         if (keepCursor) {
             cursorFreer.dismiss();
+        } else if (resultCacheReadSequence) {
+            // Only the results which were all returned in the first batch are cached.
+            AggregationResultCache::get(opCtx)->insert(resultCacheKey,
+                                                       std::move(firstBatch),
+                                                       std::move(resultCacheDependencies),
+                                                       *resultCacheReadSequence);
         }
 
         PlanSummaryStats stats;
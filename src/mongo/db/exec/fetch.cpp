@@ -31,6 +31,7 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/catalog/collection.h"
@@ -53,11 +54,13 @@ FetchStage::FetchStage(ExpressionContext* expCtx,
                        WorkingSet* ws,
                        std::unique_ptr<PlanStage> child,
                        const MatchExpression* filter,
-                       const CollectionPtr& collection)
+                       const CollectionPtr& collection,
+                       size_t batchSize)
     : RequiresCollectionStage(kStageType, expCtx, collection),
       _ws(ws),
       _filter((filter && !filter->isTriviallyTrue()) ? filter : nullptr),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      _batchSize(std::max(batchSize, size_t(1))) {
     _children.emplace_back(std::move(child));
 }
 
@@ -69,6 +72,11 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (!_batch.empty()) {
+        // There are members collected from the child which we have yet to return.
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -77,6 +85,10 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_batchSize > 1) {
+        return doWorkBatched(out);
+    }
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
@@ -125,6 +137,95 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::doWorkBatched(WorkingSetID* out) {
+    if (!_batchReady) {
+        // Collect the next batch from the child.
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState status = child()->work(&id);
+        if (PlanStage::ADVANCED == status) {
+            _batch.push_back(id);
+            if (_batch.size() < _batchSize && !child()->isEOF()) {
+                return NEED_TIME;
+            }
+        } else if (PlanStage::IS_EOF == status) {
+            if (_batch.empty()) {
+                return IS_EOF;
+            }
+        } else {
+            if (PlanStage::NEED_YIELD == status) {
+                *out = id;
+            }
+            return status;
+        }
+
+        // The batch is complete: order the members still needing their records by RecordId.
+        _fetchOrder.clear();
+        _nextToFetch = 0;
+        _nextToReturn = 0;
+        for (size_t i = 0; i < _batch.size(); ++i) {
+            WorkingSetMember* member = _ws->get(_batch[i]);
+            if (member->hasObj()) {
+                ++_specificStats.alreadyHasObj;
+            } else {
+                // We need a valid RecordId to fetch from and this is the only state that has one.
+                verify(WorkingSetMember::RID_AND_IDX == member->getState());
+                verify(member->hasRecordId());
+                _fetchOrder.push_back(i);
+            }
+        }
+        std::sort(_fetchOrder.begin(), _fetchOrder.end(), [&](size_t lhs, size_t rhs) {
+            return _ws->get(_batch[lhs])->recordId < _ws->get(_batch[rhs])->recordId;
+        });
+        _batchReady = true;
+        ++_specificStats.batchesFetched;
+    }
+
+    if (_nextToFetch < _fetchOrder.size()) {
+        try {
+            fetchBatch();
+        } catch (const WriteConflictException&) {
+            // The members fetched so far own their objects, and the next call resumes fetching
+            // from the member which hit the conflict.
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+    }
+
+    // Return the members of the batch in the order the child produced them, skipping those whose
+    // record is gone.
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    while (id == WorkingSet::INVALID_ID && _nextToReturn < _batch.size()) {
+        id = _batch[_nextToReturn++];
+    }
+    if (_nextToReturn == _batch.size()) {
+        _batch.clear();
+        _batchReady = false;
+    }
+
+    if (id == WorkingSet::INVALID_ID) {
+        return NEED_TIME;
+    }
+    return returnIfMatches(_ws->get(id), id, out);
+}
+
+void FetchStage::fetchBatch() {
+    if (!_cursor)
+        _cursor = collection()->getCursor(opCtx());
+
+    for (; _nextToFetch < _fetchOrder.size(); ++_nextToFetch) {
+        WorkingSetID& id = _batch[_fetchOrder[_nextToFetch]];
+        if (!WorkingSetCommon::fetch(opCtx(), _ws, id, _cursor, collection()->ns())) {
+            _ws->free(id);
+            id = WorkingSet::INVALID_ID;
+            continue;
+        }
+
+        // The next seek of the cursor may release the record just read, while the member has
+        // yet to be returned.
+        _ws->get(id)->makeObjOwnedIfNeeded();
+    }
+}
+
 void FetchStage::doSaveStateRequiresCollection() {
     if (_cursor) {
         _cursor->saveUnpositioned();
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/jsobj.h"
@@ -47,6 +48,11 @@ class SeekableRecordCursor;
  * the record at the provided RecordId.  Returns verbatim any data that already has an object.
  *
  * Preconditions: Valid RecordId.
+ *
+ * With a 'batchSize' greater than one, the stage collects up to that many members from its child
+ * before reading any of their records, then reads them in RecordId order so that consecutive seeks
+ * land near one another in the record store. The members are still returned in the order the child
+ * produced them, which keeps any sort order provided by an index scan below.
  */
 class FetchStage : public RequiresCollectionStage {
 public:
@@ -54,7 +60,8 @@ public:
                WorkingSet* ws,
                std::unique_ptr<PlanStage> child,
                const MatchExpression* filter,
-               const CollectionPtr& collection);
+               const CollectionPtr& collection,
+               size_t batchSize = 1);
 
     ~FetchStage();
 
@@ -86,6 +93,18 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Implements doWork() when fetching in batches: fills '_batch' from the child, reads the
+     * records of the batch in RecordId order, then returns its members in their original order.
+     */
+    StageState doWorkBatched(WorkingSetID* out);
+
+    /**
+     * Reads the records of the members of '_batch' not fetched yet, in RecordId order. Throws
+     * WriteConflictException, in which case a later call resumes where this one stopped.
+     */
+    void fetchBatch();
+
     // Used to fetch Records from _collection.
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
@@ -98,6 +117,24 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // The number of members collected from the child before fetching their records.
+    const size_t _batchSize;
+
+    // The members of the current batch, in the order the child returned them. A member whose
+    // record no longer exists is freed and replaced by WorkingSet::INVALID_ID.
+    std::vector<WorkingSetID> _batch;
+
+    // Positions in '_batch' of the members left to fetch, sorted by RecordId, and how many of them
+    // have been fetched already.
+    std::vector<size_t> _fetchOrder;
+    size_t _nextToFetch = 0;
+
+    // Whether '_batch' holds a complete batch, whose members are being fetched or returned.
+    bool _batchReady = false;
+
+    // Position in '_batch' of the next member to return, once the whole batch has been fetched.
+    size_t _nextToReturn = 0;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -431,6 +431,9 @@ struct FetchStats : public SpecificStats {
 
     // The total number of full documents touched by the fetch stage.
     size_t docsExamined = 0u;
+
+    // The number of batches of records read in RecordId order, when fetching in batches.
+    size_t batchesFetched = 0u;
 };
 
 struct IDHackStats : public SpecificStats {
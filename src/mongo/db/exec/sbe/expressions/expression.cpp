@@ -375,6 +375,10 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
     {"addToSet", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::addToSet, true}},
     {"doubleDoubleSum",
      BuiltinFn{[](size_t n) { return n > 0; }, vm::Builtin::doubleDoubleSum, false}},
+    {"aggDoubleDoubleSum",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::aggDoubleDoubleSum, true}},
+    {"doubleDoubleSumFinalize",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::doubleDoubleSumFinalize, false}},
     {"bitTestZero", BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::bitTestZero, false}},
     {"bitTestMask", BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::bitTestMask, false}},
     {"bitTestPosition",
@@ -413,6 +417,22 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
      BuiltinFn{[](size_t n) { return n > 0; }, vm::Builtin::setIntersection, false}},
     {"setDifference",
      BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::setDifference, false}},
+    {"valueBlockMatchLt",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockMatchLt, false}},
+    {"valueBlockMatchLte",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockMatchLte, false}},
+    {"valueBlockMatchGt",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockMatchGt, false}},
+    {"valueBlockMatchGte",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockMatchGte, false}},
+    {"valueBlockMatchEq",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockMatchEq, false}},
+    {"valueBlockLogicalAnd",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockLogicalAnd, false}},
+    {"valueBlockLogicalOr",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::valueBlockLogicalOr, false}},
+    {"valueBlockLogicalNot",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::valueBlockLogicalNot, false}},
 };
 
 /**
@@ -795,6 +815,13 @@ value::SlotId RuntimeEnvironment::getSlot(StringData type) {
     uasserted(4946305, str::stream() << "environment slot is not registered for type: " << type);
 }
 
+boost::optional<value::SlotId> RuntimeEnvironment::getSlotIfExists(StringData type) {
+    if (auto it = _state->slots.find(type); it != _state->slots.end()) {
+        return it->second.first;
+    }
+    return boost::none;
+}
+
 void RuntimeEnvironment::resetSlot(value::SlotId slot,
                                    value::TypeTags tag,
                                    value::Value val,
@@ -828,6 +855,27 @@ std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeCopy(bool isSmp) {
     return std::unique_ptr<RuntimeEnvironment>(new RuntimeEnvironment(*this));
 }
 
+std::unique_ptr<RuntimeEnvironment> RuntimeEnvironment::makeDeepCopy() const {
+    auto env = std::make_unique<RuntimeEnvironment>();
+    env->_state->slots = _state->slots;
+    env->_state->typeTags = _state->typeTags;
+    env->_state->owned = _state->owned;
+    env->_state->vals.reserve(_state->vals.size());
+    for (size_t idx = 0; idx < _state->vals.size(); ++idx) {
+        if (_state->owned[idx]) {
+            auto [tag, val] = copyValue(_state->typeTags[idx], _state->vals[idx]);
+            env->_state->typeTags[idx] = tag;
+            env->_state->vals.push_back(val);
+        } else {
+            env->_state->vals.push_back(_state->vals[idx]);
+        }
+    }
+    for (auto&& [type, slot] : env->_state->slots) {
+        env->emplaceAccessor(slot.first, slot.second);
+    }
+    return env;
+}
+
 void RuntimeEnvironment::debugString(StringBuilder* builder) {
     *builder << "env: { ";
     for (auto&& [type, slot] : _state->slots) {
@@ -846,6 +894,16 @@ value::SlotAccessor* CompileCtx::getAccessor(value::SlotId slot) {
     return env->getAccessor(slot);
 }
 
+bool CompileCtx::isOuterSlot(value::SlotId slot) const {
+    for (auto& [correlatedSlot, accessor] : correlated) {
+        if (correlatedSlot == slot) {
+            return true;
+        }
+    }
+
+    return env->isSlotRegistered(slot);
+}
+
 std::shared_ptr<SpoolBuffer> CompileCtx::getSpoolBuffer(SpoolId spool) {
     if (spoolBuffers.find(spool) == spoolBuffers.end()) {
         spoolBuffers.emplace(spool, std::make_shared<SpoolBuffer>());
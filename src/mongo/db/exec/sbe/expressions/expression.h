@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 #include <string>
 #include <vector>
@@ -42,7 +43,7 @@
 
 namespace mongo {
 namespace sbe {
-using SpoolBuffer = std::vector<value::MaterializedRow>;
+using SpoolBuffer = std::vector<value::CompactRow>;
 
 /**
  * A holder for slots and accessors which are used in a PlanStage tree but:
@@ -92,6 +93,12 @@ public:
      */
     value::SlotId getSlot(StringData type);
 
+    /**
+     * Same as above, but returns boost::none rather than raising an exception if the slot hasn't
+     * been registered.
+     */
+    boost::optional<value::SlotId> getSlotIfExists(StringData type);
+
     /**
      * Store the given value in the specified slot within this runtime environment instance.
      *
@@ -108,6 +115,13 @@ public:
      */
     value::SlotAccessor* getAccessor(value::SlotId slot);
 
+    /**
+     * Returns true if the given SlotId is registered within this environment.
+     */
+    bool isSlotRegistered(value::SlotId slot) const {
+        return _accessors.find(slot) != _accessors.end();
+    }
+
     /**
      * Make a copy of his environment. The new environment will have its own set of SlotAccessors
      * pointing to the same shared data holding slot values.
@@ -118,6 +132,14 @@ public:
      */
     std::unique_ptr<RuntimeEnvironment> makeCopy(bool isSmp);
 
+    /**
+     * Make an independent copy of this environment, which registers the same slots under the same
+     * SlotIds but holds its own copies of the owned slot values. Unlike the copies made by
+     * 'makeCopy()', the new environment can be reset without affecting this one, which allows a
+     * plan built against this environment to be cloned and rebound to different values.
+     */
+    std::unique_ptr<RuntimeEnvironment> makeDeepCopy() const;
+
     /**
      * Dumps all the slots currently defined in this environment into the given string builder.
      */
@@ -196,6 +218,12 @@ struct CompileCtx {
     value::SlotAccessor* getAccessor(value::SlotId slot);
     std::shared_ptr<SpoolBuffer> getSpoolBuffer(SpoolId spool);
 
+    /**
+     * Returns true if the value of 'slot' comes from the runtime environment or from a correlated
+     * slot, rather than from the plan subtree being compiled.
+     */
+    bool isOuterSlot(value::SlotId slot) const;
+
     void pushCorrelated(value::SlotId slot, value::SlotAccessor* accessor);
     void popCorrelated();
 
@@ -52,6 +52,7 @@
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unique.h"
 #include "mongo/db/exec/sbe/stages/unwind.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
 
@@ -915,6 +916,9 @@ void Parser::walkGroup(AstQuery& ast) {
     ast.stage = makeS<HashAggStage>(std::move(ast.nodes[2]->stage),
                                     lookupSlots(std::move(ast.nodes[0]->identifiers)),
                                     lookupSlots(std::move(ast.nodes[1]->projects)),
+                                    internalQuerySlotBasedExecutionHashAggMaxMemoryBytes.load(),
+                                    true /* allowDiskUse */,
+                                    nullptr,
                                     getCurrentPlanNodeId());
 }
 
@@ -927,6 +931,8 @@ void Parser::walkHashJoin(AstQuery& ast) {
                              lookupSlots(ast.nodes[0]->nodes[1]->identifiers),  // outer projections
                              lookupSlots(ast.nodes[1]->nodes[0]->identifiers),  // inner conditions
                              lookupSlots(ast.nodes[1]->nodes[1]->identifiers),  // inner projections
+                             internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes.load(),
+                             true /* allowDiskUse */,
                              getCurrentPlanNodeId());
 }
 
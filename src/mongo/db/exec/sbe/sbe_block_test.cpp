@@ -0,0 +1,214 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::BlockStage, sbe::UnblockStage and the block builtins.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/block.h"
+#include "mongo/db/exec/sbe/stages/project.h"
+
+namespace mongo::sbe {
+
+using BlockStageTest = PlanStageTestFixture;
+
+TEST_F(BlockStageTest, BlockUnblockRoundTrip) {
+    auto [inputTag, inputVal] =
+        makeValue(BSON_ARRAY(12LL << "yar" << BSON_ARRAY(2.5) << 7.5 << BSON("foo" << 23)));
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    auto [expectedTag, expectedVal] = value::copyValue(inputTag, inputVal);
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    for (size_t blockSize : {1, 2, 5, 100}) {
+        auto [scanTag, scanVal] = value::copyValue(inputTag, inputVal);
+        auto [scanSlot, scan] = generateMockScan(scanTag, scanVal);
+
+        auto blockSlot = generateSlotId();
+        auto outSlot = generateSlotId();
+        auto block = makeS<BlockStage>(std::move(scan),
+                                       makeSV(scanSlot),
+                                       makeSV(blockSlot),
+                                       blockSize,
+                                       kEmptyPlanNodeId);
+        auto unblock = makeS<UnblockStage>(
+            std::move(block), makeSV(blockSlot), makeSV(outSlot), boost::none, kEmptyPlanNodeId);
+
+        auto resultAccessor = prepareTree(unblock.get(), outSlot);
+        auto [resultsTag, resultsVal] = getAllResults(unblock.get(), resultAccessor);
+        value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+        ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+    }
+}
+
+TEST_F(BlockStageTest, BlockSizeLimitsRowsPerBatch) {
+    auto [scanSlot, scan] = generateMockScan(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+
+    auto blockSlot = generateSlotId();
+    auto block = makeS<BlockStage>(
+        std::move(scan), makeSV(scanSlot), makeSV(blockSlot), 2, kEmptyPlanNodeId);
+
+    auto accessor = prepareTree(block.get(), blockSlot);
+
+    for (size_t expectedSize : {2, 2, 1}) {
+        ASSERT_TRUE(block->getNext() == PlanState::ADVANCED);
+        auto [tag, val] = accessor->getViewOfValue();
+        ASSERT_TRUE(tag == value::TypeTags::valueBlock);
+        ASSERT_EQ(value::getValueBlockView(val)->size(), expectedSize);
+    }
+    ASSERT_TRUE(block->getNext() == PlanState::IS_EOF);
+}
+
+TEST_F(BlockStageTest, FilterOneBlockAtATime) {
+    auto [scanSlot, scan] = generateMockScan(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+
+    auto [expectedTag, expectedVal] = makeValue(BSON_ARRAY(3 << 4));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto blockSlot = generateSlotId();
+    auto selectionSlot = generateSlotId();
+    auto outSlot = generateSlotId();
+
+    auto block = makeS<BlockStage>(
+        std::move(scan), makeSV(scanSlot), makeSV(blockSlot), 2, kEmptyPlanNodeId);
+
+    // The selection is computed once per block rather than once per row.
+    auto project = makeProjectStage(
+        std::move(block),
+        kEmptyPlanNodeId,
+        selectionSlot,
+        makeE<EFunction>(
+            "valueBlockLogicalAnd",
+            makeEs(makeE<EFunction>("valueBlockMatchGt",
+                                    makeEs(makeE<EVariable>(blockSlot),
+                                           makeE<EConstant>(value::TypeTags::NumberInt32,
+                                                            value::bitcastFrom<int32_t>(2)))),
+                   makeE<EFunction>("valueBlockMatchLte",
+                                    makeEs(makeE<EVariable>(blockSlot),
+                                           makeE<EConstant>(value::TypeTags::NumberDouble,
+                                                            value::bitcastFrom<double>(4.0)))))));
+
+    auto unblock = makeS<UnblockStage>(
+        std::move(project), makeSV(blockSlot), makeSV(outSlot), selectionSlot, kEmptyPlanNodeId);
+
+    auto resultAccessor = prepareTree(unblock.get(), outSlot);
+    auto [resultsTag, resultsVal] = getAllResults(unblock.get(), resultAccessor);
+    value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+    ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+}
+
+TEST_F(BlockStageTest, MatchFollowsRowAtATimeFilterSemantics) {
+    // Numbers of any type are compared with the constant, arrays match through their immediate
+    // elements, and values of other types never match.
+    auto [scanSlot, scan] = generateMockScan(BSON_ARRAY(
+        3 << 1LL << 7.5 << "7" << BSONNULL << BSON_ARRAY(0 << 9) << BSON_ARRAY(BSON_ARRAY(9))
+          << BSON("a" << 9) << Decimal128(6)));
+
+    auto [expectedTag, expectedVal] =
+        makeValue(BSON_ARRAY(7.5 << BSON_ARRAY(0 << 9) << Decimal128(6)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto blockSlot = generateSlotId();
+    auto selectionSlot = generateSlotId();
+    auto outSlot = generateSlotId();
+
+    auto block = makeS<BlockStage>(
+        std::move(scan), makeSV(scanSlot), makeSV(blockSlot), 4, kEmptyPlanNodeId);
+    auto project = makeProjectStage(
+        std::move(block),
+        kEmptyPlanNodeId,
+        selectionSlot,
+        makeE<EFunction>("valueBlockMatchGt",
+                         makeEs(makeE<EVariable>(blockSlot),
+                                makeE<EConstant>(value::TypeTags::NumberInt64,
+                                                 value::bitcastFrom<int64_t>(5)))));
+    auto unblock = makeS<UnblockStage>(
+        std::move(project), makeSV(blockSlot), makeSV(outSlot), selectionSlot, kEmptyPlanNodeId);
+
+    auto resultAccessor = prepareTree(unblock.get(), outSlot);
+    auto [resultsTag, resultsVal] = getAllResults(unblock.get(), resultAccessor);
+    value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+    ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+}
+
+TEST_F(BlockStageTest, LogicalOperatorsCombineSelections) {
+    auto [scanSlot, scan] = generateMockScan(BSON_ARRAY(1 << 2 << 3 << 4 << 5));
+
+    auto [expectedTag, expectedVal] = makeValue(BSON_ARRAY(1 << 3 << 5));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto blockSlot = generateSlotId();
+    auto selectionSlot = generateSlotId();
+    auto outSlot = generateSlotId();
+
+    auto makeMatch = [&](const char* builtin, int32_t constant) {
+        return makeE<EFunction>(builtin,
+                                makeEs(makeE<EVariable>(blockSlot),
+                                       makeE<EConstant>(value::TypeTags::NumberInt32,
+                                                        value::bitcastFrom<int32_t>(constant))));
+    };
+
+    // Selects the rows whose value is neither 2 nor 4: {$not: {$or: [{$eq: 2}, {$eq: 4}]}}.
+    auto block = makeS<BlockStage>(
+        std::move(scan), makeSV(scanSlot), makeSV(blockSlot), 3, kEmptyPlanNodeId);
+    auto project = makeProjectStage(
+        std::move(block),
+        kEmptyPlanNodeId,
+        selectionSlot,
+        makeE<EFunction>("valueBlockLogicalNot",
+                         makeEs(makeE<EFunction>("valueBlockLogicalOr",
+                                                 makeEs(makeMatch("valueBlockMatchEq", 2),
+                                                        makeMatch("valueBlockMatchEq", 4))))));
+    auto unblock = makeS<UnblockStage>(
+        std::move(project), makeSV(blockSlot), makeSV(outSlot), selectionSlot, kEmptyPlanNodeId);
+
+    auto resultAccessor = prepareTree(unblock.get(), outSlot);
+    auto [resultsTag, resultsVal] = getAllResults(unblock.get(), resultAccessor);
+    value::ValueGuard resultGuard{resultsTag, resultsVal};
+
+    ASSERT_TRUE(valueEquals(resultsTag, resultsVal, expectedTag, expectedVal));
+}
+
+TEST_F(BlockStageTest, UnblockRejectsNonBlockInput) {
+    auto [scanSlot, scan] = generateMockScan(BSON_ARRAY(1 << 2));
+
+    auto outSlot = generateSlotId();
+    auto unblock = makeS<UnblockStage>(
+        std::move(scan), makeSV(scanSlot), makeSV(outSlot), boost::none, kEmptyPlanNodeId);
+
+    auto resultAccessor = prepareTree(unblock.get(), outSlot);
+    ASSERT_THROWS_CODE(getAllResults(unblock.get(), resultAccessor), DBException, 5300105);
+}
+}  // namespace mongo::sbe
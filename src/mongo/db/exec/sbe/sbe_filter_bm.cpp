@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/values/slot.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo::sbe {
+namespace {
+
+constexpr size_t kNumDocs = 1000;
+
+/**
+ * Compiles the filter 'fillEmpty(getField(doc, "a") < 500, false) &&
+ * fillEmpty(getField(doc, "b") != "skip", true)' over a set of documents, which is the shape of the
+ * code the stage builder generates for '{a: {$lt: 500}, b: {$ne: "skip"}}' over scalar fields.
+ */
+class FilterBenchmarkFixture {
+public:
+    FilterBenchmarkFixture() : _ctx{std::make_unique<RuntimeEnvironment>()} {
+        _ctx.root = &_emptyStage;
+        auto docSlot = _slotIdGenerator.generate();
+        _ctx.pushCorrelated(docSlot, &_docAccessor);
+
+        auto getField = [&](StringData field) {
+            return makeE<EFunction>(
+                "getField",
+                makeEs(makeE<EVariable>(docSlot), makeE<EConstant>(field.toString())));
+        };
+        auto expr = makeE<EPrimBinary>(
+            EPrimBinary::logicAnd,
+            makeE<EFunction>(
+                "fillEmpty",
+                makeEs(makeE<EPrimBinary>(EPrimBinary::less,
+                                          getField("a"),
+                                          makeE<EConstant>(value::TypeTags::NumberInt32,
+                                                           value::bitcastFrom<int32_t>(500))),
+                       makeE<EConstant>(value::TypeTags::Boolean,
+                                        value::bitcastFrom<bool>(false)))),
+            makeE<EFunction>(
+                "fillEmpty",
+                makeEs(makeE<EPrimBinary>(
+                           EPrimBinary::neq, getField("b"), makeE<EConstant>("skip")),
+                       makeE<EConstant>(value::TypeTags::Boolean,
+                                        value::bitcastFrom<bool>(true)))));
+        code = expr->compile(_ctx);
+
+        for (size_t i = 0; i < kNumDocs; ++i) {
+            _docs.push_back(BSON("a" << static_cast<int>(i) << "b"
+                                     << (i % 3 ? "keep" : "skip") << "c" << BSON("d" << 1)));
+        }
+    }
+
+    void bind(size_t idx) {
+        const auto& doc = _docs[idx % _docs.size()];
+        _docAccessor.reset(value::TypeTags::bsonObject,
+                           value::bitcastFrom<const char*>(doc.objdata()));
+    }
+
+    std::unique_ptr<vm::CodeFragment> code;
+    vm::ByteCode vm;
+
+private:
+    value::SlotIdGenerator _slotIdGenerator;
+    CoScanStage _emptyStage{kEmptyPlanNodeId};
+    CompileCtx _ctx;
+    value::ViewOfValueAccessor _docAccessor;
+    std::vector<BSONObj> _docs;
+};
+
+bool passes(const std::tuple<uint8_t, value::TypeTags, value::Value>& result) {
+    auto [owned, tag, val] = result;
+    invariant(!owned);
+    return tag == value::TypeTags::Boolean && value::bitcastTo<bool>(val);
+}
+
+void BM_FilterInterpreted(benchmark::State& state) {
+    auto oldThreshold = internalQuerySlotBasedExecutionTierUpThreshold.load();
+    internalQuerySlotBasedExecutionTierUpThreshold.store(0);
+
+    FilterBenchmarkFixture fixture;
+    size_t idx = 0;
+    size_t matched = 0;
+    for (auto _ : state) {
+        fixture.bind(idx++);
+        matched += passes(fixture.vm.run(fixture.code.get()));
+    }
+    benchmark::DoNotOptimize(matched);
+    internalQuerySlotBasedExecutionTierUpThreshold.store(oldThreshold);
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_FilterCompiled(benchmark::State& state) {
+    FilterBenchmarkFixture fixture;
+    auto compiled = vm::CompiledFragment::compile(*fixture.code);
+    invariant(compiled);
+    size_t idx = 0;
+    size_t matched = 0;
+    for (auto _ : state) {
+        fixture.bind(idx++);
+        matched += passes(fixture.vm.runCompiled(compiled.get()));
+    }
+    benchmark::DoNotOptimize(matched);
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FilterInterpreted);
+BENCHMARK(BM_FilterCompiled);
+
+}  // namespace
+}  // namespace mongo::sbe
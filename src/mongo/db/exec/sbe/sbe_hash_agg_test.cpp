@@ -0,0 +1,291 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::HashAggStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo::sbe {
+
+class HashAggStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Groups the [key, value] pairs in 'input' by key, summing up the values, and returns the
+     * resulting groups together with the stats of the stage.
+     */
+    std::pair<std::map<int64_t, int64_t>, HashAggStats> runSumGroup(const BSONArray& input,
+                                                                   size_t memoryLimit,
+                                                                   bool allowDiskUse) {
+        auto [scanSlots, scan] = generateMockScanMulti(2, input);
+
+        auto sumSlot = generateSlotId();
+        auto group = makeS<HashAggStage>(
+            std::move(scan),
+            makeSV(scanSlots[0]),
+            makeEM(sumSlot, makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[1])))),
+            memoryLimit,
+            allowDiskUse,
+            nullptr,
+            kEmptyPlanNodeId);
+
+        auto accessors = prepareTree(group.get(), makeSV(scanSlots[0], sumSlot));
+
+        std::map<int64_t, int64_t> results;
+        while (group->getNext() == PlanState::ADVANCED) {
+            auto [keyTag, keyVal] = accessors[0]->getViewOfValue();
+            auto [sumTag, sumVal] = accessors[1]->getViewOfValue();
+            ASSERT_TRUE(value::isNumber(keyTag));
+            ASSERT_TRUE(value::isNumber(sumTag));
+
+            auto [it, inserted] = results.emplace(value::numericCast<int64_t>(keyTag, keyVal),
+                                                  value::numericCast<int64_t>(sumTag, sumVal));
+            ASSERT_TRUE(inserted);
+        }
+
+        auto stats = *static_cast<const HashAggStats*>(group->getSpecificStats());
+        group->close();
+        return {std::move(results), stats};
+    }
+
+    static BSONArray makeInput(int numKeys, int numRowsPerKey) {
+        BSONArrayBuilder builder;
+        for (int row = 0; row < numRowsPerKey; ++row) {
+            for (int key = 0; key < numKeys; ++key) {
+                builder.append(BSON_ARRAY(key << row));
+            }
+        }
+        return builder.arr();
+    }
+
+    static std::map<int64_t, int64_t> makeExpected(int numKeys, int numRowsPerKey) {
+        std::map<int64_t, int64_t> expected;
+        for (int key = 0; key < numKeys; ++key) {
+            expected[key] = numRowsPerKey * (numRowsPerKey - 1) / 2;
+        }
+        return expected;
+    }
+};
+
+TEST_F(HashAggStageTest, GroupsInMemoryWithinMemoryLimit) {
+    auto [results, stats] = runSumGroup(makeInput(10, 5),
+                                        std::numeric_limits<size_t>::max(),
+                                        false /* allowDiskUse */);
+
+    ASSERT(results == makeExpected(10, 5));
+    ASSERT_FALSE(stats.usedDisk);
+    ASSERT_EQ(stats.spilledRecords, 0U);
+}
+
+TEST_F(HashAggStageTest, FailsWhenMemoryLimitExceededWithoutDiskUse) {
+    ASSERT_THROWS_CODE(runSumGroup(makeInput(10, 5), 1, false /* allowDiskUse */),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashAggStageTest, SpillsAndRepartitionsWhenMemoryLimitExceeded) {
+    unittest::TempDir tempDir("HashAggStageTest");
+    auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // With a limit this small only a couple of groups fit in memory at a time, so every partition
+    // gets partitioned again until it holds only a couple of groups.
+    auto [results, stats] = runSumGroup(makeInput(50, 4), 100, true /* allowDiskUse */);
+
+    ASSERT(results == makeExpected(50, 4));
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledRecords, 0U);
+    ASSERT_GT(stats.spilledBytes, 0U);
+    ASSERT_GT(stats.spilledPartitions, HashAggStage::kNumSpillPartitions);
+}
+
+TEST_F(HashAggStageTest, FailsWhenGroupOutgrowsMemoryLimit) {
+    unittest::TempDir tempDir("HashAggStageTest");
+    auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // A single group whose array keeps growing is accounted for, although it cannot be spilled.
+    auto runPushGroup = [&](bool allowDiskUse) {
+        auto [scanSlots, scan] = generateMockScanMulti(2, makeInput(1, 1000));
+
+        auto pushSlot = generateSlotId();
+        auto group = makeS<HashAggStage>(
+            std::move(scan),
+            makeSV(scanSlots[0]),
+            makeEM(pushSlot,
+                   makeE<EFunction>("addToArray", makeEs(makeE<EVariable>(scanSlots[1])))),
+            1024,
+            allowDiskUse,
+            nullptr,
+            kEmptyPlanNodeId);
+        prepareTree(group.get(), makeSV(pushSlot));
+    };
+
+    ASSERT_THROWS_CODE(runPushGroup(false /* allowDiskUse */),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+    ASSERT_THROWS_CODE(
+        runPushGroup(true /* allowDiskUse */), DBException, ErrorCodes::ExceededMemoryLimit);
+}
+
+TEST_F(HashAggStageTest, MinAndMaxOrderValuesOfDifferentTypesByType) {
+    auto [scanSlots, scan] = generateMockScanMulti(
+        2, BSON_ARRAY(BSON_ARRAY(0 << "b") << BSON_ARRAY(0 << 2.5) << BSON_ARRAY(0 << 1)));
+
+    auto minSlot = generateSlotId();
+    auto maxSlot = generateSlotId();
+    auto group = makeS<HashAggStage>(
+        std::move(scan),
+        makeSV(scanSlots[0]),
+        makeEM(minSlot,
+               makeE<EFunction>("min", makeEs(makeE<EVariable>(scanSlots[1]))),
+               maxSlot,
+               makeE<EFunction>("max", makeEs(makeE<EVariable>(scanSlots[1])))),
+        std::numeric_limits<size_t>::max(),
+        false /* allowDiskUse */,
+        nullptr,
+        kEmptyPlanNodeId);
+
+    auto accessors = prepareTree(group.get(), makeSV(minSlot, maxSlot));
+    ASSERT_TRUE(group->getNext() == PlanState::ADVANCED);
+
+    // Numbers sort before strings.
+    auto [minTag, minVal] = accessors[0]->getViewOfValue();
+    ASSERT_TRUE(minTag == value::TypeTags::NumberInt32);
+    ASSERT_EQ(value::bitcastTo<int32_t>(minVal), 1);
+    auto [maxTag, maxVal] = accessors[1]->getViewOfValue();
+    ASSERT_TRUE(value::isString(maxTag));
+    ASSERT_EQ(value::getStringView(maxTag, maxVal), "b");
+
+    ASSERT_TRUE(group->getNext() == PlanState::IS_EOF);
+    group->close();
+}
+
+TEST_F(HashAggStageTest, SumOfInt32ValuesIsInt32) {
+    auto [scanSlots, scan] =
+        generateMockScanMulti(2, BSON_ARRAY(BSON_ARRAY(0 << 1) << BSON_ARRAY(0 << 2)));
+
+    auto sumSlot = generateSlotId();
+    auto group = makeS<HashAggStage>(
+        std::move(scan),
+        makeSV(scanSlots[0]),
+        makeEM(sumSlot, makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[1])))),
+        std::numeric_limits<size_t>::max(),
+        false /* allowDiskUse */,
+        nullptr,
+        kEmptyPlanNodeId);
+
+    auto accessors = prepareTree(group.get(), makeSV(sumSlot));
+    ASSERT_TRUE(group->getNext() == PlanState::ADVANCED);
+    auto [sumTag, sumVal] = accessors[0]->getViewOfValue();
+    ASSERT_TRUE(sumTag == value::TypeTags::NumberInt32);
+    ASSERT_EQ(value::bitcastTo<int32_t>(sumVal), 3);
+    group->close();
+}
+
+TEST_F(HashAggStageTest, DoubleDoubleSumIsCompensatedAndPromotedOnOverflow) {
+    auto runDoubleDoubleSum = [&](const BSONArray& input) {
+        auto [scanSlots, scan] = generateMockScanMulti(2, input);
+
+        auto aggSlot = generateSlotId();
+        auto sumSlot = generateSlotId();
+        auto group = makeS<HashAggStage>(
+            std::move(scan),
+            makeSV(scanSlots[0]),
+            makeEM(aggSlot,
+                   makeE<EFunction>("aggDoubleDoubleSum", makeEs(makeE<EVariable>(scanSlots[1])))),
+            std::numeric_limits<size_t>::max(),
+            false /* allowDiskUse */,
+            nullptr,
+            kEmptyPlanNodeId);
+        auto stage = makeProjectStage(
+            std::move(group),
+            kEmptyPlanNodeId,
+            sumSlot,
+            makeE<EFunction>("doubleDoubleSumFinalize", makeEs(makeE<EVariable>(aggSlot))));
+
+        auto accessors = prepareTree(stage.get(), makeSV(sumSlot));
+        ASSERT_TRUE(stage->getNext() == PlanState::ADVANCED);
+        // The sums checked below are all shallow values, which stay valid after closing the tree.
+        auto sum = accessors[0]->getViewOfValue();
+        stage->close();
+        return sum;
+    };
+
+    // A naive summation of ten times 0.1 is off by one ulp.
+    BSONArrayBuilder doubles;
+    for (int i = 0; i < 10; ++i) {
+        doubles.append(BSON_ARRAY(0 << 0.1));
+    }
+    auto [doubleTag, doubleVal] = runDoubleDoubleSum(doubles.arr());
+    ASSERT_TRUE(doubleTag == value::TypeTags::NumberDouble);
+    ASSERT_EQ(value::bitcastTo<double>(doubleVal), 1.0);
+
+    // Integers are summed as a NumberLong, and as a NumberDouble once that overflows.
+    auto [longTag, longVal] = runDoubleDoubleSum(
+        BSON_ARRAY(BSON_ARRAY(0 << std::numeric_limits<int32_t>::max()) << BSON_ARRAY(0 << 1LL)));
+    ASSERT_TRUE(longTag == value::TypeTags::NumberInt64);
+    ASSERT_EQ(value::bitcastTo<int64_t>(longVal), std::numeric_limits<int32_t>::max() + 1LL);
+
+    auto [overflowTag, overflowVal] =
+        runDoubleDoubleSum(BSON_ARRAY(BSON_ARRAY(0 << std::numeric_limits<long long>::max())
+                                      << BSON_ARRAY(0 << 1LL)));
+    ASSERT_TRUE(overflowTag == value::TypeTags::NumberDouble);
+    ASSERT_EQ(value::bitcastTo<double>(overflowVal), std::ldexp(1.0, 63));
+}
+
+TEST_F(HashAggStageTest, EndsTrialRunOnceEnoughRowsAreAggregated) {
+    auto [scanSlots, scan] = generateMockScanMulti(2, makeInput(10, 5));
+
+    TrialRunProgressTracker tracker{size_t{5} /* kNumResults */, size_t{0} /* kNumReads */};
+    auto sumSlot = generateSlotId();
+    auto group = makeS<HashAggStage>(
+        std::move(scan),
+        makeSV(scanSlots[0]),
+        makeEM(sumSlot, makeE<EFunction>("sum", makeEs(makeE<EVariable>(scanSlots[1])))),
+        std::numeric_limits<size_t>::max(),
+        false /* allowDiskUse */,
+        &tracker,
+        kEmptyPlanNodeId);
+
+    ASSERT_THROWS_CODE(prepareTree(group.get()), DBException, ErrorCodes::QueryTrialRunCompleted);
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::HashJoinStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+#include <tuple>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_join.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo::sbe {
+
+class HashJoinStageTest : public PlanStageTestFixture {
+public:
+    using JoinResult = std::multiset<std::tuple<int64_t, int64_t, int64_t>>;
+
+    /**
+     * Joins the [key, value] pairs of 'outer' and 'inner' on the key, and returns the
+     * [key, outer value, inner value] triples produced together with the stats of the stage.
+     */
+    std::pair<JoinResult, HashJoinStats> runJoin(const BSONArray& outer,
+                                                 const BSONArray& inner,
+                                                 size_t memoryLimit,
+                                                 bool allowDiskUse) {
+        auto [outerSlots, outerScan] = generateMockScanMulti(2, outer);
+        auto [innerSlots, innerScan] = generateMockScanMulti(2, inner);
+
+        auto join = makeS<HashJoinStage>(std::move(outerScan),
+                                         std::move(innerScan),
+                                         makeSV(outerSlots[0]),
+                                         makeSV(outerSlots[1]),
+                                         makeSV(innerSlots[0]),
+                                         makeSV(innerSlots[1]),
+                                         memoryLimit,
+                                         allowDiskUse,
+                                         kEmptyPlanNodeId);
+
+        auto accessors =
+            prepareTree(join.get(), makeSV(outerSlots[0], outerSlots[1], innerSlots[1]));
+
+        JoinResult results;
+        while (join->getNext() == PlanState::ADVANCED) {
+            std::vector<int64_t> row;
+            for (auto accessor : accessors) {
+                auto [tag, val] = accessor->getViewOfValue();
+                ASSERT_TRUE(value::isNumber(tag));
+                row.push_back(value::numericCast<int64_t>(tag, val));
+            }
+            results.emplace(row[0], row[1], row[2]);
+        }
+
+        auto stats = *static_cast<const HashJoinStats*>(join->getSpecificStats());
+        join->close();
+        return {std::move(results), stats};
+    }
+
+    /**
+     * Generates 'numRowsPerKey' [key, value] pairs for every key in [0, numKeys).
+     */
+    static BSONArray makeInput(int numKeys, int numRowsPerKey) {
+        BSONArrayBuilder builder;
+        for (int row = 0; row < numRowsPerKey; ++row) {
+            for (int key = 0; key < numKeys; ++key) {
+                builder.append(BSON_ARRAY(key << row));
+            }
+        }
+        return builder.arr();
+    }
+
+    static JoinResult makeExpected(int numKeys, int numOuterRowsPerKey, int numInnerRowsPerKey) {
+        JoinResult expected;
+        for (int key = 0; key < numKeys; ++key) {
+            for (int outer = 0; outer < numOuterRowsPerKey; ++outer) {
+                for (int inner = 0; inner < numInnerRowsPerKey; ++inner) {
+                    expected.emplace(key, outer, inner);
+                }
+            }
+        }
+        return expected;
+    }
+};
+
+TEST_F(HashJoinStageTest, JoinsInMemoryWithinMemoryLimit) {
+    auto [results, stats] = runJoin(makeInput(10, 2),
+                                    makeInput(20, 3),
+                                    std::numeric_limits<size_t>::max(),
+                                    false /* allowDiskUse */);
+
+    ASSERT(results == makeExpected(10, 2, 3));
+    ASSERT_FALSE(stats.usedDisk);
+}
+
+TEST_F(HashJoinStageTest, FailsWhenMemoryLimitExceededWithoutDiskUse) {
+    ASSERT_THROWS_CODE(runJoin(makeInput(10, 2), makeInput(10, 2), 1, false /* allowDiskUse */),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
+TEST_F(HashJoinStageTest, GraceHashJoinWhenMemoryLimitExceeded) {
+    unittest::TempDir tempDir("HashJoinStageTest");
+    auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // Keys in [100, 120) only exist on the inner side and must not produce any output.
+    auto [results, stats] =
+        runJoin(makeInput(100, 2), makeInput(120, 3), 1024, true /* allowDiskUse */);
+
+    ASSERT(results == makeExpected(100, 2, 3));
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_GT(stats.spilledRecords, 0U);
+    ASSERT_GT(stats.spilledBytes, 0U);
+    ASSERT_GT(stats.spilledPartitions, 0U);
+}
+
+TEST_F(HashJoinStageTest, SkewedPartitionIsLoadedAfterMaxSpillLevel) {
+    unittest::TempDir tempDir("HashJoinStageTest");
+    auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // All the rows share the same key, so partitioning again never reduces the partition size.
+    auto [results, stats] = runJoin(makeInput(1, 50), makeInput(1, 4), 1, true /* allowDiskUse */);
+
+    ASSERT(results == makeExpected(1, 50, 4));
+    ASSERT_TRUE(stats.usedDisk);
+    ASSERT_EQ(stats.maxSpillLevel, HashJoinStage::kMaxSpillLevel);
+}
+}  // namespace mongo::sbe
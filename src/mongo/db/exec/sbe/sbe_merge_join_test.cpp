@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::MergeJoinStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <tuple>
+#include <vector>
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/merge_join.h"
+
+namespace mongo::sbe {
+
+class MergeJoinStageTest : public PlanStageTestFixture {
+public:
+    using JoinResult = std::vector<std::tuple<int64_t, int64_t, int64_t>>;
+
+    /**
+     * Joins the [key, value] pairs of 'outer' and 'inner', which are sorted by key in the 'dir'
+     * order, and returns the [key, outer value, inner value] triples in the order they are
+     * produced.
+     */
+    JoinResult runJoin(const BSONArray& outer, const BSONArray& inner, value::SortDirection dir) {
+        auto [outerSlots, outerScan] = generateMockScanMulti(2, outer);
+        auto [innerSlots, innerScan] = generateMockScanMulti(2, inner);
+
+        auto join = makeS<MergeJoinStage>(std::move(outerScan),
+                                          std::move(innerScan),
+                                          makeSV(outerSlots[0]),
+                                          makeSV(outerSlots[1]),
+                                          makeSV(innerSlots[0]),
+                                          makeSV(innerSlots[1]),
+                                          std::vector<value::SortDirection>{dir},
+                                          kEmptyPlanNodeId);
+
+        auto accessors =
+            prepareTree(join.get(), makeSV(outerSlots[0], outerSlots[1], innerSlots[1]));
+
+        JoinResult results;
+        while (join->getNext() == PlanState::ADVANCED) {
+            std::vector<int64_t> row;
+            for (auto accessor : accessors) {
+                auto [tag, val] = accessor->getViewOfValue();
+                ASSERT_TRUE(value::isNumber(tag));
+                row.push_back(value::numericCast<int64_t>(tag, val));
+            }
+            results.emplace_back(row[0], row[1], row[2]);
+        }
+        join->close();
+        return results;
+    }
+};
+
+TEST_F(MergeJoinStageTest, JoinsRowsWithEqualKeys) {
+    auto results = runJoin(BSON_ARRAY(BSON_ARRAY(1 << 10) << BSON_ARRAY(3 << 30)
+                                                         << BSON_ARRAY(4 << 40)
+                                                         << BSON_ARRAY(7 << 70)),
+                           BSON_ARRAY(BSON_ARRAY(0 << 0) << BSON_ARRAY(3 << 31)
+                                                         << BSON_ARRAY(5 << 51)
+                                                         << BSON_ARRAY(7 << 71)
+                                                         << BSON_ARRAY(8 << 81)),
+                           value::SortDirection::Ascending);
+
+    ASSERT(results == JoinResult({{3, 30, 31}, {7, 70, 71}}));
+}
+
+TEST_F(MergeJoinStageTest, JoinsEveryPairOfRowsWithDuplicateKeys) {
+    auto results = runJoin(BSON_ARRAY(BSON_ARRAY(2 << 20) << BSON_ARRAY(2 << 21)
+                                                         << BSON_ARRAY(3 << 30)
+                                                         << BSON_ARRAY(5 << 50)
+                                                         << BSON_ARRAY(5 << 51)),
+                           BSON_ARRAY(BSON_ARRAY(2 << 22) << BSON_ARRAY(2 << 23)
+                                                         << BSON_ARRAY(4 << 40)
+                                                         << BSON_ARRAY(5 << 52)),
+                           value::SortDirection::Ascending);
+
+    ASSERT(results ==
+           JoinResult(
+               {{2, 20, 22}, {2, 21, 22}, {2, 20, 23}, {2, 21, 23}, {5, 50, 52}, {5, 51, 52}}));
+}
+
+TEST_F(MergeJoinStageTest, JoinsInputsSortedInDescendingOrder) {
+    auto results = runJoin(BSON_ARRAY(BSON_ARRAY(9 << 90) << BSON_ARRAY(6 << 60)
+                                                         << BSON_ARRAY(2 << 20)),
+                           BSON_ARRAY(BSON_ARRAY(8 << 81) << BSON_ARRAY(6 << 61)
+                                                         << BSON_ARRAY(2 << 21)
+                                                         << BSON_ARRAY(1 << 11)),
+                           value::SortDirection::Descending);
+
+    ASSERT(results == JoinResult({{6, 60, 61}, {2, 20, 21}}));
+}
+
+TEST_F(MergeJoinStageTest, ReturnsNothingWhenEitherSideIsEmpty) {
+    auto rows = BSON_ARRAY(BSON_ARRAY(1 << 10) << BSON_ARRAY(2 << 20));
+    ASSERT(runJoin(BSONArray{}, rows, value::SortDirection::Ascending).empty());
+    ASSERT(runJoin(rows, BSONArray{}, value::SortDirection::Ascending).empty());
+}
+}  // namespace mongo::sbe
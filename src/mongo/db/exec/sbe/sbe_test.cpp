@@ -27,9 +27,12 @@
  *    it in the license file.
  */
 
+#include "mongo/bson/util/builder.h"
+#include "mongo/db/exec/sbe/values/slot.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/bufreader.h"
 
 namespace mongo::sbe {
 
@@ -188,6 +191,74 @@ TEST(SBEValues, HashCompound) {
     }
 }
 
+TEST(SBEValues, CompactRow) {
+    using namespace std::literals;
+    auto obj = BSON("a" << 1 << "b"
+                        << "str");
+
+    std::vector<value::OwnedValueAccessor> values(7);
+    values[0].reset(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(-5));
+    values[1].reset(value::TypeTags::NumberDouble, value::bitcastFrom<double>(2.5));
+    auto [strTag, strVal] = value::makeNewString("not so small string"sv);
+    values[2].reset(strTag, strVal);
+    auto [decTag, decVal] = value::makeCopyDecimal(Decimal128(42));
+    values[3].reset(decTag, decVal);
+    auto [objTag, objVal] = value::copyValue(value::TypeTags::bsonObject,
+                                             value::bitcastFrom<const char*>(obj.objdata()));
+    values[4].reset(objTag, objVal);
+    auto [oidTag, oidVal] = value::makeCopyObjectId({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    values[5].reset(oidTag, oidVal);
+    auto [arrTag, arrVal] = value::makeNewArray();
+    value::getArrayView(arrVal)->push_back(value::TypeTags::NumberInt32,
+                                           value::bitcastFrom<int32_t>(1));
+    values[6].reset(arrTag, arrVal);
+
+    std::vector<value::SlotAccessor*> accessors;
+    for (auto&& value : values) {
+        accessors.push_back(&value);
+    }
+
+    auto assertRowEq = [&](const value::CompactRow& row) {
+        ASSERT_EQ(row.size(), values.size());
+        for (size_t idx = 0; idx < values.size(); ++idx) {
+            auto [lhsTag, lhsVal] = row.getViewOfValue(idx);
+            auto [rhsTag, rhsVal] = values[idx].getViewOfValue();
+            ASSERT_EQ(lhsTag, rhsTag);
+            auto [cmpTag, cmpVal] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal);
+            ASSERT_EQ(cmpTag, value::TypeTags::NumberInt32);
+            ASSERT_EQ(value::bitcastTo<int32_t>(cmpVal), 0);
+        }
+    };
+
+    value::CompactRow row{accessors, false};
+    assertRowEq(row);
+
+    // The values stored in the buffer of the row are viewed from there.
+    auto [rowStrTag, rowStrVal] = row.getViewOfValue(2);
+    ASSERT_NE(rowStrVal, strVal);
+
+    auto copy = row;
+    assertRowEq(copy);
+
+    BufBuilder builder;
+    row.serializeForSorter(builder);
+    BufReader reader{builder.buf(), static_cast<unsigned>(builder.len())};
+    auto deserialized = value::CompactRow::deserializeForSorter(reader, {});
+    ASSERT_EQ(deserialized.size(), row.size());
+    for (size_t idx = 0; idx < row.size(); ++idx) {
+        auto [lhsTag, lhsVal] = row.getViewOfValue(idx);
+        auto [rhsTag, rhsVal] = deserialized.getViewOfValue(idx);
+        auto [cmpTag, cmpVal] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal);
+        ASSERT_EQ(value::bitcastTo<int32_t>(cmpVal), 0);
+    }
+
+    // Values which cannot be stored in the buffer may be moved out of their accessors.
+    value::CompactRow moved{accessors, true};
+    auto [movedArrTag, movedArrVal] = moved.getViewOfValue(6);
+    ASSERT_EQ(movedArrTag, value::TypeTags::Array);
+    ASSERT_EQ(movedArrVal, arrVal);
+}
+
 TEST(SBEVM, Add) {
     {
         auto tagInt32 = value::TypeTags::NumberInt32;
@@ -0,0 +1,218 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/expression_test_base.h"
+#include "mongo/db/query/bson_typemask.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo::sbe {
+
+class SBETierUpTest : public EExpressionTestFixture {
+protected:
+    /**
+     * Runs 'code' through both the interpreter and its compiled form against every document in
+     * 'docs', bound to 'accessor', and checks that both produce the same value.
+     */
+    void assertCompiledMatchesInterpreted(const vm::CodeFragment* code,
+                                          const vm::CompiledFragment* compiled,
+                                          value::ViewOfValueAccessor* accessor,
+                                          const std::vector<BSONObj>& docs) {
+        for (auto&& doc : docs) {
+            accessor->reset(value::TypeTags::bsonObject,
+                            value::bitcastFrom<const char*>(doc.objdata()));
+
+            uint8_t interpretedOwned, compiledOwned;
+            value::TypeTags interpretedTag, compiledTag;
+            value::Value interpretedVal, compiledVal;
+            std::tie(interpretedOwned, interpretedTag, interpretedVal) = _interpreter.run(code);
+            std::tie(compiledOwned, compiledTag, compiledVal) = _compiledVm.runCompiled(compiled);
+            ON_BLOCK_EXIT([&] {
+                if (interpretedOwned) {
+                    value::releaseValue(interpretedTag, interpretedVal);
+                }
+                if (compiledOwned) {
+                    value::releaseValue(compiledTag, compiledVal);
+                }
+            });
+
+            ASSERT_EQ(interpretedTag, compiledTag) << doc;
+            if (interpretedTag == value::TypeTags::Nothing) {
+                continue;
+            }
+            auto [cmpTag, cmpVal] =
+                value::compareValue(interpretedTag, interpretedVal, compiledTag, compiledVal);
+            ASSERT_EQ(cmpTag, value::TypeTags::NumberInt32) << doc;
+            ASSERT_EQ(value::bitcastTo<int32_t>(cmpVal), 0) << doc;
+        }
+    }
+
+    static size_t countOps(const vm::CompiledFragment& compiled,
+                           vm::CompiledFragment::Op::Tags tag) {
+        return std::count_if(compiled.ops().begin(),
+                             compiled.ops().end(),
+                             [&](auto&& op) { return op.tag == tag; });
+    }
+
+    const std::vector<BSONObj> kDocs{BSON("a" << 1 << "b"
+                                              << "foo"),
+                                     BSON("a" << 20 << "b"
+                                              << "bar"),
+                                     BSON("a" << 5.5),
+                                     BSON("a" << BSONNULL << "b" << 3),
+                                     BSON("a" << BSON_ARRAY(1 << 2)),
+                                     BSON("b" << 1),
+                                     BSONObj()};
+
+    vm::ByteCode _interpreter;
+    vm::ByteCode _compiledVm;
+};
+
+TEST_F(SBETierUpTest, FusedFilterMatchesInterpreter) {
+    value::ViewOfValueAccessor docAccessor;
+    auto docSlot = bindAccessor(&docAccessor);
+
+    // fillEmpty(getField(doc, "a") < 10, false) && fillEmpty(getField(doc, "b") != "bar", true)
+    auto expr = makeE<EPrimBinary>(
+        EPrimBinary::logicAnd,
+        makeE<EFunction>(
+            "fillEmpty",
+            makeEs(makeE<EPrimBinary>(
+                       EPrimBinary::less,
+                       makeE<EFunction>("getField",
+                                        makeEs(makeE<EVariable>(docSlot), makeE<EConstant>("a"))),
+                       makeE<EConstant>(value::TypeTags::NumberInt32,
+                                        value::bitcastFrom<int32_t>(10))),
+                   makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(false)))),
+        makeE<EFunction>(
+            "fillEmpty",
+            makeEs(makeE<EPrimBinary>(
+                       EPrimBinary::neq,
+                       makeE<EFunction>("getField",
+                                        makeEs(makeE<EVariable>(docSlot), makeE<EConstant>("b"))),
+                       makeE<EConstant>("bar")),
+                   makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(true)))));
+    auto code = compileExpression(*expr);
+
+    auto compiled = vm::CompiledFragment::compile(*code);
+    ASSERT(compiled);
+    ASSERT_EQ(countOps(*compiled, vm::CompiledFragment::Op::getFieldAccessConst), 2U);
+    ASSERT_EQ(countOps(*compiled, vm::CompiledFragment::Op::lessConst), 1U);
+    ASSERT_EQ(countOps(*compiled, vm::CompiledFragment::Op::neqConst), 1U);
+    ASSERT_EQ(countOps(*compiled, vm::CompiledFragment::Op::fillEmptyConst), 2U);
+
+    assertCompiledMatchesInterpreted(code.get(), compiled.get(), &docAccessor, kDocs);
+}
+
+TEST_F(SBETierUpTest, LocalBindsTypeChecksAndBuiltinsMatchInterpreter) {
+    value::ViewOfValueAccessor docAccessor;
+    auto docSlot = bindAccessor(&docAccessor);
+    FrameId frame = 10;
+
+    // let [l.0 = getField(doc, "a")]
+    //     if (typeMatch(l.0, number) || isNull(l.0), abs(l.0), exists(getField(doc, "b")))
+    auto expr = makeE<ELocalBind>(
+        frame,
+        makeEs(makeE<EFunction>("getField",
+                                makeEs(makeE<EVariable>(docSlot), makeE<EConstant>("a")))),
+        makeE<EIf>(makeE<EPrimBinary>(
+                       EPrimBinary::logicOr,
+                       makeE<ETypeMatch>(makeE<EVariable>(frame, 0),
+                                         getBSONTypeMask(BSONType::NumberInt) |
+                                             getBSONTypeMask(BSONType::NumberDouble)),
+                       makeE<EFunction>("isNull", makeEs(makeE<EVariable>(frame, 0)))),
+                   makeE<EFunction>("abs", makeEs(makeE<EVariable>(frame, 0))),
+                   makeE<EFunction>("exists",
+                                    makeEs(makeE<EFunction>(
+                                        "getField",
+                                        makeEs(makeE<EVariable>(docSlot),
+                                               makeE<EConstant>("b")))))));
+    auto code = compileExpression(*expr);
+
+    auto compiled = vm::CompiledFragment::compile(*code);
+    ASSERT(compiled);
+
+    assertCompiledMatchesInterpreted(code.get(), compiled.get(), &docAccessor, kDocs);
+}
+
+TEST_F(SBETierUpTest, UnsupportedInstructionIsNotCompiled) {
+    value::ViewOfValueAccessor docAccessor;
+    auto docSlot = bindAccessor(&docAccessor);
+
+    auto expr = makeE<EPrimBinary>(
+        EPrimBinary::add,
+        makeE<EFunction>("getField", makeEs(makeE<EVariable>(docSlot), makeE<EConstant>("a"))),
+        makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(1)));
+    auto code = compileExpression(*expr);
+
+    ASSERT_FALSE(vm::CompiledFragment::compile(*code));
+}
+
+TEST_F(SBETierUpTest, FragmentTiersUpAfterThreshold) {
+    auto oldThreshold = internalQuerySlotBasedExecutionTierUpThreshold.load();
+    ON_BLOCK_EXIT([&] { internalQuerySlotBasedExecutionTierUpThreshold.store(oldThreshold); });
+    internalQuerySlotBasedExecutionTierUpThreshold.store(3);
+
+    value::ViewOfValueAccessor docAccessor;
+    auto docSlot = bindAccessor(&docAccessor);
+
+    auto expr = makeE<EFunction>(
+        "exists",
+        makeEs(makeE<EFunction>("getField",
+                                makeEs(makeE<EVariable>(docSlot), makeE<EConstant>("a")))));
+    auto code = compileExpression(*expr);
+
+    auto doc = BSON("a" << 1);
+    docAccessor.reset(value::TypeTags::bsonObject, value::bitcastFrom<const char*>(doc.objdata()));
+    for (int run = 0; run < 5; ++run) {
+        ASSERT_EQ(code->tierUp() != nullptr, run >= 2);
+    }
+
+    // The fragment now runs through its compiled form.
+    ASSERT_TRUE(_interpreter.runPredicate(code.get()));
+    doc = BSON("b" << 1);
+    docAccessor.reset(value::TypeTags::bsonObject, value::bitcastFrom<const char*>(doc.objdata()));
+    ASSERT_FALSE(_interpreter.runPredicate(code.get()));
+}
+
+TEST_F(SBETierUpTest, ZeroThresholdDisablesTierUp) {
+    auto oldThreshold = internalQuerySlotBasedExecutionTierUpThreshold.load();
+    ON_BLOCK_EXIT([&] { internalQuerySlotBasedExecutionTierUpThreshold.store(oldThreshold); });
+    internalQuerySlotBasedExecutionTierUpThreshold.store(0);
+
+    auto expr = makeE<EConstant>(value::TypeTags::Boolean, value::bitcastFrom<bool>(true));
+    auto code = compileExpression(*expr);
+
+    for (int run = 0; run < 10; ++run) {
+        ASSERT_FALSE(code->tierUp());
+    }
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,318 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/block.h"
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+
+#include "mongo/util/str.h"
+
+namespace mongo::sbe {
+namespace {
+void addSlotVector(std::vector<DebugPrinter::Block>& ret, const value::SlotVector& slots) {
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < slots.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+
+        DebugPrinter::addIdentifier(ret, slots[idx]);
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+}
+}  // namespace
+
+BlockStage::BlockStage(std::unique_ptr<PlanStage> input,
+                       value::SlotVector inSlots,
+                       value::SlotVector outSlots,
+                       size_t blockSize,
+                       PlanNodeId planNodeId)
+    : PlanStage("block"_sd, planNodeId),
+      _inSlots(std::move(inSlots)),
+      _outSlots(std::move(outSlots)),
+      _blockSize(blockSize) {
+    _children.emplace_back(std::move(input));
+
+    uassert(5300100, "block size must be positive", _blockSize > 0);
+    uassert(5300101,
+            "the number of input and output slots must be the same",
+            _inSlots.size() == _outSlots.size());
+}
+
+std::unique_ptr<PlanStage> BlockStage::clone() const {
+    return std::make_unique<BlockStage>(
+        _children[0]->clone(), _inSlots, _outSlots, _blockSize, _commonStats.nodeId);
+}
+
+void BlockStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    for (size_t idx = 0; idx < _inSlots.size(); ++idx) {
+        _inAccessors.emplace_back(_children[0]->getAccessor(ctx, _inSlots[idx]));
+        _outAccessors.emplace_back(std::make_unique<value::OwnedValueAccessor>());
+
+        auto [it, inserted] = _outAccessorsMap.emplace(_outSlots[idx], _outAccessors.back().get());
+        const auto slotId = _outSlots[idx];
+        uassert(5300102, str::stream() << "duplicate field: " << slotId, inserted);
+    }
+}
+
+value::SlotAccessor* BlockStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _outAccessorsMap.find(slot); it != _outAccessorsMap.end()) {
+        return it->second;
+    }
+
+    // The per-row slots of the child are not visible above this stage, as they only hold the last
+    // row of the batch.
+    return ctx.getAccessor(slot);
+}
+
+void BlockStage::open(bool reOpen) {
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+    _done = false;
+}
+
+PlanState BlockStage::getNext() {
+    if (_done) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    std::vector<value::ValueBlock*> blocks;
+    blocks.reserve(_outAccessors.size());
+    for (auto& accessor : _outAccessors) {
+        auto [tag, val] = value::makeNewValueBlock();
+        accessor->reset(tag, val);
+
+        auto block = value::getValueBlockView(val);
+        block->reserve(_blockSize);
+        blocks.push_back(block);
+    }
+
+    size_t rows = 0;
+    while (rows < _blockSize) {
+        auto state = _children[0]->getNext();
+        if (state == PlanState::IS_EOF) {
+            _done = true;
+            break;
+        }
+
+        for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
+            auto [tag, val] = _inAccessors[idx]->copyOrMoveValue();
+            blocks[idx]->push_back(tag, val);
+        }
+        ++rows;
+    }
+
+    if (rows == 0) {
+        return trackPlanState(PlanState::IS_EOF);
+    }
+
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void BlockStage::close() {
+    _commonStats.closes++;
+    _children[0]->close();
+}
+
+std::unique_ptr<PlanStageStats> BlockStage::getStats() const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->children.emplace_back(_children[0]->getStats());
+    return ret;
+}
+
+const SpecificStats* BlockStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> BlockStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    ret.emplace_back(std::to_string(_blockSize));
+    addSlotVector(ret, _outSlots);
+    addSlotVector(ret, _inSlots);
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+
+UnblockStage::UnblockStage(std::unique_ptr<PlanStage> input,
+                           value::SlotVector inSlots,
+                           value::SlotVector outSlots,
+                           boost::optional<value::SlotId> selectionSlot,
+                           PlanNodeId planNodeId)
+    : PlanStage("unblock"_sd, planNodeId),
+      _inSlots(std::move(inSlots)),
+      _outSlots(std::move(outSlots)),
+      _selectionSlot(selectionSlot) {
+    _children.emplace_back(std::move(input));
+
+    uassert(5300103,
+            "the number of input and output slots must be the same",
+            _inSlots.size() == _outSlots.size());
+}
+
+std::unique_ptr<PlanStage> UnblockStage::clone() const {
+    return std::make_unique<UnblockStage>(
+        _children[0]->clone(), _inSlots, _outSlots, _selectionSlot, _commonStats.nodeId);
+}
+
+void UnblockStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+
+    for (size_t idx = 0; idx < _inSlots.size(); ++idx) {
+        _inAccessors.emplace_back(_children[0]->getAccessor(ctx, _inSlots[idx]));
+        _outAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+
+        auto [it, inserted] = _outAccessorsMap.emplace(_outSlots[idx], _outAccessors.back().get());
+        const auto slotId = _outSlots[idx];
+        uassert(5300104, str::stream() << "duplicate field: " << slotId, inserted);
+    }
+
+    if (_selectionSlot) {
+        _selectionAccessor = _children[0]->getAccessor(ctx, *_selectionSlot);
+    }
+}
+
+value::SlotAccessor* UnblockStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _outAccessorsMap.find(slot); it != _outAccessorsMap.end()) {
+        return it->second;
+    }
+
+    return _children[0]->getAccessor(ctx, slot);
+}
+
+void UnblockStage::open(bool reOpen) {
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+
+    _index = 0;
+    _blockSize = 0;
+}
+
+value::ValueBlock* UnblockStage::getBlock(value::SlotAccessor* accessor) {
+    auto [tag, val] = accessor->getViewOfValue();
+    uassert(5300105,
+            str::stream() << "unblock expects a block of values, got: " << tag,
+            tag == value::TypeTags::valueBlock);
+
+    auto block = value::getValueBlockView(val);
+    uassert(5300106,
+            str::stream() << "mismatched block sizes: " << block->size() << " and " << _blockSize,
+            block->size() == _blockSize);
+    return block;
+}
+
+PlanState UnblockStage::getNext() {
+    while (true) {
+        if (_index >= _blockSize) {
+            auto state = _children[0]->getNext();
+            if (state != PlanState::ADVANCED) {
+                return trackPlanState(state);
+            }
+
+            _index = 0;
+            _blockSize = 0;
+            // All the blocks must have the same size, so take it from the first one.
+            if (!_inAccessors.empty()) {
+                auto [tag, val] = _inAccessors[0]->getViewOfValue();
+                if (tag == value::TypeTags::valueBlock) {
+                    _blockSize = value::getValueBlockView(val)->size();
+                }
+            } else if (_selectionAccessor) {
+                auto [tag, val] = _selectionAccessor->getViewOfValue();
+                if (tag == value::TypeTags::valueBlock) {
+                    _blockSize = value::getValueBlockView(val)->size();
+                }
+            }
+
+            // Validate all the blocks once per batch rather than once per row.
+            for (auto accessor : _inAccessors) {
+                getBlock(accessor);
+            }
+            if (_selectionAccessor) {
+                getBlock(_selectionAccessor);
+            }
+            continue;
+        }
+
+        auto idx = _index++;
+        if (_selectionAccessor) {
+            auto [tag, val] =
+                value::getValueBlockView(_selectionAccessor->getViewOfValue().second)->getAt(idx);
+            if (tag != value::TypeTags::Boolean || !value::bitcastTo<bool>(val)) {
+                continue;
+            }
+        }
+
+        for (size_t slot = 0; slot < _inAccessors.size(); ++slot) {
+            auto [tag, val] =
+                value::getValueBlockView(_inAccessors[slot]->getViewOfValue().second)->getAt(idx);
+            _outAccessors[slot]->reset(tag, val);
+        }
+
+        return trackPlanState(PlanState::ADVANCED);
+    }
+}
+
+void UnblockStage::close() {
+    _commonStats.closes++;
+    _children[0]->close();
+}
+
+std::unique_ptr<PlanStageStats> UnblockStage::getStats() const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->children.emplace_back(_children[0]->getStats());
+    return ret;
+}
+
+const SpecificStats* UnblockStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> UnblockStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    addSlotVector(ret, _outSlots);
+    addSlotVector(ret, _inSlots);
+    if (_selectionSlot) {
+        DebugPrinter::addIdentifier(ret, *_selectionSlot);
+    }
+
+    DebugPrinter::addNewLine(ret);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+
+    return ret;
+}
+}  // namespace mongo::sbe
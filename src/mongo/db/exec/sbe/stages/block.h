@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+
+namespace mongo::sbe {
+/**
+ * Groups up to 'blockSize' consecutive rows produced by the child stage into blocks of values so
+ * that the stages above can process the whole batch at once. For every slot in 'inSlots' the stage
+ * exposes a 'valueBlock' holding the values of that slot in the corresponding slot of 'outSlots'.
+ * The value at position 'idx' of every output block belongs to the same input row.
+ *
+ * Debug string representation:
+ *
+ *  block blockSize [<out slots>] [<in slots>] childStage
+ */
+class BlockStage final : public PlanStage {
+public:
+    BlockStage(std::unique_ptr<PlanStage> input,
+               value::SlotVector inSlots,
+               value::SlotVector outSlots,
+               size_t blockSize,
+               PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats() const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    const value::SlotVector _inSlots;
+    const value::SlotVector _outSlots;
+    const size_t _blockSize;
+
+    std::vector<value::SlotAccessor*> _inAccessors;
+    std::vector<std::unique_ptr<value::OwnedValueAccessor>> _outAccessors;
+    value::SlotAccessorMap _outAccessorsMap;
+
+    bool _done{false};
+};
+
+/**
+ * The inverse of BlockStage: takes the blocks of values stored in 'inSlots' and produces one row
+ * per position in the blocks, exposing the individual values in the corresponding 'outSlots'. If
+ * 'selectionSlot' is given, it must hold a block of the same size, and only the rows for which the
+ * selection block contains boolean 'true' are returned. This is how a filter evaluated a block at
+ * a time is applied to the rows.
+ *
+ * Debug string representation:
+ *
+ *  unblock [<out slots>] [<in slots>] selectionSlot? childStage
+ */
+class UnblockStage final : public PlanStage {
+public:
+    UnblockStage(std::unique_ptr<PlanStage> input,
+                 value::SlotVector inSlots,
+                 value::SlotVector outSlots,
+                 boost::optional<value::SlotId> selectionSlot,
+                 PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats() const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    /**
+     * Returns a view of the block stored in the given accessor, or throws if the accessor holds
+     * something other than a block of the expected size.
+     */
+    value::ValueBlock* getBlock(value::SlotAccessor* accessor);
+
+    const value::SlotVector _inSlots;
+    const value::SlotVector _outSlots;
+    const boost::optional<value::SlotId> _selectionSlot;
+
+    std::vector<value::SlotAccessor*> _inAccessors;
+    value::SlotAccessor* _selectionAccessor{nullptr};
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outAccessors;
+    value::SlotAccessorMap _outAccessorsMap;
+
+    // Position of the next row to produce within the current set of blocks, and the number of rows
+    // in it.
+    size_t _index{0};
+    size_t _blockSize{0};
+};
+}  // namespace mongo::sbe
@@ -31,8 +31,13 @@
 
 #include "mongo/db/exec/sbe/stages/exchange.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 std::unique_ptr<ThreadPool> s_globalThreadPool;
@@ -84,10 +89,12 @@ std::unique_ptr<ExchangeBuffer> ExchangePipe::getEmptyBuffer() {
     return std::move(_emptyBuffers[_emptyCount]);
 }
 
-std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer() {
+std::unique_ptr<ExchangeBuffer> ExchangePipe::getFullBuffer(OperationContext* opCtx) {
     stdx::unique_lock lock(_mutex);
 
-    _cond.wait(lock, [this]() { return _closed || _fullCount != _fullPosition; });
+    // The consumer waits on behalf of the query, so it must notice when the query is killed.
+    opCtx->waitForConditionOrInterrupt(
+        _cond, lock, [this]() { return _closed || _fullCount != _fullPosition; });
 
     if (_closed) {
         return nullptr;
@@ -134,12 +141,35 @@ ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
 }
 
+void ExchangeState::addProducerOpCtx(OperationContext* opCtx) {
+    stdx::lock_guard lock(_producerOpCtxsMutex);
+    _producerOpCtxs.push_back(opCtx);
+    if (_producerKillCode != ErrorCodes::OK) {
+        stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+        opCtx->getServiceContext()->killOperation(clientLock, opCtx, _producerKillCode);
+    }
+}
+
+void ExchangeState::removeProducerOpCtx(OperationContext* opCtx) {
+    stdx::lock_guard lock(_producerOpCtxsMutex);
+    _producerOpCtxs.erase(std::find(_producerOpCtxs.begin(), _producerOpCtxs.end(), opCtx));
+}
+
+void ExchangeState::killProducers(ErrorCodes::Error killCode) {
+    stdx::lock_guard lock(_producerOpCtxsMutex);
+    _producerKillCode = killCode;
+    for (auto opCtx : _producerOpCtxs) {
+        stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+        opCtx->getServiceContext()->killOperation(clientLock, opCtx, killCode);
+    }
+}
+
 ExchangeBuffer* ExchangeConsumer::getBuffer(size_t producerId) {
     if (_fullBuffers[producerId]) {
         return _fullBuffers[producerId].get();
     }
 
-    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer();
+    _fullBuffers[producerId] = _pipes[producerId]->getFullBuffer(_opCtx);
 
     return _fullBuffers[producerId].get();
 }
@@ -249,15 +279,22 @@ void ExchangeConsumer::open(bool reOpen) {
                 }
             }
 
-            // Start n producers.
+            // Start n producers. Each producer runs under its own operation context, which
+            // inherits the deadline of this operation and is killed along with it in close().
             invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
+            const auto deadline = _opCtx->getDeadline();
+            const auto timeoutError = _opCtx->getTimeoutError();
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 auto pf = makePromiseFuture<void>();
                 s_globalThreadPool->schedule(
-                    [this, idx, promise = std::move(pf.promise)](auto status) mutable {
+                    [this, idx, deadline, timeoutError, promise = std::move(pf.promise)](
+                        auto status) mutable {
                         invariant(status);
 
                         auto opCtx = cc().makeOperationContext();
+                        opCtx->setDeadlineByDate(deadline, timeoutError);
+                        _state->addProducerOpCtx(opCtx.get());
+                        ON_BLOCK_EXIT([&] { _state->removeProducerOpCtx(opCtx.get()); });
 
                         promise.setWith([&] {
                             ExchangeProducer::start(opCtx.get(),
@@ -329,6 +366,12 @@ void ExchangeConsumer::close() {
         stdx::unique_lock lock(_state->consumerCloseMutex());
         ++_state->consumerClose();
 
+        // If the query has been killed, the producers may be blocked on something else than the
+        // pipes, so kill them too.
+        if (auto killCode = _opCtx->getKillStatus(); killCode != ErrorCodes::OK) {
+            _state->killProducers(killCode);
+        }
+
         // Signal early out.
         for (auto& p : _pipes) {
             p->close();
@@ -363,7 +406,10 @@ void ExchangeConsumer::close() {
 
 std::unique_ptr<PlanStageStats> ExchangeConsumer::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
-    ret->children.emplace_back(_children[0]->getStats());
+    // Once opened, the subtree has been handed over to the producers.
+    if (!_children.empty()) {
+        ret->children.emplace_back(_children[0]->getStats());
+    }
     return ret;
 }
 
@@ -396,8 +442,10 @@ std::vector<DebugPrinter::Block> ExchangeConsumer::debugPrint() const {
             uasserted(4822835, "policy not yet implemented");
     }
 
-    DebugPrinter::addNewLine(ret);
-    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    if (!_children.empty()) {
+        DebugPrinter::addNewLine(ret);
+        DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    }
 
     return ret;
 }
@@ -123,7 +123,7 @@ public:
 
     void close();
     std::unique_ptr<ExchangeBuffer> getEmptyBuffer();
-    std::unique_ptr<ExchangeBuffer> getFullBuffer();
+    std::unique_ptr<ExchangeBuffer> getFullBuffer(OperationContext* opCtx);
     void putEmptyBuffer(std::unique_ptr<ExchangeBuffer>);
     void putFullBuffer(std::unique_ptr<ExchangeBuffer>);
 
@@ -217,6 +217,19 @@ public:
     }
     ExchangePipe* pipe(size_t consumerTid, size_t producerTid);
 
+    /**
+     * Links the operation context of a producer to the operation running the consumers until it is
+     * removed, so that killProducers() reaches it. A producer added after killProducers() has been
+     * called is killed right away.
+     */
+    void addProducerOpCtx(OperationContext* opCtx);
+    void removeProducerOpCtx(OperationContext* opCtx);
+
+    /**
+     * Kills the operation contexts of all the producers with 'killCode'.
+     */
+    void killProducers(ErrorCodes::Error killCode);
+
 private:
     const ExchangePolicy _policy;
     const size_t _numOfProducers;
@@ -244,6 +257,11 @@ private:
     mongo::Mutex _consumerCloseMutex;
     stdx::condition_variable _consumerCloseCond;
     size_t _consumerClose{0};
+
+    // The operation contexts of the running producers, and the code they have been killed with.
+    mongo::Mutex _producerOpCtxsMutex = MONGO_MAKE_LATCH("ExchangeState::_producerOpCtxsMutex");
+    std::vector<OperationContext*> _producerOpCtxs;
+    ErrorCodes::Error _producerKillCode{ErrorCodes::OK};
 };
 
 class ExchangeConsumer final : public PlanStage {
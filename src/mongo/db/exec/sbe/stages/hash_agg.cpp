@@ -31,16 +31,55 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include <absl/hash/hash.h>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
+namespace {
+Counter64 hashAggSpilledRecordsCounter;
+Counter64 hashAggSpilledBytesCounter;
+Counter64 hashAggSpilledPartitionsCounter;
+
+ServerStatusMetricField<Counter64> displayHashAggSpilledRecords(
+    "query.sbe.hashAgg.spilledRecords", &hashAggSpilledRecordsCounter);
+ServerStatusMetricField<Counter64> displayHashAggSpilledBytes("query.sbe.hashAgg.spilledBytes",
+                                                              &hashAggSpilledBytesCounter);
+ServerStatusMetricField<Counter64> displayHashAggSpilledPartitions(
+    "query.sbe.hashAgg.spilledPartitions", &hashAggSpilledPartitionsCounter);
+}  // namespace
+
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
                            value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                           size_t memoryLimit,
+                           bool allowDiskUse,
+                           TrialRunProgressTracker* tracker,
                            PlanNodeId planNodeId)
-    : PlanStage("group"_sd, planNodeId), _gbs(std::move(gbs)), _aggs(std::move(aggs)) {
+    : PlanStage("group"_sd, planNodeId),
+      _gbs(std::move(gbs)),
+      _aggs(std::move(aggs)),
+      _allowDiskUse(allowDiskUse),
+      _tracker(tracker) {
     _children.emplace_back(std::move(input));
+
+    _specificStats.maxMemoryUsageBytes = memoryLimit;
+}
+
+HashAggStage::~HashAggStage() {
+    dropPartitions();
 }
 
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
@@ -48,8 +87,13 @@ std::unique_ptr<PlanStage> HashAggStage::clone() const {
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(
-        _children[0]->clone(), _gbs, std::move(aggs), _commonStats.nodeId);
+    return std::make_unique<HashAggStage>(_children[0]->clone(),
+                                          _gbs,
+                                          std::move(aggs),
+                                          _specificStats.maxMemoryUsageBytes,
+                                          _allowDiskUse,
+                                          _tracker,
+                                          _commonStats.nodeId);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
@@ -95,72 +139,310 @@ value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId sl
             return it->second;
         }
     } else {
-        return _children[0]->getAccessor(ctx, slot);
+        // The aggregate expressions are being compiled. Values coming from outside of this subtree
+        // stay the same for the whole input, so only the slots produced by the child need to be
+        // saved when an input row is spilled.
+        if (ctx.isOuterSlot(slot)) {
+            return _children[0]->getAccessor(ctx, slot);
+        }
+
+        for (size_t idx = 0; idx < _inAggSlots.size(); ++idx) {
+            if (_inAggSlots[idx] == slot) {
+                return _inAggAccessors[idx].get();
+            }
+        }
+
+        _inAggSlots.push_back(slot);
+        _inAggChildAccessors.push_back(_children[0]->getAccessor(ctx, slot));
+        _inAggAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+        return _inAggAccessors.back().get();
     }
 
     return ctx.getAccessor(slot);
 }
 
-void HashAggStage::open(bool reOpen) {
-    _commonStats.opens++;
-    _children[0]->open(reOpen);
-
-    while (_children[0]->getNext() == PlanState::ADVANCED) {
-        value::MaterializedRow key{_inKeyAccessors.size()};
-        // Copy keys in order to do the lookup.
+void HashAggStage::accumulate() {
+    value::MaterializedRow key{_inKeyAccessors.size()};
+    // Copy keys in order to do the lookup.
+    if (_readingSpilledRow) {
+        for (size_t idx = 0; idx < key.size(); ++idx) {
+            auto [tag, val] = _spilledRow.first.getViewOfValue(idx);
+            key.reset(idx, false, tag, val);
+        }
+        for (size_t idx = 0; idx < _inAggAccessors.size(); ++idx) {
+            auto [tag, val] = _spilledRow.second.getViewOfValue(idx);
+            _inAggAccessors[idx]->reset(tag, val);
+        }
+    } else {
         size_t idx = 0;
         for (auto& p : _inKeyAccessors) {
             auto [tag, val] = p->getViewOfValue();
             key.reset(idx++, false, tag, val);
         }
+        for (idx = 0; idx < _inAggAccessors.size(); ++idx) {
+            auto [tag, val] = _inAggChildAccessors[idx]->getViewOfValue();
+            _inAggAccessors[idx]->reset(tag, val);
+        }
+    }
+
+    auto it = _ht.find(key);
+    bool inserted = false;
+    if (it == _ht.end()) {
+        // A new group can always be added to an empty table, which guarantees that every pass
+        // over a spilled partition makes progress.
+        if (!_ht.empty() && _htMemUsage > _specificStats.maxMemoryUsageBytes) {
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    str::stream() << "Exceeded memory limit for $group, but didn't allow external "
+                                     "sort. Pass allowDiskUse:true to opt in.",
+                    _allowDiskUse);
+            spill(key);
+            return;
+        }
+
+        std::tie(it, inserted) = _ht.try_emplace(std::move(key), value::MaterializedRow{0});
+        // Copy keys.
+        const_cast<value::MaterializedRow&>(it->first).makeOwned();
+        // Initialize accumulators, followed by the estimated size of each of them.
+        it->second.resize(2 * _outAggAccessors.size());
+    }
 
-        auto [it, inserted] = _ht.try_emplace(std::move(key), value::MaterializedRow{0});
-        if (inserted) {
-            // Copy keys.
-            const_cast<value::MaterializedRow&>(it->first).makeOwned();
-            // Initialize accumulators.
-            it->second.resize(_outAggAccessors.size());
+    // Accumulate.
+    _htIt = it;
+    const size_t numAggs = _outAggAccessors.size();
+    int64_t growth = inserted ? it->first.memUsageForSorter() : 0;
+    int64_t maxInputSize = -1;
+    for (size_t idx = 0; idx < numAggs; ++idx) {
+        auto [oldTag, oldVal] = it->second.getViewOfValue(idx);
+        size_t oldNumElems = 0;
+        if (oldTag == value::TypeTags::Array) {
+            oldNumElems = value::getArrayView(oldVal)->size();
+        } else if (oldTag == value::TypeTags::ArraySet) {
+            oldNumElems = value::getArraySetView(oldVal)->size();
         }
 
-        // Accumulate.
-        _htIt = it;
-        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
-            auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
-            _outAggAccessors[idx]->reset(owned, tag, val);
+        auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
+        _outAggAccessors[idx]->reset(owned, tag, val);
+
+        // An aggregate function like 'addToArray' appends to the array it is given, in which case
+        // only the appended elements are measured, as measuring the whole array for each input row
+        // would take quadratic time. The elements appended to a set are not known, so each of them
+        // is assumed to be as large as the largest input value.
+        const int64_t oldSize = inserted
+            ? 0
+            : value::bitcastTo<int64_t>(it->second.getViewOfValue(numAggs + idx).second);
+        int64_t newSize = oldSize;
+        if (tag == value::TypeTags::Array && tag == oldTag && val == oldVal) {
+            auto arr = value::getArrayView(val);
+            for (size_t elemIdx = oldNumElems; elemIdx < arr->size(); ++elemIdx) {
+                auto [elemTag, elemVal] = arr->getAt(elemIdx);
+                newSize += value::getApproximateSize(elemTag, elemVal);
+            }
+        } else if (tag == value::TypeTags::ArraySet && tag == oldTag && val == oldVal) {
+            if (auto numAdded = value::getArraySetView(val)->size() - oldNumElems; numAdded > 0) {
+                if (maxInputSize < 0) {
+                    maxInputSize = 0;
+                    for (auto&& inputAccessor : _inAggAccessors) {
+                        auto [inputTag, inputVal] = inputAccessor->getViewOfValue();
+                        maxInputSize = std::max<int64_t>(
+                            maxInputSize, value::getApproximateSize(inputTag, inputVal));
+                    }
+                }
+                newSize += static_cast<int64_t>(numAdded) * maxInputSize;
+            }
+        } else {
+            newSize = value::getApproximateSize(tag, val);
+        }
+        it->second.reset(numAggs + idx,
+                         false,
+                         value::TypeTags::NumberInt64,
+                         value::bitcastFrom<int64_t>(newSize));
+        growth += newSize - oldSize;
+    }
+    _htMemUsage = std::max<int64_t>(0, static_cast<int64_t>(_htMemUsage) + growth);
+
+    // The groups in the table are never spilled, so the query fails when the groups keep growing
+    // past the limit without allowDiskUse, or when a single group does not fit within the limit.
+    if (growth > 0 && _htMemUsage > _specificStats.maxMemoryUsageBytes) {
+        uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                str::stream() << "Exceeded memory limit for $group, but didn't allow external "
+                                 "sort. Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+
+        size_t groupMemUsage = it->first.memUsageForSorter();
+        for (size_t idx = 0; idx < numAggs; ++idx) {
+            groupMemUsage +=
+                value::bitcastTo<int64_t>(it->second.getViewOfValue(numAggs + idx).second);
+        }
+        uassert(ErrorCodes::ExceededMemoryLimit,
+                str::stream() << "Exceeded memory limit of " << _specificStats.maxMemoryUsageBytes
+                              << " bytes for a single $group group",
+                groupMemUsage <= _specificStats.maxMemoryUsageBytes);
+    }
+}
+
+void HashAggStage::spill(const value::MaterializedRow& key) {
+    if (_spillWriters.empty()) {
+        _spillWriters.resize(kNumSpillPartitions);
+        _spillFileNames.resize(kNumSpillPartitions);
+    }
+
+    // Mix the level into the hash, so that the rows of a spilled partition are spread across all
+    // the new partitions when it gets partitioned again.
+    auto partition = absl::Hash<std::pair<size_t, size_t>>{}(
+                         std::make_pair(_level, value::MaterializedRowHasher{}(key))) %
+        kNumSpillPartitions;
+
+    auto& writer = _spillWriters[partition];
+    if (!writer) {
+        SortOptions opts;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        _spillFileNames[partition] = opts.tempDir + "/" + nextFileName();
+        writer = std::make_unique<SpillWriter>(opts, _spillFileNames[partition], 0);
+        _specificStats.usedDisk = true;
+    }
+
+    value::MaterializedRow values{_inAggAccessors.size()};
+    for (size_t idx = 0; idx < _inAggAccessors.size(); ++idx) {
+        auto [tag, val] = _inAggAccessors[idx]->getViewOfValue();
+        values.reset(idx, false, tag, val);
+    }
+
+    writer->addAlreadySorted(key, values);
+    ++_specificStats.spilledRecords;
+    hashAggSpilledRecordsCounter.increment();
+}
+
+void HashAggStage::finishSpilling() {
+    for (size_t partition = 0; partition < _spillWriters.size(); ++partition) {
+        auto& writer = _spillWriters[partition];
+        if (!writer) {
+            continue;
+        }
+
+        std::unique_ptr<SpillIterator> it{writer->done()};
+        size_t bytes = writer->getFileEndOffset();
+        writer.reset();
+
+        _specificStats.spilledBytes += bytes;
+        ++_specificStats.spilledPartitions;
+        hashAggSpilledBytesCounter.increment(bytes);
+        hashAggSpilledPartitionsCounter.increment();
+
+        _pendingPartitions.push_back(
+            {std::move(_spillFileNames[partition]), std::move(it), _level + 1});
+    }
+}
+
+void HashAggStage::consumePartition(SpilledPartition& partition) {
+    _level = partition.level;
+    _readingSpilledRow = true;
+
+    while (partition.it->more()) {
+        _spilledRow = partition.it->next();
+        accumulate();
+    }
+
+    _readingSpilledRow = false;
+    finishSpilling();
+}
+
+void HashAggStage::dropPartitions() {
+    for (auto& writer : _spillWriters) {
+        if (writer) {
+            // Close the file before deleting it.
+            DESTRUCTOR_GUARD(std::unique_ptr<SpillIterator>(writer->done()));
+            writer.reset();
+        }
+    }
+    for (auto& fileName : _spillFileNames) {
+        if (!fileName.empty()) {
+            DESTRUCTOR_GUARD(boost::filesystem::remove(fileName));
+        }
+    }
+    _spillWriters.clear();
+    _spillFileNames.clear();
+
+    for (auto& partition : _pendingPartitions) {
+        partition.it.reset();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(partition.fileName));
+    }
+    _pendingPartitions.clear();
+}
+
+void HashAggStage::open(bool reOpen) {
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+
+    _ht.clear();
+    _htMemUsage = 0;
+    _level = 0;
+    dropPartitions();
+
+    while (_children[0]->getNext() == PlanState::ADVANCED) {
+        accumulate();
+
+        if (_tracker && _tracker->trackProgress<TrialRunProgressTracker::kNumResults>(1)) {
+            // Like a sort, the aggregation is a blocking operation which does not return control
+            // to the runtime planner until its whole input is consumed. Bail out from the trial
+            // run once it has done enough work by raising the special exception signaling that
+            // this candidate plan has completed its trial run early.
+            _tracker = nullptr;
+            _children[0]->close();
+            uasserted(ErrorCodes::QueryTrialRunCompleted, "Trial run early exit");
         }
     }
 
     _children[0]->close();
 
+    finishSpilling();
+
     _htIt = _ht.end();
 }
 
 PlanState HashAggStage::getNext() {
-    if (_htIt == _ht.end()) {
-        _htIt = _ht.begin();
-    } else {
-        ++_htIt;
-    }
+    while (true) {
+        if (_htIt == _ht.end()) {
+            _htIt = _ht.begin();
+        } else {
+            ++_htIt;
+        }
 
-    if (_htIt == _ht.end()) {
-        return trackPlanState(PlanState::IS_EOF);
-    }
+        if (_htIt != _ht.end()) {
+            return trackPlanState(PlanState::ADVANCED);
+        }
 
-    return trackPlanState(PlanState::ADVANCED);
+        if (_pendingPartitions.empty()) {
+            return trackPlanState(PlanState::IS_EOF);
+        }
+
+        // All the groups in the table have been returned, so aggregate the next spilled partition.
+        auto partition = std::move(_pendingPartitions.front());
+        _pendingPartitions.pop_front();
+
+        _ht.clear();
+        _htMemUsage = 0;
+        consumePartition(partition);
+
+        partition.it.reset();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(partition.fileName));
+        _htIt = _ht.end();
+    }
 }
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
     ret->children.emplace_back(_children[0]->getStats());
     return ret;
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
     _commonStats.closes++;
+    dropPartitions();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
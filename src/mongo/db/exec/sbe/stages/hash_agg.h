@@ -29,22 +29,50 @@
 
 #pragma once
 
+#include <deque>
 #include <unordered_map>
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
+#include "mongo/db/exec/trial_run_progress_tracker.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class SortedFileWriter;
+
 namespace sbe {
+/**
+ * Groups the rows produced by the child stage by the values in the 'gbs' slots and computes the
+ * 'aggs' aggregate expressions for each group using a hash table.
+ *
+ * Once the estimated size of the hash table exceeds 'memoryLimit', no new groups are added to the
+ * table. Rows belonging to groups already in the table are still aggregated in memory, while the
+ * rows of all the other groups are hash partitioned by their group-by key and spilled to temporary
+ * files if 'allowDiskUse' is true, or the query fails otherwise. After the in-memory groups have
+ * been returned, each spilled partition is read back and aggregated in the same way, spilling into
+ * finer grained partitions when it still doesn't fit in memory. As all the rows of a group end up
+ * in the same partition, the partial results never need to be merged. The groups in the table are
+ * never spilled, so the query fails if a single group outgrows 'memoryLimit'.
+ */
 class HashAggStage final : public PlanStage {
 public:
+    // The number of partitions the rows that don't fit in memory are split into.
+    static constexpr size_t kNumSpillPartitions = 8;
+
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
+                 size_t memoryLimit,
+                 bool allowDiskUse,
+                 TrialRunProgressTracker* tracker,
                  PlanNodeId planNodeId);
 
+    ~HashAggStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -57,6 +85,11 @@ public:
     const SpecificStats* getSpecificStats() const final;
     std::vector<DebugPrinter::Block> debugPrint() const final;
 
+protected:
+    void doAttachToTrialRunTracker(TrialRunProgressTracker* tracker) override {
+        _tracker = tracker;
+    }
+
 private:
     using TableType = stdx::
         unordered_map<value::MaterializedRow, value::MaterializedRow, value::MaterializedRowHasher>;
@@ -64,11 +97,59 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashAggAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    // A spilled input row consists of the group-by key and the values of the slots read by the
+    // aggregate expressions.
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+    using SpillWriter = SortedFileWriter<value::MaterializedRow, value::MaterializedRow>;
+
+    struct SpilledPartition {
+        std::string fileName;
+        std::unique_ptr<SpillIterator> it;
+        // The number of times the rows in this partition have been partitioned.
+        size_t level;
+    };
+
+    /**
+     * Aggregates the current input row into the hash table, or spills it into one of the
+     * partitions if its group is not in the table and the table is full.
+     */
+    void accumulate();
+
+    /**
+     * Spills the current input row with the given group-by 'key' to its partition.
+     */
+    void spill(const value::MaterializedRow& key);
+
+    /**
+     * Aggregates all the rows of the given spilled partition into the hash table.
+     */
+    void consumePartition(SpilledPartition& partition);
+
+    /**
+     * Closes the partitions written while aggregating the current input and queues them up for
+     * processing.
+     */
+    void finishSpilling();
+
+    /**
+     * Drops all the pending spilled partitions and deletes their files.
+     */
+    void dropPartitions();
+
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
+    const bool _allowDiskUse;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
+
+    // The child slots read by the aggregate expressions. The expressions are compiled against the
+    // '_inAggAccessors' that are populated either from the '_inAggChildAccessors', or from a
+    // spilled row.
+    value::SlotVector _inAggSlots;
+    std::vector<value::SlotAccessor*> _inAggChildAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _inAggAccessors;
     std::vector<std::unique_ptr<HashKeyAccessor>> _outKeyAccessors;
 
     std::vector<std::unique_ptr<HashAggAccessor>> _outAggAccessors;
@@ -80,6 +161,28 @@ private:
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    // Estimated memory used by the hash table: the size of the group-by keys and of the aggregate
+    // values, which is kept up to date as the aggregate values of a group grow. The estimated size
+    // of each aggregate value is stored in the row of its group, after the aggregate values.
+    size_t _htMemUsage{0};
+
+    // The input row being aggregated when reading back a spilled partition.
+    SpilledRow _spilledRow;
+    bool _readingSpilledRow{false};
+    // The number of times the input being aggregated has been partitioned, zero for the child
+    // input.
+    size_t _level{0};
+
+    std::vector<std::unique_ptr<SpillWriter>> _spillWriters;
+    std::vector<std::string> _spillFileNames;
+    std::deque<SpilledPartition> _pendingPartitions;
+
+    HashAggStats _specificStats;
+
+    // If provided, used during a trial run to accumulate certain execution stats. Once the trial
+    // run is complete, this pointer is reset to nullptr.
+    TrialRunProgressTracker* _tracker{nullptr};
 };
 }  // namespace sbe
 }  // namespace mongo
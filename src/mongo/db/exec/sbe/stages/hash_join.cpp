@@ -31,23 +31,84 @@
 
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
+#include <absl/hash/hash.h>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashJoinFileCounter;
+    return "extsort-hash-join-sbe." + std::to_string(hashJoinFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
+namespace {
+Counter64 hashJoinSpilledRecordsCounter;
+Counter64 hashJoinSpilledBytesCounter;
+Counter64 hashJoinSpilledPartitionsCounter;
+
+ServerStatusMetricField<Counter64> displayHashJoinSpilledRecords(
+    "query.sbe.hashJoin.spilledRecords", &hashJoinSpilledRecordsCounter);
+ServerStatusMetricField<Counter64> displayHashJoinSpilledBytes("query.sbe.hashJoin.spilledBytes",
+                                                               &hashJoinSpilledBytesCounter);
+ServerStatusMetricField<Counter64> displayHashJoinSpilledPartitions(
+    "query.sbe.hashJoin.spilledPartitions", &hashJoinSpilledPartitionsCounter);
+}  // namespace
+
+HashJoinStage::SpillFile::SpillFile(SpillFile&& other)
+    : fileName(std::exchange(other.fileName, {})),
+      writer(std::move(other.writer)),
+      it(std::move(other.it)) {}
+
+HashJoinStage::SpillFile& HashJoinStage::SpillFile::operator=(SpillFile&& other) {
+    if (this != &other) {
+        drop();
+        fileName = std::exchange(other.fileName, {});
+        writer = std::move(other.writer);
+        it = std::move(other.it);
+    }
+    return *this;
+}
+
+HashJoinStage::SpillFile::~SpillFile() {
+    drop();
+}
+
+void HashJoinStage::SpillFile::drop() {
+    if (writer) {
+        // Close the file before deleting it.
+        DESTRUCTOR_GUARD(std::unique_ptr<SpillIterator>(writer->done()));
+        writer.reset();
+    }
+    it.reset();
+    if (!fileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(fileName));
+        fileName.clear();
+    }
+}
+
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              std::unique_ptr<PlanStage> inner,
                              value::SlotVector outerCond,
                              value::SlotVector outerProjects,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
+                             size_t memoryLimit,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
       _outerProjects(std::move(outerProjects)),
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
+      _allowDiskUse(allowDiskUse),
       _probeKey(0) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
@@ -55,8 +116,12 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
 
     _children.emplace_back(std::move(outer));
     _children.emplace_back(std::move(inner));
+
+    _specificStats.maxMemoryUsageBytes = memoryLimit;
 }
 
+HashJoinStage::~HashJoinStage() {}
+
 std::unique_ptr<PlanStage> HashJoinStage::clone() const {
     return std::make_unique<HashJoinStage>(_children[0]->clone(),
                                            _children[1]->clone(),
@@ -64,6 +129,8 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _outerProjects,
                                            _innerCond,
                                            _innerProjects,
+                                           _specificStats.maxMemoryUsageBytes,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
@@ -88,6 +155,8 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         uassert(4822825, str::stream() << "duplicate field: " << slot, inserted);
 
         _inInnerKeyAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+        _outInnerKeyAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+        _outInnerAccessors[slot] = _outInnerKeyAccessors.back().get();
     }
 
     counter = 0;
@@ -101,6 +170,12 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
         _outOuterAccessors[slot] = _outOuterProjectAccessors.back().get();
     }
 
+    for (auto& slot : _innerProjects) {
+        _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+        _outInnerProjectAccessors.emplace_back(std::make_unique<value::ViewOfValueAccessor>());
+        _outInnerAccessors[slot] = _outInnerProjectAccessors.back().get();
+    }
+
     _probeKey.resize(_inInnerKeyAccessors.size());
 
     _compiled = true;
@@ -112,15 +187,143 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second;
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
     return ctx.getAccessor(slot);
 }
 
+void HashJoinStage::insertIntoTable(value::MaterializedRow key, value::MaterializedRow project) {
+    _htMemUsage += key.memUsageForSorter() + project.memUsageForSorter();
+    _ht.emplace(std::move(key), std::move(project));
+}
+
+void HashJoinStage::spillRow(SpillFiles& files,
+                             size_t level,
+                             const value::MaterializedRow& key,
+                             const value::MaterializedRow& project) {
+    files.resize(kNumSpillPartitions);
+
+    // Mix the level into the hash, so that the rows of a spilled partition are spread across all
+    // the new partitions when it gets partitioned again.
+    auto partition = absl::Hash<std::pair<size_t, size_t>>{}(
+                         std::make_pair(level, value::MaterializedRowHasher{}(key))) %
+        kNumSpillPartitions;
+
+    auto& file = files[partition];
+    if (!file) {
+        SortOptions opts;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        file.fileName = opts.tempDir + "/" + nextFileName();
+        file.writer = std::make_unique<SpillWriter>(opts, file.fileName, 0);
+        _specificStats.usedDisk = true;
+    }
+
+    file.writer->addAlreadySorted(key, project);
+    ++_specificStats.spilledRecords;
+    hashJoinSpilledRecordsCounter.increment();
+}
+
+void HashJoinStage::spillTable(SpillFiles& buildFiles, size_t level) {
+    for (auto& [key, project] : _ht) {
+        spillRow(buildFiles, level, key, project);
+    }
+    _ht.clear();
+    _htMemUsage = 0;
+}
+
+void HashJoinStage::finishSpilling(SpillFiles& buildFiles, SpillFiles& probeFiles, size_t level) {
+    buildFiles.resize(kNumSpillPartitions);
+    probeFiles.resize(kNumSpillPartitions);
+
+    for (size_t partition = 0; partition < kNumSpillPartitions; ++partition) {
+        for (auto file : {&buildFiles[partition], &probeFiles[partition]}) {
+            if (*file) {
+                file->it.reset(file->writer->done());
+                size_t bytes = file->writer->getFileEndOffset();
+                file->writer.reset();
+
+                _specificStats.spilledBytes += bytes;
+                ++_specificStats.spilledPartitions;
+                hashJoinSpilledBytesCounter.increment(bytes);
+                hashJoinSpilledPartitionsCounter.increment();
+            }
+        }
+
+        // A partition with no rows on either side cannot produce any output.
+        if (buildFiles[partition] && probeFiles[partition]) {
+            _pendingPartitions.push_back(
+                {std::move(buildFiles[partition]), std::move(probeFiles[partition]), level});
+            _specificStats.maxSpillLevel = std::max(_specificStats.maxSpillLevel, level);
+        }
+    }
+
+    // Drop the partitions that were not queued.
+    buildFiles.clear();
+    probeFiles.clear();
+}
+
+bool HashJoinStage::loadNextPartition() {
+    _currentPartition = boost::none;
+
+    while (!_pendingPartitions.empty()) {
+        auto partition = std::move(_pendingPartitions.front());
+        _pendingPartitions.pop_front();
+
+        _ht.clear();
+        _htMemUsage = 0;
+
+        SpillFiles buildFiles;
+        bool repartition = false;
+        while (partition.build.it->more()) {
+            auto [key, project] = partition.build.it->next();
+            if (repartition) {
+                spillRow(buildFiles, partition.level, key, project);
+                continue;
+            }
+
+            insertIntoTable(std::move(key), std::move(project));
+            if (_htMemUsage > _specificStats.maxMemoryUsageBytes &&
+                partition.level < kMaxSpillLevel) {
+                repartition = true;
+                spillTable(buildFiles, partition.level);
+            }
+        }
+
+        if (!repartition) {
+            _currentPartition = std::move(partition);
+            return true;
+        }
+
+        // The build side of this partition doesn't fit in memory, so split both sides further.
+        SpillFiles probeFiles;
+        while (partition.probe.it->more()) {
+            auto [key, project] = partition.probe.it->next();
+            spillRow(probeFiles, partition.level, key, project);
+        }
+        finishSpilling(buildFiles, probeFiles, partition.level + 1);
+    }
+
+    _ht.clear();
+    _htMemUsage = 0;
+    return false;
+}
+
 void HashJoinStage::open(bool reOpen) {
     _commonStats.opens++;
     _children[0]->open(reOpen);
+
+    _ht.clear();
+    _htMemUsage = 0;
+    _spilled = false;
+    _pendingPartitions.clear();
+    _currentPartition = boost::none;
+
+    SpillFiles buildFiles;
     // Insert the outer side into the hash table.
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inOuterKeyAccessors.size()};
@@ -140,43 +343,116 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
-        _ht.emplace(std::move(key), std::move(project));
+        if (_spilled) {
+            spillRow(buildFiles, 0, key, project);
+            continue;
+        }
+
+        insertIntoTable(std::move(key), std::move(project));
+        if (_htMemUsage > _specificStats.maxMemoryUsageBytes) {
+            uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                    str::stream() << "Exceeded memory limit for hash join, but didn't allow "
+                                     "external sort. Pass allowDiskUse:true to opt in.",
+                    _allowDiskUse);
+            _spilled = true;
+            spillTable(buildFiles, 0);
+        }
     }
 
     _children[0]->close();
 
     _children[1]->open(reOpen);
 
+    if (_spilled) {
+        // Every inner row has to be partitioned in the same way as the outer side before any of
+        // the partitions can be joined.
+        SpillFiles probeFiles;
+        value::MaterializedRow key{_inInnerKeyAccessors.size()};
+        value::MaterializedRow project{_inInnerProjectAccessors.size()};
+        while (_children[1]->getNext() == PlanState::ADVANCED) {
+            size_t idx = 0;
+            for (auto& p : _inInnerKeyAccessors) {
+                auto [tag, val] = p->getViewOfValue();
+                key.reset(idx++, false, tag, val);
+            }
+
+            idx = 0;
+            for (auto& p : _inInnerProjectAccessors) {
+                auto [tag, val] = p->getViewOfValue();
+                project.reset(idx++, false, tag, val);
+            }
+
+            spillRow(probeFiles, 0, key, project);
+        }
+        finishSpilling(buildFiles, probeFiles, 1);
+    }
+
     _htIt = _ht.end();
     _htItEnd = _ht.end();
 }
 
+bool HashJoinStage::nextProbeRow() {
+    if (!_spilled) {
+        auto state = _children[1]->getNext();
+        if (state == PlanState::IS_EOF) {
+            return false;
+        }
+
+        // Copy keys in order to do the lookup.
+        size_t idx = 0;
+        for (auto& p : _inInnerKeyAccessors) {
+            auto [tag, val] = p->getViewOfValue();
+            _probeKey.reset(idx, false, tag, val);
+            _outInnerKeyAccessors[idx++]->reset(tag, val);
+        }
+
+        idx = 0;
+        for (auto& p : _inInnerProjectAccessors) {
+            auto [tag, val] = p->getViewOfValue();
+            _outInnerProjectAccessors[idx++]->reset(tag, val);
+        }
+
+        return true;
+    }
+
+    while (!_currentPartition || !_currentPartition->probe.it->more()) {
+        if (!loadNextPartition()) {
+            return false;
+        }
+    }
+
+    _probeRow = _currentPartition->probe.it->next();
+
+    for (size_t idx = 0; idx < _probeKey.size(); ++idx) {
+        auto [tag, val] = _probeRow.first.getViewOfValue(idx);
+        _probeKey.reset(idx, false, tag, val);
+        _outInnerKeyAccessors[idx]->reset(tag, val);
+    }
+
+    for (size_t idx = 0; idx < _outInnerProjectAccessors.size(); ++idx) {
+        auto [tag, val] = _probeRow.second.getViewOfValue(idx);
+        _outInnerProjectAccessors[idx]->reset(tag, val);
+    }
+
+    return true;
+}
+
 PlanState HashJoinStage::getNext() {
     if (_htIt != _htItEnd) {
         ++_htIt;
     }
 
-    if (_htIt == _htItEnd) {
-        while (_htIt == _htItEnd) {
-            auto state = _children[1]->getNext();
-            if (state == PlanState::IS_EOF) {
-                // LEFT and OUTER joins should enumerate "non-returned" rows here.
-                return trackPlanState(state);
-            }
-
-            // Copy keys in order to do the lookup.
-            size_t idx = 0;
-            for (auto& p : _inInnerKeyAccessors) {
-                auto [tag, val] = p->getViewOfValue();
-                _probeKey.reset(idx++, false, tag, val);
-            }
-
-            auto [low, hi] = _ht.equal_range(_probeKey);
-            _htIt = low;
-            _htItEnd = hi;
-            // If _htIt == _htItEnd (i.e. no match) then RIGHT and OUTER joins
-            // should enumerate "non-returned" rows here.
+    while (_htIt == _htItEnd) {
+        if (!nextProbeRow()) {
+            // LEFT and OUTER joins should enumerate "non-returned" rows here.
+            return trackPlanState(PlanState::IS_EOF);
         }
+
+        auto [low, hi] = _ht.equal_range(_probeKey);
+        _htIt = low;
+        _htItEnd = hi;
+        // If _htIt == _htItEnd (i.e. no match) then RIGHT and OUTER joins
+        // should enumerate "non-returned" rows here.
     }
 
     return trackPlanState(PlanState::ADVANCED);
@@ -185,17 +461,21 @@ PlanState HashJoinStage::getNext() {
 void HashJoinStage::close() {
     _commonStats.closes++;
     _children[1]->close();
+
+    _pendingPartitions.clear();
+    _currentPartition = boost::none;
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats() const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
     ret->children.emplace_back(_children[0]->getStats());
     ret->children.emplace_back(_children[1]->getStats());
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
@@ -29,22 +29,54 @@
 
 #pragma once
 
+#include <deque>
 #include <vector>
 
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 
+namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+template <typename Key, typename Value>
+class SortedFileWriter;
+}  // namespace mongo
+
 namespace mongo::sbe {
+/**
+ * Joins the rows of the 'outer' (build) and 'inner' (probe) children for which the values of the
+ * 'outerCond' and 'innerCond' slots are equal. The outer side is loaded into a hash table which is
+ * then probed with every inner row.
+ *
+ * When the estimated size of the hash table exceeds 'memoryLimit' and 'allowDiskUse' is true, the
+ * stage switches to a grace hash join: the outer rows, and then all the inner rows, are hash
+ * partitioned by their join key into temporary files, and each pair of matching build and probe
+ * partitions is then joined in memory. A build partition which still doesn't fit in memory is
+ * recursively partitioned again, up to 'kMaxSpillLevel' times, after which it is loaded in memory
+ * regardless, as it most likely consists of very few distinct keys.
+ *
+ * Once the stage has spilled, only the values of the 'innerCond' and 'innerProjects' slots are
+ * available from the inner side.
+ */
 class HashJoinStage final : public PlanStage {
 public:
+    // The number of partitions each side is split into when spilling.
+    static constexpr size_t kNumSpillPartitions = 8;
+    // The maximum number of times a partition is partitioned again.
+    static constexpr size_t kMaxSpillLevel = 4;
+
     HashJoinStage(std::unique_ptr<PlanStage> outer,
                   std::unique_ptr<PlanStage> inner,
                   value::SlotVector outerCond,
                   value::SlotVector outerProjects,
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
+                  size_t memoryLimit,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
+    ~HashJoinStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -65,10 +97,84 @@ private:
     using HashKeyAccessor = value::MaterializedRowKeyAccessor<TableType::iterator>;
     using HashProjectAccessor = value::MaterializedRowValueAccessor<TableType::iterator>;
 
+    // A spilled row consists of the join key and the projected values of either side.
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+    using SpillWriter = SortedFileWriter<value::MaterializedRow, value::MaterializedRow>;
+
+    /**
+     * A temporary file holding the rows of one side of a spilled partition. The file is written
+     * through 'writer', then read back through 'it', and deleted on destruction.
+     */
+    struct SpillFile {
+        SpillFile() = default;
+        SpillFile(SpillFile&& other);
+        SpillFile& operator=(SpillFile&& other);
+        ~SpillFile();
+
+        explicit operator bool() const {
+            return !fileName.empty();
+        }
+
+        /**
+         * Closes and deletes the file, if any.
+         */
+        void drop();
+
+        std::string fileName;
+        std::unique_ptr<SpillWriter> writer;
+        std::unique_ptr<SpillIterator> it;
+    };
+
+    /**
+     * A pair of matching build and probe partitions. 'level' is the number of times their rows
+     * have been partitioned.
+     */
+    struct SpilledPartition {
+        SpillFile build;
+        SpillFile probe;
+        size_t level;
+    };
+
+    using SpillFiles = std::vector<SpillFile>;
+
+    void insertIntoTable(value::MaterializedRow key, value::MaterializedRow project);
+
+    /**
+     * Appends a row to the partition of 'files' the given join 'key' belongs to.
+     */
+    void spillRow(SpillFiles& files,
+                  size_t level,
+                  const value::MaterializedRow& key,
+                  const value::MaterializedRow& project);
+
+    /**
+     * Moves the content of the hash table into the given build partitions.
+     */
+    void spillTable(SpillFiles& buildFiles, size_t level);
+
+    /**
+     * Closes the given build and probe partitions, and queues the non-empty pairs for processing.
+     */
+    void finishSpilling(SpillFiles& buildFiles, SpillFiles& probeFiles, size_t level);
+
+    /**
+     * Loads the build side of the next pending partition into the hash table, partitioning it
+     * again if it is too large. Returns false if there are no more partitions to process.
+     */
+    bool loadNextPartition();
+
+    /**
+     * Fetches the next probe row, either from the inner child or from the current spilled
+     * partition, and exposes its values. Returns false when there are no more probe rows.
+     */
+    bool nextProbeRow();
+
     const value::SlotVector _outerCond;
     const value::SlotVector _outerProjects;
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -88,6 +194,15 @@ private:
     // Accessors of input codition values (keys) that are being inserted into the hash table.
     std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
 
+    // Accessors of the inner projections.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // All the values exposed from the inner side. They are populated for every probe row either
+    // from the inner child or from a spilled probe row.
+    value::SlotAccessorMap _outInnerAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outInnerKeyAccessors;
+    std::vector<std::unique_ptr<value::ViewOfValueAccessor>> _outInnerProjectAccessors;
+
     // Key used to probe inside the hash table.
     value::MaterializedRow _probeKey;
 
@@ -98,5 +213,17 @@ private:
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    // Estimated memory used by the hash table.
+    size_t _htMemUsage{0};
+
+    // Set once the stage has switched to the grace hash join.
+    bool _spilled{false};
+    std::deque<SpilledPartition> _pendingPartitions;
+    // The partition being joined. Its probe rows are read into '_probeRow'.
+    boost::optional<SpilledPartition> _currentPartition;
+    SpilledRow _probeRow;
+
+    HashJoinStats _specificStats;
 };
 }  // namespace mongo::sbe
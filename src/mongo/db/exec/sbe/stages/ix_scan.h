@@ -90,6 +90,9 @@ protected:
     void doRestoreState() override;
     void doDetachFromOperationContext() override;
     void doAttachFromOperationContext(OperationContext* opCtx) override;
+    void doAttachToTrialRunTracker(TrialRunProgressTracker* tracker) override {
+        _tracker = tracker;
+    }
 
 private:
     const NamespaceStringOrUUID _name;
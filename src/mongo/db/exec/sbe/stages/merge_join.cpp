@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/merge_join.h"
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/util/str.h"
+
+namespace mongo::sbe {
+MergeJoinStage::MergeJoinStage(std::unique_ptr<PlanStage> outer,
+                               std::unique_ptr<PlanStage> inner,
+                               value::SlotVector outerKeys,
+                               value::SlotVector outerProjects,
+                               value::SlotVector innerKeys,
+                               value::SlotVector innerProjects,
+                               std::vector<value::SortDirection> dirs,
+                               PlanNodeId planNodeId)
+    : PlanStage("mj"_sd, planNodeId),
+      _outerKeys(std::move(outerKeys)),
+      _outerProjects(std::move(outerProjects)),
+      _innerKeys(std::move(innerKeys)),
+      _innerProjects(std::move(innerProjects)),
+      _dirs(std::move(dirs)) {
+    uassert(5300505,
+            "left and right size do not match",
+            _outerKeys.size() == _innerKeys.size() && _outerKeys.size() == _dirs.size());
+
+    _children.emplace_back(std::move(outer));
+    _children.emplace_back(std::move(inner));
+}
+
+std::unique_ptr<PlanStage> MergeJoinStage::clone() const {
+    return std::make_unique<MergeJoinStage>(_children[0]->clone(),
+                                            _children[1]->clone(),
+                                            _outerKeys,
+                                            _outerProjects,
+                                            _innerKeys,
+                                            _innerProjects,
+                                            _dirs,
+                                            _commonStats.nodeId);
+}
+
+void MergeJoinStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+    _children[1]->prepare(ctx);
+
+    auto outerSlots = _outerKeys;
+    outerSlots.insert(outerSlots.end(), _outerProjects.begin(), _outerProjects.end());
+
+    size_t counter = 0;
+    value::SlotSet dupCheck;
+    for (auto slot : outerSlots) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        uassert(5300506, str::stream() << "duplicate field: " << slot, inserted);
+
+        _inOuterAccessors.emplace_back(_children[0]->getAccessor(ctx, slot));
+        _outOuterAccessors.emplace_back(
+            std::make_unique<BufferAccessor>(_outerBuffer, _outerBufferIdx, counter++));
+        _outOuterAccessorMap[slot] = _outOuterAccessors.back().get();
+    }
+
+    for (auto slot : _innerKeys) {
+        auto [it, inserted] = dupCheck.emplace(slot);
+        uassert(5300507, str::stream() << "duplicate field: " << slot, inserted);
+
+        _inInnerKeyAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+    }
+
+    _compiled = true;
+}
+
+value::SlotAccessor* MergeJoinStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (_compiled) {
+        if (auto it = _outOuterAccessorMap.find(slot); it != _outOuterAccessorMap.end()) {
+            return it->second;
+        }
+
+        return _children[1]->getAccessor(ctx, slot);
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+void MergeJoinStage::open(bool reOpen) {
+    _commonStats.opens++;
+    _children[0]->open(reOpen);
+    _children[1]->open(reOpen);
+
+    _outerBuffer.clear();
+    _outerBufferIdx = 0;
+    _innerMatched = false;
+    _outerHasRow = _children[0]->getNext() == PlanState::ADVANCED;
+}
+
+int MergeJoinStage::compareWithBufferedKey(
+    const std::vector<value::SlotAccessor*>& keyAccessors) const {
+    invariant(!_outerBuffer.empty());
+    const auto& bufferedRow = _outerBuffer.front();
+
+    for (size_t idx = 0; idx < _dirs.size(); ++idx) {
+        auto [lhsTag, lhsVal] = keyAccessors[idx]->getViewOfValue();
+        auto [rhsTag, rhsVal] = bufferedRow.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal);
+        uassert(5300508,
+                "merge join keys must be comparable",
+                tag == value::TypeTags::NumberInt32);
+
+        auto result = value::bitcastTo<int32_t>(val);
+        if (result != 0) {
+            return _dirs[idx] == value::SortDirection::Ascending ? result : -result;
+        }
+    }
+
+    return 0;
+}
+
+bool MergeJoinStage::bufferNextOuterKey() {
+    _outerBuffer.clear();
+    if (!_outerHasRow) {
+        return false;
+    }
+
+    auto bufferOuterRow = [&]() {
+        value::MaterializedRow row{_inOuterAccessors.size()};
+        size_t idx = 0;
+        for (auto accessor : _inOuterAccessors) {
+            auto [tag, val] = accessor->copyOrMoveValue();
+            row.reset(idx++, true, tag, val);
+        }
+        _outerBuffer.emplace_back(std::move(row));
+    };
+
+    bufferOuterRow();
+    while ((_outerHasRow = _children[0]->getNext() == PlanState::ADVANCED)) {
+        if (compareWithBufferedKey(_inOuterAccessors) != 0) {
+            break;
+        }
+        bufferOuterRow();
+    }
+
+    return true;
+}
+
+PlanState MergeJoinStage::getNext() {
+    // Join the current inner row with the remaining buffered outer rows first.
+    if (_innerMatched && ++_outerBufferIdx < _outerBuffer.size()) {
+        return trackPlanState(PlanState::ADVANCED);
+    }
+    _innerMatched = false;
+
+    while (_children[1]->getNext() == PlanState::ADVANCED) {
+        // Skip over the outer rows with a key lower than the one of the inner row.
+        auto cmp = _outerBuffer.empty() ? 1 : compareWithBufferedKey(_inInnerKeyAccessors);
+        while (cmp > 0) {
+            if (!bufferNextOuterKey()) {
+                return trackPlanState(PlanState::IS_EOF);
+            }
+            cmp = compareWithBufferedKey(_inInnerKeyAccessors);
+        }
+
+        if (cmp == 0) {
+            _outerBufferIdx = 0;
+            _innerMatched = true;
+            return trackPlanState(PlanState::ADVANCED);
+        }
+    }
+
+    return trackPlanState(PlanState::IS_EOF);
+}
+
+void MergeJoinStage::close() {
+    _commonStats.closes++;
+    _children[1]->close();
+    _children[0]->close();
+
+    _outerBuffer.clear();
+}
+
+std::unique_ptr<PlanStageStats> MergeJoinStage::getStats() const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->children.emplace_back(_children[0]->getStats());
+    ret->children.emplace_back(_children[1]->getStats());
+    return ret;
+}
+
+const SpecificStats* MergeJoinStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> MergeJoinStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    auto addSlots = [&](const value::SlotVector& slots) {
+        ret.emplace_back(DebugPrinter::Block("[`"));
+        for (size_t idx = 0; idx < slots.size(); ++idx) {
+            if (idx) {
+                ret.emplace_back(DebugPrinter::Block("`,"));
+            }
+
+            DebugPrinter::addIdentifier(ret, slots[idx]);
+        }
+        ret.emplace_back(DebugPrinter::Block("`]"));
+    };
+
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    for (size_t idx = 0; idx < _dirs.size(); ++idx) {
+        if (idx) {
+            ret.emplace_back(DebugPrinter::Block("`,"));
+        }
+        DebugPrinter::addKeyword(
+            ret, _dirs[idx] == value::SortDirection::Ascending ? "asc" : "desc");
+    }
+    ret.emplace_back(DebugPrinter::Block("`]"));
+
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+
+    DebugPrinter::addKeyword(ret, "left");
+    addSlots(_outerKeys);
+    addSlots(_outerProjects);
+
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    DebugPrinter::addKeyword(ret, "right");
+    addSlots(_innerKeys);
+    addSlots(_innerProjects);
+
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+    DebugPrinter::addBlocks(ret, _children[1]->debugPrint());
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    return ret;
+}
+}  // namespace mongo::sbe
@@ -0,0 +1,109 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+
+namespace mongo::sbe {
+/**
+ * Joins the rows of the 'outer' and 'inner' children for which the values of the 'outerKeys' and
+ * 'innerKeys' slots are equal. Both children must return their rows sorted by their key slots in
+ * the order given by 'dirs'.
+ *
+ * Unlike a hash join, the stage streams both of its inputs: only the outer rows sharing the key of
+ * the current inner row are kept in memory, so that an inner row matching several outer rows is
+ * joined with each of them.
+ */
+class MergeJoinStage final : public PlanStage {
+public:
+    MergeJoinStage(std::unique_ptr<PlanStage> outer,
+                   std::unique_ptr<PlanStage> inner,
+                   value::SlotVector outerKeys,
+                   value::SlotVector outerProjects,
+                   value::SlotVector innerKeys,
+                   value::SlotVector innerProjects,
+                   std::vector<value::SortDirection> dirs,
+                   PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats() const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    using BufferAccessor = value::MaterializedRowAccessor<std::vector<value::MaterializedRow>>;
+
+    /**
+     * Compares the key read through 'keyAccessors' with the key of the buffered outer rows, in the
+     * sort order of the inputs.
+     */
+    int compareWithBufferedKey(const std::vector<value::SlotAccessor*>& keyAccessors) const;
+
+    /**
+     * Replaces the buffered outer rows with the next run of outer rows sharing the same key.
+     * Returns false if the outer side is exhausted.
+     */
+    bool bufferNextOuterKey();
+
+    const value::SlotVector _outerKeys;
+    const value::SlotVector _outerProjects;
+    const value::SlotVector _innerKeys;
+    const value::SlotVector _innerProjects;
+    const std::vector<value::SortDirection> _dirs;
+
+    // Accessors of the 'outerKeys' slots followed by the 'outerProjects' slots of the outer child.
+    std::vector<value::SlotAccessor*> _inOuterAccessors;
+    std::vector<value::SlotAccessor*> _inInnerKeyAccessors;
+
+    // The outer rows sharing the key of the last outer row read, each made of the values of the
+    // 'outerKeys' slots followed by the values of the 'outerProjects' slots.
+    std::vector<value::MaterializedRow> _outerBuffer;
+    size_t _outerBufferIdx{0};
+
+    std::vector<std::unique_ptr<BufferAccessor>> _outOuterAccessors;
+    value::SlotAccessorMap _outOuterAccessorMap;
+
+    // Whether the outer child is positioned on a row which hasn't been buffered yet.
+    bool _outerHasRow{false};
+    // Whether the current inner row matches the buffered outer rows.
+    bool _innerMatched{false};
+
+    bool _compiled{false};
+};
+}  // namespace mongo::sbe
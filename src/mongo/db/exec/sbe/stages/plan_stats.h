@@ -132,6 +132,44 @@ struct UniqueStats : public SpecificStats {
     unsigned int dupsDropped = 0;
 };
 
+struct HashAggStats final : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new HashAggStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    size_t maxMemoryUsageBytes{0};
+    bool usedDisk{false};
+    // The number of input rows and bytes written to the spill partitions, and the number of
+    // partitions created, including those created when re-partitioning a spilled partition.
+    size_t spilledRecords{0};
+    size_t spilledBytes{0};
+    size_t spilledPartitions{0};
+};
+
+struct HashJoinStats final : public SpecificStats {
+    SpecificStats* clone() const final {
+        return new HashJoinStats(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    size_t maxMemoryUsageBytes{0};
+    bool usedDisk{false};
+    // The number of rows and bytes written to the spill partitions of both sides, and the number
+    // of partitions created, including those created when re-partitioning a spilled partition.
+    size_t spilledRecords{0};
+    size_t spilledBytes{0};
+    size_t spilledPartitions{0};
+    // The deepest level at which a partition was partitioned again.
+    size_t maxSpillLevel{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
@@ -443,6 +443,9 @@ void ParallelScanStage::open(bool reOpen) {
 
     invariant(!_cursor);
     invariant(!_coll);
+    // The thread that started the query holds its own locks while it waits for the producers, so
+    // open the collection lock-free. A producer that still queues behind a conflicting request
+    // runs under the deadline of that query and is killed along with it, see ExchangeConsumer.
     _coll.emplace(_opCtx, _name);
 
     uassertStatusOK(repl::ReplicationCoordinator::get(_opCtx)->checkCanServeReadsFor(
@@ -454,7 +457,7 @@ void ParallelScanStage::open(bool reOpen) {
         {
             stdx::unique_lock lock(_state->mutex);
             if (_state->ranges.empty()) {
-                auto ranges = collection->getRecordStore()->numRecords(_opCtx) / 10240;
+                auto ranges = collection->getRecordStore()->numRecords(_opCtx) / kRecordsPerRange;
                 if (ranges < 2) {
                     _state->ranges.emplace_back(Range{RecordId{}, RecordId{}});
                 } else {
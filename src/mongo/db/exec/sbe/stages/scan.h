@@ -70,6 +70,9 @@ protected:
     void doRestoreState() override;
     void doDetachFromOperationContext() override;
     void doAttachFromOperationContext(OperationContext* opCtx) override;
+    void doAttachToTrialRunTracker(TrialRunProgressTracker* tracker) override {
+        _tracker = tracker;
+    }
 
 private:
     const NamespaceStringOrUUID _name;
@@ -115,6 +118,9 @@ class ParallelScanStage final : public PlanStage {
     };
 
 public:
+    // The approximate number of records in each range the collection is split into.
+    static constexpr long long kRecordsPerRange = 10240;
+
     ParallelScanStage(const NamespaceStringOrUUID& name,
                       boost::optional<value::SlotId> recordSlot,
                       boost::optional<value::SlotId> recordIdSlot,
@@ -179,7 +185,7 @@ private:
     bool _open{false};
 
     std::unique_ptr<SeekableRecordCursor> _cursor;
-    boost::optional<AutoGetCollectionForRead> _coll;
+    boost::optional<AutoGetCollectionForReadLockFree> _coll;
 };
 }  // namespace sbe
 }  // namespace mongo
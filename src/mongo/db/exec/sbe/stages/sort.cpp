@@ -59,7 +59,6 @@ SortStage::SortStage(std::unique_ptr<PlanStage> input,
       _dirs(std::move(dirs)),
       _vals(std::move(vals)),
       _allowDiskUse(allowDiskUse),
-      _mergeData({0, 0}),
       _tracker(tracker) {
     _children.emplace_back(std::move(input));
 
@@ -126,6 +125,8 @@ void SortStage::makeSorter() {
     opts.extSortAllowed = _allowDiskUse;
     opts.limit =
         _specificStats.limit != std::numeric_limits<size_t>::max() ? _specificStats.limit : 0;
+    // The rows own their values, which can be compared on several threads at once.
+    opts.maxWorkerThreads = internalSorterMaxWorkerThreads.load();
 
     auto comp = [&](const SorterData& lhs, const SorterData& rhs) {
         auto size = lhs.first.size();
@@ -145,7 +146,7 @@ void SortStage::makeSorter() {
         return 0;
     };
 
-    _sorter.reset(Sorter<value::MaterializedRow, value::MaterializedRow>::make(opts, comp, {}));
+    _sorter.reset(Sorter<value::CompactRow, value::CompactRow>::make(opts, comp, {}));
     _mergeIt.reset();
 }
 
@@ -156,22 +157,10 @@ void SortStage::open(bool reOpen) {
     makeSorter();
 
     while (_children[0]->getNext() == PlanState::ADVANCED) {
-        value::MaterializedRow keys{_inKeyAccessors.size()};
-        value::MaterializedRow vals{_inValueAccessors.size()};
+        value::CompactRow keys{_inKeyAccessors, true};
+        value::CompactRow vals{_inValueAccessors, true};
 
-        size_t idx = 0;
-        for (auto accesor : _inKeyAccessors) {
-            auto [tag, val] = accesor->copyOrMoveValue();
-            keys.reset(idx++, true, tag, val);
-        }
-
-        idx = 0;
-        for (auto accesor : _inValueAccessors) {
-            auto [tag, val] = accesor->copyOrMoveValue();
-            vals.reset(idx++, true, tag, val);
-        }
-
-        // TODO SERVER-51815: count total mem usage for specificStats.
+        _specificStats.totalDataSizeBytes += keys.memUsageForSorter() + vals.memUsageForSorter();
         _sorter->emplace(std::move(keys), std::move(vals));
 
         if (_tracker && _tracker->trackProgress<TrialRunProgressTracker::kNumResults>(1)) {
@@ -66,11 +66,16 @@ public:
     const SpecificStats* getSpecificStats() const final;
     std::vector<DebugPrinter::Block> debugPrint() const final;
 
+protected:
+    void doAttachToTrialRunTracker(TrialRunProgressTracker* tracker) override {
+        _tracker = tracker;
+    }
+
 private:
     void makeSorter();
 
-    using SorterIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
-    using SorterData = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SorterIterator = SortIteratorInterface<value::CompactRow, value::CompactRow>;
+    using SorterData = std::pair<value::CompactRow, value::CompactRow>;
 
     const value::SlotVector _obs;
     const std::vector<value::SortDirection> _dirs;
@@ -86,7 +91,7 @@ private:
     std::unique_ptr<SorterIterator> _mergeIt;
     SorterData _mergeData;
     SorterData* _mergeDataIt{&_mergeData};
-    std::unique_ptr<Sorter<value::MaterializedRow, value::MaterializedRow>> _sorter;
+    std::unique_ptr<Sorter<value::CompactRow, value::CompactRow>> _sorter;
 
     // If provided, used during a trial run to accumulate certain execution stats. Once the trial
     // run is complete, this pointer is reset to nullptr.
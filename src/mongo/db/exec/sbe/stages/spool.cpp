@@ -82,15 +82,7 @@ void SpoolEagerProducerStage::open(bool reOpen) {
     }
 
     while (_children[0]->getNext() == PlanState::ADVANCED) {
-        value::MaterializedRow vals{_inAccessors.size()};
-
-        size_t idx = 0;
-        for (auto accessor : _inAccessors) {
-            auto [tag, val] = accessor->copyOrMoveValue();
-            vals.reset(idx++, true, tag, val);
-        }
-
-        _buffer->emplace_back(std::move(vals));
+        _buffer->emplace_back(_inAccessors, true);
     }
 
     _children[0]->close();
@@ -221,17 +213,12 @@ PlanState SpoolLazyProducerStage::getNext() {
         if (pass) {
             // We either haven't got a predicate, or it has passed. In both cases, we need pass
             // through the input values, and store them into the buffer.
-            value::MaterializedRow vals{_inAccessors.size()};
-
             for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
                 auto [tag, val] = _inAccessors[idx]->getViewOfValue();
                 _outAccessors[_vals[idx]].reset(tag, val);
-
-                auto [copyTag, copyVal] = value::copyValue(tag, val);
-                vals.reset(idx, true, copyTag, copyVal);
             }
 
-            _buffer->emplace_back(std::move(vals));
+            _buffer->emplace_back(_inAccessors, false);
         } else {
             // Otherwise, just pass through the input values.
             for (size_t idx = 0; idx < _inAccessors.size(); ++idx) {
@@ -34,6 +34,7 @@
 #include "mongo/db/exec/sbe/values/slot.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/exec/trial_run_progress_tracker.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/util/str.h"
@@ -257,7 +258,7 @@ public:
     }
 
 protected:
-    PlanYieldPolicy* const _yieldPolicy{nullptr};
+    PlanYieldPolicy* _yieldPolicy{nullptr};
 
 private:
     static const int kInterruptCheckPeriod = 128;
@@ -319,6 +320,35 @@ public:
      */
     virtual void close() = 0;
 
+    /**
+     * Makes every stage of this tree which yields use 'yieldPolicy' instead of the policy it was
+     * built with. Stages built without a yield policy never yield and are left unchanged. Used
+     * when a copy of a previously built plan is executed on behalf of a different operation.
+     */
+    void attachNewYieldPolicy(PlanYieldPolicy* yieldPolicy) {
+        for (auto&& child : _children) {
+            child->attachNewYieldPolicy(yieldPolicy);
+        }
+
+        if (_yieldPolicy) {
+            _yieldPolicy = yieldPolicy;
+        }
+    }
+
+    /**
+     * Makes every stage of this tree which reports its progress during a trial run report it to
+     * 'tracker', or stop reporting if 'tracker' is nullptr.
+     *
+     * Propagates to all children, then calls doAttachToTrialRunTracker().
+     */
+    void attachToTrialRunTracker(TrialRunProgressTracker* tracker) {
+        for (auto&& child : _children) {
+            child->attachToTrialRunTracker(tracker);
+        }
+
+        doAttachToTrialRunTracker(tracker);
+    }
+
     virtual std::vector<DebugPrinter::Block> debugPrint() const {
         auto stats = getCommonStats();
         std::string str = str::stream() << '[' << stats->nodeId << "] " << stats->stageType;
@@ -335,6 +365,7 @@ protected:
     virtual void doRestoreState() {}
     virtual void doDetachFromOperationContext() {}
     virtual void doAttachFromOperationContext(OperationContext* opCtx) {}
+    virtual void doAttachToTrialRunTracker(TrialRunProgressTracker* tracker) {}
 
     std::vector<std::unique_ptr<PlanStage>> _children;
 };
@@ -289,7 +289,7 @@ void MaterializedRow::serializeForSorter(BufBuilder& buf) const {
     }
 }
 
-static int getApproximateSize(TypeTags tag, Value val) {
+int getApproximateSize(TypeTags tag, Value val) {
     int result = sizeof(tag) + sizeof(val);
     switch (tag) {
         // These are shallow types.
@@ -378,4 +378,176 @@ int MaterializedRow::memUsageForSorter() const {
     return result;
 }
 
+namespace {
+constexpr size_t kCompactRowAlignment = alignof(Value);
+
+size_t alignCompactRowOffset(size_t offset) {
+    return (offset + kCompactRowAlignment - 1) & ~(kCompactRowAlignment - 1);
+}
+
+/**
+ * Returns the number of bytes taken by the value (tag, val) once copied into the buffer of a
+ * CompactRow.
+ */
+size_t getSizeInCompactRow(TypeTags tag, Value val) {
+    switch (tag) {
+        case TypeTags::NumberDecimal:
+            return 2 * sizeof(long long);
+        case TypeTags::StringBig:
+            return strlen(getBigStringView(val)) + 1;
+        case TypeTags::bsonString:
+            return sizeof(uint32_t) +
+                ConstDataView(getRawPointerView(val)).read<LittleEndian<uint32_t>>();
+        case TypeTags::ObjectId:
+        case TypeTags::bsonObjectId:
+            return sizeof(ObjectIdType);
+        case TypeTags::bsonObject:
+        case TypeTags::bsonArray:
+            return ConstDataView(getRawPointerView(val)).read<LittleEndian<uint32_t>>();
+        case TypeTags::bsonBinData:
+            return getBSONBinDataSize(tag, val) + sizeof(uint32_t) + 1;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+}  // namespace
+
+CompactRow::Layout CompactRow::getLayout(TypeTags tag) {
+    switch (tag) {
+        case TypeTags::NumberDecimal:
+        case TypeTags::StringBig:
+        case TypeTags::bsonString:
+        case TypeTags::ObjectId:
+        case TypeTags::bsonObjectId:
+        case TypeTags::bsonObject:
+        case TypeTags::bsonArray:
+        case TypeTags::bsonBinData:
+            return Layout::kInBuffer;
+        case TypeTags::Array:
+        case TypeTags::ArraySet:
+        case TypeTags::Object:
+        case TypeTags::ksValue:
+        case TypeTags::pcreRegex:
+        case TypeTags::valueBlock:
+            return Layout::kBoxed;
+        default:
+            return Layout::kInLane;
+    }
+}
+
+size_t CompactRow::allocate(size_t count, size_t valuesSize) {
+    invariant(!_data);
+
+    const auto valuesOffset =
+        alignCompactRowOffset(count * (sizeof(Value) + sizeof(TypeTags) + sizeof(Layout)));
+    _count = count;
+    _size = valuesOffset + valuesSize;
+    if (_size) {
+        _data = new char[_size];
+    }
+    return valuesOffset;
+}
+
+CompactRow::CompactRow(const std::vector<SlotAccessor*>& accessors, bool moveBoxedValues) {
+    size_t valuesSize = 0;
+    for (auto accessor : accessors) {
+        auto [tag, val] = accessor->getViewOfValue();
+        if (getLayout(tag) == Layout::kInBuffer) {
+            valuesSize += alignCompactRowOffset(getSizeInCompactRow(tag, val));
+        }
+    }
+
+    auto offset = allocate(accessors.size(), valuesSize);
+    for (size_t idx = 0; idx < _count; ++idx) {
+        auto [tag, val] = accessors[idx]->getViewOfValue();
+        auto layout = getLayout(tag);
+        tags()[idx] = tag;
+        layouts()[idx] = layout;
+
+        switch (layout) {
+            case Layout::kInLane:
+                lanes()[idx] = val;
+                break;
+            case Layout::kInBuffer: {
+                auto size = getSizeInCompactRow(tag, val);
+                memcpy(_data + offset, getRawPointerView(val), size);
+                lanes()[idx] = offset;
+                offset += alignCompactRowOffset(size);
+                break;
+            }
+            case Layout::kBoxed: {
+                auto [copyTag, copyVal] =
+                    moveBoxedValues ? accessors[idx]->copyOrMoveValue() : copyValue(tag, val);
+                lanes()[idx] = copyVal;
+                break;
+            }
+        }
+    }
+}
+
+CompactRow::CompactRow(const CompactRow& other) : _count{other._count}, _size{other._size} {
+    if (_size) {
+        _data = new char[_size];
+        memcpy(_data, other._data, _size);
+    }
+
+    for (size_t idx = 0; idx < _count; ++idx) {
+        if (layouts()[idx] == Layout::kBoxed) {
+            auto [copyTag, copyVal] = copyValue(tags()[idx], lanes()[idx]);
+            lanes()[idx] = copyVal;
+        }
+    }
+}
+
+void CompactRow::release() {
+    if (!_data) {
+        return;
+    }
+
+    for (size_t idx = 0; idx < _count; ++idx) {
+        if (layouts()[idx] == Layout::kBoxed) {
+            releaseValue(tags()[idx], lanes()[idx]);
+        }
+    }
+    delete[] _data;
+    _data = nullptr;
+}
+
+CompactRow CompactRow::deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&) {
+    auto cnt = buf.read<size_t>();
+
+    std::vector<OwnedValueAccessor> values(cnt);
+    for (auto&& value : values) {
+        auto [tag, val] = deserializeTagVal(buf);
+        value.reset(tag, val);
+    }
+
+    std::vector<SlotAccessor*> accessors;
+    accessors.reserve(cnt);
+    for (auto&& value : values) {
+        accessors.push_back(&value);
+    }
+    return {accessors, true};
+}
+
+void CompactRow::serializeForSorter(BufBuilder& buf) const {
+    buf.appendNum(size());
+
+    for (size_t idx = 0; idx < size(); ++idx) {
+        auto [tag, val] = getViewOfValue(idx);
+        serializeTagValue(buf, tag, val);
+    }
+}
+
+int CompactRow::memUsageForSorter() const {
+    int result = sizeof(CompactRow) + _size;
+
+    for (size_t idx = 0; idx < _count; ++idx) {
+        if (layouts()[idx] == Layout::kBoxed) {
+            result += getApproximateSize(tags()[idx], lanes()[idx]);
+        }
+    }
+
+    return result;
+}
 }  // namespace mongo::sbe::value
@@ -348,6 +348,11 @@ private:
     const size_t _slot;
 };
 
+/**
+ * Returns the approximate number of bytes taken by the value, including the values it contains.
+ */
+int getApproximateSize(TypeTags tag, Value val);
+
 /**
  * This class holds values in a buffer. The most common usage is a sort and hash agg plan stages.
  */
@@ -519,6 +524,118 @@ private:
 };
 
 
+/**
+ * A row of values held in a single contiguous buffer, used instead of MaterializedRow by the stages
+ * which buffer many rows, like sort and spool. Each value has a fixed-width lane holding shallow
+ * values, e.g. numbers and dates, directly. Strings, raw BSON values, ObjectIds and decimals are
+ * copied into the buffer after the lanes, so that a row of such values takes a single allocation
+ * instead of one per value, and the views of these values point into the buffer. The values which
+ * cannot be copied byte by byte, like SBE arrays and objects, are owned by the row and pointed to
+ * by their lanes.
+ *
+ * A row cannot be modified once it is built.
+ */
+class CompactRow {
+public:
+    CompactRow() = default;
+
+    /**
+     * Builds a row holding the values currently held by 'accessors'. The values which cannot be
+     * copied into the buffer of the row are moved out of the accessors if 'moveBoxedValues' is
+     * true, and copied otherwise.
+     */
+    CompactRow(const std::vector<SlotAccessor*>& accessors, bool moveBoxedValues);
+
+    CompactRow(const CompactRow& other);
+
+    CompactRow(CompactRow&& other) noexcept {
+        swap(*this, other);
+    }
+
+    ~CompactRow() {
+        release();
+    }
+
+    CompactRow& operator=(CompactRow other) noexcept {
+        swap(*this, other);
+        return *this;
+    }
+
+    std::pair<TypeTags, Value> getViewOfValue(size_t idx) const {
+        auto val = lanes()[idx];
+        if (layouts()[idx] == Layout::kInBuffer) {
+            val = bitcastFrom<const char*>(_data + val);
+        }
+        return {tags()[idx], val};
+    }
+
+    /**
+     * Returns a copy of the value at 'idx', as values cannot be moved out of the row.
+     */
+    std::pair<TypeTags, Value> copyOrMoveValue(size_t idx) const {
+        auto [tag, val] = getViewOfValue(idx);
+        return copyValue(tag, val);
+    }
+
+    size_t size() const {
+        return _count;
+    }
+
+    // The following methods are used by the sorter only.
+    struct SorterDeserializeSettings {};
+    static CompactRow deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&);
+    void serializeForSorter(BufBuilder& buf) const;
+    int memUsageForSorter() const;
+    CompactRow getOwned() const {
+        return *this;
+    }
+
+private:
+    // How the value at a given index is held by the row.
+    enum class Layout : uint8_t {
+        // The value is shallow and held by its lane.
+        kInLane,
+        // The value is stored in the buffer, at the offset held by its lane.
+        kInBuffer,
+        // The value is owned by the row, and its lane points to it.
+        kBoxed,
+    };
+
+    static Layout getLayout(TypeTags tag);
+
+    /**
+     * Allocates the buffer of a row of 'count' values whose values stored in the buffer take
+     * 'valuesSize' bytes, and returns the offset of these values in the buffer.
+     */
+    size_t allocate(size_t count, size_t valuesSize);
+
+    Value* lanes() const {
+        return reinterpret_cast<Value*>(_data);
+    }
+
+    TypeTags* tags() const {
+        return reinterpret_cast<TypeTags*>(_data + _count * sizeof(Value));
+    }
+
+    Layout* layouts() const {
+        return reinterpret_cast<Layout*>(_data + _count * (sizeof(Value) + sizeof(TypeTags)));
+    }
+
+    void release();
+
+    friend void swap(CompactRow& lhs, CompactRow& rhs) noexcept {
+        std::swap(lhs._data, rhs._data);
+        std::swap(lhs._count, rhs._count);
+        std::swap(lhs._size, rhs._size);
+    }
+
+    char* _data{nullptr};
+    size_t _count{0};
+    // The size of '_data' in bytes.
+    size_t _size{0};
+};
+
+
 struct MaterializedRowComparator {
     MaterializedRowComparator(const std::vector<value::SortDirection>& direction)
         : _direction(direction) {}
@@ -84,6 +84,9 @@ void releaseValue(TypeTags tag, Value val) noexcept {
         case TypeTags::pcreRegex:
             delete getPcreRegexView(val);
             break;
+        case TypeTags::valueBlock:
+            delete getValueBlockView(val);
+            break;
         default:
             break;
     }
@@ -161,6 +164,9 @@ void writeTagToStream(T& stream, const TypeTags tag) {
         case TypeTags::timeZoneDB:
             stream << "timeZoneDB";
             break;
+        case TypeTags::valueBlock:
+            stream << "valueBlock";
+            break;
         case TypeTags::RecordId:
             stream << "RecordId";
             break;
@@ -376,6 +382,19 @@ void writeValueToStream(T& stream, TypeTags tag, Value val) {
         case value::TypeTags::RecordId:
             stream << "RecordId(" << bitcastTo<int64_t>(val) << ")";
             break;
+        case value::TypeTags::valueBlock: {
+            auto block = getValueBlockView(val);
+            stream << "Block[";
+            for (size_t idx = 0; idx < block->size(); ++idx) {
+                if (idx != 0) {
+                    stream << ", ";
+                }
+                auto [tag, val] = block->getAt(idx);
+                writeValueToStream(stream, tag, val);
+            }
+            stream << ']';
+            break;
+        }
         default:
             MONGO_UNREACHABLE;
     }
@@ -118,6 +118,9 @@ enum class TypeTags : uint8_t {
 
     // Pointer to a timezone database object.
     timeZoneDB,
+
+    // Pointer to a block of values processed by the block-at-a-time execution mode.
+    valueBlock,
 };
 
 inline constexpr bool isNumber(TypeTags tag) noexcept {
@@ -469,6 +472,16 @@ public:
         return {_typeTags[idx], _values[idx]};
     }
 
+    /**
+     * Replaces the element at 'idx', taking ownership of the new value and releasing the old one.
+     */
+    void setAt(std::size_t idx, TypeTags tag, Value val) {
+        invariant(idx < _values.size());
+        releaseValue(_typeTags[idx], _values[idx]);
+        _typeTags[idx] = tag;
+        _values[idx] = val;
+    }
+
     void reserve(size_t s) {
         // Normalize to at least 1.
         s = s ? s : 1;
@@ -524,6 +537,85 @@ private:
     ValueSetType _values;
 };
 
+/**
+ * A block of values processed together by the block-at-a-time (vectorized) execution mode. Unlike
+ * Array, a block keeps 'Nothing' values, so the value at position 'idx' in every block produced for
+ * the same batch belongs to the same input row. Blocks only flow between block-aware stages and
+ * builtins and are never returned to the user.
+ */
+class ValueBlock {
+public:
+    ValueBlock() = default;
+    ValueBlock(const ValueBlock& other) {
+        reserve(other._typeTags.size());
+        for (size_t idx = 0; idx < other._values.size(); ++idx) {
+            const auto [tag, val] = copyValue(other._typeTags[idx], other._values[idx]);
+            _values.push_back(val);
+            _typeTags.push_back(tag);
+        }
+    }
+    ValueBlock(ValueBlock&&) = default;
+    ~ValueBlock() {
+        clear();
+    }
+
+    /**
+     * Appends the value to the block. The block takes ownership of the value.
+     */
+    void push_back(TypeTags tag, Value val) {
+        ValueGuard guard{tag, val};
+        reserve(_typeTags.size() + 1);
+
+        _typeTags.push_back(tag);
+        _values.push_back(val);
+
+        guard.reset();
+    }
+
+    auto size() const noexcept {
+        return _values.size();
+    }
+
+    /**
+     * The tags and the values of the block are stored apart, so that the block builtins can run
+     * over either of them in a tight loop.
+     */
+    const std::vector<TypeTags>& tags() const noexcept {
+        return _typeTags;
+    }
+
+    const std::vector<Value>& values() const noexcept {
+        return _values;
+    }
+
+    std::pair<TypeTags, Value> getAt(std::size_t idx) const {
+        if (idx >= _values.size()) {
+            return {TypeTags::Nothing, 0};
+        }
+
+        return {_typeTags[idx], _values[idx]};
+    }
+
+    void reserve(size_t s) {
+        // Normalize to at least 1.
+        s = s ? s : 1;
+        _typeTags.reserve(s);
+        _values.reserve(s);
+    }
+
+    void clear() {
+        for (size_t idx = 0; idx < _typeTags.size(); ++idx) {
+            releaseValue(_typeTags[idx], _values[idx]);
+        }
+        _typeTags.clear();
+        _values.clear();
+    }
+
+private:
+    std::vector<TypeTags> _typeTags;
+    std::vector<Value> _values;
+};
+
 constexpr size_t kSmallStringThreshold = 8;
 using ObjectIdType = std::array<uint8_t, 12>;
 static_assert(sizeof(ObjectIdType) == 12);
@@ -645,6 +737,20 @@ inline Array* getArrayView(Value val) noexcept {
     return reinterpret_cast<Array*>(val);
 }
 
+inline std::pair<TypeTags, Value> makeNewValueBlock() {
+    auto b = new ValueBlock;
+    return {TypeTags::valueBlock, reinterpret_cast<Value>(b)};
+}
+
+inline std::pair<TypeTags, Value> makeCopyValueBlock(const ValueBlock& inB) {
+    auto b = new ValueBlock(inB);
+    return {TypeTags::valueBlock, reinterpret_cast<Value>(b)};
+}
+
+inline ValueBlock* getValueBlockView(Value val) noexcept {
+    return reinterpret_cast<ValueBlock*>(val);
+}
+
 inline ArraySet* getArraySetView(Value val) noexcept {
     return reinterpret_cast<ArraySet*>(val);
 }
@@ -762,6 +868,8 @@ inline std::pair<TypeTags, Value> copyValue(TypeTags tag, Value val) {
             return makeCopyKeyString(*getKeyStringView(val));
         case TypeTags::pcreRegex:
             return makeCopyPcreRegex(*getPcreRegexView(val));
+        case TypeTags::valueBlock:
+            return makeCopyValueBlock(*getValueBlockView(val));
         default:
             break;
     }
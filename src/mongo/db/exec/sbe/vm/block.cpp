@@ -0,0 +1,255 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+namespace {
+/**
+ * Returns whether a value matches the comparison of a filter against the numeric constant
+ * 'constTag'/'constValue', the same way as the row-at-a-time filter does: a number is compared with
+ * the constant, an array matches if any of its immediate elements does, and any other value,
+ * including Nothing for a missing field, does not match.
+ */
+template <typename Op>
+bool matchesNumber(value::TypeTags tag,
+                   value::Value val,
+                   value::TypeTags constTag,
+                   value::Value constValue,
+                   Op op) {
+    if (value::isNumber(tag)) {
+        auto [resTag, resVal] = genericNumericCompare(tag, val, constTag, constValue, op);
+        return resTag == value::TypeTags::Boolean && value::bitcastTo<bool>(resVal);
+    }
+
+    if (value::isArray(tag)) {
+        for (value::ArrayEnumerator it{tag, val}; !it.atEnd(); it.advance()) {
+            auto [elemTag, elemVal] = it.getViewOfValue();
+            if (value::isNumber(elemTag) &&
+                matchesNumber(elemTag, elemVal, constTag, constValue, op)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Matches every value of 'block' against a constant of the C++ type 'T'. The values of the same
+ * type as the constant, which is the common case for a field holding numbers of a single type, are
+ * compared without converting them.
+ */
+template <typename T, typename Op>
+void matchBlockOfType(const value::ValueBlock& block,
+                      value::TypeTags constTag,
+                      value::Value constValue,
+                      Op op,
+                      value::ValueBlock* result) {
+    const auto constant = value::bitcastTo<T>(constValue);
+    const auto& tags = block.tags();
+    const auto& values = block.values();
+    for (size_t idx = 0; idx < tags.size(); ++idx) {
+        const bool matches = tags[idx] == constTag
+            ? op(value::bitcastTo<T>(values[idx]), constant)
+            : matchesNumber(tags[idx], values[idx], constTag, constValue, op);
+        result->push_back(value::TypeTags::Boolean, value::bitcastFrom<bool>(matches));
+    }
+}
+
+/**
+ * Produces a block of booleans holding whether each value of the block 'blockTag'/'blockValue'
+ * matches the comparison 'op' against the numeric constant 'constTag'/'constValue'. Returns Nothing
+ * if the first argument is not a block or the second one is not a number.
+ */
+template <typename Op>
+std::tuple<bool, value::TypeTags, value::Value> matchValueBlock(value::TypeTags blockTag,
+                                                                value::Value blockValue,
+                                                                value::TypeTags constTag,
+                                                                value::Value constValue,
+                                                                Op op) {
+    if (blockTag != value::TypeTags::valueBlock || !value::isNumber(constTag)) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto block = value::getValueBlockView(blockValue);
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard resGuard{resTag, resVal};
+    auto result = value::getValueBlockView(resVal);
+    result->reserve(block->size());
+
+    switch (constTag) {
+        case value::TypeTags::NumberInt32:
+            matchBlockOfType<int32_t>(*block, constTag, constValue, op, result);
+            break;
+        case value::TypeTags::NumberInt64:
+            matchBlockOfType<int64_t>(*block, constTag, constValue, op, result);
+            break;
+        case value::TypeTags::NumberDouble:
+            matchBlockOfType<double>(*block, constTag, constValue, op, result);
+            break;
+        default:
+            for (size_t idx = 0; idx < block->size(); ++idx) {
+                auto [tag, val] = block->getAt(idx);
+                result->push_back(
+                    value::TypeTags::Boolean,
+                    value::bitcastFrom<bool>(matchesNumber(tag, val, constTag, constValue, op)));
+            }
+            break;
+    }
+
+    resGuard.reset();
+    return {true, resTag, resVal};
+}
+
+/**
+ * Returns whether the value at position 'idx' of a block of booleans is 'true'.
+ */
+bool isSelected(const value::ValueBlock& block, size_t idx) {
+    return block.tags()[idx] == value::TypeTags::Boolean &&
+        value::bitcastTo<bool>(block.values()[idx]);
+}
+
+/**
+ * Combines two blocks of booleans of the same size position by position. Returns Nothing if either
+ * argument is not a block, or if the blocks differ in size.
+ */
+template <typename Op>
+std::tuple<bool, value::TypeTags, value::Value> combineValueBlocks(value::TypeTags lhsTag,
+                                                                   value::Value lhsValue,
+                                                                   value::TypeTags rhsTag,
+                                                                   value::Value rhsValue,
+                                                                   Op op) {
+    if (lhsTag != value::TypeTags::valueBlock || rhsTag != value::TypeTags::valueBlock) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto lhsBlock = value::getValueBlockView(lhsValue);
+    auto rhsBlock = value::getValueBlockView(rhsValue);
+    if (lhsBlock->size() != rhsBlock->size()) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [resTag, resVal] = value::makeNewValueBlock();
+    value::ValueGuard resGuard{resTag, resVal};
+    auto result = value::getValueBlockView(resVal);
+    result->reserve(lhsBlock->size());
+
+    for (size_t idx = 0; idx < lhsBlock->size(); ++idx) {
+        const bool selected = op(isSelected(*lhsBlock, idx), isSelected(*rhsBlock, idx));
+        result->push_back(value::TypeTags::Boolean, value::bitcastFrom<bool>(selected));
+    }
+
+    resGuard.reset();
+    return {true, resTag, resVal};
+}
+}  // namespace
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMatchLt(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [constOwned, constTag, constVal] = getFromStack(1);
+
+    return matchValueBlock(blockTag, blockVal, constTag, constVal, std::less<>{});
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMatchLte(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [constOwned, constTag, constVal] = getFromStack(1);
+
+    return matchValueBlock(blockTag, blockVal, constTag, constVal, std::less_equal<>{});
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMatchGt(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [constOwned, constTag, constVal] = getFromStack(1);
+
+    return matchValueBlock(blockTag, blockVal, constTag, constVal, std::greater<>{});
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMatchGte(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [constOwned, constTag, constVal] = getFromStack(1);
+
+    return matchValueBlock(blockTag, blockVal, constTag, constVal, std::greater_equal<>{});
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockMatchEq(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+    auto [constOwned, constTag, constVal] = getFromStack(1);
+
+    return matchValueBlock(blockTag, blockVal, constTag, constVal, std::equal_to<>{});
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockLogicalAnd(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+    auto [rhsOwned, rhsTag, rhsVal] = getFromStack(1);
+
+    return combineValueBlocks(
+        lhsTag, lhsVal, rhsTag, rhsVal, [](bool lhs, bool rhs) { return lhs && rhs; });
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockLogicalOr(
+    uint8_t arity) {
+    invariant(arity == 2);
+    auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+    auto [rhsOwned, rhsTag, rhsVal] = getFromStack(1);
+
+    return combineValueBlocks(
+        lhsTag, lhsVal, rhsTag, rhsVal, [](bool lhs, bool rhs) { return lhs || rhs; });
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinValueBlockLogicalNot(
+    uint8_t arity) {
+    invariant(arity == 1);
+    auto [blockOwned, blockTag, blockVal] = getFromStack(0);
+
+    // Pass the block on both sides so that the result has the block's size; only the left-hand
+    // side is inspected.
+    return combineValueBlocks(
+        blockTag, blockVal, blockTag, blockVal, [](bool selected, bool) { return !selected; });
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
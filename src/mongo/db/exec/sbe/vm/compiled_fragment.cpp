@@ -0,0 +1,562 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo {
+namespace sbe {
+namespace vm {
+namespace {
+using Op = CompiledFragment::Op;
+
+/**
+ * An instruction decoded from a CodeFragment, along with its position in the bytecode.
+ */
+struct DecodedInstruction {
+    Instruction::Tags tag;
+    size_t offset;
+    Op op;
+    // Bytecode offset of the jump destination, only meaningful for jumps.
+    size_t jumpTarget{0};
+};
+
+boost::optional<Op::Tags> simpleCounterpart(Instruction::Tags tag) {
+    switch (tag) {
+        case Instruction::pop:
+            return Op::pop;
+        case Instruction::swap:
+            return Op::swap;
+        case Instruction::logicNot:
+            return Op::logicNot;
+        case Instruction::less:
+            return Op::less;
+        case Instruction::lessEq:
+            return Op::lessEq;
+        case Instruction::greater:
+            return Op::greater;
+        case Instruction::greaterEq:
+            return Op::greaterEq;
+        case Instruction::eq:
+            return Op::eq;
+        case Instruction::neq:
+            return Op::neq;
+        case Instruction::fillEmpty:
+            return Op::fillEmpty;
+        case Instruction::getField:
+            return Op::getField;
+        case Instruction::exists:
+            return Op::exists;
+        case Instruction::isNull:
+            return Op::isNull;
+        case Instruction::isObject:
+            return Op::isObject;
+        case Instruction::isArray:
+            return Op::isArray;
+        case Instruction::isString:
+            return Op::isString;
+        case Instruction::isNumber:
+            return Op::isNumber;
+        case Instruction::isDate:
+            return Op::isDate;
+        default:
+            return boost::none;
+    }
+}
+
+/**
+ * Returns the superinstruction replacing 'pushConstVal; tag', if any.
+ */
+boost::optional<Op::Tags> constOperandCounterpart(Instruction::Tags tag) {
+    switch (tag) {
+        case Instruction::less:
+            return Op::lessConst;
+        case Instruction::lessEq:
+            return Op::lessEqConst;
+        case Instruction::greater:
+            return Op::greaterConst;
+        case Instruction::greaterEq:
+            return Op::greaterEqConst;
+        case Instruction::eq:
+            return Op::eqConst;
+        case Instruction::neq:
+            return Op::neqConst;
+        case Instruction::fillEmpty:
+            return Op::fillEmptyConst;
+        default:
+            return boost::none;
+    }
+}
+
+/**
+ * Decodes every instruction of 'code', or returns boost::none if any of them has no compiled
+ * counterpart.
+ */
+boost::optional<std::vector<DecodedInstruction>> decode(const CodeFragment& code) {
+    std::vector<DecodedInstruction> decoded;
+    auto begin = code.instrs().data();
+    auto pcPointer = begin;
+    auto pcEnd = begin + code.instrs().size();
+
+    while (pcPointer != pcEnd) {
+        DecodedInstruction instr;
+        instr.offset = pcPointer - begin;
+
+        Instruction i = value::readFromMemory<Instruction>(pcPointer);
+        pcPointer += sizeof(i);
+        instr.tag = static_cast<Instruction::Tags>(i.tag);
+
+        switch (instr.tag) {
+            case Instruction::pushConstVal: {
+                instr.op.tag = Op::pushConstVal;
+                instr.op.constTag = value::readFromMemory<value::TypeTags>(pcPointer);
+                pcPointer += sizeof(instr.op.constTag);
+                instr.op.constVal = value::readFromMemory<value::Value>(pcPointer);
+                pcPointer += sizeof(instr.op.constVal);
+                break;
+            }
+            case Instruction::pushAccessVal:
+            case Instruction::pushMoveVal: {
+                instr.op.tag =
+                    instr.tag == Instruction::pushAccessVal ? Op::pushAccessVal : Op::pushMoveVal;
+                instr.op.accessor = value::readFromMemory<value::SlotAccessor*>(pcPointer);
+                pcPointer += sizeof(instr.op.accessor);
+                break;
+            }
+            case Instruction::pushLocalVal: {
+                instr.op.tag = Op::pushLocalVal;
+                instr.op.operand = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(instr.op.operand);
+                break;
+            }
+            case Instruction::typeMatch: {
+                instr.op.tag = Op::typeMatch;
+                instr.op.operand = value::readFromMemory<uint32_t>(pcPointer);
+                pcPointer += sizeof(uint32_t);
+                break;
+            }
+            case Instruction::function: {
+                instr.op.tag = Op::function;
+                instr.op.builtin = value::readFromMemory<Builtin>(pcPointer);
+                pcPointer += sizeof(instr.op.builtin);
+                instr.op.arity = value::readFromMemory<uint8_t>(pcPointer);
+                pcPointer += sizeof(instr.op.arity);
+                break;
+            }
+            case Instruction::jmp:
+            case Instruction::jmpTrue:
+            case Instruction::jmpNothing: {
+                instr.op.tag = instr.tag == Instruction::jmp
+                    ? Op::jmp
+                    : (instr.tag == Instruction::jmpTrue ? Op::jmpTrue : Op::jmpNothing);
+                auto jumpOffset = value::readFromMemory<int>(pcPointer);
+                pcPointer += sizeof(jumpOffset);
+                instr.jumpTarget = (pcPointer - begin) + jumpOffset;
+                invariant(instr.jumpTarget <= code.instrs().size());
+                break;
+            }
+            default: {
+                auto tag = simpleCounterpart(instr.tag);
+                if (!tag) {
+                    return boost::none;
+                }
+                instr.op.tag = *tag;
+                break;
+            }
+        }
+        decoded.push_back(instr);
+    }
+
+    return decoded;
+}
+}  // namespace
+
+std::unique_ptr<CompiledFragment> CompiledFragment::compile(const CodeFragment& code) {
+    auto decoded = decode(code);
+    if (!decoded) {
+        return nullptr;
+    }
+
+    const auto codeSize = code.instrs().size();
+    std::vector<bool> isJumpTarget(codeSize + 1, false);
+    for (auto&& instr : *decoded) {
+        if (instr.op.tag == Op::jmp || instr.op.tag == Op::jmpTrue ||
+            instr.op.tag == Op::jmpNothing) {
+            isJumpTarget[instr.jumpTarget] = true;
+        }
+    }
+
+    // Instructions can only be fused when control never enters the middle of the sequence.
+    auto canFuse = [&](size_t first, size_t count) {
+        if (first + count > decoded->size()) {
+            return false;
+        }
+        for (size_t idx = first + 1; idx < first + count; ++idx) {
+            if (isJumpTarget[(*decoded)[idx].offset]) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    auto compiled = std::make_unique<CompiledFragment>();
+    auto& ops = compiled->_ops;
+    std::vector<int> opIndexAtOffset(codeSize + 1, -1);
+    std::vector<std::pair<size_t, size_t>> jumpFixups;
+
+    for (size_t idx = 0; idx < decoded->size();) {
+        const auto& instr = (*decoded)[idx];
+        opIndexAtOffset[instr.offset] = ops.size();
+
+        if (instr.tag == Instruction::pushAccessVal && canFuse(idx, 3) &&
+            (*decoded)[idx + 1].tag == Instruction::pushConstVal &&
+            (*decoded)[idx + 2].tag == Instruction::getField) {
+            Op op = instr.op;
+            op.tag = Op::getFieldAccessConst;
+            op.constTag = (*decoded)[idx + 1].op.constTag;
+            op.constVal = (*decoded)[idx + 1].op.constVal;
+            ops.push_back(op);
+            idx += 3;
+            continue;
+        }
+
+        if (instr.tag == Instruction::pushConstVal && canFuse(idx, 2)) {
+            if (auto tag = constOperandCounterpart((*decoded)[idx + 1].tag)) {
+                Op op = instr.op;
+                op.tag = *tag;
+                ops.push_back(op);
+                idx += 2;
+                continue;
+            }
+        }
+
+        if (instr.op.tag == Op::jmp || instr.op.tag == Op::jmpTrue ||
+            instr.op.tag == Op::jmpNothing) {
+            jumpFixups.emplace_back(ops.size(), instr.jumpTarget);
+        }
+        ops.push_back(instr.op);
+        ++idx;
+    }
+    opIndexAtOffset[codeSize] = ops.size();
+
+    for (auto [opIndex, target] : jumpFixups) {
+        invariant(opIndexAtOffset[target] >= 0);
+        ops[opIndex].operand = opIndexAtOffset[target];
+    }
+
+    return compiled;
+}
+
+const CompiledFragment* CodeFragment::tierUp() const {
+    if (_compiled) {
+        return _compiled.get();
+    }
+
+    auto threshold = internalQuerySlotBasedExecutionTierUpThreshold.load();
+    if (threshold > 0 && ++_runCount == static_cast<uint64_t>(threshold)) {
+        _compiled = CompiledFragment::compile(*this);
+    }
+    return _compiled.get();
+}
+
+std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::runCompiled(
+    const CompiledFragment* code) {
+    auto compareWith = [this](auto cmp, value::TypeTags rhsTag, value::Value rhsVal) {
+        auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+        auto [tag, val] = cmp(lhsTag, lhsVal, rhsTag, rhsVal);
+
+        topStack(false, tag, val);
+
+        if (lhsOwned) {
+            value::releaseValue(lhsTag, lhsVal);
+        }
+    };
+    auto compare = [this, &compareWith](auto cmp) {
+        auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
+        popStack();
+
+        compareWith(cmp, rhsTag, rhsVal);
+
+        if (rhsOwned) {
+            value::releaseValue(rhsTag, rhsVal);
+        }
+    };
+    auto checkType = [this](auto pred) {
+        auto [owned, tag, val] = getFromStack(0);
+
+        if (tag != value::TypeTags::Nothing) {
+            topStack(false, value::TypeTags::Boolean, value::bitcastFrom<bool>(pred(tag)));
+        }
+
+        if (owned) {
+            value::releaseValue(tag, val);
+        }
+    };
+    auto fillEmptyWith = [this](bool rhsOwned, value::TypeTags rhsTag, value::Value rhsVal) {
+        auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+        if (lhsTag == value::TypeTags::Nothing) {
+            topStack(rhsOwned, rhsTag, rhsVal);
+
+            if (lhsOwned) {
+                value::releaseValue(lhsTag, lhsVal);
+            }
+        } else if (rhsOwned) {
+            value::releaseValue(rhsTag, rhsVal);
+        }
+    };
+
+    auto less = [this](auto... args) { return genericCompare<std::less<>>(args...); };
+    auto lessEq = [this](auto... args) { return genericCompare<std::less_equal<>>(args...); };
+    auto greater = [this](auto... args) { return genericCompare<std::greater<>>(args...); };
+    auto greaterEq = [this](auto... args) {
+        return genericCompare<std::greater_equal<>>(args...);
+    };
+    auto eq = [this](auto... args) { return genericCompareEq(args...); };
+    auto neq = [this](auto... args) { return genericCompareNeq(args...); };
+
+    const auto begin = code->ops().data();
+    const auto end = begin + code->ops().size();
+    for (auto op = begin; op != end;) {
+        switch (op->tag) {
+            case Op::pushConstVal:
+                pushStack(false, op->constTag, op->constVal);
+                break;
+            case Op::pushAccessVal: {
+                auto [tag, val] = op->accessor->getViewOfValue();
+                pushStack(false, tag, val);
+                break;
+            }
+            case Op::pushMoveVal: {
+                auto [tag, val] = op->accessor->copyOrMoveValue();
+                pushStack(true, tag, val);
+                break;
+            }
+            case Op::pushLocalVal: {
+                auto [owned, tag, val] = getFromStack(op->operand);
+                pushStack(false, tag, val);
+                break;
+            }
+            case Op::pop: {
+                auto [owned, tag, val] = getFromStack(0);
+                popStack();
+
+                if (owned) {
+                    value::releaseValue(tag, val);
+                }
+                break;
+            }
+            case Op::swap: {
+                auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
+                auto [lhsOwned, lhsTag, lhsVal] = getFromStack(1);
+
+                // See the interpreter for why physically identical values must not be swapped.
+                if (!(rhsTag == lhsTag && rhsVal == lhsVal)) {
+                    setStack(0, lhsOwned, lhsTag, lhsVal);
+                    setStack(1, rhsOwned, rhsTag, rhsVal);
+                } else {
+                    invariant(!rhsOwned);
+                }
+                break;
+            }
+            case Op::logicNot: {
+                auto [owned, tag, val] = getFromStack(0);
+
+                auto [resultOwned, resultTag, resultVal] = genericNot(tag, val);
+
+                topStack(resultOwned, resultTag, resultVal);
+
+                if (owned) {
+                    value::releaseValue(tag, val);
+                }
+                break;
+            }
+            case Op::less:
+                compare(less);
+                break;
+            case Op::lessEq:
+                compare(lessEq);
+                break;
+            case Op::greater:
+                compare(greater);
+                break;
+            case Op::greaterEq:
+                compare(greaterEq);
+                break;
+            case Op::eq:
+                compare(eq);
+                break;
+            case Op::neq:
+                compare(neq);
+                break;
+            case Op::fillEmpty: {
+                auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
+                popStack();
+
+                fillEmptyWith(rhsOwned, rhsTag, rhsVal);
+                break;
+            }
+            case Op::getField: {
+                auto [rhsOwned, rhsTag, rhsVal] = getFromStack(0);
+                popStack();
+                auto [lhsOwned, lhsTag, lhsVal] = getFromStack(0);
+
+                auto [owned, tag, val] = getField(lhsTag, lhsVal, rhsTag, rhsVal);
+
+                topStack(owned, tag, val);
+
+                if (rhsOwned) {
+                    value::releaseValue(rhsTag, rhsVal);
+                }
+                if (lhsOwned) {
+                    value::releaseValue(lhsTag, lhsVal);
+                }
+                break;
+            }
+            case Op::exists: {
+                auto [owned, tag, val] = getFromStack(0);
+
+                topStack(false,
+                         value::TypeTags::Boolean,
+                         value::bitcastFrom<bool>(tag != value::TypeTags::Nothing));
+
+                if (owned) {
+                    value::releaseValue(tag, val);
+                }
+                break;
+            }
+            case Op::isNull:
+                checkType([](value::TypeTags tag) { return tag == value::TypeTags::Null; });
+                break;
+            case Op::isObject:
+                checkType([](value::TypeTags tag) { return value::isObject(tag); });
+                break;
+            case Op::isArray:
+                checkType([](value::TypeTags tag) { return value::isArray(tag); });
+                break;
+            case Op::isString:
+                checkType([](value::TypeTags tag) { return value::isString(tag); });
+                break;
+            case Op::isNumber:
+                checkType([](value::TypeTags tag) { return value::isNumber(tag); });
+                break;
+            case Op::isDate:
+                checkType([](value::TypeTags tag) { return tag == value::TypeTags::Date; });
+                break;
+            case Op::typeMatch: {
+                auto typeMask = static_cast<uint32_t>(op->operand);
+                checkType([typeMask](value::TypeTags tag) {
+                    return static_cast<bool>(getBSONTypeMask(tag) & typeMask);
+                });
+                break;
+            }
+            case Op::function: {
+                auto [owned, tag, val] = dispatchBuiltin(op->builtin, op->arity);
+
+                for (uint8_t cnt = 0; cnt < op->arity; ++cnt) {
+                    auto [owned, tag, val] = getFromStack(0);
+                    popStack();
+                    if (owned) {
+                        value::releaseValue(tag, val);
+                    }
+                }
+
+                pushStack(owned, tag, val);
+                break;
+            }
+            case Op::jmp:
+                op = begin + op->operand;
+                continue;
+            case Op::jmpTrue: {
+                auto [owned, tag, val] = getFromStack(0);
+                popStack();
+
+                bool taken = tag == value::TypeTags::Boolean && value::bitcastTo<bool>(val);
+
+                if (owned) {
+                    value::releaseValue(tag, val);
+                }
+                if (taken) {
+                    op = begin + op->operand;
+                    continue;
+                }
+                break;
+            }
+            case Op::jmpNothing: {
+                auto [owned, tag, val] = getFromStack(0);
+                if (tag == value::TypeTags::Nothing) {
+                    op = begin + op->operand;
+                    continue;
+                }
+                break;
+            }
+            case Op::getFieldAccessConst: {
+                auto [objTag, objVal] = op->accessor->getViewOfValue();
+
+                auto [owned, tag, val] = getField(objTag, objVal, op->constTag, op->constVal);
+
+                pushStack(owned, tag, val);
+                break;
+            }
+            case Op::lessConst:
+                compareWith(less, op->constTag, op->constVal);
+                break;
+            case Op::lessEqConst:
+                compareWith(lessEq, op->constTag, op->constVal);
+                break;
+            case Op::greaterConst:
+                compareWith(greater, op->constTag, op->constVal);
+                break;
+            case Op::greaterEqConst:
+                compareWith(greaterEq, op->constTag, op->constVal);
+                break;
+            case Op::eqConst:
+                compareWith(eq, op->constTag, op->constVal);
+                break;
+            case Op::neqConst:
+                compareWith(neq, op->constTag, op->constVal);
+                break;
+            case Op::fillEmptyConst:
+                fillEmptyWith(false, op->constTag, op->constVal);
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+        ++op;
+    }
+
+    return popResult();
+}
+}  // namespace vm
+}  // namespace sbe
+}  // namespace mongo
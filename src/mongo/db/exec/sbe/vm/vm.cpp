@@ -41,6 +41,7 @@
 #include "mongo/db/exec/sbe/vm/datetime.h"
 #include "mongo/db/query/datetime/date_time_support.h"
 #include "mongo/db/storage/key_string.h"
+#include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/summation.h"
 
@@ -543,10 +544,11 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::aggSum(value::TypeTags
         return {true, tag, val};
     }
 
-    // Initialize the accumulator.
+    // Initialize the accumulator. A 32-bit zero keeps the type of the sum as narrow as that of the
+    // widest input, like the $sum accumulator.
     if (accTag == value::TypeTags::Nothing) {
-        accTag = value::TypeTags::NumberInt64;
-        accValue = value::bitcastFrom<int64_t>(0);
+        accTag = value::TypeTags::NumberInt32;
+        accValue = value::bitcastFrom<int32_t>(0);
     }
 
     return genericAdd(accTag, accValue, fieldTag, fieldValue);
@@ -568,8 +570,9 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::aggMin(value::TypeTags
         return {true, tag, val};
     }
 
-    auto [tag, val] = genericCompare<std::less<>>(accTag, accValue, fieldTag, fieldValue);
-    if (tag == value::TypeTags::Boolean && value::bitcastTo<bool>(val)) {
+    // Values of different types are ordered by the canonical order of their types.
+    auto [tag, val] = value::compareValue(accTag, accValue, fieldTag, fieldValue);
+    if (tag == value::TypeTags::NumberInt32 && value::bitcastTo<int32_t>(val) < 0) {
         auto [tag, val] = value::copyValue(accTag, accValue);
         return {true, tag, val};
     } else {
@@ -594,8 +597,9 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::aggMax(value::TypeTags
         return {true, tag, val};
     }
 
-    auto [tag, val] = genericCompare<std::greater<>>(accTag, accValue, fieldTag, fieldValue);
-    if (tag == value::TypeTags::Boolean && value::bitcastTo<bool>(val)) {
+    // Values of different types are ordered by the canonical order of their types.
+    auto [tag, val] = value::compareValue(accTag, accValue, fieldTag, fieldValue);
+    if (tag == value::TypeTags::NumberInt32 && value::bitcastTo<int32_t>(val) > 0) {
         auto [tag, val] = value::copyValue(accTag, accValue);
         return {true, tag, val};
     } else {
@@ -1072,6 +1076,173 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinDoubleDoubleSum
     return {false, value::TypeTags::Nothing, 0};
 }
 
+namespace {
+/**
+ * The elements of the array holding the state of an 'aggDoubleDoubleSum' aggregate, which mirror
+ * the members of AccumulatorSum.
+ */
+enum AggDoubleDoubleSumElems : size_t {
+    // The widest numeric type added so far, which is the type of the result.
+    kTotalType,
+    // The sum of the integers added since the last time it would have overflowed.
+    kLongTotal,
+    // The 'sum', 'addend' and 'special' members of the DoubleDoubleSummation of all other numbers.
+    kDoubleSum,
+    kDoubleAddend,
+    kDoubleSpecial,
+    // The sum of the decimals added.
+    kDecimalTotal,
+    kNumElems
+};
+
+DoubleDoubleSummation getDoubleDoubleSummation(const value::Array* state) {
+    return DoubleDoubleSummation::create(
+        value::bitcastTo<double>(state->getAt(kDoubleSum).second),
+        value::bitcastTo<double>(state->getAt(kDoubleAddend).second),
+        value::bitcastTo<double>(state->getAt(kDoubleSpecial).second));
+}
+
+void setDoubleDoubleSummation(value::Array* state, const DoubleDoubleSummation& summation) {
+    auto [sum, addend, special] = summation.getState();
+    state->setAt(kDoubleSum, value::TypeTags::NumberDouble, value::bitcastFrom<double>(sum));
+    state->setAt(kDoubleAddend, value::TypeTags::NumberDouble, value::bitcastFrom<double>(addend));
+    state->setAt(
+        kDoubleSpecial, value::TypeTags::NumberDouble, value::bitcastFrom<double>(special));
+}
+}  // namespace
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinAggDoubleDoubleSum(
+    uint8_t arity) {
+    auto [ownAgg, tagAgg, valAgg] = getFromStack(0);
+    auto [_, tagField, valField] = getFromStack(1);
+
+    // Create the state of the sum if it does not exist yet.
+    if (tagAgg == value::TypeTags::Nothing) {
+        auto [tagNewAgg, valNewAgg] = value::makeNewArray();
+        value::ValueGuard newGuard{tagNewAgg, valNewAgg};
+        auto state = value::getArrayView(valNewAgg);
+        state->reserve(kNumElems);
+        state->push_back(value::TypeTags::NumberInt32,
+                         value::bitcastFrom<int32_t>(
+                             static_cast<int32_t>(value::TypeTags::NumberInt32)));
+        state->push_back(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(0));
+        state->push_back(value::TypeTags::NumberDouble, value::bitcastFrom<double>(0.0));
+        state->push_back(value::TypeTags::NumberDouble, value::bitcastFrom<double>(0.0));
+        state->push_back(value::TypeTags::NumberDouble, value::bitcastFrom<double>(0.0));
+        auto [tagDecimal, valDecimal] = value::makeCopyDecimal(Decimal128{});
+        state->push_back(tagDecimal, valDecimal);
+        newGuard.reset();
+        ownAgg = true;
+        tagAgg = tagNewAgg;
+        valAgg = valNewAgg;
+    } else {
+        // Take ownership of the accumulator.
+        topStack(false, value::TypeTags::Nothing, 0);
+    }
+    value::ValueGuard guard{tagAgg, valAgg};
+
+    invariant(ownAgg && tagAgg == value::TypeTags::Array);
+    auto state = value::getArrayView(valAgg);
+    invariant(state->size() == kNumElems);
+
+    // Non-numeric values are ignored.
+    if (!value::isNumber(tagField)) {
+        guard.reset();
+        return {ownAgg, tagAgg, valAgg};
+    }
+
+    auto totalType =
+        static_cast<value::TypeTags>(value::bitcastTo<int32_t>(state->getAt(kTotalType).second));
+    if (tagField == value::TypeTags::NumberInt32 || tagField == value::TypeTags::NumberInt64) {
+        // Integers are added to the long total, and only go through the compensated sum once it
+        // would overflow.
+        if (tagField == value::TypeTags::NumberInt64 &&
+            totalType == value::TypeTags::NumberInt32) {
+            totalType = value::TypeTags::NumberInt64;
+        }
+        auto longTotal = value::bitcastTo<int64_t>(state->getAt(kLongTotal).second);
+        auto input = value::numericCast<int64_t>(tagField, valField);
+        int64_t nextTotal;
+        if (overflow::add(longTotal, input, &nextTotal)) {
+            auto summation = getDoubleDoubleSummation(state);
+            summation.addLong(longTotal);
+            setDoubleDoubleSummation(state, summation);
+            nextTotal = input;
+        }
+        state->setAt(
+            kLongTotal, value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(nextTotal));
+    } else {
+        // Upgrade to the widest type required to hold the result.
+        totalType = value::getWidestNumericalType(totalType, tagField);
+        if (tagField == value::TypeTags::NumberDouble) {
+            auto summation = getDoubleDoubleSummation(state);
+            summation.addDouble(value::bitcastTo<double>(valField));
+            setDoubleDoubleSummation(state, summation);
+        } else {
+            invariant(tagField == value::TypeTags::NumberDecimal);
+            auto decimalTotal = value::bitcastTo<Decimal128>(state->getAt(kDecimalTotal).second);
+            auto [tagDecimal, valDecimal] =
+                value::makeCopyDecimal(decimalTotal.add(value::bitcastTo<Decimal128>(valField)));
+            state->setAt(kDecimalTotal, tagDecimal, valDecimal);
+        }
+    }
+    state->setAt(kTotalType,
+                 value::TypeTags::NumberInt32,
+                 value::bitcastFrom<int32_t>(static_cast<int32_t>(totalType)));
+
+    guard.reset();
+    return {ownAgg, tagAgg, valAgg};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinDoubleDoubleSumFinalize(
+    uint8_t arity) {
+    invariant(arity == 1);
+
+    auto [_, tagState, valState] = getFromStack(0);
+    if (tagState != value::TypeTags::Array) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+    auto state = value::getArrayView(valState);
+    invariant(state->size() == kNumElems);
+
+    auto summation = getDoubleDoubleSummation(state);
+    summation.addLong(value::bitcastTo<int64_t>(state->getAt(kLongTotal).second));
+
+    // The result has the same type as that of AccumulatorSum.
+    switch (
+        static_cast<value::TypeTags>(value::bitcastTo<int32_t>(state->getAt(kTotalType).second))) {
+        case value::TypeTags::NumberInt32:
+            if (summation.fitsLong()) {
+                auto result = summation.getLong();
+                if (result >= std::numeric_limits<int32_t>::min() &&
+                    result <= std::numeric_limits<int32_t>::max()) {
+                    return {false,
+                            value::TypeTags::NumberInt32,
+                            value::bitcastFrom<int32_t>(static_cast<int32_t>(result))};
+                }
+            }
+        // Fall through to the larger type.
+        case value::TypeTags::NumberInt64:
+            if (summation.fitsLong()) {
+                return {false,
+                        value::TypeTags::NumberInt64,
+                        value::bitcastFrom<int64_t>(summation.getLong())};
+            }
+        // The sum does not fit a NumberLong, so it is returned as a NumberDouble instead.
+        case value::TypeTags::NumberDouble:
+            return {false,
+                    value::TypeTags::NumberDouble,
+                    value::bitcastFrom<double>(summation.getDouble())};
+        case value::TypeTags::NumberDecimal: {
+            auto decimalTotal = value::bitcastTo<Decimal128>(state->getAt(kDecimalTotal).second);
+            auto [tag, val] = value::makeCopyDecimal(decimalTotal.add(summation.getDecimal()));
+            return {true, tag, val};
+        }
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
 /**
  * A helper for the bultinDate method. The formal parameters yearOrWeekYear and monthOrWeek carry
  * values depending on wether the date is a year-month-day or ISOWeekYear.
@@ -1940,6 +2111,10 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinAddToSet(arity);
         case Builtin::doubleDoubleSum:
             return builtinDoubleDoubleSum(arity);
+        case Builtin::aggDoubleDoubleSum:
+            return builtinAggDoubleDoubleSum(arity);
+        case Builtin::doubleDoubleSumFinalize:
+            return builtinDoubleDoubleSumFinalize(arity);
         case Builtin::bitTestZero:
             return builtinBitTestZero(arity);
         case Builtin::bitTestMask:
@@ -2000,12 +2175,32 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinSetIntersection(arity);
         case Builtin::setDifference:
             return builtinSetDifference(arity);
+        case Builtin::valueBlockMatchLt:
+            return builtinValueBlockMatchLt(arity);
+        case Builtin::valueBlockMatchLte:
+            return builtinValueBlockMatchLte(arity);
+        case Builtin::valueBlockMatchGt:
+            return builtinValueBlockMatchGt(arity);
+        case Builtin::valueBlockMatchGte:
+            return builtinValueBlockMatchGte(arity);
+        case Builtin::valueBlockMatchEq:
+            return builtinValueBlockMatchEq(arity);
+        case Builtin::valueBlockLogicalAnd:
+            return builtinValueBlockLogicalAnd(arity);
+        case Builtin::valueBlockLogicalOr:
+            return builtinValueBlockLogicalOr(arity);
+        case Builtin::valueBlockLogicalNot:
+            return builtinValueBlockLogicalNot(arity);
     }
 
     MONGO_UNREACHABLE;
 }
 
 std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragment* code) {
+    if (auto compiled = code->tierUp()) {
+        return runCompiled(compiled);
+    }
+
     auto pcPointer = code->instrs().data();
     auto pcEnd = pcPointer + code->instrs().size();
 
@@ -2713,6 +2908,10 @@ std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::run(const CodeFragm
             }
         }
     }
+    return popResult();
+}
+
+std::tuple<uint8_t, value::TypeTags, value::Value> ByteCode::popResult() {
     uassert(
         4822801, "The evaluation stack must hold only a single value", _argStackOwned.size() == 1);
 
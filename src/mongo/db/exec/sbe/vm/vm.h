@@ -198,6 +198,8 @@ enum class Builtin : uint8_t {
     addToArray,       // agg function to append to an array
     addToSet,         // agg function to append to a set
     doubleDoubleSum,  // special double summation
+    aggDoubleDoubleSum,       // agg function to sum numbers like the $sum and $avg accumulators
+    doubleDoubleSumFinalize,  // the result of a sum computed by 'aggDoubleDoubleSum'
     bitTestZero,      // test bitwise mask & value is zero
     bitTestMask,      // test bitwise mask & value is mask
     bitTestPosition,  // test BinData with a bit position list
@@ -228,6 +230,95 @@ enum class Builtin : uint8_t {
     setUnion,
     setIntersection,
     setDifference,
+
+    // Block-at-a-time counterparts of the comparison and logical instructions of a filter, which
+    // produce a block of booleans holding whether each row matches.
+    valueBlockMatchLt,
+    valueBlockMatchLte,
+    valueBlockMatchGt,
+    valueBlockMatchGte,
+    valueBlockMatchEq,
+    valueBlockLogicalAnd,
+    valueBlockLogicalOr,
+    valueBlockLogicalNot,
+};
+
+class CodeFragment;
+
+/**
+ * A CodeFragment lowered into a flat array of fixed-width operations. Operands are decoded once,
+ * jump offsets are resolved to operation indices and the instruction sequences most commonly
+ * emitted for filters are fused into single superinstructions, so executing a compiled fragment
+ * neither parses variable-length bytecode nor round-trips constants through the stack.
+ *
+ * Only a subset of the instruction set has a compiled counterpart. A fragment containing any other
+ * instruction is not compiled and keeps running in the interpreter.
+ */
+class CompiledFragment {
+public:
+    struct Op {
+        enum Tags : uint8_t {
+            // Counterparts of the instructions with the same name.
+            pushConstVal,
+            pushAccessVal,
+            pushMoveVal,
+            pushLocalVal,
+            pop,
+            swap,
+            logicNot,
+            less,
+            lessEq,
+            greater,
+            greaterEq,
+            eq,
+            neq,
+            fillEmpty,
+            getField,
+            exists,
+            isNull,
+            isObject,
+            isArray,
+            isString,
+            isNumber,
+            isDate,
+            typeMatch,
+            function,
+            jmp,
+            jmpTrue,
+            jmpNothing,
+
+            // Superinstructions.
+            getFieldAccessConst,  // pushAccessVal; pushConstVal; getField
+            lessConst,            // pushConstVal; less
+            lessEqConst,          // pushConstVal; lessEq
+            greaterConst,         // pushConstVal; greater
+            greaterEqConst,       // pushConstVal; greaterEq
+            eqConst,              // pushConstVal; eq
+            neqConst,             // pushConstVal; neq
+            fillEmptyConst,       // pushConstVal; fillEmpty
+        };
+
+        Tags tag{pushConstVal};
+        Builtin builtin{};
+        uint8_t arity{0};
+        value::TypeTags constTag{value::TypeTags::Nothing};
+        // Stack offset, type mask or jump target, depending on the operation.
+        int operand{0};
+        value::Value constVal{0};
+        value::SlotAccessor* accessor{nullptr};
+    };
+
+    /**
+     * Returns nullptr if 'code' contains an instruction without a compiled counterpart.
+     */
+    static std::unique_ptr<CompiledFragment> compile(const CodeFragment& code);
+
+    const auto& ops() const {
+        return _ops;
+    }
+
+private:
+    std::vector<Op> _ops;
 };
 
 class CodeFragment {
@@ -314,6 +405,13 @@ public:
     }
     void appendNumericConvert(value::TypeTags targetTag);
 
+    /**
+     * Records one more execution of this fragment and returns its compiled form once it has been
+     * run 'internalQuerySlotBasedExecutionTierUpThreshold' times, or nullptr while it is still
+     * interpreted.
+     */
+    const CompiledFragment* tierUp() const;
+
 private:
     void appendSimpleInstruction(Instruction::Tags tag);
     auto allocateSpace(size_t size) {
@@ -342,6 +440,11 @@ private:
     std::vector<FixUp> _fixUps;
 
     int _stackSize{0};
+
+    // A fragment is no longer modified once it starts running and is only ever run by the thread
+    // that owns its plan, so it can be tiered up lazily from the const execution path.
+    mutable uint64_t _runCount{0};
+    mutable std::unique_ptr<CompiledFragment> _compiled;
 };
 
 class ByteCode {
@@ -351,6 +454,12 @@ public:
     std::tuple<uint8_t, value::TypeTags, value::Value> run(const CodeFragment* code);
     bool runPredicate(const CodeFragment* code);
 
+    /**
+     * Runs the compiled form of a fragment. The result is identical to running the fragment itself
+     * through 'run()'.
+     */
+    std::tuple<uint8_t, value::TypeTags, value::Value> runCompiled(const CompiledFragment* code);
+
 private:
     std::vector<uint8_t> _argStackOwned;
     std::vector<value::TypeTags> _argStackTags;
@@ -542,6 +651,8 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinAddToArray(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinAddToSet(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinDoubleDoubleSum(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinAggDoubleDoubleSum(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinDoubleDoubleSumFinalize(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestZero(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestMask(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestPosition(uint8_t arity);
@@ -572,9 +683,19 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinSetUnion(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinSetIntersection(uint8_t arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinSetDifference(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMatchLt(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMatchLte(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMatchGt(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMatchGte(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockMatchEq(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockLogicalAnd(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockLogicalOr(uint8_t arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinValueBlockLogicalNot(uint8_t arity);
 
     std::tuple<bool, value::TypeTags, value::Value> dispatchBuiltin(Builtin f, uint8_t arity);
 
+    std::tuple<uint8_t, value::TypeTags, value::Value> popResult();
+
     std::tuple<bool, value::TypeTags, value::Value> getFromStack(size_t offset) {
         auto backOffset = _argStackOwned.size() - 1 - offset;
         auto owned = _argStackOwned[backOffset];
@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/sorter/sorter_gen.h"
 
 namespace mongo {
 /**
@@ -124,9 +125,16 @@ public:
      */
     void add(const Value& sortKey, const T& data) {
         if (!_sorter) {
-            _sorter.reset(DocumentSorter::make(makeSortOptions(), Comparator(_sortPattern)));
+            const auto opts = makeSortOptions();
+            // Only a sort without a limit sorts the keys it holds in memory on worker threads.
+            _sortOnWorkerThreads = opts.maxWorkerThreads > 1 && !opts.limit;
+            _sorter.reset(DocumentSorter::make(opts, Comparator(_sortPattern)));
+        }
+        if (_sortOnWorkerThreads) {
+            _sorter->add(makeIndependentSortKey(sortKey), data);
+        } else {
+            _sorter->add(sortKey, data);
         }
-        _sorter->add(sortKey, data);
 
         _stats.totalDataSizeBytes += data.memUsageForSorter();
     }
@@ -179,6 +187,7 @@ private:
         }
 
         opts.maxMemoryUsageBytes = _stats.maxMemoryUsageBytes;
+        opts.maxWorkerThreads = internalSorterMaxWorkerThreads.load();
         if (_diskUseAllowed) {
             opts.extSortAllowed = true;
             opts.tempDir = _tempDir;
@@ -187,6 +196,22 @@ private:
         return opts;
     }
 
+    /**
+     * Returns a copy of 'sortKey' which shares no storage with any other value, so that the sorter
+     * can compare it on a worker thread. Comparing documents caches their fields in their storage,
+     * which a sort key may share with other documents, e.g. those produced by $unwind. The copy is
+     * made the way the sorter spills keys to disk and reads them back.
+     */
+    static Value makeIndependentSortKey(const Value& sortKey) {
+        if (sortKey.getType() != BSONType::Object && sortKey.getType() != BSONType::Array) {
+            return sortKey;
+        }
+        BufBuilder buf;
+        sortKey.serializeForSorter(buf);
+        BufReader reader(buf.buf(), buf.len());
+        return Value::deserializeForSorter(reader, Value::SorterDeserializeSettings());
+    }
+
     const SortPattern _sortPattern;
     const std::string _tempDir;
     const bool _diskUseAllowed;
@@ -194,6 +219,9 @@ private:
     std::unique_ptr<DocumentSorter> _sorter;
     std::unique_ptr<typename DocumentSorter::Iterator> _output;
 
+    // Whether '_sorter' may compare the sort keys it holds in memory on several threads.
+    bool _sortOnWorkerThreads = false;
+
     SortStats _stats;
 
     bool _isEOF = false;
@@ -57,6 +57,13 @@ class TreeMatchExpression;
 
 typedef StatusWith<std::unique_ptr<MatchExpression>> StatusWithMatchExpression;
 
+/**
+ * Identifies a constant of a query which was replaced by an input parameter, so that the plans of
+ * queries which only differ by the values of their constants can be shared. See
+ * expression_parameterization.h.
+ */
+using InputParamId = int32_t;
+
 class MatchExpression {
     MatchExpression(const MatchExpression&) = delete;
     MatchExpression& operator=(const MatchExpression&) = delete;
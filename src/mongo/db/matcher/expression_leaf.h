@@ -142,6 +142,19 @@ public:
         return _collator;
     }
 
+    /**
+     * The id of the input parameter bound to the RHS of this expression, if any. Plans lowered to
+     * SBE read a parameterized RHS from a runtime environment slot rather than embedding it as a
+     * constant, so that they can be reused for queries of the same shape with different values.
+     */
+    void setInputParamId(boost::optional<InputParamId> paramId) {
+        _inputParamId = paramId;
+    }
+
+    boost::optional<InputParamId> getInputParamId() const {
+        return _inputParamId;
+    }
+
 protected:
     /**
      * 'collator' must outlive the ComparisonMatchExpression and any clones made of it.
@@ -157,6 +170,8 @@ protected:
     // Collator used to compare elements. By default, simple binary comparison will be used.
     const CollatorInterface* _collator = nullptr;
 
+    boost::optional<InputParamId> _inputParamId;
+
 private:
     ExpressionOptimizerFunc getOptimizer() const final {
         return [](std::unique_ptr<MatchExpression> expression) { return expression; };
@@ -221,6 +236,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -257,6 +273,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -293,6 +310,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -334,6 +352,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -374,6 +393,7 @@ public:
             e->setTag(getTag()->clone());
         }
         e->setCollator(_collator);
+        e->setInputParamId(_inputParamId);
         return e;
     }
 
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_parameterization.h"
+
+#include <cmath>
+
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo::expression {
+namespace {
+void parameterize(MatchExpression* expr, InputParamId* nextId) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<ComparisonMatchExpression*>(expr);
+        if (isParameterizable(comparison->getData())) {
+            comparison->setInputParamId((*nextId)++);
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        parameterize(expr->getChild(i), nextId);
+    }
+}
+
+void collectInputParams(const MatchExpression* expr, std::vector<BSONElement>* params) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<const ComparisonMatchExpression*>(expr);
+        if (auto paramId = comparison->getInputParamId()) {
+            if (static_cast<size_t>(*paramId) >= params->size()) {
+                params->resize(*paramId + 1);
+            }
+            (*params)[*paramId] = comparison->getData();
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        collectInputParams(expr->getChild(i), params);
+    }
+}
+}  // namespace
+
+bool isParameterizable(const BSONElement& elem) {
+    switch (elem.type()) {
+        case NumberInt:
+        case NumberLong:
+            return true;
+        case NumberDouble:
+            return !std::isnan(elem.numberDouble());
+        case NumberDecimal:
+            return !elem.numberDecimal().isNaN();
+        case String:
+        case Date:
+        case jstOID:
+        case Bool:
+        case bsonTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void parameterize(MatchExpression* tree) {
+    InputParamId nextId = 0;
+    parameterize(tree, &nextId);
+}
+
+std::vector<BSONElement> collectInputParams(const MatchExpression* tree) {
+    std::vector<BSONElement> params;
+    collectInputParams(tree, &params);
+    return params;
+}
+
+}  // namespace mongo::expression
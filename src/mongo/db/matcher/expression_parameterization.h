@@ -0,0 +1,59 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonelement.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo::expression {
+
+/**
+ * Returns true if a comparison against 'elem' can be parameterized. Only scalar values whose exact
+ * value never affects the shape of the plan qualify: the planner handles comparisons against
+ * null, MinKey, MaxKey, NaN, arrays, objects and regular expressions specially.
+ */
+bool isParameterizable(const BSONElement& elem);
+
+/**
+ * Assigns an input parameter id to every parameterizable $eq, $lt, $lte, $gt and $gte in 'tree'.
+ * The ids are assigned in pre-order, starting from zero, so two normalized expressions of the
+ * same shape get the same ids at the same positions.
+ */
+void parameterize(MatchExpression* tree);
+
+/**
+ * Returns the values of the input parameters of 'tree', indexed by their id. Ids missing from the
+ * tree map to an EOO element.
+ */
+std::vector<BSONElement> collectInputParams(const MatchExpression* tree);
+
+}  // namespace mongo::expression
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_parameterization.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& obj) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    return unittest::assertGet(MatchExpressionParser::parse(obj, std::move(expCtx)));
+}
+
+const ComparisonMatchExpression* comparisonAt(const MatchExpression* tree, size_t index) {
+    auto child = tree->getChild(index);
+    ASSERT(ComparisonMatchExpression::isComparisonMatchExpression(child));
+    return static_cast<const ComparisonMatchExpression*>(child);
+}
+
+void assertParamId(const MatchExpression* tree, size_t index, InputParamId expected) {
+    auto paramId = comparisonAt(tree, index)->getInputParamId();
+    ASSERT(paramId);
+    ASSERT_EQ(*paramId, expected);
+}
+
+TEST(MatchExpressionParameterizationTest, AssignsIdsInPreOrder) {
+    BSONObj query = fromjson("{a: 1, b: {$gt: 'x'}, $or: [{c: {$lte: 2.5}}, {d: {$lt: 3}}]}");
+    auto expr = parse(query);
+    expression::parameterize(expr.get());
+
+    ASSERT_EQ(expr->numChildren(), 3U);
+    assertParamId(expr.get(), 0, 0);
+    assertParamId(expr.get(), 1, 1);
+    auto orExpr = expr->getChild(2);
+    assertParamId(orExpr, 0, 2);
+    assertParamId(orExpr, 1, 3);
+}
+
+TEST(MatchExpressionParameterizationTest, SkipsValuesWhichAffectThePlanShape) {
+    BSONObj query = fromjson(
+        "{a: null, b: {$gt: NaN}, c: {$lt: {$maxKey: 1}}, d: [1, 2], e: {$eq: {x: 1}}, "
+        "f: {$eq: /abc/}, g: {$gte: {$minKey: 1}}, h: {$lte: true}}");
+    auto expr = parse(query);
+    expression::parameterize(expr.get());
+
+    ASSERT_EQ(expr->numChildren(), 8U);
+    for (size_t i = 0; i < 7; ++i) {
+        ASSERT_FALSE(comparisonAt(expr.get(), i)->getInputParamId());
+    }
+    assertParamId(expr.get(), 7, 0);
+}
+
+TEST(MatchExpressionParameterizationTest, CollectsParamsById) {
+    BSONObj query = fromjson("{a: 1, b: null, c: {$gte: 'str'}}");
+    auto expr = parse(query);
+    expression::parameterize(expr.get());
+
+    auto params = expression::collectInputParams(expr.get());
+    ASSERT_EQ(params.size(), 2U);
+    ASSERT_EQ(params[0].numberInt(), 1);
+    ASSERT_EQ(params[1].str(), "str");
+}
+
+TEST(MatchExpressionParameterizationTest, ShallowClonePreservesParamId) {
+    BSONObj query = fromjson("{a: {$lt: 5}}");
+    auto expr = parse(query);
+    expression::parameterize(expr.get());
+
+    auto clone = expr->shallowClone();
+    ASSERT(ComparisonMatchExpression::isComparisonMatchExpression(clone.get()));
+    auto paramId = static_cast<const ComparisonMatchExpression*>(clone.get())->getInputParamId();
+    ASSERT(paramId);
+    ASSERT_EQ(*paramId, 0);
+}
+
+}  // namespace
+}  // namespace mongo
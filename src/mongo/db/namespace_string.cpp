@@ -50,6 +50,7 @@ constexpr StringData NamespaceString::kAdminDb;
 constexpr StringData NamespaceString::kLocalDb;
 constexpr StringData NamespaceString::kConfigDb;
 constexpr StringData NamespaceString::kSystemDotViewsCollectionName;
+constexpr StringData NamespaceString::kSystemDotStatisticsCollectionName;
 constexpr StringData NamespaceString::kOrphanCollectionPrefix;
 constexpr StringData NamespaceString::kOrphanCollectionDb;
 
@@ -143,12 +144,19 @@ bool NamespaceString::isLegalClientSystemNS() const {
         return true;
     if (coll() == kSystemDotViewsCollectionName)
         return true;
+    if (coll() == kSystemDotStatisticsCollectionName)
+        return true;
     if (isTemporaryReshardingCollection()) {
         return true;
     }
     if (isTimeseriesBucketsCollection()) {
         return true;
     }
+    // Cloned along with the materialized view, but not written to by clients, see
+    // userAllowedWriteNS().
+    if (isMaterializedViewCollection()) {
+        return true;
+    }
 
     return false;
 }
@@ -288,6 +296,15 @@ NamespaceString NamespaceString::makeTimeseriesBucketsNamespace() const {
     return {db(), bucketsColl};
 }
 
+bool NamespaceString::isMaterializedViewCollection() const {
+    return coll().startsWith(kMaterializedViewCollectionPrefix);
+}
+
+NamespaceString NamespaceString::makeMaterializedViewNamespace() const {
+    auto materializedColl = kMaterializedViewCollectionPrefix.toString() + coll();
+    return {db(), materializedColl};
+}
+
 bool NamespaceString::isReplicated() const {
     if (isLocal()) {
         return false;
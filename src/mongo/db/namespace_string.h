@@ -65,6 +65,9 @@ public:
     // Name for the system views collection
     static constexpr StringData kSystemDotViewsCollectionName = "system.views"_sd;
 
+    // Name for the collection holding the query planner statistics of the database's collections
+    static constexpr StringData kSystemDotStatisticsCollectionName = "system.statistics"_sd;
+
     // Names of privilege document collections
     static constexpr StringData kSystemUsers = "system.users"_sd;
     static constexpr StringData kSystemRoles = "system.roles"_sd;
@@ -79,6 +82,9 @@ public:
     // Prefix for time-series buckets collection.
     static constexpr StringData kTimeseriesBucketsCollectionPrefix = "system.buckets."_sd;
 
+    // Prefix for the collection holding the contents of a materialized view.
+    static constexpr StringData kMaterializedViewCollectionPrefix = "system.materialized."_sd;
+
     // Namespace for storing configuration data, which needs to be replicated if the server is
     // running as a replica set. Documents in this collection should represent some configuration
     // state of the server, which needs to be recovered/consulted at startup. Each document in this
@@ -262,6 +268,9 @@ public:
     bool isSystemDotViews() const {
         return coll() == kSystemDotViewsCollectionName;
     }
+    bool isSystemDotStatistics() const {
+        return coll() == kSystemDotStatisticsCollectionName;
+    }
     bool isServerConfigurationCollection() const {
         return (db() == kAdminDb) && (coll() == "system.version");
     }
@@ -320,6 +329,16 @@ public:
      */
     NamespaceString makeTimeseriesBucketsNamespace() const;
 
+    /**
+     * Returns whether the specified namespace is <database>.system.materialized.<>.
+     */
+    bool isMaterializedViewCollection() const;
+
+    /**
+     * Returns the namespace of the collection holding the contents of this materialized view.
+     */
+    NamespaceString makeMaterializedViewNamespace() const;
+
     /**
      * Returns whether a namespace is replicated, based only on its string value. One notable
      * omission is that map reduce `tmp.mr` collections may or may not be replicated. Callers must
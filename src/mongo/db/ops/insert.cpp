@@ -178,7 +178,10 @@ StatusWith<BSONObj> fixDocumentForInsert(OperationContext* opCtx, const BSONObj&
 
 Status userAllowedWriteNS(const NamespaceString& ns) {
     // TODO (SERVER-49545): Remove the FCV check when 5.0 becomes last-lts.
-    if (ns.isSystemDotProfile() ||
+    // The statistics in 'system.statistics' are only written by the 'analyze' command, and the
+    // groups of a materialized view only by the writes to the collection it is defined on.
+    if (ns.isSystemDotProfile() || ns.isSystemDotStatistics() ||
+        ns.isMaterializedViewCollection() ||
         (ns.isSystemDotViews() && serverGlobalParams.featureCompatibility.isVersionInitialized() &&
          serverGlobalParams.featureCompatibility.isGreaterThanOrEqualTo(
              ServerGlobalParams::FeatureCompatibility::Version::kVersion47)) ||
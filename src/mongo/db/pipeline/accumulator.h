@@ -245,6 +245,7 @@ public:
 
 private:
     BSONType totalType = NumberInt;
+    long long longTotal = 0;
     DoubleDoubleSummation nonDecimalTotal;
     Decimal128 decimalTotal;
 };
@@ -67,13 +67,24 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
         return;
     }
 
+    // Integers are added to 'longTotal', and only go through the compensated sum once it would
+    // overflow.
+    const BSONType type = input.getType();
+    if (type == NumberInt || type == NumberLong) {
+        if (type == NumberLong && totalType == NumberInt)
+            totalType = NumberLong;
+        long long nextTotal;
+        if (overflow::add(longTotal, input.coerceToLong(), &nextTotal)) {
+            nonDecimalTotal.addLong(longTotal);
+            nextTotal = input.coerceToLong();
+        }
+        longTotal = nextTotal;
+        return;
+    }
+
     // Upgrade to the widest type required to hold the result.
-    totalType = Value::getWidestNumeric(totalType, input.getType());
-    switch (input.getType()) {
-        case NumberInt:
-        case NumberLong:
-            nonDecimalTotal.addLong(input.coerceToLong());
-            break;
+    totalType = Value::getWidestNumeric(totalType, type);
+    switch (type) {
         case NumberDouble:
             nonDecimalTotal.addDouble(input.getDouble());
             break;
@@ -90,6 +101,9 @@ intrusive_ptr<AccumulatorState> AccumulatorSum::create(ExpressionContext* const
 }
 
 Value AccumulatorSum::getValue(bool toBeMerged) {
+    nonDecimalTotal.addLong(longTotal);
+    longTotal = 0;
+
     switch (totalType) {
         case NumberInt:
             if (nonDecimalTotal.fitsLong())
@@ -133,6 +147,7 @@ AccumulatorSum::AccumulatorSum(ExpressionContext* const expCtx) : AccumulatorSta
 
 void AccumulatorSum::reset() {
     totalType = NumberInt;
+    longTotal = 0;
     nonDecimalTotal = {};
     decimalTotal = {};
 }
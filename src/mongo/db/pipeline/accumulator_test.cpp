@@ -320,6 +320,13 @@ TEST(Accumulators, Sum) {
          // Two doubles overflow to infinity.
          {{Value(numeric_limits<double>::max()), Value(numeric_limits<double>::max())},
           Value(numeric_limits<double>::infinity())},
+         // Integers which overflow part way through the sum are summed exactly.
+         {{Value(numeric_limits<long long>::max()), Value(1), Value(-1LL)},
+          Value(numeric_limits<long long>::max())},
+         {{Value(numeric_limits<long long>::min()), Value(-1), Value(1), Value(-1), Value(2)},
+          Value(numeric_limits<long long>::min() + 1)},
+         // Integers on either side of a double.
+         {{Value(1), Value(2.5), Value(3LL)}, Value(6.5)},
          // Two large integers do not overflow if a double is added later.
          {{Value(numeric_limits<long long>::max()),
            Value(numeric_limits<long long>::max()),
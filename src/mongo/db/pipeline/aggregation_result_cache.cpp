@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/aggregation_result_cache.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/aggregation_result_cache_gen.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+const auto getAggregationResultCache =
+    ServiceContext::declareDecoration<AggregationResultCache>();
+
+const auto getReadSequenceDecoration =
+    OperationContext::declareDecoration<boost::optional<uint64_t>>();
+
+Counter64 aggregationResultCacheHitsCounter;
+Counter64 aggregationResultCacheMissesCounter;
+Counter64 aggregationResultCacheEvictionsCounter;
+
+ServerStatusMetricField<Counter64> displayAggregationResultCacheHits(
+    "query.aggregationResultCache.hits", &aggregationResultCacheHitsCounter);
+ServerStatusMetricField<Counter64> displayAggregationResultCacheMisses(
+    "query.aggregationResultCache.misses", &aggregationResultCacheMissesCounter);
+ServerStatusMetricField<Counter64> displayAggregationResultCacheEvictions(
+    "query.aggregationResultCache.evictions", &aggregationResultCacheEvictionsCounter);
+
+size_t getMaxSizeBytes() {
+    return static_cast<size_t>(gInternalQueryAggregationResultCacheMaxSizeBytes.load());
+}
+
+}  // namespace
+
+AggregationResultCache* AggregationResultCache::get(ServiceContext* service) {
+    return &getAggregationResultCache(service);
+}
+
+AggregationResultCache* AggregationResultCache::get(OperationContext* opCtx) {
+    return get(opCtx->getServiceContext());
+}
+
+bool AggregationResultCache::isEnabled() {
+    return gInternalQueryAggregationResultCacheMaxSizeBytes.load() > 0;
+}
+
+Status AggregationResultCache::onUpdateMaxSizeBytes(const long long& maxSizeBytes) {
+    if (hasGlobalServiceContext()) {
+        get(getGlobalServiceContext())->clear();
+    }
+    return Status::OK();
+}
+
+uint64_t AggregationResultCache::getReadSequence(OperationContext* opCtx) {
+    auto& readSequence = getReadSequenceDecoration(opCtx);
+    if (!readSequence) {
+        stdx::lock_guard<Latch> lk(_mutex);
+        readSequence = _writeSequence;
+    }
+    return *readSequence;
+}
+
+boost::optional<std::vector<BSONObj>> AggregationResultCache::lookup(const std::string& key) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        aggregationResultCacheMissesCounter.increment();
+        return boost::none;
+    }
+
+    if (!_isCurrent(lk, it->second)) {
+        _sizeBytes -= it->second.sizeBytes;
+        _entries.erase(it);
+        aggregationResultCacheMissesCounter.increment();
+        return boost::none;
+    }
+
+    aggregationResultCacheHitsCounter.increment();
+    return it->second.results;
+}
+
+void AggregationResultCache::insert(const std::string& key,
+                                    std::vector<BSONObj> results,
+                                    std::vector<NamespaceString> dependencies,
+                                    uint64_t readSequence) {
+    size_t sizeBytes = key.size();
+    for (auto&& result : results) {
+        result = result.getOwned();
+        sizeBytes += result.objsize();
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    const auto maxSizeBytes = getMaxSizeBytes();
+    if (sizeBytes > maxSizeBytes) {
+        return;
+    }
+
+    Entry entry{std::move(results), std::move(dependencies), readSequence, sizeBytes};
+    if (!_isCurrent(lk, entry)) {
+        return;
+    }
+
+    if (auto it = _entries.cfind(key); it != _entries.cend()) {
+        _sizeBytes -= it->second.sizeBytes;
+    }
+    _entries.add(key, std::move(entry));
+    _sizeBytes += sizeBytes;
+    _evictDownTo(lk, maxSizeBytes);
+}
+
+void AggregationResultCache::noteWrite(const NamespaceString& nss) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    _lastWrites[nss.ns()] = ++_writeSequence;
+}
+
+void AggregationResultCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _entries.clear();
+    _sizeBytes = 0;
+
+    // The writes made before now no longer need to be remembered, since the results read before
+    // now are not cached.
+    _lastWrites.clear();
+    _clearedAtSequence = ++_writeSequence;
+}
+
+size_t AggregationResultCache::getNumEntries() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _entries.size();
+}
+
+size_t AggregationResultCache::getSizeBytes() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _sizeBytes;
+}
+
+bool AggregationResultCache::_isCurrent(WithLock, const Entry& entry) const {
+    if (entry.readSequence < _clearedAtSequence) {
+        return false;
+    }
+
+    for (auto&& nss : entry.dependencies) {
+        auto it = _lastWrites.find(nss.ns());
+        if (it != _lastWrites.end() && it->second > entry.readSequence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AggregationResultCache::_evictDownTo(WithLock, size_t maxSizeBytes) {
+    while (_sizeBytes > maxSizeBytes && _entries.size() > 0) {
+        auto lru = std::prev(_entries.end());
+        _sizeBytes -= lru->second.sizeBytes;
+        _entries.erase(lru);
+        aggregationResultCacheEvictionsCounter.increment();
+    }
+}
+
+}  // namespace mongo
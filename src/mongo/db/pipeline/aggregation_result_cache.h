@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/lru_cache.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * A cache of the results of read-only aggregations, shared by all of the aggregate commands run on
+ * a node. An entry is keyed by the shape of the optimized pipeline and what it runs on, and
+ * remembers the namespaces its results were read from. It is only served while none of those
+ * namespaces has been written to since the aggregation which filled it began to read.
+ *
+ * Writes are ordered by a sequence number, which is advanced as each write commits and remembered
+ * as the last write to the namespace written to. The cache holds at most
+ * internalQueryAggregationResultCacheMaxSizeBytes worth of results, evicting the least recently
+ * used entries beyond that, and is disabled when that is 0.
+ */
+class AggregationResultCache {
+    AggregationResultCache(const AggregationResultCache&) = delete;
+    AggregationResultCache& operator=(const AggregationResultCache&) = delete;
+
+public:
+    AggregationResultCache() = default;
+
+    static AggregationResultCache* get(ServiceContext* service);
+    static AggregationResultCache* get(OperationContext* opCtx);
+
+    static bool isEnabled();
+
+    /**
+     * Empties the cache whenever its maximum size is changed, since it may have been disabled
+     * while writes were made which were not noted.
+     */
+    static Status onUpdateMaxSizeBytes(const long long& maxSizeBytes);
+
+    /**
+     * Returns the write sequence number as of the first time this is called for 'opCtx'. It must be
+     * called before the operation opens its storage snapshot, so that every write which the
+     * snapshot might not see is ordered after it.
+     */
+    uint64_t getReadSequence(OperationContext* opCtx);
+
+    /**
+     * Returns the results cached under 'key', unless there are none or some of the namespaces they
+     * were read from have been written to since.
+     */
+    boost::optional<std::vector<BSONObj>> lookup(const std::string& key);
+
+    /**
+     * Caches 'results', read from 'dependencies' by an aggregation for which getReadSequence()
+     * returned 'readSequence'. Results read before a write which has since committed to one of
+     * 'dependencies', or too large for the cache, are not cached.
+     */
+    void insert(const std::string& key,
+                std::vector<BSONObj> results,
+                std::vector<NamespaceString> dependencies,
+                uint64_t readSequence);
+
+    /**
+     * Records that a write to 'nss' has committed, invalidating the results read from it before.
+     */
+    void noteWrite(const NamespaceString& nss);
+
+    /**
+     * Drops every cached result, for when data may have changed without noteWrite() being called,
+     * e.g. by a rollback or while the cache was disabled.
+     */
+    void clear();
+
+    size_t getNumEntries() const;
+    size_t getSizeBytes() const;
+
+private:
+    struct Entry {
+        std::vector<BSONObj> results;
+        std::vector<NamespaceString> dependencies;
+        uint64_t readSequence;
+        size_t sizeBytes;
+    };
+
+    bool _isCurrent(WithLock, const Entry& entry) const;
+
+    void _evictDownTo(WithLock, size_t maxSizeBytes);
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("AggregationResultCache::_mutex");
+
+    uint64_t _writeSequence = 0;
+
+    // Results read before the last clear() may have missed writes which were not noted.
+    uint64_t _clearedAtSequence = 0;
+
+    // The sequence number of the last write to each namespace written to while the cache was
+    // enabled.
+    StringMap<uint64_t> _lastWrites;
+
+    // The number of entries is only bounded by their total size.
+    LRUCache<std::string, Entry> _entries{std::numeric_limits<size_t>::max()};
+    size_t _sizeBytes = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/aggregation_result_cache_op_observer.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/aggregation_result_cache.h"
+
+namespace mongo {
+
+void AggregationResultCacheOpObserver::onInserts(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 OptionalCollectionUUID uuid,
+                                                 std::vector<InsertStatement>::const_iterator first,
+                                                 std::vector<InsertStatement>::const_iterator last,
+                                                 bool fromMigrate) {
+    _noteWriteOnCommit(opCtx, nss);
+}
+
+void AggregationResultCacheOpObserver::onUpdate(OperationContext* opCtx,
+                                                const OplogUpdateEntryArgs& args) {
+    _noteWriteOnCommit(opCtx, args.nss);
+}
+
+void AggregationResultCacheOpObserver::onDelete(OperationContext* opCtx,
+                                                const NamespaceString& nss,
+                                                OptionalCollectionUUID uuid,
+                                                StmtId stmtId,
+                                                bool fromMigrate,
+                                                const boost::optional<BSONObj>& deletedDoc) {
+    _noteWriteOnCommit(opCtx, nss);
+}
+
+void AggregationResultCacheOpObserver::onCollMod(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 OptionalCollectionUUID uuid,
+                                                 const BSONObj& collModCmd,
+                                                 const CollectionOptions& oldCollOptions,
+                                                 boost::optional<IndexCollModInfo> indexInfo) {
+    // A collMod may change what an aggregation on 'nss' reads, e.g. the pipeline of a view.
+    _noteWriteOnCommit(opCtx, nss);
+}
+
+void AggregationResultCacheOpObserver::onDropDatabase(OperationContext* opCtx,
+                                                      const std::string& dbName) {
+    // The namespaces of the database are not listed here, and dropping a database is rare enough
+    // for dropping every cached result instead.
+    AggregationResultCache::get(opCtx)->clear();
+}
+
+repl::OpTime AggregationResultCacheOpObserver::onDropCollection(
+    OperationContext* opCtx,
+    const NamespaceString& collectionName,
+    OptionalCollectionUUID uuid,
+    std::uint64_t numRecords,
+    const CollectionDropType dropType) {
+    _noteWriteOnCommit(opCtx, collectionName);
+    return {};
+}
+
+void AggregationResultCacheOpObserver::onRenameCollection(OperationContext* opCtx,
+                                                          const NamespaceString& fromCollection,
+                                                          const NamespaceString& toCollection,
+                                                          OptionalCollectionUUID uuid,
+                                                          OptionalCollectionUUID dropTargetUUID,
+                                                          std::uint64_t numRecords,
+                                                          bool stayTemp) {
+    _noteWriteOnCommit(opCtx, fromCollection);
+    _noteWriteOnCommit(opCtx, toCollection);
+}
+
+void AggregationResultCacheOpObserver::postRenameCollection(OperationContext* opCtx,
+                                                            const NamespaceString& fromCollection,
+                                                            const NamespaceString& toCollection,
+                                                            OptionalCollectionUUID uuid,
+                                                            OptionalCollectionUUID dropTargetUUID,
+                                                            bool stayTemp) {
+    _noteWriteOnCommit(opCtx, fromCollection);
+    _noteWriteOnCommit(opCtx, toCollection);
+}
+
+void AggregationResultCacheOpObserver::onImportCollection(OperationContext* opCtx,
+                                                          const UUID& importUUID,
+                                                          const NamespaceString& nss,
+                                                          long long numRecords,
+                                                          long long dataSize,
+                                                          const BSONObj& catalogEntry,
+                                                          const BSONObj& storageMetadata,
+                                                          bool isDryRun) {
+    _noteWriteOnCommit(opCtx, nss);
+}
+
+void AggregationResultCacheOpObserver::onEmptyCapped(OperationContext* opCtx,
+                                                     const NamespaceString& collectionName,
+                                                     OptionalCollectionUUID uuid) {
+    _noteWriteOnCommit(opCtx, collectionName);
+}
+
+void AggregationResultCacheOpObserver::onReplicationRollback(OperationContext* opCtx,
+                                                             const RollbackObserverInfo& rbInfo) {
+    AggregationResultCache::get(opCtx)->clear();
+}
+
+void AggregationResultCacheOpObserver::_noteWriteOnCommit(OperationContext* opCtx,
+                                                          const NamespaceString& nss) {
+    // This is registered even while the cache is disabled, since it may be enabled before the write
+    // commits, and then serve results read without the write.
+    opCtx->recoveryUnit()->onCommit(
+        [service = opCtx->getServiceContext(), nss](boost::optional<Timestamp>) {
+            AggregationResultCache::get(service)->noteWrite(nss);
+        });
+}
+
+}  // namespace mongo
@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/aggregation_result_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/aggregation_result_cache_gen.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test", "coll");
+const NamespaceString kOtherNss("test", "other");
+
+class AggregationResultCacheTest : public ServiceContextTest {
+public:
+    void setUp() override {
+        _savedMaxSizeBytes = gInternalQueryAggregationResultCacheMaxSizeBytes.load();
+        gInternalQueryAggregationResultCacheMaxSizeBytes.store(1024 * 1024);
+    }
+
+    void tearDown() override {
+        gInternalQueryAggregationResultCacheMaxSizeBytes.store(_savedMaxSizeBytes);
+    }
+
+    AggregationResultCache* cache() {
+        return AggregationResultCache::get(getServiceContext());
+    }
+
+    /**
+     * Returns the write sequence number as of now, as a new operation would see it.
+     */
+    uint64_t readSequence() {
+        auto opCtx = makeOperationContext();
+        return cache()->getReadSequence(opCtx.get());
+    }
+
+    static std::vector<BSONObj> makeResults(int n) {
+        std::vector<BSONObj> results;
+        for (int i = 0; i < n; ++i) {
+            results.push_back(BSON("_id" << i));
+        }
+        return results;
+    }
+
+private:
+    long long _savedMaxSizeBytes;
+};
+
+TEST_F(AggregationResultCacheTest, ServesResultsUntilDependencyIsWritten) {
+    ASSERT_FALSE(cache()->lookup("key"));
+
+    cache()->insert("key", makeResults(3), {kNss}, readSequence());
+    auto results = cache()->lookup("key");
+    ASSERT(results);
+    ASSERT_EQ(3U, results->size());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), (*results)[2]);
+
+    cache()->noteWrite(kOtherNss);
+    ASSERT(cache()->lookup("key"));
+
+    cache()->noteWrite(kNss);
+    ASSERT_FALSE(cache()->lookup("key"));
+    ASSERT_EQ(0U, cache()->getNumEntries());
+    ASSERT_EQ(0U, cache()->getSizeBytes());
+}
+
+TEST_F(AggregationResultCacheTest, DoesNotCacheResultsReadBeforeAWrite) {
+    auto sequence = readSequence();
+    cache()->noteWrite(kNss);
+    cache()->insert("key", makeResults(1), {kOtherNss, kNss}, sequence);
+    ASSERT_FALSE(cache()->lookup("key"));
+
+    // The write was made before the second read began, so the second read saw it.
+    cache()->insert("key", makeResults(1), {kOtherNss, kNss}, readSequence());
+    ASSERT(cache()->lookup("key"));
+}
+
+TEST_F(AggregationResultCacheTest, ReadSequenceIsTakenOncePerOperation) {
+    auto opCtx = makeOperationContext();
+    auto sequence = cache()->getReadSequence(opCtx.get());
+    cache()->noteWrite(kNss);
+    ASSERT_EQ(sequence, cache()->getReadSequence(opCtx.get()));
+    ASSERT_GT(readSequence(), sequence);
+}
+
+TEST_F(AggregationResultCacheTest, WritesAreNotNotedWhileDisabled) {
+    cache()->insert("key", makeResults(1), {kNss}, readSequence());
+
+    gInternalQueryAggregationResultCacheMaxSizeBytes.store(0);
+    ASSERT_FALSE(AggregationResultCache::isEnabled());
+    cache()->noteWrite(kNss);
+    gInternalQueryAggregationResultCacheMaxSizeBytes.store(1024 * 1024);
+
+    // Only changing the size through the server parameter empties the cache.
+    ASSERT(cache()->lookup("key"));
+    ASSERT_OK(AggregationResultCache::onUpdateMaxSizeBytes(1024 * 1024));
+    ASSERT_FALSE(cache()->lookup("key"));
+}
+
+TEST_F(AggregationResultCacheTest, ClearDropsResultsReadBeforeIt) {
+    auto sequence = readSequence();
+    cache()->insert("key", makeResults(1), {kNss}, sequence);
+    cache()->clear();
+    ASSERT_FALSE(cache()->lookup("key"));
+
+    cache()->insert("key", makeResults(1), {kNss}, sequence);
+    ASSERT_FALSE(cache()->lookup("key"));
+
+    cache()->insert("key", makeResults(1), {kNss}, readSequence());
+    ASSERT(cache()->lookup("key"));
+}
+
+TEST_F(AggregationResultCacheTest, EvictsLeastRecentlyUsedEntriesBeyondMaxSize) {
+    const auto results = makeResults(10);
+    size_t resultsSize = 0;
+    for (auto&& result : results) {
+        resultsSize += result.objsize();
+    }
+
+    // Room for two entries, counting their keys.
+    gInternalQueryAggregationResultCacheMaxSizeBytes.store(2 * (resultsSize + 1));
+    cache()->insert("a", results, {kNss}, readSequence());
+    cache()->insert("b", results, {kNss}, readSequence());
+    ASSERT_EQ(2U, cache()->getNumEntries());
+    ASSERT_EQ(2 * (resultsSize + 1), cache()->getSizeBytes());
+
+    // Looking up "a" makes "b" the least recently used entry.
+    ASSERT(cache()->lookup("a"));
+    cache()->insert("c", results, {kNss}, readSequence());
+    ASSERT_EQ(2U, cache()->getNumEntries());
+    ASSERT(cache()->lookup("a"));
+    ASSERT_FALSE(cache()->lookup("b"));
+    ASSERT(cache()->lookup("c"));
+
+    // Replacing an entry does not count it twice.
+    cache()->insert("c", results, {kNss}, readSequence());
+    ASSERT_EQ(2 * (resultsSize + 1), cache()->getSizeBytes());
+}
+
+TEST_F(AggregationResultCacheTest, DoesNotCacheResultsLargerThanMaxSize) {
+    gInternalQueryAggregationResultCacheMaxSizeBytes.store(64);
+    cache()->insert("key", makeResults(10), {kNss}, readSequence());
+    ASSERT_FALSE(cache()->lookup("key"));
+    ASSERT_EQ(0U, cache()->getSizeBytes());
+}
+
+}  // namespace
+}  // namespace mongo
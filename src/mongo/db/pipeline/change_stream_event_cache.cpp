@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_event_cache.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/pipeline/change_stream_event_cache_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+namespace {
+
+const auto getChangeStreamEventCache = ServiceContext::declareDecoration<ChangeStreamEventCache>();
+
+AtomicWord<long long> numRegisteredChangeStreams;
+
+Counter64 changeStreamEventCacheHitsCounter;
+Counter64 changeStreamEventCacheMissesCounter;
+
+ServerStatusMetricField<Counter64> displayChangeStreamEventCacheHits(
+    "changeStreams.eventCache.hits", &changeStreamEventCacheHitsCounter);
+ServerStatusMetricField<Counter64> displayChangeStreamEventCacheMisses(
+    "changeStreams.eventCache.misses", &changeStreamEventCacheMissesCounter);
+
+}  // namespace
+
+ChangeStreamEventCache::Registration::Registration() {
+    numRegisteredChangeStreams.fetchAndAdd(1);
+}
+
+ChangeStreamEventCache::Registration::~Registration() {
+    numRegisteredChangeStreams.fetchAndSubtract(1);
+}
+
+ChangeStreamEventCache* ChangeStreamEventCache::get(ServiceContext* service) {
+    return &getChangeStreamEventCache(service);
+}
+
+bool ChangeStreamEventCache::shouldShareEvents() {
+    // A single change stream would only fill the cache with events no other stream reads.
+    return gInternalChangeStreamEventCacheMaxSizeBytes.load() > 0 &&
+        numRegisteredChangeStreams.load() > 1;
+}
+
+Status ChangeStreamEventCache::onUpdateMaxSizeBytes(const long long& maxSizeBytes) {
+    if (hasGlobalServiceContext()) {
+        get(getGlobalServiceContext())->clear();
+    }
+    return Status::OK();
+}
+
+std::string ChangeStreamEventCache::makeKey(Timestamp ts,
+                                            long long term,
+                                            bool includePreImageOpTime,
+                                            const std::vector<FieldPath>& documentKeyFields) {
+    BSONObjBuilder keyBuilder;
+    keyBuilder.append("ts", ts);
+    keyBuilder.append("t", term);
+    keyBuilder.append("includePreImageOpTime", includePreImageOpTime);
+    BSONArrayBuilder documentKeyFieldsBuilder(keyBuilder.subarrayStart("documentKeyFields"));
+    for (auto&& field : documentKeyFields) {
+        documentKeyFieldsBuilder.append(field.fullPath());
+    }
+    documentKeyFieldsBuilder.doneFast();
+    auto key = keyBuilder.done();
+    return std::string(key.objdata(), key.objsize());
+}
+
+boost::optional<BSONObj> ChangeStreamEventCache::lookup(const std::string& key) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        changeStreamEventCacheMissesCounter.increment();
+        return boost::none;
+    }
+
+    changeStreamEventCacheHitsCounter.increment();
+    return it->second;
+}
+
+void ChangeStreamEventCache::insert(const std::string& key, BSONObj event) {
+    const size_t sizeBytes = key.size() + event.objsize();
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    const auto maxSizeBytes =
+        static_cast<size_t>(gInternalChangeStreamEventCacheMaxSizeBytes.load());
+    if (sizeBytes > maxSizeBytes) {
+        return;
+    }
+
+    if (auto it = _entries.cfind(key); it != _entries.cend()) {
+        _sizeBytes -= it->first.size() + it->second.objsize();
+    }
+    _entries.add(key, event.getOwned());
+    _sizeBytes += sizeBytes;
+    _evictDownTo(lk, maxSizeBytes);
+}
+
+void ChangeStreamEventCache::clear() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    _entries.clear();
+    _sizeBytes = 0;
+}
+
+size_t ChangeStreamEventCache::getNumEntries() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _entries.size();
+}
+
+size_t ChangeStreamEventCache::getSizeBytes() const {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _sizeBytes;
+}
+
+void ChangeStreamEventCache::_evictDownTo(WithLock, size_t maxSizeBytes) {
+    while (_sizeBytes > maxSizeBytes && _entries.size() > 0) {
+        auto lru = std::prev(_entries.end());
+        _sizeBytes -= lru->first.size() + lru->second.objsize();
+        _entries.erase(lru);
+    }
+}
+
+}  // namespace mongo
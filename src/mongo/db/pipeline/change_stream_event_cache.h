@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/lru_cache.h"
+
+namespace mongo {
+
+class ServiceContext;
+
+/**
+ * A cache of the change events which DocumentSourceChangeStreamTransform builds from CRUD oplog
+ * entries, so that a change stream reading an entry which another stream on the node has already
+ * transformed can rebuild the event from the cache. Each stream still reads the oplog itself; only
+ * the transformation of an entry into an event is saved. An event is keyed by the optime of the
+ * entry it was transformed from and by the options of the stream which change the transformation.
+ * Since no two entries ever share an optime, including across rollbacks, a cached event never
+ * needs to be invalidated.
+ *
+ * The events are cached as BSON, since a Document may not be read from several threads at once.
+ *
+ * The cache holds at most internalChangeStreamEventCacheMaxSizeBytes worth of events, evicting
+ * the least recently used beyond that. It is disabled when that is 0, as it is by default, and is
+ * only used while more than one change stream is open.
+ */
+class ChangeStreamEventCache {
+    ChangeStreamEventCache(const ChangeStreamEventCache&) = delete;
+    ChangeStreamEventCache& operator=(const ChangeStreamEventCache&) = delete;
+
+public:
+    /**
+     * Counts an open change stream for as long as it exists.
+     */
+    class Registration {
+        Registration(const Registration&) = delete;
+        Registration& operator=(const Registration&) = delete;
+
+    public:
+        Registration();
+        ~Registration();
+    };
+
+    ChangeStreamEventCache() = default;
+
+    static ChangeStreamEventCache* get(ServiceContext* service);
+
+    /**
+     * Returns true if the change streams should share their events through the cache.
+     */
+    static bool shouldShareEvents();
+
+    /**
+     * Empties the cache whenever its maximum size is changed.
+     */
+    static Status onUpdateMaxSizeBytes(const long long& maxSizeBytes);
+
+    /**
+     * Returns the key of the event transformed from the entry at optime ('ts', 'term'), by a
+     * change stream which includes the pre-image optime if 'includePreImageOpTime', and which
+     * extracts 'documentKeyFields' from inserted documents.
+     */
+    static std::string makeKey(Timestamp ts,
+                               long long term,
+                               bool includePreImageOpTime,
+                               const std::vector<FieldPath>& documentKeyFields);
+
+    boost::optional<BSONObj> lookup(const std::string& key);
+
+    void insert(const std::string& key, BSONObj event);
+
+    void clear();
+
+    size_t getNumEntries() const;
+    size_t getSizeBytes() const;
+
+private:
+    void _evictDownTo(WithLock, size_t maxSizeBytes);
+
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("ChangeStreamEventCache::_mutex");
+
+    // The number of entries is only bounded by their total size.
+    LRUCache<std::string, BSONObj> _entries{std::numeric_limits<size_t>::max()};
+    size_t _sizeBytes = 0;
+};
+
+}  // namespace mongo
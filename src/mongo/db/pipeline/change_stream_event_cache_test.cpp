@@ -0,0 +1,146 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/change_stream_event_cache.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/change_stream_event_cache_gen.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class ChangeStreamEventCacheTest : public ServiceContextTest {
+public:
+    void setUp() override {
+        _savedMaxSizeBytes = gInternalChangeStreamEventCacheMaxSizeBytes.load();
+        gInternalChangeStreamEventCacheMaxSizeBytes.store(1024 * 1024);
+    }
+
+    void tearDown() override {
+        gInternalChangeStreamEventCacheMaxSizeBytes.store(_savedMaxSizeBytes);
+    }
+
+    ChangeStreamEventCache* cache() {
+        return ChangeStreamEventCache::get(getServiceContext());
+    }
+
+    static std::string makeKey(unsigned secs) {
+        return ChangeStreamEventCache::makeKey(Timestamp(secs, 1), 1, false, {});
+    }
+
+private:
+    long long _savedMaxSizeBytes;
+};
+
+TEST_F(ChangeStreamEventCacheTest, KeyDependsOnOpTimeAndTransformationOptions) {
+    const std::vector<FieldPath> idOnly{"_id"};
+    const std::vector<FieldPath> shardKeyAndId{"x", "_id"};
+    const std::vector<std::string> keys{
+        ChangeStreamEventCache::makeKey(Timestamp(1, 1), 1, false, idOnly),
+        ChangeStreamEventCache::makeKey(Timestamp(1, 2), 1, false, idOnly),
+        ChangeStreamEventCache::makeKey(Timestamp(1, 1), 2, false, idOnly),
+        ChangeStreamEventCache::makeKey(Timestamp(1, 1), 1, true, idOnly),
+        ChangeStreamEventCache::makeKey(Timestamp(1, 1), 1, false, shardKeyAndId),
+        ChangeStreamEventCache::makeKey(Timestamp(1, 1), 1, false, {}),
+    };
+    for (size_t i = 0; i < keys.size(); ++i) {
+        for (size_t j = i + 1; j < keys.size(); ++j) {
+            ASSERT_NE(keys[i], keys[j]);
+        }
+    }
+    ASSERT_EQ(keys[0], ChangeStreamEventCache::makeKey(Timestamp(1, 1), 1, false, idOnly));
+}
+
+TEST_F(ChangeStreamEventCacheTest, ServesInsertedEvents) {
+    ASSERT_FALSE(cache()->lookup(makeKey(1)));
+
+    cache()->insert(makeKey(1), BSON("operationType"
+                                     << "insert"));
+    auto event = cache()->lookup(makeKey(1));
+    ASSERT(event);
+    ASSERT_BSONOBJ_EQ(BSON("operationType"
+                           << "insert"),
+                      *event);
+    ASSERT_FALSE(cache()->lookup(makeKey(2)));
+}
+
+TEST_F(ChangeStreamEventCacheTest, EvictsLeastRecentlyUsedEventsBeyondMaxSize) {
+    const auto event = BSON("padding" << std::string(100, 'x'));
+    const size_t entrySize = makeKey(1).size() + event.objsize();
+    gInternalChangeStreamEventCacheMaxSizeBytes.store(2 * entrySize);
+
+    cache()->insert(makeKey(1), event);
+    cache()->insert(makeKey(2), event);
+    ASSERT_EQ(2U, cache()->getNumEntries());
+    ASSERT_EQ(2 * entrySize, cache()->getSizeBytes());
+
+    // Looking up the first event makes the second the least recently used.
+    ASSERT(cache()->lookup(makeKey(1)));
+    cache()->insert(makeKey(3), event);
+    ASSERT_EQ(2U, cache()->getNumEntries());
+    ASSERT(cache()->lookup(makeKey(1)));
+    ASSERT_FALSE(cache()->lookup(makeKey(2)));
+    ASSERT(cache()->lookup(makeKey(3)));
+
+    // Replacing an event does not count it twice.
+    cache()->insert(makeKey(3), event);
+    ASSERT_EQ(2 * entrySize, cache()->getSizeBytes());
+
+    // Events larger than the cache are not cached, and changing its size empties it.
+    gInternalChangeStreamEventCacheMaxSizeBytes.store(entrySize - 1);
+    cache()->insert(makeKey(4), event);
+    ASSERT_FALSE(cache()->lookup(makeKey(4)));
+    ASSERT_OK(ChangeStreamEventCache::onUpdateMaxSizeBytes(entrySize - 1));
+    ASSERT_EQ(0U, cache()->getNumEntries());
+    ASSERT_EQ(0U, cache()->getSizeBytes());
+}
+
+TEST_F(ChangeStreamEventCacheTest, EventsAreOnlySharedBetweenSeveralChangeStreams) {
+    boost::optional<ChangeStreamEventCache::Registration> first;
+    boost::optional<ChangeStreamEventCache::Registration> second;
+
+    first.emplace();
+    ASSERT_FALSE(ChangeStreamEventCache::shouldShareEvents());
+    second.emplace();
+    ASSERT_TRUE(ChangeStreamEventCache::shouldShareEvents());
+
+    gInternalChangeStreamEventCacheMaxSizeBytes.store(0);
+    ASSERT_FALSE(ChangeStreamEventCache::shouldShareEvents());
+    gInternalChangeStreamEventCacheMaxSizeBytes.store(1024 * 1024);
+
+    first.reset();
+    ASSERT_FALSE(ChangeStreamEventCache::shouldShareEvents());
+}
+
+}  // namespace
+}  // namespace mongo
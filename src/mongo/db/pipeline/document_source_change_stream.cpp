@@ -34,6 +34,7 @@
 #include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/db/bson/bson_helper.h"
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/document_source_change_stream_close_cursor.h"
@@ -102,8 +103,8 @@ static constexpr StringData kOplogMatchExplainName = "$_internalOplogMatch"_sd;
 }  // namespace
 
 intrusive_ptr<DocumentSourceOplogMatch> DocumentSourceOplogMatch::create(
-    BSONObj filter, const intrusive_ptr<ExpressionContext>& expCtx) {
-    return new DocumentSourceOplogMatch(std::move(filter), expCtx);
+    BSONObj filter, Timestamp startFromInclusive, const intrusive_ptr<ExpressionContext>& expCtx) {
+    return new DocumentSourceOplogMatch(std::move(filter), startFromInclusive, expCtx);
 }
 
 const char* DocumentSourceOplogMatch::getSourceName() const {
@@ -138,6 +139,43 @@ Value DocumentSourceOplogMatch::serialize(optional<ExplainOptions::Verbosity> ex
     return Value();
 }
 
+Pipeline::SourceContainer::iterator DocumentSourceOplogMatch::doOptimizeAt(
+    Pipeline::SourceContainer::iterator itr, Pipeline::SourceContainer* container) {
+    invariant(*itr == this);
+
+    // The oplog is always filtered with the simple collation, so a user $match which compares
+    // strings with another collation cannot be rewritten in terms of the oplog.
+    if (_hasPushedDownUserFilter || pExpCtx->getCollator()) {
+        return std::next(itr);
+    }
+
+    // None of the other stages of the $changeStream modify the fields which can be rewritten.
+    auto userStage = std::next(itr);
+    while (userStage != container->end() && (*userStage)->constraints().isChangeStreamStage()) {
+        ++userStage;
+    }
+    auto userMatch = userStage != container->end()
+        ? dynamic_cast<DocumentSourceMatch*>(userStage->get())
+        : nullptr;
+    if (!userMatch) {
+        return std::next(itr);
+    }
+
+    if (auto rewrittenFilter =
+            DocumentSourceChangeStream::rewriteFilterForOplog(userMatch->getMatchExpression())) {
+        // Commands, transactions and no-ops are always let through, since the events built from
+        // them are not covered by the rewritten filter, as are the entries of the resume token.
+        auto notCrudOp = BSON("op" << BSON("$nin" << BSON_ARRAY("i"
+                                                               << "u"
+                                                               << "d")));
+        auto resumeTokenTs = BSON("ts" << _startFromInclusive);
+        rebuild(BSON("$and" << BSON_ARRAY(getQuery() << BSON(
+                                              OR(notCrudOp, resumeTokenTs, *rewrittenFilter)))));
+        _hasPushedDownUserFilter = true;
+    }
+    return std::next(itr);
+}
+
 void DocumentSourceChangeStream::checkValueType(const Value v,
                                                 const StringData filedName,
                                                 BSONType expectedType) {
@@ -195,6 +233,111 @@ BSONObj getTxnApplyOpsFilter(BSONElement nsMatch, const NamespaceString& nss) {
     }
     return applyOpsBuilder.obj();
 }
+
+std::string regexEscape(StringData source) {
+    std::string result = "";
+    std::string escapes = "*+|()^?[]{}./\\$";
+    for (const char& c : source) {
+        if (escapes.find(c) != std::string::npos) {
+            result.append("\\");
+        }
+        result += c;
+    }
+    return result;
+}
+
+/**
+ * Returns a filter matching any of 'disjuncts', which is always false if there are none.
+ */
+BSONObj makeOrFilter(std::vector<BSONObj> disjuncts) {
+    if (disjuncts.empty()) {
+        return BSON("$alwaysFalse" << 1);
+    }
+    if (disjuncts.size() == 1) {
+        return disjuncts.front();
+    }
+    BSONArrayBuilder orBuilder;
+    for (auto&& disjunct : disjuncts) {
+        orBuilder.append(disjunct);
+    }
+    return BSON("$or" << orBuilder.arr());
+}
+
+/**
+ * Rewrites an equality to any of 'values' on the field 'path' of the change events into a filter
+ * on the CRUD oplog entries. Returns boost::none if 'path' cannot be rewritten. The values which no
+ * event built from a CRUD entry can be equal to are left out of the rewritten filter.
+ */
+boost::optional<BSONObj> rewriteEqualitiesForOplog(StringData path,
+                                                   const std::vector<BSONElement>& values) {
+    std::vector<BSONObj> disjuncts;
+    if (path == DocumentSourceChangeStream::kOperationTypeField) {
+        BSONArrayBuilder opTypes;
+        for (auto&& value : values) {
+            if (value.type() != BSONType::String) {
+                continue;
+            }
+            auto opType = value.valueStringData();
+            if (opType == DocumentSourceChangeStream::kInsertOpType) {
+                opTypes.append("i");
+            } else if (opType == DocumentSourceChangeStream::kDeleteOpType) {
+                opTypes.append("d");
+            } else if (opType == DocumentSourceChangeStream::kUpdateOpType ||
+                       opType == DocumentSourceChangeStream::kReplaceOpType) {
+                // Whether an update is reported as an "update" or a "replace" depends on the
+                // contents of its 'o' field, so both match all update entries.
+                opTypes.append("u");
+            }
+        }
+        return BSON("op" << BSON("$in" << opTypes.arr()));
+    } else if (path == DocumentSourceChangeStream::kNamespaceField) {
+        // The 'ns' of a CRUD event is exactly {db: <db>, coll: <coll>}.
+        for (auto&& value : values) {
+            if (value.type() != BSONType::Object || value.Obj().nFields() != 2) {
+                continue;
+            }
+            auto db = value.Obj()["db"];
+            auto coll = value.Obj()["coll"];
+            if (db.type() == BSONType::String && coll.type() == BSONType::String &&
+                value.Obj().firstElementFieldNameStringData() == "db"_sd) {
+                disjuncts.push_back(
+                    BSON("ns" << (db.str() + "." + coll.str())));
+            }
+        }
+    } else if (path == "ns.db"_sd || path == "ns.coll"_sd) {
+        // Database names cannot contain a '.', so the first one in the oplog 'ns' separates the
+        // database name from the collection name.
+        for (auto&& value : values) {
+            if (value.type() != BSONType::String) {
+                continue;
+            }
+            disjuncts.push_back(BSON(
+                "ns" << BSONRegEx(path == "ns.db"_sd
+                                      ? "^" + regexEscape(value.valueStringData()) + "\\."
+                                      : "^[^.]*\\." + regexEscape(value.valueStringData()) + "$")));
+        }
+    } else if (path == "documentKey._id"_sd) {
+        // The document key of an update is in its 'o2' field, and those of inserts and deletes in
+        // their 'o' field.
+        BSONArrayBuilder updateIds;
+        BSONArrayBuilder insertOrDeleteIds;
+        for (auto&& value : values) {
+            updateIds.append(BSON("o2._id" << BSON("$eq" << value)));
+            insertOrDeleteIds.append(BSON("o._id" << BSON("$eq" << value)));
+        }
+        if (!values.empty()) {
+            disjuncts.push_back(BSON("op"
+                                     << "u"
+                                     << "$or" << updateIds.arr()));
+            disjuncts.push_back(BSON("op" << BSON("$in" << BSON_ARRAY("i"
+                                                                      << "d"))
+                                          << "$or" << insertOrDeleteIds.arr()));
+        }
+    } else {
+        return boost::none;
+    }
+    return makeOrFilter(std::move(disjuncts));
+}
 }  // namespace
 
 DocumentSourceChangeStream::ChangeStreamType DocumentSourceChangeStream::getChangeStreamType(
@@ -208,18 +351,6 @@ DocumentSourceChangeStream::ChangeStreamType DocumentSourceChangeStream::getChan
 }
 
 std::string DocumentSourceChangeStream::getNsRegexForChangeStream(const NamespaceString& nss) {
-    auto regexEscape = [](const std::string& source) {
-        std::string result = "";
-        std::string escapes = "*+|()^?[]./\\$";
-        for (const char& c : source) {
-            if (escapes.find(c) != std::string::npos) {
-                result.append("\\");
-            }
-            result += c;
-        }
-        return result;
-    };
-
     auto type = getChangeStreamType(nss);
     switch (type) {
         case ChangeStreamType::kSingleCollection:
@@ -330,6 +461,54 @@ BSONObj DocumentSourceChangeStream::buildMatchFilter(
                                      << BSON(OR(opMatch, commandAndApplyOpsMatch))));
 }
 
+boost::optional<BSONObj> DocumentSourceChangeStream::rewriteFilterForOplog(
+    const MatchExpression* userFilter) {
+    switch (userFilter->matchType()) {
+        case MatchExpression::AND: {
+            // Any of the conjuncts which cannot be rewritten can be left out of the rewritten
+            // filter, which then matches more entries than it needs to.
+            BSONArrayBuilder andBuilder;
+            boost::optional<BSONObj> onlyConjunct;
+            size_t numRewritten = 0;
+            for (size_t i = 0; i < userFilter->numChildren(); ++i) {
+                if (auto rewritten = rewriteFilterForOplog(userFilter->getChild(i))) {
+                    andBuilder.append(*rewritten);
+                    onlyConjunct = std::move(rewritten);
+                    ++numRewritten;
+                }
+            }
+            if (numRewritten <= 1) {
+                return onlyConjunct;
+            }
+            return BSON("$and" << andBuilder.arr());
+        }
+        case MatchExpression::OR: {
+            std::vector<BSONObj> disjuncts;
+            for (size_t i = 0; i < userFilter->numChildren(); ++i) {
+                auto rewritten = rewriteFilterForOplog(userFilter->getChild(i));
+                if (!rewritten) {
+                    return boost::none;
+                }
+                disjuncts.push_back(std::move(*rewritten));
+            }
+            return makeOrFilter(std::move(disjuncts));
+        }
+        case MatchExpression::EQ: {
+            auto eq = static_cast<const EqualityMatchExpression*>(userFilter);
+            return rewriteEqualitiesForOplog(eq->path(), {eq->getData()});
+        }
+        case MatchExpression::MATCH_IN: {
+            auto in = static_cast<const InMatchExpression*>(userFilter);
+            if (!in->getRegexes().empty()) {
+                return boost::none;
+            }
+            return rewriteEqualitiesForOplog(in->path(), in->getEqualities());
+        }
+        default:
+            return boost::none;
+    }
+}
+
 namespace {
 
 list<intrusive_ptr<DocumentSource>> buildPipeline(const intrusive_ptr<ExpressionContext>& expCtx,
@@ -424,6 +603,7 @@ list<intrusive_ptr<DocumentSource>> buildPipeline(const intrusive_ptr<Expression
     // upon the fact that it is always the first stage in the pipeline.
     stages.push_back(DocumentSourceOplogMatch::create(
         DocumentSourceChangeStream::buildMatchFilter(expCtx, *startFrom, showMigrationEvents),
+        *startFrom,
         expCtx));
 
     // If we haven't already populated the initial PBRT, then we are starting from a specific
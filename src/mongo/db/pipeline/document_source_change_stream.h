@@ -174,6 +174,16 @@ public:
                                     Timestamp startFrom,
                                     bool showMigrationEvents);
 
+    /**
+     * Rewrites 'userFilter', a $match on the events of a change stream, into a filter on the
+     * insert, update and delete oplog entries from which those events are built. Only equalities
+     * on 'operationType', 'ns' and 'documentKey._id' are rewritten; other predicates are dropped
+     * from a conjunction, so the rewritten filter may match entries whose events do not pass
+     * 'userFilter', but never the reverse. Returns boost::none if nothing can be rewritten. The
+     * rewritten filter must be applied with the simple collation, and only to CRUD entries.
+     */
+    static boost::optional<BSONObj> rewriteFilterForOplog(const MatchExpression* userFilter);
+
     /**
      * Parses a $changeStream stage from 'elem' and produces the $match and transformation
      * stages required.
@@ -217,14 +227,19 @@ private:
  */
 class DocumentSourceOplogMatch final : public DocumentSourceMatch {
 public:
-    DocumentSourceOplogMatch(const DocumentSourceOplogMatch& other) : DocumentSourceMatch(other) {}
+    DocumentSourceOplogMatch(const DocumentSourceOplogMatch& other)
+        : DocumentSourceMatch(other),
+          _startFromInclusive(other._startFromInclusive),
+          _hasPushedDownUserFilter(other._hasPushedDownUserFilter) {}
 
     virtual boost::intrusive_ptr<DocumentSourceMatch> clone() const {
         return make_intrusive<std::decay_t<decltype(*this)>>(*this);
     }
 
     static boost::intrusive_ptr<DocumentSourceOplogMatch> create(
-        BSONObj filter, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+        BSONObj filter,
+        Timestamp startFromInclusive,
+        const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     const char* getSourceName() const final;
 
@@ -240,8 +255,26 @@ public:
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain) const final;
 
+    /**
+     * Pushes the parts of a user $match which directly follows the stages of the $changeStream
+     * down into this filter, so that the oplog entries whose events it would discard are skipped
+     * by the oplog scan rather than transformed into events first.
+     */
+    Pipeline::SourceContainer::iterator doOptimizeAt(Pipeline::SourceContainer::iterator itr,
+                                                     Pipeline::SourceContainer* container) final;
+
 private:
-    using DocumentSourceMatch::DocumentSourceMatch;
+    DocumentSourceOplogMatch(BSONObj filter,
+                             Timestamp startFromInclusive,
+                             const boost::intrusive_ptr<ExpressionContext>& expCtx)
+        : DocumentSourceMatch(std::move(filter), expCtx),
+          _startFromInclusive(startFromInclusive) {}
+
+    // The entries at this timestamp must be let through the filter so that the stream can check
+    // that the event of its resume token is still in the oplog.
+    Timestamp _startFromInclusive;
+
+    bool _hasPushedDownUserFilter = false;
 };
 
 }  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/db/exec/document_value/document_value_test_util.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
@@ -2686,5 +2688,127 @@ TEST_F(ChangeStreamStageDBTest, StartAfterSucceedsEvenIfResumeTokenDoesNotContai
         BSON("$changeStream" << BSON("startAfter" << resumeToken)));
 }
 
+/**
+ * Returns the filter of the oplog scan of a $changeStream with 'spec' followed by the stages in
+ * 'userStages', once the pipeline has been optimized.
+ */
+BSONObj getOptimizedOplogFilter(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                const BSONObj& spec,
+                                std::vector<BSONObj> userStages) {
+    userStages.insert(userStages.begin(), spec);
+    auto pipeline = Pipeline::parse(userStages, expCtx);
+    pipeline->optimizePipeline();
+    auto oplogMatch = dynamic_cast<DocumentSourceMatch*>(pipeline->getSources().front().get());
+    ASSERT(oplogMatch);
+    return oplogMatch->getQuery();
+}
+
+bool oplogFilterMatches(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                        const BSONObj& filter,
+                        const OplogEntry& entry) {
+    auto expr = uassertStatusOK(MatchExpressionParser::parse(filter, expCtx));
+    return expr->matchesBSON(entry.toBSON());
+}
+
+TEST_F(ChangeStreamStageTest, UserMatchOnOperationTypeAndDocumentKeyIsPushedDownToOplogScan) {
+    auto filter = getOptimizedOplogFilter(
+        getExpCtx(),
+        kDefaultSpec,
+        {fromjson("{$match: {operationType: {$in: ['insert', 'replace']}, 'documentKey._id': 2, "
+                  "'fullDocument.x': 1}}")});
+
+    auto insert = makeOplogEntry(OpTypeEnum::kInsert, nss, BSON("_id" << 2 << "x" << 2));
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, insert));
+    auto otherInsert = makeOplogEntry(OpTypeEnum::kInsert, nss, BSON("_id" << 1 << "x" << 1));
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, otherInsert));
+
+    // Both "update" and "replace" events are built from update entries.
+    auto update = makeOplogEntry(OpTypeEnum::kUpdate,
+                                 nss,
+                                 BSON("$set" << BSON("x" << 1)),
+                                 testUuid(),
+                                 boost::none,
+                                 BSON("_id" << 2));
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, update));
+    auto otherUpdate = makeOplogEntry(OpTypeEnum::kUpdate,
+                                      nss,
+                                      BSON("x" << 1),
+                                      testUuid(),
+                                      boost::none,
+                                      BSON("_id" << 1));
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, otherUpdate));
+
+    auto deletion = makeOplogEntry(OpTypeEnum::kDelete, nss, BSON("_id" << 2));
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, deletion));
+
+    // Commands are not filtered, since the events built from them may still need to be returned.
+    auto drop = createCommand(BSON("drop" << nss.coll()), testUuid());
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, drop));
+}
+
+TEST_F(ChangeStreamStageTest, UserMatchOnNamespaceIsPushedDownToOplogScan) {
+    auto filter = getOptimizedOplogFilter(
+        getExpCtx(),
+        kDefaultSpec,
+        {BSON("$match" << BSON("$or" << BSON_ARRAY(BSON("ns.coll" << nss.coll())
+                                                   << BSON("ns" << BSON("db"
+                                                                        << "other"
+                                                                        << "coll"
+                                                                        << "coll")))))});
+
+    auto insert = makeOplogEntry(OpTypeEnum::kInsert, nss, BSON("_id" << 1));
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, insert));
+
+    filter = getOptimizedOplogFilter(
+        getExpCtx(), kDefaultSpec, {BSON("$match" << BSON("ns.db" << "other"))});
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, insert));
+}
+
+TEST_F(ChangeStreamStageDBTest, UserMatchOnNamespaceIsPushedDownWithRegexCharactersEscaped) {
+    auto filter = getOptimizedOplogFilter(
+        getExpCtx(), kDefaultSpec, {fromjson("{$match: {'ns.coll': 'a{2}'}}")});
+
+    // The braces are matched literally rather than as a repetition of the character before them.
+    auto literal =
+        makeOplogEntry(OpTypeEnum::kInsert, NamespaceString(nss.db(), "a{2}"), BSON("_id" << 1));
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, literal));
+    auto repeated =
+        makeOplogEntry(OpTypeEnum::kInsert, NamespaceString(nss.db(), "aa"), BSON("_id" << 1));
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, repeated));
+}
+
+TEST_F(ChangeStreamStageTest, UserMatchWhichCannotBeRewrittenIsNotPushedDownToOplogScan) {
+    auto unfiltered = getOptimizedOplogFilter(getExpCtx(), kDefaultSpec, {});
+
+    // Each branch of an $or must be rewritten for the $or to be, and the $match must directly
+    // follow the $changeStream.
+    for (auto&& userStages : std::vector<std::vector<BSONObj>>{
+             {fromjson("{$match: {$or: [{operationType: 'insert'}, {'fullDocument.x': 1}]}}")},
+             {fromjson("{$match: {operationType: {$ne: 'insert'}}}")},
+             {fromjson("{$addFields: {operationType: 'insert'}}"),
+              fromjson("{$match: {operationType: 'insert'}}")}}) {
+        ASSERT_BSONOBJ_EQ(unfiltered,
+                          getOptimizedOplogFilter(getExpCtx(), kDefaultSpec, userStages));
+    }
+}
+
+TEST_F(ChangeStreamStageTest, OplogScanWithPushedDownUserMatchStillReturnsResumeTokenEntry) {
+    auto spec = BSON("$changeStream" << BSON("startAtOperationTime" << kDefaultTs));
+    auto filter = getOptimizedOplogFilter(
+        getExpCtx(), spec, {fromjson("{$match: {operationType: 'delete'}}")});
+
+    auto insert = makeOplogEntry(OpTypeEnum::kInsert, nss, BSON("_id" << 1));
+    ASSERT_TRUE(oplogFilterMatches(getExpCtx(), filter, insert));
+
+    auto laterInsert = makeOplogEntry(OpTypeEnum::kInsert,
+                                      nss,
+                                      BSON("_id" << 1),
+                                      testUuid(),
+                                      boost::none,
+                                      boost::none,
+                                      repl::OpTime(Timestamp(kDefaultTs.getSecs() + 1, 1), 1));
+    ASSERT_FALSE(oplogFilterMatches(getExpCtx(), filter, laterInsert));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/commands/feature_compatibility_version_documentation.h"
 #include "mongo/db/pipeline/change_stream_constants.h"
 #include "mongo/db/pipeline/change_stream_document_diff_parser.h"
+#include "mongo/db/pipeline/change_stream_event_cache.h"
 #include "mongo/db/pipeline/document_path_support.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
@@ -217,6 +218,28 @@ Document DocumentSourceChangeStreamTransform::applyTransformation(const Document
 
         documentKeyFields = _documentKeyCache.find(uuid.getUuid())->second.documentKeyFields;
     }
+
+    // The events of the CRUD operations outside of transactions only depend on the oplog entry and
+    // on the options below, so another change stream which has transformed the same entry with the
+    // same options may have left the event in the cache.
+    boost::optional<std::string> sharedEventKey;
+    Value term = input[repl::OplogEntry::kTermFieldName];
+    if (!_txnIterator && term.numeric() &&
+        (opType == repl::OpTypeEnum::kInsert || opType == repl::OpTypeEnum::kUpdate ||
+         opType == repl::OpTypeEnum::kDelete) &&
+        ChangeStreamEventCache::shouldShareEvents()) {
+        sharedEventKey = ChangeStreamEventCache::makeKey(
+            ts.getTimestamp(),
+            term.coerceToLong(),
+            _includePreImageOptime,
+            opType == repl::OpTypeEnum::kInsert ? documentKeyFields : std::vector<FieldPath>{});
+        if (auto sharedEvent =
+                ChangeStreamEventCache::get(pExpCtx->opCtx->getServiceContext())
+                    ->lookup(*sharedEventKey)) {
+            return makeEventFromShared(*sharedEvent);
+        }
+    }
+
     Value id = input.getNestedField("o._id");
     // Non-replace updates have the _id in field "o2".
     StringData operationType;
@@ -378,6 +401,39 @@ Document DocumentSourceChangeStreamTransform::applyTransformation(const Document
     // Note that 'updateDescription' might be the 'missing' value, in which case it will not be
     // serialized.
     doc.addField("updateDescription", updateDescription);
+
+    auto event = doc.freeze();
+    if (sharedEventKey) {
+        ChangeStreamEventCache::get(pExpCtx->opCtx->getServiceContext())
+            ->insert(*sharedEventKey, event.toBson());
+    }
+    return event;
+}
+
+Document DocumentSourceChangeStreamTransform::makeEventFromShared(
+    const BSONObj& sharedEvent) const {
+    // The fields which are missing from the event were not serialized, but are kept in their place
+    // in the Document, as in applyTransformation(), since later stages may fill them in.
+    Document shared(sharedEvent);
+    MutableDocument doc;
+    for (auto&& field : {DocumentSourceChangeStream::kIdField,
+                         DocumentSourceChangeStream::kOperationTypeField,
+                         DocumentSourceChangeStream::kClusterTimeField,
+                         DocumentSourceChangeStream::kFullDocumentField}) {
+        doc.addField(field, shared[field]);
+    }
+    if (_includePreImageOptime) {
+        doc.addField(DocumentSourceChangeStream::kFullDocumentBeforeChangeField,
+                     shared[DocumentSourceChangeStream::kFullDocumentBeforeChangeField]);
+    }
+    for (auto&& field : {DocumentSourceChangeStream::kNamespaceField,
+                         DocumentSourceChangeStream::kDocumentKeyField,
+                         "updateDescription"_sd}) {
+        doc.addField(field, shared[field]);
+    }
+
+    const bool isSingleElementKey = true;
+    doc.metadata().setSortKey(shared[DocumentSourceChangeStream::kIdField], isSingleElementKey);
     return doc.freeze();
 }
 
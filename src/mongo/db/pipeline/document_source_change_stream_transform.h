@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/db/pipeline/change_stream_event_cache.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_change_stream_gen.h"
@@ -200,6 +201,12 @@ private:
      */
     ResumeTokenData getResumeToken(Value ts, Value uuid, Value documentKey);
 
+    /**
+     * Rebuilds an event transformed from a CRUD oplog entry outside of a transaction from
+     * 'sharedEvent', as cached in the ChangeStreamEventCache.
+     */
+    Document makeEventFromShared(const BSONObj& sharedEvent) const;
+
     BSONObj _changeStreamSpec;
 
     // Map of collection UUID to document key fields.
@@ -223,6 +230,10 @@ private:
     // This is a snapshot of what the feature compatibility version was at the time the stream was
     // opened or resumed.
     ServerGlobalParams::FeatureCompatibility::Version _fcv;
+
+    // Counts this change stream among those sharing their events through the
+    // ChangeStreamEventCache.
+    ChangeStreamEventCache::Registration _eventCacheRegistration;
 };
 
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source_facet.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -38,6 +39,8 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsontypes.h"
+#include "mongo/db/bounded_worker_pool.h"
+#include "mongo/db/client.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
 #include "mongo/db/pipeline/document_source_tee_consumer.h"
@@ -45,7 +48,11 @@
 #include "mongo/db/pipeline/field_path.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/tee_buffer.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -58,15 +65,18 @@ using std::vector;
 DocumentSourceFacet::DocumentSourceFacet(std::vector<FacetPipeline> facetPipelines,
                                          const intrusive_ptr<ExpressionContext>& expCtx,
                                          size_t bufferSizeBytes,
-                                         size_t maxOutputDocBytes)
+                                         size_t maxOutputDocBytes,
+                                         bool runFacetsConcurrently)
     : DocumentSource(kStageName, expCtx),
-      _teeBuffer(TeeBuffer::create(facetPipelines.size(), bufferSizeBytes)),
+      _teeBuffer(
+          TeeBuffer::create(facetPipelines.size(), bufferSizeBytes, runFacetsConcurrently)),
       _facets(std::move(facetPipelines)),
-      _maxOutputDocSizeBytes(maxOutputDocBytes) {
+      _maxOutputDocSizeBytes(maxOutputDocBytes),
+      _runFacetsConcurrently(runFacetsConcurrently) {
     for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
         auto& facet = _facets[facetId];
-        facet.pipeline->addInitialSource(
-            DocumentSourceTeeConsumer::create(pExpCtx, facetId, _teeBuffer));
+        facet.pipeline->addInitialSource(DocumentSourceTeeConsumer::create(
+            facet.pipeline->getContext(), facetId, _teeBuffer));
     }
 }
 
@@ -129,9 +139,13 @@ intrusive_ptr<DocumentSourceFacet> DocumentSourceFacet::create(
     std::vector<FacetPipeline> facetPipelines,
     const intrusive_ptr<ExpressionContext>& expCtx,
     size_t bufferSizeBytes,
-    size_t maxOutputDocBytes) {
-    return new DocumentSourceFacet(
-        std::move(facetPipelines), expCtx, bufferSizeBytes, maxOutputDocBytes);
+    size_t maxOutputDocBytes,
+    bool runFacetsConcurrently) {
+    return new DocumentSourceFacet(std::move(facetPipelines),
+                                   expCtx,
+                                   bufferSizeBytes,
+                                   maxOutputDocBytes,
+                                   runFacetsConcurrently);
 }
 
 void DocumentSourceFacet::setSource(DocumentSource* source) {
@@ -150,27 +164,40 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
         return GetNextResult::makeEOF();
     }
 
+    // The facets share the limit on the size of the output document, even when they run
+    // concurrently.
     const size_t maxBytes = _maxOutputDocSizeBytes;
-    auto ensureUnderMemoryLimit = [usedBytes = 0ul, &maxBytes](long long additional) mutable {
-        usedBytes += additional;
+    AtomicWord<long long> usedBytes{0};
+    auto ensureUnderMemoryLimit = [&usedBytes, &maxBytes](long long additional) {
+        const auto totalBytes = usedBytes.addAndFetch(additional);
         uassert(4031700,
-                str::stream() << "document constructed by $facet is " << usedBytes
+                str::stream() << "document constructed by $facet is " << totalBytes
                               << " bytes, which exceeds the limit of " << maxBytes << " bytes",
-                usedBytes <= maxBytes);
+                static_cast<size_t>(totalBytes) <= maxBytes);
     };
 
+    // Pulls the results of the pipeline of 'facetId' until it pauses for more input, and returns
+    // whether the pipeline is exhausted.
     vector<vector<Value>> results(_facets.size());
-    bool allPipelinesEOF = false;
-    while (!allPipelinesEOF) {
-        allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
-        for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
-            const auto& pipeline = _facets[facetId].pipeline;
-            auto next = pipeline->getSources().back()->getNext();
-            for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
-                ensureUnderMemoryLimit(next.getDocument().getApproximateSize());
-                results[facetId].emplace_back(next.releaseDocument());
+    auto drainFacet = [&](size_t facetId) {
+        const auto& pipeline = _facets[facetId].pipeline;
+        auto next = pipeline->getSources().back()->getNext();
+        for (; next.isAdvanced(); next = pipeline->getSources().back()->getNext()) {
+            ensureUnderMemoryLimit(next.getDocument().getApproximateSize());
+            results[facetId].emplace_back(next.releaseDocument());
+        }
+        return next.isEOF();
+    };
+
+    if (_runFacetsConcurrently) {
+        runFacetsConcurrently(drainFacet);
+    } else {
+        bool allPipelinesEOF = false;
+        while (!allPipelinesEOF) {
+            allPipelinesEOF = true;  // Set this to false if any pipeline isn't EOF.
+            for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+                allPipelinesEOF = drainFacet(facetId) && allPipelinesEOF;
             }
-            allPipelinesEOF = allPipelinesEOF && next.isEOF();
         }
     }
 
@@ -183,6 +210,140 @@ DocumentSource::GetNextResult DocumentSourceFacet::doGetNext() {
     return resultDoc.freeze();
 }
 
+void DocumentSourceFacet::runFacetsConcurrently(const std::function<bool(size_t)>& drainFacet) {
+    auto opCtx = pExpCtx->opCtx;
+
+    // When the workers are all busy with other $facet stages, the facets run one after another on
+    // the thread of this operation instead of waiting for workers to become available.
+    auto workers = BoundedWorkerPool::get(opCtx->getServiceContext())
+                       ->reserve("facet"_sd,
+                                 internalQueryFacetMaxWorkerThreads.load(),
+                                 _facets.size(),
+                                 2 /* minWorkers */);
+
+    ON_BLOCK_EXIT([&] {
+        for (auto&& facet : _facets) {
+            facet.pipeline->reattachToOperationContext(opCtx);
+        }
+    });
+
+    // The outcome of the last run of each facet, which only the worker running it writes to.
+    struct FacetRun {
+        bool isEOF = false;
+        Status status = Status::OK();
+    };
+    std::vector<FacetRun> facetRuns(_facets.size());
+
+    // Runs the facets in 'pendingFacets' on the reserved workers, each of which takes the next
+    // facet nobody has run yet until there are none left, and waits for all of them to be done.
+    // The facets run under operations of the workers, which share the deadline of this operation
+    // and are killed along with it.
+    auto runOnWorkers = [&](const std::vector<size_t>& pendingFacets) {
+        auto mutex = MONGO_MAKE_LATCH("DocumentSourceFacet::runFacetsConcurrently::mutex");
+        stdx::condition_variable allWorkersDone;
+        AtomicWord<size_t> nextFacet{0};
+        auto numRunning = std::min(pendingFacets.size(), static_cast<size_t>(workers.size()));
+        const auto deadline = opCtx->getDeadline();
+        const auto timeoutError = opCtx->getTimeoutError();
+
+        // The operations of the workers, and the code they are to be killed with, if any. A
+        // worker which starts an operation after the kill has its operation killed right away.
+        std::vector<OperationContext*> workerOpCtxs;
+        ErrorCodes::Error killCode = ErrorCodes::OK;
+        auto killWorkerOpCtx = [](OperationContext* workerOpCtx, ErrorCodes::Error code) {
+            stdx::lock_guard<Client> clientLock(*workerOpCtx->getClient());
+            workerOpCtx->getServiceContext()->killOperation(clientLock, workerOpCtx, code);
+        };
+
+        const auto numTasks = numRunning;
+        for (size_t task = 0; task < numTasks; ++task) {
+            workers.schedule([&](Status status) {
+                for (auto idx = nextFacet.fetchAndAdd(1); idx < pendingFacets.size();
+                     idx = nextFacet.fetchAndAdd(1)) {
+                    const auto facetId = pendingFacets[idx];
+                    auto& run = facetRuns[facetId];
+                    if (!status.isOK()) {
+                        run.status = status;
+                        continue;
+                    }
+                    // The facet runs under an operation of this worker thread, so that none of its
+                    // stages touches the operation of the $facet from another thread.
+                    auto workerOpCtx = cc().makeOperationContext();
+                    workerOpCtx->setDeadlineByDate(deadline, timeoutError);
+                    {
+                        stdx::lock_guard<Latch> lk(mutex);
+                        workerOpCtxs.push_back(workerOpCtx.get());
+                        if (killCode != ErrorCodes::OK) {
+                            killWorkerOpCtx(workerOpCtx.get(), killCode);
+                        }
+                    }
+                    ON_BLOCK_EXIT([&] {
+                        stdx::lock_guard<Latch> lk(mutex);
+                        workerOpCtxs.erase(std::find(
+                            workerOpCtxs.begin(), workerOpCtxs.end(), workerOpCtx.get()));
+                    });
+
+                    const auto& pipeline = _facets[facetId].pipeline;
+                    pipeline->reattachToOperationContext(workerOpCtx.get());
+                    ON_BLOCK_EXIT([&] { pipeline->detachFromOperationContext(); });
+                    try {
+                        run.isEOF = drainFacet(facetId);
+                    } catch (const DBException& ex) {
+                        run.status = ex.toStatus();
+                    }
+                }
+
+                stdx::lock_guard<Latch> lk(mutex);
+                if (--numRunning == 0) {
+                    allWorkersDone.notify_all();
+                }
+            });
+        }
+
+        stdx::unique_lock<Latch> lk(mutex);
+        try {
+            opCtx->waitForConditionOrInterrupt(
+                allWorkersDone, lk, [&] { return numRunning == 0; });
+        } catch (const DBException& ex) {
+            // The workers run the facets on the stack of this thread, so they must be done before
+            // the error is passed on. Killing their operations makes them stop shortly.
+            killCode = ex.code();
+            for (auto workerOpCtx : workerOpCtxs) {
+                killWorkerOpCtx(workerOpCtx, killCode);
+            }
+            allWorkersDone.wait(lk, [&] { return numRunning == 0; });
+            throw;
+        }
+    };
+
+    bool allPipelinesEOF = false;
+    while (!allPipelinesEOF) {
+        _teeBuffer->loadNextSharedBatch();
+
+        std::vector<size_t> pendingFacets;
+        for (size_t facetId = 0; facetId < _facets.size(); ++facetId) {
+            if (!facetRuns[facetId].isEOF) {
+                pendingFacets.push_back(facetId);
+            }
+        }
+
+        if (workers.size() > 0) {
+            runOnWorkers(pendingFacets);
+            for (auto&& run : facetRuns) {
+                uassertStatusOK(run.status);
+            }
+        } else {
+            for (auto facetId : pendingFacets) {
+                facetRuns[facetId].isEOF = drainFacet(facetId);
+            }
+        }
+
+        opCtx->checkForInterrupt();
+        allPipelinesEOF = std::all_of(
+            facetRuns.begin(), facetRuns.end(), [](const FacetRun& run) { return run.isEOF; });
+    }
+}
+
 Value DocumentSourceFacet::serialize(boost::optional<ExplainOptions::Verbosity> explain) const {
     MutableDocument serialized;
     for (auto&& facet : _facets) {
@@ -304,11 +465,26 @@ intrusive_ptr<DocumentSource> DocumentSourceFacet::createFromBson(
     boost::optional<std::string> needsMongoS;
     boost::optional<std::string> needsShard;
 
+    // The facets can run concurrently if none of them reads from a collection, and if they need
+    // not see variables set at runtime on 'expCtx' by an enclosing stage. Each of them then gets a
+    // copy of 'expCtx', so that they do not share its variables and interrupt check counter.
+    const auto rawFacets = extractRawPipelines(elem);
+    const bool runFacetsConcurrently = internalQueryFacetMaxWorkerThreads.load() > 1 &&
+        rawFacets.size() > 1 && expCtx->subPipelineDepth == 0 &&
+        !expCtx->variablesParseState.hasDefinedVariables() &&
+        std::all_of(rawFacets.begin(), rawFacets.end(), [&](const auto& rawFacet) {
+            return LiteParsedPipeline(expCtx->ns, rawFacet.second)
+                .getInvolvedNamespaces()
+                .empty();
+        });
+
     std::vector<FacetPipeline> facetPipelines;
-    for (auto&& rawFacet : extractRawPipelines(elem)) {
+    for (auto&& rawFacet : rawFacets) {
         const auto facetName = rawFacet.first;
 
-        auto pipeline = Pipeline::parse(rawFacet.second, expCtx, [](const Pipeline& pipeline) {
+        auto facetExpCtx = runFacetsConcurrently ? expCtx->copyWith(expCtx->ns, expCtx->uuid)
+                                                 : expCtx;
+        auto pipeline = Pipeline::parse(rawFacet.second, facetExpCtx, [](const Pipeline& pipeline) {
             auto sources = pipeline.getSources();
             std::for_each(sources.begin(), sources.end(), [](auto& stage) {
                 auto stageConstraints = stage->constraints();
@@ -341,6 +517,10 @@ intrusive_ptr<DocumentSource> DocumentSourceFacet::createFromBson(
         facetPipelines.emplace_back(facetName, std::move(pipeline));
     }
 
-    return DocumentSourceFacet::create(std::move(facetPipelines), expCtx);
+    return DocumentSourceFacet::create(std::move(facetPipelines),
+                                       expCtx,
+                                       internalQueryFacetBufferSizeBytes.load(),
+                                       internalQueryFacetMaxOutputDocSizeBytes.load(),
+                                       runFacetsConcurrently);
 }
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <boost/optional.hpp>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -91,11 +92,16 @@ public:
     static boost::intrusive_ptr<DocumentSource> createFromBson(
         BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
+    /**
+     * If 'runFacetsConcurrently' is true, each of the 'facetPipelines' must have an
+     * ExpressionContext of its own, and must not read from any collection.
+     */
     static boost::intrusive_ptr<DocumentSourceFacet> create(
         std::vector<FacetPipeline> facetPipelines,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         size_t bufferSizeBytes = internalQueryFacetBufferSizeBytes.load(),
-        size_t maxOutputDocBytes = internalQueryFacetMaxOutputDocSizeBytes.load());
+        size_t maxOutputDocBytes = internalQueryFacetMaxOutputDocSizeBytes.load(),
+        bool runFacetsConcurrently = false);
 
     /**
      * Optimizes inner pipelines.
@@ -153,7 +159,18 @@ private:
     DocumentSourceFacet(std::vector<FacetPipeline> facetPipelines,
                         const boost::intrusive_ptr<ExpressionContext>& expCtx,
                         size_t bufferSizeBytes,
-                        size_t maxOutputDocBytes);
+                        size_t maxOutputDocBytes,
+                        bool runFacetsConcurrently);
+
+    /**
+     * Runs 'drainFacet' over every facet, each time the TeeBuffer has loaded a batch of input and
+     * once it has run out of input, until it has returned true for all of them. The facets run
+     * concurrently on workers reserved from the BoundedWorkerPool, each under an operation of its
+     * own which shares the deadline of this operation and is killed along with it, while the input
+     * is read on the thread of this operation. If fewer than two workers can be reserved, the
+     * facets run one after another on the thread of this operation instead.
+     */
+    void runFacetsConcurrently(const std::function<bool(size_t)>& drainFacet);
 
     Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
 
@@ -162,6 +179,9 @@ private:
 
     const size_t _maxOutputDocSizeBytes;
 
+    // Whether the facets run concurrently on worker threads rather than one after another.
+    const bool _runFacetsConcurrently;
+
     bool _done = false;
 };
 }  // namespace mongo
@@ -44,8 +44,10 @@
 #include "mongo/db/pipeline/document_source_limit.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_skip.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 using std::deque;
@@ -496,6 +498,86 @@ DEATH_TEST_REGEX_F(DocumentSourceFacetTest,
     facetStage->getNext();  // This should cause a crash.
 }
 
+/**
+ * Runs the $facet given by 'spec' over 'numInputs' documents, loaded into the TeeBuffer a few at a
+ * time, with the facets run concurrently on up to 'maxWorkerThreads' threads.
+ */
+Document runFacetWithWorkerThreads(const boost::intrusive_ptr<ExpressionContext>& ctx,
+                                   const BSONObj& spec,
+                                   int numInputs,
+                                   int maxWorkerThreads) {
+    const auto defaultMaxWorkerThreads = internalQueryFacetMaxWorkerThreads.load();
+    const auto defaultBufferSizeBytes = internalQueryFacetBufferSizeBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalQueryFacetMaxWorkerThreads.store(defaultMaxWorkerThreads);
+        internalQueryFacetBufferSizeBytes.store(defaultBufferSizeBytes);
+    });
+    internalQueryFacetMaxWorkerThreads.store(maxWorkerThreads);
+    internalQueryFacetBufferSizeBytes.store(100);
+
+    deque<DocumentSource::GetNextResult> inputs;
+    for (int i = 0; i < numInputs; ++i) {
+        inputs.emplace_back(Document{{"_id", i}, {"a", i % 3}});
+    }
+    auto mock = DocumentSourceMock::createForTest(inputs, ctx);
+
+    auto facetStage = DocumentSourceFacet::createFromBson(spec.firstElement(), ctx);
+    facetStage->setSource(mock.get());
+
+    auto output = facetStage->getNext();
+    ASSERT(output.isAdvanced());
+    ASSERT(facetStage->getNext().isEOF());
+    return output.releaseDocument();
+}
+
+TEST_F(DocumentSourceFacetTest, ConcurrentFacetsProduceTheSameResultsAsSequentialFacets) {
+    auto spec = fromjson(
+        "{$facet: {skipped: [{$skip: 5}], limited: [{$limit: 3}], projected: [{$project: {a: 1, "
+        "_id: 0}}, {$skip: 40}], all: []}}");
+
+    auto sequential = runFacetWithWorkerThreads(getExpCtx(), spec, 50, 1);
+    auto concurrent = runFacetWithWorkerThreads(getExpCtx(), spec, 50, 4);
+    ASSERT_DOCUMENT_EQ(sequential, concurrent);
+    ASSERT_EQ(concurrent["skipped"].getArrayLength(), 45ULL);
+    ASSERT_EQ(concurrent["limited"].getArrayLength(), 3ULL);
+    ASSERT_EQ(concurrent["projected"].getArrayLength(), 10ULL);
+    ASSERT_EQ(concurrent["all"].getArrayLength(), 50ULL);
+}
+
+TEST_F(DocumentSourceFacetTest, ConcurrentFacetsShareFewerWorkersThanFacets) {
+    auto spec = fromjson(
+        "{$facet: {first: [{$skip: 1}], second: [{$limit: 7}], third: [{$skip: 30}], fourth: [], "
+        "fifth: [{$project: {_id: 1}}]}}");
+
+    auto sequential = runFacetWithWorkerThreads(getExpCtx(), spec, 40, 1);
+    auto concurrent = runFacetWithWorkerThreads(getExpCtx(), spec, 40, 2);
+    ASSERT_DOCUMENT_EQ(sequential, concurrent);
+    ASSERT_EQ(concurrent["first"].getArrayLength(), 39ULL);
+    ASSERT_EQ(concurrent["third"].getArrayLength(), 10ULL);
+}
+
+TEST_F(DocumentSourceFacetTest, ConcurrentFacetsFailWhenTheOutputExceedsTheSizeLimit) {
+    const auto defaultMaxOutputDocSizeBytes = internalQueryFacetMaxOutputDocSizeBytes.load();
+    ON_BLOCK_EXIT(
+        [&] { internalQueryFacetMaxOutputDocSizeBytes.store(defaultMaxOutputDocSizeBytes); });
+    internalQueryFacetMaxOutputDocSizeBytes.store(5000);
+
+    // The error raised on a worker thread is rethrown on the thread of the operation.
+    auto spec = fromjson("{$facet: {first: [], second: [], third: []}}");
+    ASSERT_THROWS_CODE(
+        runFacetWithWorkerThreads(getExpCtx(), spec, 200, 3), AssertionException, 4031700);
+}
+
+TEST_F(DocumentSourceFacetTest, ConcurrentFacetsFailWhenTheDeadlineOfTheOperationHasPassed) {
+    // The operations of the workers share the deadline of the operation running the $facet.
+    getExpCtx()->opCtx->setDeadlineAfterNowBy(Milliseconds(0), ErrorCodes::MaxTimeMSExpired);
+
+    auto spec = fromjson("{$facet: {first: [], second: [{$skip: 1}], third: [{$limit: 2}]}}");
+    ASSERT_THROWS_CODE(runFacetWithWorkerThreads(getExpCtx(), spec, 200, 3),
+                       AssertionException,
+                       ErrorCodes::MaxTimeMSExpired);
+}
+
 //
 // Miscellaneous.
 //
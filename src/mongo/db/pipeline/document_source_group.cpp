@@ -164,6 +164,13 @@ int DocumentSourceGroup::freeMemory() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
+    if (_streamingSortKeyGen) {
+        if (auto next = getNextStreaming()) {
+            return std::move(*next);
+        }
+        invariant(!_streamingSortKeyGen);
+    }
+
     if (!_initialized) {
         const auto initializationResult = initialize();
         if (initializationResult.isPaused()) {
@@ -183,6 +190,54 @@ DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
     }
 }
 
+boost::optional<DocumentSource::GetNextResult> DocumentSourceGroup::getNextStreaming() {
+    if (!_outputtingRun) {
+        if (_nextRunFirstDocument) {
+            _currentRunSortKey = std::move(_nextRunSortKey);
+            processDocument(*_nextRunFirstDocument);
+            _nextRunFirstDocument = boost::none;
+        }
+
+        // Group the input until the sort fields of the group key change, which means that every
+        // group seen so far is complete.
+        GetNextResult input = pSource->getNext();
+        for (; input.isAdvanced(); input = pSource->getNext()) {
+            auto rootDocument = input.releaseDocument();
+            auto sortKey = _streamingSortKeyGen->computeSortKeyFromDocument(rootDocument);
+            if (_groups->empty()) {
+                _currentRunSortKey = std::move(sortKey);
+            } else if (Value::compare(sortKey, _currentRunSortKey, nullptr) != 0) {
+                _nextRunFirstDocument = std::move(rootDocument);
+                _nextRunSortKey = std::move(sortKey);
+                break;
+            }
+
+            processDocument(rootDocument);
+            if (_memoryTracker.memoryUsageBytes > _memoryTracker.maxMemoryUsageBytes) {
+                _streamingSortKeyGen = boost::none;
+                return boost::none;
+            }
+        }
+
+        if (input.isPaused() || (input.isEOF() && _groups->empty())) {
+            return input;
+        }
+
+        groupsIterator = _groups->begin();
+        _outputtingRun = true;
+    }
+
+    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+
+    if (++groupsIterator == _groups->end()) {
+        _groups->clear();
+        _memoryTracker.memoryUsageBytes = 0;
+        _outputtingRun = false;
+    }
+
+    return GetNextResult(std::move(out));
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
     // We aren't streaming, and we have spilled to disk.
     if (!_sorterIterator)
@@ -245,6 +300,8 @@ void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _nextRunFirstDocument = boost::none;
+    _outputtingRun = false;
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -349,6 +406,20 @@ StringMap<boost::intrusive_ptr<Expression>> DocumentSourceGroup::getIdFields() c
     }
 }
 
+boost::intrusive_ptr<Expression> DocumentSourceGroup::getIdExpression() const {
+    if (_idFieldNames.empty()) {
+        invariant(_idExpressions.size() == 1);
+        return _idExpressions[0];
+    }
+
+    invariant(_idFieldNames.size() == _idExpressions.size());
+    std::vector<std::pair<std::string, boost::intrusive_ptr<Expression>>> fields;
+    for (std::size_t i = 0; i < _idFieldNames.size(); ++i) {
+        fields.emplace_back(_idFieldNames[i], _idExpressions[i]);
+    }
+    return ExpressionObject::create(pExpCtx.get(), std::move(fields));
+}
+
 const std::vector<AccumulationStatement>& DocumentSourceGroup::getAccumulatedFields() const {
     return _accumulatedFields;
 }
@@ -508,73 +579,81 @@ private:
 };
 }  // namespace
 
-DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
+void DocumentSourceGroup::processDocument(const Document& rootDocument) {
     const size_t numAccumulators = _accumulatedFields.size();
 
-    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
-
-    for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryTracker.shouldSpillWithAttemptToSaveMemory([this]() { return freeMemory(); })) {
-            _sortedFiles.push_back(spill());
+    // A streaming $group only holds the groups of one run of input, which it never spills.
+    if (!_streamingSortKeyGen &&
+        _memoryTracker.shouldSpillWithAttemptToSaveMemory([this]() { return freeMemory(); })) {
+        _sortedFiles.push_back(spill());
+    }
+
+    Value id = computeId(rootDocument);
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryTracker.memoryUsageBytes += id.getApproximateSize();
+
+        // Initialize and add the accumulators
+        Value expandedId = expandId(id);
+        Document idDoc =
+            expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            auto accum = accumulatedField.makeAccumulator();
+            Value initializerValue =
+                accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
+            accum->startNewGroup(initializerValue);
+            group.push_back(accum);
         }
-
-        // We release the result document here so that it does not outlive the end of this loop
-        // iteration. Not releasing could lead to an array copy when this group follows an unwind.
-        auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<AccumulatorState>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryTracker.memoryUsageBytes += id.getApproximateSize();
-
-            // Initialize and add the accumulators
-            Value expandedId = expandId(id);
-            Document idDoc =
-                expandedId.getType() == BSONType::Object ? expandedId.getDocument() : Document();
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                auto accum = accumulatedField.makeAccumulator();
-                Value initializerValue =
-                    accumulatedField.expr.initializer->evaluate(idDoc, &pExpCtx->variables);
-                accum->startNewGroup(initializerValue);
-                group.push_back(accum);
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryTracker.memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryTracker.memoryUsageBytes -= groupObj->memUsageForSorter();
         }
+    }
 
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
 
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(
-                _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
-                _doingMerge);
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(
+            _accumulatedFields[i].expr.argument->evaluate(rootDocument, &pExpCtx->variables),
+            _doingMerge);
 
-            _memoryTracker.memoryUsageBytes += group[i]->memUsageForSorter();
-        }
+        _memoryTracker.memoryUsageBytes += group[i]->memUsageForSorter();
+    }
 
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                     // is a dup
-                !pExpCtx->inMongos &&            // can't spill to disk in mongos
-                !_memoryTracker.allowDiskUse &&  // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {      // don't open too many FDs
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                     // is a dup
+            !_streamingSortKeyGen &&         // a streaming $group does not spill
+            !pExpCtx->inMongos &&            // can't spill to disk in mongos
+            !_memoryTracker.allowDiskUse &&  // don't change behavior when testing external sort
+            _sortedFiles.size() < 20) {      // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
-            }
+            _sortedFiles.push_back(spill());
         }
     }
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
+    GetNextResult input = pSource->getNext();
+
+    for (; input.isAdvanced(); input = pSource->getNext()) {
+        // We release the result document here so that it does not outlive the end of this loop
+        // iteration. Not releasing could lead to an array copy when this group follows an unwind.
+        processDocument(input.releaseDocument());
+    }
 
     switch (input.getStatus()) {
         case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
@@ -785,6 +864,45 @@ bool DocumentSourceGroup::canRunInParallelBeforeWriteStage(
     return true;
 }
 
+bool DocumentSourceGroup::setSortedInput(const SortPattern& inputSortPattern) {
+    if (!internalDocumentSourceGroupEnableStreaming.load() || _doingMerge ||
+        inputSortPattern.size() < _idExpressions.size()) {
+        return false;
+    }
+
+    // The group key must consist of top-level fields, as equal values of a dotted path such as
+    // "$a.b" may come from documents whose sort keys differ, when 'a' or 'b' holds an array.
+    std::set<StringData> idFields;
+    for (auto&& idExpr : _idExpressions) {
+        auto fieldPathExpr = dynamic_cast<ExpressionFieldPath*>(idExpr.get());
+        if (!fieldPathExpr || !fieldPathExpr->isRootFieldPath() ||
+            fieldPathExpr->getFieldPath().getPathLength() != 2) {
+            return false;
+        }
+        idFields.insert(fieldPathExpr->getFieldPath().getFieldName(1));
+    }
+
+    // Those fields must be the leading fields of the sort, in any order. Documents with the same
+    // group key then have the same values of these sort fields, and so are contiguous in the
+    // input. Different group keys may share these values, for example an array and its least
+    // element, which is why the groups are delimited by the sort key rather than by the group key.
+    std::vector<SortPattern::SortPatternPart> runSortParts;
+    for (size_t i = 0; i < _idExpressions.size(); ++i) {
+        const auto& part = inputSortPattern[i];
+        if (!part.fieldPath || part.fieldPath->getPathLength() != 1 ||
+            !idFields.count(part.fieldPath->getFieldName(0))) {
+            return false;
+        }
+        runSortParts.push_back(part);
+    }
+    if (idFields.size() != runSortParts.size()) {
+        return false;
+    }
+
+    _streamingSortKeyGen.emplace(SortPattern{std::move(runSortParts)}, pExpCtx->getCollator());
+    return true;
+}
+
 std::unique_ptr<GroupFromFirstDocumentTransformation>
 DocumentSourceGroup::rewriteGroupAsTransformOnFirstDocument() const {
     if (_idExpressions.size() != 1) {
@@ -32,10 +32,12 @@
 #include <memory>
 #include <utility>
 
+#include "mongo/db/index/sort_key_generator.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/transformer_interface.h"
+#include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -99,6 +101,13 @@ public:
     const char* getSourceName() const final;
     GetModPathsReturn getModifiedPaths() const final;
     StringMap<boost::intrusive_ptr<Expression>> getIdFields() const;
+
+    /**
+     * Returns the expression which computes the _id of a group, with an _id given as a document of
+     * expressions rebuilt as an ExpressionObject.
+     */
+    boost::intrusive_ptr<Expression> getIdExpression() const;
+
     const std::vector<AccumulationStatement>& getAccumulatedFields() const;
 
     /**
@@ -177,6 +186,22 @@ public:
     std::unique_ptr<GroupFromFirstDocumentTransformation> rewriteGroupAsTransformOnFirstDocument()
         const;
 
+    /**
+     * Tells this $group that its input is sorted by 'inputSortPattern'. If the group key consists
+     * of top-level fields which are the leading fields of the sort, the documents of each group are
+     * contiguous in the input, and the $group streams: it outputs the groups of each run of input
+     * sharing those sort fields as soon as the run ends, instead of after the whole input. Returns
+     * true if the $group streams.
+     */
+    bool setSortedInput(const SortPattern& inputSortPattern);
+
+    /**
+     * Returns true if this $group outputs its groups as they complete.
+     */
+    bool isStreaming() const {
+        return static_cast<bool>(_streamingSortKeyGen);
+    }
+
 protected:
     GetNextResult doGetNext() final;
     void doDispose() final;
@@ -210,6 +235,19 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Returns the next group of a streaming $group, or boost::none if the run of input being
+     * grouped grew too large to hold in memory. In that case the $group stops streaming and
+     * groups the rest of its input as a whole, which is correct as the groups output so far are
+     * complete.
+     */
+    boost::optional<GetNextResult> getNextStreaming();
+
+    /**
+     * Adds 'rootDocument' to its group in '_groups', spilling '_groups' first if needed.
+     */
+    void processDocument(const Document& rootDocument);
+
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
      * initialize() requests the first document from the previous source, and uses it to prepare the
@@ -287,6 +325,18 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // Only set when streaming, to compute the values of the sort fields of the group key which
+    // delimit the runs of input.
+    boost::optional<SortKeyGenerator> _streamingSortKeyGen;
+
+    // When streaming, '_groups' holds the groups of the current run of input, whose sort key is
+    // '_currentRunSortKey'. The first document of the next run is held until those groups are
+    // output.
+    Value _currentRunSortKey;
+    boost::optional<Document> _nextRunFirstDocument;
+    Value _nextRunSortKey;
+    bool _outputtingRun = false;
 };
 
 }  // namespace mongo
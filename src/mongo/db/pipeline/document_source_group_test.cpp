@@ -244,6 +244,141 @@ TEST_F(DocumentSourceGroupTest, ShouldNotReportDottedGroupKeyAsARename) {
     ASSERT_EQ(modifiedPathsRet.renames.size(), 0UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldStreamOnlyWhenGroupedByLeadingSortFields) {
+    auto expCtx = getExpCtx();
+    VariablesParseState vps = expCtx->variablesParseState;
+    auto x = ExpressionFieldPath::parse(expCtx.get(), "$x", vps);
+    auto y = ExpressionFieldPath::parse(expCtx.get(), "$y", vps);
+    auto xDotY = ExpressionFieldPath::parse(expCtx.get(), "$x.y", vps);
+
+    auto groupByX = DocumentSourceGroup::create(expCtx, x, {});
+    ASSERT_FALSE(groupByX->setSortedInput(SortPattern{BSON("y" << 1 << "x" << 1), expCtx}));
+    ASSERT_FALSE(groupByX->isStreaming());
+    ASSERT_TRUE(groupByX->setSortedInput(SortPattern{BSON("x" << -1 << "y" << 1), expCtx}));
+    ASSERT_TRUE(groupByX->isStreaming());
+
+    auto groupByXAndY = DocumentSourceGroup::create(
+        expCtx, ExpressionObject::create(expCtx.get(), {{"x", x}, {"y", y}}), {});
+    ASSERT_FALSE(groupByXAndY->setSortedInput(SortPattern{BSON("x" << 1), expCtx}));
+    ASSERT_FALSE(groupByXAndY->setSortedInput(SortPattern{BSON("x" << 1 << "z" << 1), expCtx}));
+    ASSERT_TRUE(
+        groupByXAndY->setSortedInput(SortPattern{BSON("y" << 1 << "x" << 1 << "z" << 1), expCtx}));
+
+    auto groupByXDotY = DocumentSourceGroup::create(expCtx, xDotY, {});
+    ASSERT_FALSE(groupByXDotY->setSortedInput(SortPattern{BSON("x.y" << 1), expCtx}));
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupOutputsEachGroupOnceTheInputMovesPastIt) {
+    auto expCtx = getExpCtx();
+    auto&& parser = AccumulationStatement::getParser("$sum", boost::none);
+    auto accumulatorArg = BSON("" << 1);
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement countStatement{"count", accExpr};
+    auto group = DocumentSourceGroup::create(
+        expCtx,
+        ExpressionFieldPath::parse(expCtx.get(), "$x", expCtx->variablesParseState),
+        {countStatement});
+    ASSERT_TRUE(group->setSortedInput(SortPattern{BSON("x" << 1), expCtx}));
+
+    auto mock =
+        DocumentSourceMock::createForTest({Document{{"x", 1}},
+                                           Document{{"x", 1}},
+                                           Document{{"x", 2}},
+                                           DocumentSource::GetNextResult::makePauseExecution(),
+                                           Document{{"x", 3}}},
+                                          expCtx);
+    group->setSource(mock.get());
+
+    // The first group is output before the pause is reached.
+    auto result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 1}, {"count", 2}}));
+
+    ASSERT_TRUE(group->getNext().isPaused());
+
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 2}, {"count", 1}}));
+    result = group->getNext();
+    ASSERT_TRUE(result.isAdvanced());
+    ASSERT_DOCUMENT_EQ(result.releaseDocument(), (Document{{"_id", 3}, {"count", 1}}));
+    ASSERT_TRUE(group->getNext().isEOF());
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupKeepsGroupsSharingASortKeyTogether) {
+    auto expCtx = getExpCtx();
+    auto&& parser = AccumulationStatement::getParser("$sum", boost::none);
+    auto accumulatorArg = BSON("" << 1);
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement countStatement{"count", accExpr};
+    auto group = DocumentSourceGroup::create(
+        expCtx,
+        ExpressionFieldPath::parse(expCtx.get(), "$x", expCtx->variablesParseState),
+        {countStatement});
+    ASSERT_TRUE(group->setSortedInput(SortPattern{BSON("x" << 1), expCtx}));
+
+    // An array sorts by its least element, so that it may be interleaved with that element.
+    auto mock = DocumentSourceMock::createForTest({Document{{"x", 1}},
+                                                   Document{{"x", BSON_ARRAY(1 << 5)}},
+                                                   Document{{"x", 1}},
+                                                   Document{{"x", 2}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    std::map<std::string, int> counts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(counts.count(doc["_id"].toString()), 0UL);
+        counts[doc["_id"].toString()] = doc["count"].coerceToInt();
+    }
+
+    ASSERT_EQ(counts.size(), 3UL);
+    ASSERT_EQ(counts[Value(1).toString()], 2);
+    ASSERT_EQ(counts[Value(BSON_ARRAY(1 << 5)).toString()], 1);
+    ASSERT_EQ(counts[Value(2).toString()], 1);
+}
+
+TEST_F(DocumentSourceGroupTest, StreamingGroupStopsStreamingWhenARunIsTooLarge) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    auto&& parser = AccumulationStatement::getParser("$push", boost::none);
+    auto accumulatorArg = BSON(""
+                               << "$largeStr");
+    auto accExpr = parser(expCtx.get(), accumulatorArg.firstElement(), expCtx->variablesParseState);
+    AccumulationStatement pushStatement{"spaceHog", accExpr};
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx.get(), "$x", expCtx->variablesParseState);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+    ASSERT_TRUE(group->setSortedInput(SortPattern{BSON("x" << 1), expCtx}));
+
+    string largeStr(maxMemoryUsageBytes / 2, 'x');
+    auto mock = DocumentSourceMock::createForTest({Document{{"x", 1}, {"largeStr", largeStr}},
+                                                   Document{{"x", 1}, {"largeStr", largeStr}},
+                                                   Document{{"x", 1}, {"largeStr", largeStr}},
+                                                   Document{{"x", 2}, {"largeStr", largeStr}}},
+                                                  expCtx);
+    group->setSource(mock.get());
+
+    // The groups are output once the whole input is consumed, although in no particular order.
+    std::map<int, size_t> pushedCounts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        pushedCounts[doc["_id"].coerceToInt()] = doc["spaceHog"].getArrayLength();
+    }
+    ASSERT_FALSE(group->isStreaming());
+
+    ASSERT_EQ(pushedCounts.size(), 2UL);
+    ASSERT_EQ(pushedCounts[1], 3UL);
+    ASSERT_EQ(pushedCounts[2], 1UL);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -31,11 +31,14 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/base/init.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
 #include "mongo/db/pipeline/document_path_support.h"
@@ -43,9 +46,11 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/variable_validation.h"
+#include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/str.h"
 
 namespace mongo {
 
@@ -287,6 +292,29 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
+    std::vector<Value> results;
+    long long objsize = 0;
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    auto appendResult = [&](Document result) {
+        long long safeSum = 0;
+        bool hasOverflowed = overflow::add(objsize, result.getApproximateSize(), &safeSum);
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching pipeline's $lookup stage exceeds " << maxBytes
+                              << " bytes",
+
+                !hasOverflowed && objsize <= maxBytes);
+        objsize = safeSum;
+        results.emplace_back(std::move(result));
+    };
+
+    if (!wasConstructedWithPipelineSyntax() && ensureForeignHashTable(inputDoc) &&
+        probeForeignHashTable(inputDoc, appendResult)) {
+        MutableDocument output(std::move(inputDoc));
+        output.setNestedField(_as, Value(std::move(results)));
+        return output.freeze();
+    }
+
     if (!wasConstructedWithPipelineSyntax()) {
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
@@ -309,21 +337,8 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
         throw;
     }
 
-    std::vector<Value> results;
-    long long objsize = 0;
-    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
-
     while (auto result = pipeline->getNext()) {
-        long long safeSum = 0;
-        bool hasOverflowed = overflow::add(objsize, result->getApproximateSize(), &safeSum);
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll()
-                              << " matching pipeline's $lookup stage exceeds " << maxBytes
-                              << " bytes",
-
-                !hasOverflowed && objsize <= maxBytes);
-        objsize = safeSum;
-        results.emplace_back(std::move(*result));
+        appendResult(std::move(*result));
     }
     _usedDisk = _usedDisk || pipeline->usedDisk();
 
@@ -332,6 +347,138 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     return output.freeze();
 }
 
+bool DocumentSourceLookUp::ensureForeignHashTable(const Document& inputDoc) {
+    if (_hashJoinState != HashJoinState::kUninitialized) {
+        return _hashJoinState == HashJoinState::kActive;
+    }
+    _hashJoinState = HashJoinState::kDisabled;
+
+    // The hash join reads the foreign collection locally, so it is only used when the foreign
+    // collection is known to be unsharded. An absorbed $unwind streams its results from
+    // '_pipeline' and keeps using the sub-pipeline.
+    const auto maxDocs = internalDocumentSourceLookupHashJoinMaxForeignDocs.load();
+    if (maxDocs <= 0 || _unwindSrc || pExpCtx->inMongos || foreignShardedLookupAllowed()) {
+        return false;
+    }
+
+    // A numeric path component may refer either to an array position or to a field name. Leave
+    // such paths to the query system.
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (str::parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return false;
+        }
+    }
+
+    BSONObjBuilder countBuilder;
+    auto status = pExpCtx->mongoProcessInterface->appendRecordCount(
+        pExpCtx->opCtx, _resolvedNs, &countBuilder);
+    if (!status.isOK() || countBuilder.obj()["count"].safeNumberLong() > maxDocs) {
+        return false;
+    }
+
+    // With an index on '_foreignField', each sub-pipeline is an indexed nested loop join which only
+    // reads the matching foreign documents, and is cheaper than scanning the whole collection.
+    if (foreignFieldHasSupportingIndex()) {
+        return false;
+    }
+
+    // Run the foreign pipeline once with an empty trailing $match, and index every document by the
+    // values found at '_foreignField'. Arrays at the end of the path are expanded as they are by
+    // the equality match built in makeMatchStageFromInput().
+    _resolvedPipeline.back() = BSON("$match" << BSONObj());
+    auto pipeline = buildPipeline(inputDoc);
+
+    const auto maxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    long long memoryBytes = 0;
+    _foreignTable.emplace(
+        _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>());
+    while (auto result = pipeline->getNext()) {
+        memoryBytes += result->getApproximateSize();
+        if (memoryBytes > maxMemoryBytes) {
+            _foreignDocs.clear();
+            _foreignTable.reset();
+            return false;
+        }
+
+        const auto docIndex = _foreignDocs.size();
+        document_path_support::visitAllValuesAtPath(
+            *result, *_foreignField, [&](const Value& nextValue) {
+                auto& positions = (*_foreignTable)[nextValue];
+                if (positions.empty() || positions.back() != docIndex) {
+                    positions.push_back(docIndex);
+                }
+            });
+        _foreignDocs.emplace_back(std::move(*result));
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+
+    _hashJoinState = HashJoinState::kActive;
+    return true;
+}
+
+bool DocumentSourceLookUp::foreignFieldHasSupportingIndex() const {
+    const auto* collator = _fromExpCtx->getCollator();
+    const auto collation = collator ? collator->getSpec().toBSON() : BSONObj();
+    for (auto&& spec : pExpCtx->mongoProcessInterface->getIndexSpecs(
+             pExpCtx->opCtx, _resolvedNs, false /* includeBuildUUIDs */)) {
+        // A partial index may not contain the documents to join with, and an index with another
+        // collation cannot answer equalities on strings.
+        if (spec.hasField("partialFilterExpression") ||
+            !SimpleBSONObjComparator::kInstance.evaluate(spec.getObjectField("collation") ==
+                                                         collation)) {
+            continue;
+        }
+
+        auto firstKey = spec.getObjectField("key").firstElement();
+        if (firstKey.fieldNameStringData() == _foreignField->fullPath() &&
+            (firstKey.isNumber() || firstKey.valueStringDataSafe() == IndexNames::HASHED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DocumentSourceLookUp::probeForeignHashTable(
+    const Document& inputDoc, const std::function<void(const Document&)>& onMatch) {
+    invariant(_hashJoinState == HashJoinState::kActive);
+
+    // Equality with null also matches missing fields, arrays may match as a whole and regexes only
+    // match other regexes. The hash table does not capture these cases, so we fall back to the
+    // sub-pipeline for them.
+    std::vector<Value> localValues;
+    bool canProbe = true;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        switch (value.getType()) {
+            case BSONType::jstNULL:
+            case BSONType::Undefined:
+            case BSONType::RegEx:
+            case BSONType::Array:
+                canProbe = false;
+                break;
+            default:
+                localValues.push_back(value);
+        }
+    });
+    if (!canProbe || localValues.empty()) {
+        return false;
+    }
+
+    std::vector<size_t> matches;
+    for (auto&& value : localValues) {
+        auto it = _foreignTable->find(value);
+        if (it != _foreignTable->end()) {
+            matches.insert(matches.end(), it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+    for (auto index : matches) {
+        onMatch(_foreignDocs[index]);
+    }
+    return true;
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -531,6 +678,9 @@ bool DocumentSourceLookUp::usedDisk() {
 }
 
 void DocumentSourceLookUp::doDispose() {
+    _hashJoinState = HashJoinState::kDisabled;
+    _foreignDocs.clear();
+    _foreignTable.reset();
     if (_pipeline) {
         _usedDisk = _usedDisk || _pipeline->usedDisk();
         _pipeline->dispose(pExpCtx->opCtx);
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <functional>
 
 #include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/pipeline/document_source.h"
@@ -239,6 +240,32 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Returns true if the foreign collection can be joined through an in-memory hash table rather
+     * than a per-document sub-pipeline, building the table on the first call. The hash join is
+     * only chosen for the localField/foreignField syntax when the record count of the foreign
+     * collection is below 'internalDocumentSourceLookupHashJoinMaxForeignDocs' and no index
+     * supports the lookups on '_foreignField', and is abandoned if the table grows beyond
+     * 'internalDocumentSourceLookupHashJoinMaxMemoryBytes'.
+     */
+    bool ensureForeignHashTable(const Document& inputDoc);
+
+    /**
+     * Returns true if the foreign collection has an index which the sub-pipeline can use to find
+     * the documents whose '_foreignField' equals a local value, such that joining through the
+     * sub-pipeline is an indexed nested loop join.
+     */
+    bool foreignFieldHasSupportingIndex() const;
+
+    /**
+     * Looks up the foreign documents joining with 'inputDoc' in the hash table and passes each of
+     * them, in foreign collection order, to 'onMatch'. Returns false without calling 'onMatch' if
+     * the local values of 'inputDoc' require the sub-pipeline to preserve query semantics (e.g.
+     * null, missing, regex or array values).
+     */
+    bool probeForeignHashTable(const Document& inputDoc,
+                               const std::function<void(const Document&)>& onMatch);
+
     /**
      * Resolves let defined variables against 'localDoc' and stores the results in 'variables'.
      */
@@ -305,6 +332,14 @@ private:
 
     std::vector<LetVariable> _letVariables;
 
+    // State of the in-memory hash join used for the localField/foreignField syntax. When active,
+    // '_foreignDocs' holds the output of the foreign pipeline and '_foreignTable' maps each value
+    // found at '_foreignField' to the positions of the documents containing it.
+    enum class HashJoinState { kUninitialized, kActive, kDisabled };
+    HashJoinState _hashJoinState = HashJoinState::kUninitialized;
+    std::vector<Document> _foreignDocs;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _foreignTable;
+
     boost::intrusive_ptr<DocumentSourceMatch> _matchSrc;
     boost::intrusive_ptr<DocumentSourceUnwind> _unwindSrc;
 
@@ -32,6 +32,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <boost/optional/optional_io.hpp>
 #include <deque>
+#include <list>
 #include <vector>
 
 #include "mongo/bson/bsonmisc.h"
@@ -50,6 +51,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -661,9 +663,11 @@ TEST(MakeMatchStageFromInput, ArrayValueWithRegexUsesOrQuery) {
 class MockMongoInterface final : public StubMongoProcessInterface {
 public:
     MockMongoInterface(deque<DocumentSource::GetNextResult> mockResults,
-                       bool removeLeadingQueryStages = false)
+                       bool removeLeadingQueryStages = false,
+                       std::list<BSONObj> indexSpecs = {})
         : _mockResults(std::move(mockResults)),
-          _removeLeadingQueryStages(removeLeadingQueryStages) {}
+          _removeLeadingQueryStages(removeLeadingQueryStages),
+          _indexSpecs(std::move(indexSpecs)) {}
 
     bool isSharded(OperationContext* opCtx, const NamespaceString& ns) final {
         return false;
@@ -684,12 +688,32 @@ public:
 
         pipeline->addInitialSource(
             DocumentSourceMock::createForTest(_mockResults, pipeline->getContext()));
+        ++_numPipelinesAttached;
         return pipeline;
     }
 
+    Status appendRecordCount(OperationContext* opCtx,
+                             const NamespaceString& nss,
+                             BSONObjBuilder* builder) const final {
+        builder->appendNumber("count", static_cast<long long>(_mockResults.size()));
+        return Status::OK();
+    }
+
+    std::list<BSONObj> getIndexSpecs(OperationContext* opCtx,
+                                     const NamespaceString& ns,
+                                     bool includeBuildUUIDs) final {
+        return _indexSpecs;
+    }
+
+    size_t numPipelinesAttached() const {
+        return _numPipelinesAttached;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    std::list<BSONObj> _indexSpecs;
+    size_t _numPipelinesAttached = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -798,6 +822,146 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+std::vector<Document> runLookupAgainstMockForeignCollection(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx,
+    deque<DocumentSource::GetNextResult> localContents,
+    deque<DocumentSource::GetNextResult> foreignContents,
+    size_t* numPipelinesAttached,
+    std::list<BSONObj> foreignIndexSpecs = {}) {
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+    auto mongoInterface = std::make_shared<MockMongoInterface>(
+        std::move(foreignContents), false, std::move(foreignIndexSpecs));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "x"_sd},
+                                         {"foreignField", "a"_sd},
+                                         {"as", "joined"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto mockLocalSource = DocumentSourceMock::createForTest(std::move(localContents), expCtx);
+    parsed->setSource(mockLocalSource.get());
+
+    std::vector<Document> results;
+    for (auto next = parsed->getNext(); next.isAdvanced(); next = parsed->getNext()) {
+        results.push_back(next.releaseDocument());
+    }
+    parsed->dispose();
+
+    *numPipelinesAttached = mongoInterface->numPipelinesAttached();
+    return results;
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinProducesSameResultsAsSubPipeline) {
+    deque<DocumentSource::GetNextResult> localContents{Document{{"x", 1}},
+                                                       Document{{"x", Value{BSON_ARRAY(2 << 3)}}},
+                                                       Document{{"x", 4}},
+                                                       Document{{"y", 1}}};
+    deque<DocumentSource::GetNextResult> foreignContents{
+        Document{{"_id", 0}, {"a", 1}},
+        Document{{"_id", 1}, {"a", Value{BSON_ARRAY(1 << 2 << 2)}}},
+        Document{{"_id", 2}, {"a", 3}},
+        Document{{"_id", 3}},
+        Document{{"_id", 4}, {"a", BSONNULL}}};
+
+    const std::vector<Document> expected{
+        Document{{"x", 1},
+                 {"joined",
+                  Value{BSON_ARRAY(BSON("_id" << 0 << "a" << 1)
+                                   << BSON("_id" << 1 << "a" << BSON_ARRAY(1 << 2 << 2)))}}},
+        Document{{"x", Value{BSON_ARRAY(2 << 3)}},
+                 {"joined",
+                  Value{BSON_ARRAY(BSON("_id" << 1 << "a" << BSON_ARRAY(1 << 2 << 2))
+                                   << BSON("_id" << 2 << "a" << 3))}}},
+        Document{{"x", 4}, {"joined", Value{std::vector<Value>()}}},
+        Document{{"y", 1},
+                 {"joined",
+                  Value{BSON_ARRAY(BSON("_id" << 3) << BSON("_id" << 4 << "a" << BSONNULL))}}}};
+
+    auto assertResultsEqual = [&](const std::vector<Document>& results) {
+        ASSERT_EQ(results.size(), expected.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(results[i], expected[i]);
+        }
+    };
+
+    // The hash join is disabled by default, so every input document runs the sub-pipeline.
+    size_t numPipelinesAttached = 0;
+    assertResultsEqual(runLookupAgainstMockForeignCollection(
+        getExpCtx(), localContents, foreignContents, &numPipelinesAttached));
+    ASSERT_EQ(numPipelinesAttached, localContents.size());
+
+    const auto maxForeignDocs = internalDocumentSourceLookupHashJoinMaxForeignDocs.load();
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceLookupHashJoinMaxForeignDocs.store(maxForeignDocs); });
+    internalDocumentSourceLookupHashJoinMaxForeignDocs.store(foreignContents.size());
+
+    // The foreign collection is loaded once into the hash table. Only the input document with a
+    // missing local field, which must also match null and missing foreign values, runs the
+    // sub-pipeline.
+    assertResultsEqual(runLookupAgainstMockForeignCollection(
+        getExpCtx(), localContents, foreignContents, &numPipelinesAttached));
+    ASSERT_EQ(numPipelinesAttached, 2U);
+
+    // An index on the foreign field makes each sub-pipeline an indexed nested loop join, which is
+    // preferred to the hash join. A partial index does not support the join.
+    assertResultsEqual(runLookupAgainstMockForeignCollection(
+        getExpCtx(),
+        localContents,
+        foreignContents,
+        &numPipelinesAttached,
+        {BSON("v" << 2 << "key" << BSON("a" << 1 << "b" << 1) << "name"
+                  << "a_1_b_1")}));
+    ASSERT_EQ(numPipelinesAttached, localContents.size());
+
+    assertResultsEqual(runLookupAgainstMockForeignCollection(
+        getExpCtx(),
+        localContents,
+        foreignContents,
+        &numPipelinesAttached,
+        {BSON("v" << 2 << "key" << BSON("a" << 1) << "name"
+                  << "a_1"
+                  << "partialFilterExpression" << BSON("a" << BSON("$gt" << 1)))}));
+    ASSERT_EQ(numPipelinesAttached, 2U);
+
+    // A foreign collection larger than the threshold is joined through a sub-pipeline per input
+    // document.
+    internalDocumentSourceLookupHashJoinMaxForeignDocs.store(foreignContents.size() - 1);
+    assertResultsEqual(runLookupAgainstMockForeignCollection(
+        getExpCtx(), localContents, foreignContents, &numPipelinesAttached));
+    ASSERT_EQ(numPipelinesAttached, localContents.size());
+}
+
+TEST_F(DocumentSourceLookUpTest, HashJoinFallsBackToSubPipelineWhenOverMemoryLimit) {
+    deque<DocumentSource::GetNextResult> localContents{Document{{"x", 1}}, Document{{"x", 2}}};
+    deque<DocumentSource::GetNextResult> foreignContents{Document{{"_id", 0}, {"a", 1}},
+                                                         Document{{"_id", 1}, {"a", 2}}};
+
+    const auto maxForeignDocs = internalDocumentSourceLookupHashJoinMaxForeignDocs.load();
+    const auto maxMemoryBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceLookupHashJoinMaxForeignDocs.store(maxForeignDocs);
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(maxMemoryBytes);
+    });
+    internalDocumentSourceLookupHashJoinMaxForeignDocs.store(foreignContents.size());
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1);
+
+    // The aborted attempt to build the hash table accounts for one of the attached pipelines.
+    size_t numPipelinesAttached = 0;
+    auto results = runLookupAgainstMockForeignCollection(
+        getExpCtx(), localContents, foreignContents, &numPipelinesAttached);
+    ASSERT_EQ(numPipelinesAttached, localContents.size() + 1);
+
+    ASSERT_EQ(results.size(), 2U);
+    ASSERT_DOCUMENT_EQ(results[0],
+                       (Document{{"x", 1}, {"joined", {Document{{"_id", 0}, {"a", 1}}}}}));
+    ASSERT_DOCUMENT_EQ(results[1],
+                       (Document{{"x", 2}, {"joined", {Document{{"_id", 1}, {"a", 2}}}}}));
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
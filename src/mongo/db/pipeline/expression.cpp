@@ -235,19 +235,41 @@ const char* ExpressionAbs::getOpName() const {
 /* ------------------------- ExpressionAdd ----------------------------- */
 
 Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const {
+    const size_t n = _children.size();
+
+    // Sums of integers are by far the most common, so the operands are first added up as a plain
+    // 64-bit integer. The first operand which is not an integer, or which would overflow that
+    // integer, hands the partial sum over to the general path below.
+    long long longTotal = 0;
+    BSONType totalType = NumberInt;
+    Value val;
+    size_t i = 0;
+    for (; i < n; ++i) {
+        val = _children[i]->evaluate(root, variables);
+        const BSONType type = val.getType();
+        long long nextTotal;
+        if ((type != NumberInt && type != NumberLong) ||
+            overflow::add(longTotal, val.coerceToLong(), &nextTotal)) {
+            break;
+        }
+        longTotal = nextTotal;
+        if (type == NumberLong)
+            totalType = NumberLong;
+    }
+    if (i == n) {
+        return totalType == NumberInt ? Value::createIntOrLong(longTotal) : Value(longTotal);
+    }
+
     // We'll try to return the narrowest possible result value while avoiding overflow, loss
     // of precision due to intermediate rounding or implicit use of decimal types. To do that,
     // compute a compensated sum for non-decimal values and a separate decimal sum for decimal
     // values, and track the current narrowest type.
     DoubleDoubleSummation nonDecimalTotal;
+    nonDecimalTotal.addLong(longTotal);
     Decimal128 decimalTotal;
-    BSONType totalType = NumberInt;
     bool haveDate = false;
 
-    const size_t n = _children.size();
-    for (size_t i = 0; i < n; ++i) {
-        Value val = _children[i]->evaluate(root, variables);
-
+    for (;;) {
         switch (val.getType()) {
             case NumberDecimal:
                 decimalTotal = decimalTotal.add(val.getDecimal());
@@ -278,17 +300,21 @@ Value ExpressionAdd::evaluate(const Document& root, Variables* variables) const
                         val.nullish());
                 return Value(BSONNULL);
         }
+
+        if (++i == n)
+            break;
+        val = _children[i]->evaluate(root, variables);
     }
 
     if (haveDate) {
-        int64_t longTotal;
+        int64_t dateTotal;
         if (totalType == NumberDecimal) {
-            longTotal = decimalTotal.add(nonDecimalTotal.getDecimal()).toLong();
+            dateTotal = decimalTotal.add(nonDecimalTotal.getDecimal()).toLong();
         } else {
             uassert(ErrorCodes::Overflow, "date overflow in $add", nonDecimalTotal.fitsLong());
-            longTotal = nonDecimalTotal.getLong();
+            dateTotal = nonDecimalTotal.getLong();
         }
-        return Value(Date_t::fromMillisSinceEpoch(longTotal));
+        return Value(Date_t::fromMillisSinceEpoch(dateTotal));
     }
     switch (totalType) {
         case NumberDecimal:
@@ -2751,10 +2777,26 @@ Value ExpressionMultiply::evaluate(const Document& root, Variables* variables) c
 
     BSONType productType = NumberInt;
 
+    // Integer operands are multiplied without going through the type promotion below for as long
+    // as the product fits in 64 bits.
     const size_t n = _children.size();
-    for (size_t i = 0; i < n; ++i) {
-        Value val = _children[i]->evaluate(root, variables);
+    Value val;
+    size_t i = 0;
+    for (; i < n; ++i) {
+        val = _children[i]->evaluate(root, variables);
+        const BSONType type = val.getType();
+        long long nextProduct;
+        if ((type != NumberInt && type != NumberLong) ||
+            overflow::mul(longProduct, val.coerceToLong(), &nextProduct)) {
+            break;
+        }
+        longProduct = nextProduct;
+        doubleProduct *= val.coerceToDouble();
+        if (type == NumberLong)
+            productType = NumberLong;
+    }
 
+    for (; i < n; ++i) {
         if (val.numeric()) {
             BSONType oldProductType = productType;
             productType = Value::getWidestNumeric(productType, val.getType());
@@ -2783,6 +2825,9 @@ Value ExpressionMultiply::evaluate(const Document& root, Variables* variables) c
                       str::stream() << "$multiply only supports numeric types, not "
                                     << typeName(val.getType()));
         }
+
+        if (i + 1 < n)
+            val = _children[i + 1]->evaluate(root, variables);
     }
 
     if (productType == NumberDouble)
@@ -262,6 +262,10 @@ public:
         return tailableMode == TailableModeEnum::kTailableAndAwaitData;
     }
 
+    const StringMap<ResolvedNamespace>& getResolvedNamespaces() const {
+        return _resolvedNamespaces;
+    }
+
     void setResolvedNamespaces(StringMap<ResolvedNamespace> resolvedNamespaces) {
         _resolvedNamespaces = std::move(resolvedNamespaces);
     }
@@ -235,6 +235,54 @@ TEST(ExpressionReverseArrayTest, ReturnsNullWithNullishInput) {
         {{{Value(BSONNULL)}, Value(BSONNULL)}, {{Value(BSONUndefined)}, Value(BSONNULL)}});
 }
 
+/* ------------------------- ExpressionAdd / ExpressionMultiply -------------------------- */
+
+TEST(ExpressionAddTest, IntegerOperandsKeepTheNarrowestType) {
+    assertExpectedResults("$add",
+                          {{{1, 2, 3}, 6},
+                           {{1, 2LL, 3}, 6LL},
+                           {{numeric_limits<int>::max(), numeric_limits<int>::max(), 1},
+                            2LL * numeric_limits<int>::max() + 1}});
+}
+
+TEST(ExpressionAddTest, IntegerSumWhichOverflowsPartWayIsExact) {
+    const auto llMax = numeric_limits<long long>::max();
+    assertExpectedResults("$add",
+                          {{{llMax, 1, -1}, llMax},
+                           {{llMax, 1, 1}, static_cast<double>(llMax) + 2},
+                           {{-1, llMax, 1, 1.5}, static_cast<double>(llMax) + 1.5}});
+}
+
+TEST(ExpressionAddTest, NonIntegerOperandAfterIntegers) {
+    assertExpectedResults("$add",
+                          {{{1, 2, 0.5}, 3.5},
+                           {{1, 2LL, Decimal128("0.5")}, Decimal128("3.5")},
+                           {{1, 2, Date_t::fromMillisSinceEpoch(100)},
+                            Date_t::fromMillisSinceEpoch(103)},
+                           {{1, 2LL, Value(BSONNULL)}, Value(BSONNULL)}});
+}
+
+TEST(ExpressionMultiplyTest, IntegerOperandsKeepTheNarrowestType) {
+    assertExpectedResults("$multiply",
+                          {{{2, 3, 4}, 24},
+                           {{2, 3LL}, 6LL},
+                           {{numeric_limits<int>::max(), 2},
+                            2LL * numeric_limits<int>::max()}});
+}
+
+TEST(ExpressionMultiplyTest, IntegerProductWhichOverflowsIsADouble) {
+    const auto llMax = numeric_limits<long long>::max();
+    assertExpectedResults("$multiply",
+                          {{{llMax, 2, 0}, 0.0}, {{llMax, 2LL}, static_cast<double>(llMax) * 2}});
+}
+
+TEST(ExpressionMultiplyTest, NonIntegerOperandAfterIntegers) {
+    assertExpectedResults("$multiply",
+                          {{{2, 3, 0.5}, 3.0},
+                           {{2, 3LL, Decimal128("0.5")}, Decimal128("3.0")},
+                           {{2, 3LL, Value(BSONNULL)}, Value(BSONNULL)}});
+}
+
 /* ------------------------- Old-style tests -------------------------- */
 
 namespace Add {
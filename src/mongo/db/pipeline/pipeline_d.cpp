@@ -70,7 +70,9 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/sbe_stage_builder.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/service_context.h"
@@ -198,7 +200,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     boost::optional<std::string> groupIdForDistinctScan,
     const AggregationRequest* aggRequest,
     const size_t plannerOpts,
-    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures) {
+    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures,
+    boost::optional<CanonicalQuery::PushedDownGroup> pushedDownGroup = boost::none) {
     auto qr = std::make_unique<QueryRequest>(nss);
     qr->setTailableMode(expCtx->tailableMode);
     qr->setFilter(queryObj);
@@ -237,6 +240,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     // Mark the metadata that's requested by the pipeline on the CQ.
     cq.getValue()->requestAdditionalMetadata(metadataRequested);
 
+    if (pushedDownGroup) {
+        cq.getValue()->setPushedDownGroup(std::move(*pushedDownGroup));
+    }
+
     if (groupIdForDistinctScan) {
         // When the pipeline includes a $group that groups by a single field
         // (groupIdForDistinctScan), we use getExecutorDistinct() to attempt to get an executor that
@@ -471,6 +478,33 @@ SkipThenLimit extractSkipAndLimitForPushdown(Pipeline* pipeline) {
     return skipThenLimit;
 }
 
+/**
+ * Returns the $group at the front of 'pipeline' if the slot-based execution engine can compute it
+ * as a hash aggregation on top of the query, or nullptr otherwise.
+ */
+boost::intrusive_ptr<DocumentSourceGroup> findGroupForSbePushdown(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    const CollectionPtr& collection,
+    Pipeline* pipeline) {
+    if (!internalQueryEnableSlotBasedExecutionEngine.load() || !collection ||
+        expCtx->tailableMode != TailableModeEnum::kNormal) {
+        return nullptr;
+    }
+
+    // A $group which merges partial groups, or whose groups are to be merged later on, works on
+    // the partial states of its accumulators rather than on their values. The aggregate functions
+    // of the slot-based engine compare values without a collation.
+    auto groupStage = dynamic_cast<DocumentSourceGroup*>(pipeline->peekFront());
+    if (!groupStage || groupStage->doingMerge() || expCtx->needsMerge || expCtx->getCollator()) {
+        return nullptr;
+    }
+
+    return stage_builder::isGroupSupportedBySbe(groupStage->getIdExpression().get(),
+                                                groupStage->getAccumulatedFields())
+        ? groupStage
+        : nullptr;
+}
+
 /**
  * Given a dependency set and a pipeline, builds a projection BSON object to push down into the
  * PlanStage layer. The rules to push down the projection are as follows:
@@ -711,13 +745,23 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         // Since the limit from $sort is going before the extracted $skip stages, we construct
         // 'LimitThenSkip' object and then convert it 'SkipThenLimit'.
         skipThenLimit = LimitThenSkip(sortStage->getLimit(), skip).flip();
+
+        // A $group which now reads the sorted output of the executor can output each of its groups
+        // as soon as the input moves past it, if it groups by the leading fields of the sort.
+        if (auto groupStage = dynamic_cast<DocumentSourceGroup*>(pipeline->peekFront())) {
+            groupStage->setSortedInput(sortStage->getSortKeyPattern());
+        }
     }
 
     // Perform dependency analysis. In order to minimize the dependency set, we only analyze the
     // stages that remain in the pipeline after pushdown. In particular, any dependencies for a
     // $match or $sort pushed down into the query layer will not be reflected here.
     auto deps = pipeline->getDependencies(unavailableMetadata);
-    *hasNoRequirements = deps.hasNoRequirements();
+
+    // A $group pushed down into the query reads the documents of the query even if it needs none
+    // of their fields, so the query must not be answered as a count.
+    auto groupForPushdown = findGroupForSbePushdown(expCtx, collection, pipeline);
+    *hasNoRequirements = !groupForPushdown && deps.hasNoRequirements();
 
     BSONObj projObj;
     if (*hasNoRequirements) {
@@ -774,6 +818,31 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         }
     }
 
+    if (groupForPushdown) {
+        auto swExecutorGrouped =
+            attemptToGetExecutor(expCtx,
+                                 collection,
+                                 nss,
+                                 queryObj,
+                                 projObj,
+                                 deps.metadataDeps(),
+                                 sortObj,
+                                 skipThenLimit,
+                                 boost::none, /* groupIdForDistinctScan */
+                                 aggRequest,
+                                 plannerOpts,
+                                 matcherFeatures,
+                                 CanonicalQuery::PushedDownGroup{
+                                     groupForPushdown->getIdExpression(),
+                                     groupForPushdown->getAccumulatedFields()});
+
+        // The executor computes the groups, so the $group stage is removed from the pipeline.
+        if (swExecutorGrouped.isOK()) {
+            pipeline->popFrontWithName(DocumentSourceGroup::kStageName);
+        }
+        return swExecutorGrouped;
+    }
+
     return attemptToGetExecutor(expCtx,
                                 collection,
                                 nss,
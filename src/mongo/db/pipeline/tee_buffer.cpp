@@ -37,19 +37,36 @@
 
 namespace mongo {
 
-TeeBuffer::TeeBuffer(size_t nConsumers, size_t bufferSizeBytes)
-    : _bufferSizeBytes(bufferSizeBytes), _consumers(nConsumers) {}
-
-boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers, int bufferSizeBytes) {
+TeeBuffer::TeeBuffer(size_t nConsumers, size_t bufferSizeBytes, bool concurrentConsumers)
+    : _bufferSizeBytes(bufferSizeBytes),
+      _concurrentConsumers(concurrentConsumers),
+      _consumers(nConsumers) {}
+
+boost::intrusive_ptr<TeeBuffer> TeeBuffer::create(size_t nConsumers,
+                                                  int bufferSizeBytes,
+                                                  bool concurrentConsumers) {
     uassert(40309, "need at least one consumer for a TeeBuffer", nConsumers > 0);
     uassert(40310,
             str::stream() << "TeeBuffer requires a positive buffer size, was given "
                           << bufferSizeBytes,
             bufferSizeBytes > 0);
-    return new TeeBuffer(nConsumers, bufferSizeBytes);
+    return new TeeBuffer(nConsumers, bufferSizeBytes, concurrentConsumers);
 }
 
 DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
+    if (_concurrentConsumers) {
+        // The consumer only looks at its own state, as the others may be running at the same time.
+        auto& consumer = _consumers[consumerId];
+        if (consumer.nLeftToReturn == 0) {
+            return _sourceExhausted ? DocumentSource::GetNextResult::makeEOF()
+                                    : DocumentSource::GetNextResult::makePauseExecution();
+        }
+
+        const size_t bufferIndex = _sharedBuffer.size() - consumer.nLeftToReturn;
+        --consumer.nLeftToReturn;
+        return Document::fromBsonWithMetaData(_sharedBuffer[bufferIndex]);
+    }
+
     size_t nConsumersStillProcessingThisBatch =
         std::count_if(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
             return info.nLeftToReturn > 0;
@@ -76,6 +93,50 @@ DocumentSource::GetNextResult TeeBuffer::getNext(size_t consumerId) {
     return _buffer[bufferIndex];
 }
 
+bool TeeBuffer::loadNextSharedBatch() {
+    invariant(_concurrentConsumers);
+    _sharedBuffer.clear();
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (!hasConsumersInUse(lk)) {
+            _sourceExhausted = true;
+            if (_source) {
+                _source->dispose();
+            }
+        }
+    }
+    if (_sourceExhausted) {
+        return false;
+    }
+
+    // The documents are shared by consumers running on different threads as BSON, since a
+    // Document lazily caches its fields when they are read.
+    size_t bytesInBuffer = 0;
+    auto input = _source->getNext();
+    for (; input.isAdvanced(); input = _source->getNext()) {
+        _sharedBuffer.push_back(input.getDocument().toBsonWithMetaData());
+        bytesInBuffer += _sharedBuffer.back().objsize();
+
+        if (bytesInBuffer >= _bufferSizeBytes) {
+            break;  // Need to break here so we don't get the next input and accidentally ignore it.
+        }
+    }
+    invariant(!input.isPaused());  // NOLINT(bugprone-use-after-move)
+
+    if (_sharedBuffer.empty()) {
+        _sourceExhausted = true;
+        return false;
+    }
+
+    for (auto&& consumer : _consumers) {
+        if (consumer.stillInUse) {
+            consumer.nLeftToReturn = _sharedBuffer.size();
+        }
+    }
+    return true;
+}
+
 void TeeBuffer::loadNextBatch() {
     _buffer.clear();
     size_t bytesInBuffer = 0;
@@ -36,6 +36,8 @@
 #include "mongo/db/exec/document_value/document.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/intrusive_counter.h"
 
 namespace mongo {
@@ -45,6 +47,10 @@ namespace mongo {
  * do so, it will batch incoming documents and allow each consumer to consume one batch at a time.
  * As a consequence, consumers must be able to pause their execution to allow other consumers to
  * process the batch before moving to the next batch.
+ *
+ * If the consumers run concurrently on threads other than the one which owns the source, the
+ * batches are loaded by the owner of the source through loadNextSharedBatch() while no consumer
+ * runs, and each consumer is handed its own copy of every document of the batch.
  */
 class TeeBuffer : public RefCountable {
 public:
@@ -53,7 +59,9 @@ public:
      * 'bufferSizeBytes' is a soft cap, and may be exceeded by one document's worth (~16MB).
      */
     static boost::intrusive_ptr<TeeBuffer> create(
-        size_t nConsumers, int bufferSizeBytes = internalQueryFacetBufferSizeBytes.load());
+        size_t nConsumers,
+        int bufferSizeBytes = internalQueryFacetBufferSizeBytes.load(),
+        bool concurrentConsumers = false);
 
     void setSource(DocumentSource* source) {
         _source = source;
@@ -64,11 +72,13 @@ public:
      * consumer will not consume all input.
      */
     void dispose(size_t consumerId) {
+        stdx::lock_guard<Latch> lk(_mutex);
         _consumers[consumerId].stillInUse = false;
         _consumers[consumerId].nLeftToReturn = 0;
-        if (std::none_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
-                return info.stillInUse;
-            })) {
+
+        // Concurrent consumers may be disposed of on a thread which does not own the source, which
+        // is instead disposed of by the next call to loadNextSharedBatch().
+        if (!_concurrentConsumers && !hasConsumersInUse(lk)) {
             _buffer.clear();
             if (_source) {
                 _source->dispose();
@@ -83,8 +93,21 @@ public:
      */
     DocumentSource::GetNextResult getNext(size_t consumerId);
 
+    /**
+     * Loads the next batch of documents for consumers which run concurrently. Must only be called
+     * while none of the consumers is running. Returns false, and disposes of the source if no
+     * consumer is left, once there is nothing left for the consumers to consume.
+     */
+    bool loadNextSharedBatch();
+
 private:
-    TeeBuffer(size_t nConsumers, size_t bufferSizeBytes);
+    TeeBuffer(size_t nConsumers, size_t bufferSizeBytes, bool concurrentConsumers);
+
+    bool hasConsumersInUse(WithLock) const {
+        return std::any_of(_consumers.begin(), _consumers.end(), [](const ConsumerInfo& info) {
+            return info.stillInUse;
+        });
+    }
 
     /**
      * Clears '_buffer', then keeps requesting results from '_source' and pushing them all into
@@ -98,6 +121,15 @@ private:
     const size_t _bufferSizeBytes;
     std::vector<DocumentSource::GetNextResult> _buffer;
 
+    // Set if the consumers run concurrently, in which case the documents are buffered as BSON, out
+    // of which every consumer builds its own copy of each document.
+    const bool _concurrentConsumers;
+    std::vector<BSONObj> _sharedBuffer;
+    bool _sourceExhausted = false;
+
+    // Guards the 'stillInUse' flags of '_consumers', which concurrent consumers update on disposal.
+    Mutex _mutex = MONGO_MAKE_LATCH("TeeBuffer::_mutex");
+
     struct ConsumerInfo {
         bool stillInUse = true;
         int nLeftToReturn = 0;
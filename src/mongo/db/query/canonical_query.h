@@ -35,6 +35,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/projection.h"
 #include "mongo/db/query/projection_policies.h"
@@ -51,6 +52,15 @@ public:
     // sort with the values taken out.
     typedef std::string QueryShapeString;
 
+    /**
+     * A $group stage of the aggregation pipeline this query is the prefix of, which is executed by
+     * the query layer on top of the documents matching the query.
+     */
+    struct PushedDownGroup {
+        boost::intrusive_ptr<Expression> groupByExpression;
+        std::vector<AccumulationStatement> accumulators;
+    };
+
     /**
      * If parsing succeeds, returns a std::unique_ptr<CanonicalQuery> representing the parsed
      * query (which will never be NULL).  If parsing fails, returns an error Status.
@@ -158,6 +168,18 @@ public:
         return _expCtx->getCollator();
     }
 
+    /**
+     * Returns the $group stage pushed down into this query, if any. See
+     * QueryPlanner::extendWithAggPipeline().
+     */
+    const boost::optional<PushedDownGroup>& getPushedDownGroup() const {
+        return _pushedDownGroup;
+    }
+
+    void setPushedDownGroup(PushedDownGroup group) {
+        _pushedDownGroup = std::move(group);
+    }
+
     /**
      * Returns a bitset indicating what metadata has been requested in the query.
      */
@@ -243,6 +265,8 @@ private:
 
     boost::optional<SortPattern> _sortPattern;
 
+    boost::optional<PushedDownGroup> _pushedDownGroup;
+
     // Keeps track of what metadata has been explicitly requested.
     QueryMetadataBitSet _metadataDeps;
 
@@ -0,0 +1,412 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <cmath>
+
+#include "mongo/bson/bsonelement_comparator_interface.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/service_context.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+namespace {
+
+namespace dps = ::mongo::dotted_path_support;
+
+// How long the cached statistics of a field, or the absence thereof, are trusted before being
+// read again from 'system.statistics', which may have been updated by another node.
+constexpr Seconds kCacheEntryLifetime{60};
+
+/**
+ * Owns the pool of the background thread which loads the statistics of the fields looked up by
+ * the query planner. The pool is started on first use and shut down along with the server.
+ */
+class StatisticsLoader {
+public:
+    ~StatisticsLoader() {
+        shutdown();
+    }
+
+    void schedule(ThreadPool::Task task) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        if (!_pool && !_inShutdown) {
+            ThreadPool::Options options;
+            options.poolName = "CollectionStatisticsLoader";
+            options.threadNamePrefix = "CollectionStatisticsLoader-";
+            options.minThreads = 0;
+            options.maxThreads = 1;
+            options.onCreateThread = [](const std::string& threadName) {
+                Client::initThread(threadName);
+            };
+            _pool = std::make_unique<ThreadPool>(options);
+            _pool->startup();
+        }
+        if (!_pool) {
+            lk.unlock();
+            task(Status(ErrorCodes::ShutdownInProgress, "The statistics loader is shut down"));
+            return;
+        }
+
+        // A pool which has been shut down since runs the task right away with an error status.
+        _pool->schedule(std::move(task));
+    }
+
+    void shutdown() {
+        ThreadPool* pool;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            if (_inShutdown) {
+                return;
+            }
+            _inShutdown = true;
+            pool = _pool.get();
+        }
+
+        if (pool) {
+            pool->shutdown();
+            pool->join();
+        }
+    }
+
+private:
+    Mutex _mutex = MONGO_MAKE_LATCH("StatisticsLoader::_mutex");
+    std::unique_ptr<ThreadPool> _pool;
+    bool _inShutdown = false;
+};
+
+const auto getStatisticsLoader = ServiceContext::declareDecoration<StatisticsLoader>();
+
+const auto getCollectionStatisticsCache =
+    SharedCollectionDecorations::declareDecoration<CollectionStatisticsCache>();
+
+const BSONObj kNullValue = BSON("" << BSONNULL);
+
+NamespaceString statisticsNamespace(const NamespaceString& nss) {
+    return NamespaceString(nss.db(), NamespaceString::kSystemDotStatisticsCollectionName);
+}
+
+std::shared_ptr<const FieldStatistics> loadFieldStatistics(OperationContext* opCtx,
+                                                           const NamespaceString& nss,
+                                                           const UUID& collectionUUID,
+                                                           StringData path) {
+    DBDirectClient client(opCtx);
+    auto obj = client.findOne(statisticsNamespace(nss).ns(),
+                              BSON("_id" << FieldStatistics::makeId(nss.coll(), path)));
+    if (obj.isEmpty()) {
+        return nullptr;
+    }
+
+    auto swStats = FieldStatistics::parse(obj);
+    if (!swStats.isOK()) {
+        LOGV2_WARNING(5300800,
+                      "Ignoring invalid field statistics",
+                      "namespace"_attr = nss,
+                      "path"_attr = path,
+                      "error"_attr = swStats.getStatus());
+        return nullptr;
+    }
+
+    // The statistics may have been gathered on a collection of the same name which has since been
+    // dropped.
+    if (swStats.getValue().collectionUUID != collectionUUID) {
+        return nullptr;
+    }
+    return std::make_shared<const FieldStatistics>(std::move(swStats.getValue()));
+}
+
+}  // namespace
+
+FieldStatistics FieldStatistics::gather(OperationContext* opCtx,
+                                        const CollectionPtr& collection,
+                                        StringData path,
+                                        size_t numBuckets,
+                                        size_t sampleSize) {
+    invariant(collection);
+    invariant(sampleSize > 0);
+
+    FieldStatistics stats;
+    stats.collectionUUID = collection->uuid();
+    stats.path = path.toString();
+
+    // A uniform sample of the values along 'path', maintained by reservoir sampling.
+    std::vector<BSONObj> sample;
+    auto& prng = opCtx->getClient()->getPrng();
+
+    auto exec = InternalPlanner::collectionScan(
+        opCtx, collection->ns().ns(), &collection, PlanYieldPolicy::YieldPolicy::YIELD_AUTO);
+
+    BSONObj obj;
+    BSONElementSet values;
+    while (exec->getNext(&obj, nullptr) == PlanExecutor::ADVANCED) {
+        ++stats.numRecords;
+
+        values.clear();
+        dps::extractAllElementsAlongPath(obj, path, values);
+        if (values.empty()) {
+            values.insert(kNullValue.firstElement());
+        }
+
+        for (auto&& value : values) {
+            stats.sketch.add(value);
+            if (sample.size() < sampleSize) {
+                sample.push_back(value.wrap(""));
+            } else if (auto i = prng.nextInt64(stats.numValues + 1);
+                       static_cast<size_t>(i) < sampleSize) {
+                sample[i] = value.wrap("");
+            }
+            ++stats.numValues;
+        }
+    }
+
+    std::vector<BSONElement> sampledValues;
+    sampledValues.reserve(sample.size());
+    for (auto&& value : sample) {
+        sampledValues.push_back(value.firstElement());
+    }
+    stats.histogram = Histogram::make(std::move(sampledValues), numBuckets);
+    stats.lastUpdated = Date_t::now();
+    return stats;
+}
+
+StatusWith<FieldStatistics> FieldStatistics::parse(const BSONObj& obj) {
+    try {
+        FieldStatistics stats;
+
+        auto swUUID = UUID::parse(obj[kCollectionUUIDField]);
+        if (!swUUID.isOK()) {
+            return swUUID.getStatus();
+        }
+        stats.collectionUUID = swUUID.getValue();
+
+        auto pathElem = obj[kPathField];
+        auto numRecordsElem = obj[kNumRecordsField];
+        auto numValuesElem = obj[kNumValuesField];
+        auto histogramElem = obj[kHistogramField];
+        auto lastUpdatedElem = obj[kLastUpdatedField];
+        if (pathElem.type() != BSONType::String || !numRecordsElem.isNumber() ||
+            !numValuesElem.isNumber() || histogramElem.type() != BSONType::Object ||
+            lastUpdatedElem.type() != BSONType::Date) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "Malformed field statistics: " << obj.toString()};
+        }
+        stats.path = pathElem.str();
+        stats.numRecords = numRecordsElem.safeNumberLong();
+        stats.numValues = numValuesElem.safeNumberLong();
+        stats.lastUpdated = lastUpdatedElem.date();
+
+        auto swSketch = HyperLogLog::parse(obj[kSketchField]);
+        if (!swSketch.isOK()) {
+            return swSketch.getStatus();
+        }
+        stats.sketch = std::move(swSketch.getValue());
+
+        auto swHistogram = Histogram::parse(histogramElem.Obj());
+        if (!swHistogram.isOK()) {
+            return swHistogram.getStatus();
+        }
+        stats.histogram = std::move(swHistogram.getValue());
+
+        return std::move(stats);
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    }
+}
+
+std::string FieldStatistics::makeId(StringData collName, StringData path) {
+    return str::stream() << collName << "." << path;
+}
+
+BSONObj FieldStatistics::toBSON() const {
+    BSONObjBuilder builder;
+    collectionUUID.appendToBuilder(&builder, kCollectionUUIDField);
+    builder.append(kPathField, path);
+    builder.append(kNumRecordsField, numRecords);
+    builder.append(kNumValuesField, numValues);
+    sketch.serialize(kSketchField, &builder);
+    builder.append(kHistogramField, histogram.toBSON());
+    builder.append(kLastUpdatedField, lastUpdated);
+    return builder.obj();
+}
+
+bool FieldStatistics::isStale(long long currentNumRecords) const {
+    const double change = std::abs(static_cast<double>(currentNumRecords - numRecords));
+    return change > internalQueryCollectionStatisticsStalenessRatio.load() *
+        std::max(numRecords, 1LL);
+}
+
+double FieldStatistics::estimateCardinality(const OrderedIntervalList& oil,
+                                            long long currentNumRecords) const {
+    if (histogram.totalCount() == 0 || numRecords == 0) {
+        return 0;
+    }
+
+    double sampled = 0;
+    for (auto&& interval : oil.intervals) {
+        sampled += histogram.estimateCardinality(interval);
+    }
+
+    // Scale the estimate from the sample to the values of the whole collection, then to its
+    // current size.
+    return sampled * (static_cast<double>(numValues) / histogram.totalCount()) *
+        (static_cast<double>(currentNumRecords) / numRecords);
+}
+
+void persistFieldStatistics(OperationContext* opCtx,
+                            const NamespaceString& nss,
+                            std::shared_ptr<const FieldStatistics> stats) {
+    // Clients cannot write to 'system.statistics', see userAllowedWriteNS(), so the statistics are
+    // written directly rather than through a write command.
+    const auto statisticsNss = statisticsNamespace(nss);
+    {
+        AutoGetCollection statisticsCollection(opCtx, statisticsNss, MODE_IX);
+        uassert(ErrorCodes::NotWritablePrimary,
+                str::stream() << "Not primary while writing to " << statisticsNss,
+                repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx,
+                                                                              statisticsNss));
+        writeConflictRetry(opCtx, "persistFieldStatistics", statisticsNss.ns(), [&] {
+            Helpers::upsert(opCtx,
+                            statisticsNss.ns(),
+                            BSON("_id" << FieldStatistics::makeId(nss.coll(), stats->path)),
+                            stats->toBSON());
+        });
+    }
+
+    AutoGetCollectionForRead collection(opCtx, nss);
+    if (collection && collection->uuid() == stats->collectionUUID) {
+        CollectionStatisticsCache::get(collection.getCollection()).set(std::move(stats));
+    }
+}
+
+CollectionStatisticsCache& CollectionStatisticsCache::get(const CollectionPtr& collection) {
+    return getCollectionStatisticsCache(collection->getSharedDecorations());
+}
+
+std::shared_ptr<const FieldStatistics> CollectionStatisticsCache::lookup(
+    OperationContext* opCtx, const CollectionPtr& collection, StringData path) {
+    const auto now = Date_t::now();
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto& entry = _entries[path];
+    if (now - entry.loadedAt >= kCacheEntryLifetime && !entry.loading &&
+        !collection->ns().isSystemDotStatistics()) {
+        entry.loading = true;
+        scheduleLoad(opCtx->getServiceContext(),
+                     collection->ns().db().toString(),
+                     collection->uuid(),
+                     path.toString());
+    }
+    return entry.stats;
+}
+
+void CollectionStatisticsCache::shutdown(ServiceContext* serviceContext) {
+    getStatisticsLoader(serviceContext).shutdown();
+}
+
+void CollectionStatisticsCache::scheduleLoad(ServiceContext* serviceContext,
+                                             std::string dbName,
+                                             UUID collectionUUID,
+                                             std::string path) {
+    const auto startedAt = Date_t::now();
+    getStatisticsLoader(serviceContext).schedule([=](Status status) {
+        if (!status.isOK()) {
+            return;
+        }
+
+        auto opCtx = cc().makeOperationContext();
+        try {
+            // Resolve the collection again, as it may have been renamed or dropped since.
+            const NamespaceStringOrUUID nssOrUUID{dbName, collectionUUID};
+            auto nss = [&] {
+                AutoGetCollectionForRead collection(opCtx.get(), nssOrUUID);
+                return collection.getNss();
+            }();
+
+            StatusWith<std::shared_ptr<const FieldStatistics>> swStats{nullptr};
+            try {
+                swStats = loadFieldStatistics(opCtx.get(), nss, collectionUUID, path);
+            } catch (const DBException& ex) {
+                LOGV2_DEBUG(5300801,
+                            2,
+                            "Failed to load field statistics",
+                            "namespace"_attr = nss,
+                            "path"_attr = path,
+                            "error"_attr = ex.toStatus());
+                swStats = ex.toStatus();
+            }
+
+            AutoGetCollectionForRead collection(opCtx.get(), nssOrUUID);
+            if (collection) {
+                get(collection.getCollection()).finishLoading(path, std::move(swStats), startedAt);
+            }
+        } catch (const DBException&) {
+            // The collection, and the cache along with it, is gone.
+        }
+    });
+}
+
+void CollectionStatisticsCache::finishLoading(
+    StringData path,
+    StatusWith<std::shared_ptr<const FieldStatistics>> swStats,
+    Date_t startedAt) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto& entry = _entries[path];
+    entry.loading = false;
+    if (entry.loadedAt > startedAt) {
+        return;
+    }
+    if (swStats.isOK()) {
+        entry.stats = std::move(swStats.getValue());
+    }
+    entry.loadedAt = Date_t::now();
+}
+
+void CollectionStatisticsCache::set(std::shared_ptr<const FieldStatistics> stats) {
+    stdx::lock_guard<Latch> lk(_mutex);
+    auto& entry = _entries[stats->path];
+    entry.stats = std::move(stats);
+    entry.loadedAt = Date_t::now();
+}
+
+}  // namespace mongo
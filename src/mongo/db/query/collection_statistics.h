@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/histogram.h"
+#include "mongo/db/query/hyperloglog.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * The statistics gathered by the 'analyze' command about the values of one field of a collection.
+ * They are persisted in the 'system.statistics' collection of the database, in a document whose
+ * _id is "<collection>.<path>", and are only used to estimate the cardinality of predicates on the
+ * collection they were gathered from, as identified by its UUID.
+ */
+struct FieldStatistics {
+    static constexpr StringData kCollectionUUIDField = "collectionUUID"_sd;
+    static constexpr StringData kPathField = "path"_sd;
+    static constexpr StringData kNumRecordsField = "numRecords"_sd;
+    static constexpr StringData kNumValuesField = "numValues"_sd;
+    static constexpr StringData kSketchField = "sketch"_sd;
+    static constexpr StringData kHistogramField = "histogram"_sd;
+    static constexpr StringData kLastUpdatedField = "lastUpdated"_sd;
+
+    /**
+     * Scans 'collection' and gathers statistics about the values along 'path'. Arrays along the
+     * path are expanded and a missing field counts as null, the same way as the keys of an index
+     * on 'path' are generated. The histogram has at most 'numBuckets' buckets, built from a
+     * uniform sample of at most 'sampleSize' values; the distinct values are counted over the
+     * whole collection.
+     */
+    static FieldStatistics gather(OperationContext* opCtx,
+                                  const CollectionPtr& collection,
+                                  StringData path,
+                                  size_t numBuckets,
+                                  size_t sampleSize);
+
+    static StatusWith<FieldStatistics> parse(const BSONObj& obj);
+
+    /**
+     * Returns the _id of the document holding the statistics of 'path' in 'collName'.
+     */
+    static std::string makeId(StringData collName, StringData path);
+
+    /**
+     * Serializes the statistics, without the _id field.
+     */
+    BSONObj toBSON() const;
+
+    /**
+     * Returns true if the number of records of the collection has changed too much since the
+     * statistics were gathered for them to be trusted, as per the
+     * 'internalQueryCollectionStatisticsStalenessRatio' knob.
+     */
+    bool isStale(long long currentNumRecords) const;
+
+    /**
+     * Estimates how many index keys on 'path' fall within 'oil', given that the collection now
+     * holds 'currentNumRecords' records.
+     */
+    double estimateCardinality(const OrderedIntervalList& oil, long long currentNumRecords) const;
+
+    UUID collectionUUID = UUID::gen();
+    std::string path;
+
+    // The number of records of the collection, and the number of values along 'path' in those
+    // records, at the time the statistics were gathered.
+    long long numRecords = 0;
+    long long numValues = 0;
+
+    HyperLogLog sketch;
+    Histogram histogram;
+    Date_t lastUpdated;
+};
+
+/**
+ * Writes 'stats' to the 'system.statistics' collection of the database of 'nss', replacing any
+ * statistics previously gathered for the same field, and makes them visible to the query planner.
+ */
+void persistFieldStatistics(OperationContext* opCtx,
+                            const NamespaceString& nss,
+                            std::shared_ptr<const FieldStatistics> stats);
+
+/**
+ * Caches the statistics of the fields of a collection. All Collection instances for the same
+ * collection share the same cache, which thus goes away when the collection is dropped.
+ *
+ * The statistics are never read from 'system.statistics' while a query is being planned. A lookup
+ * only returns what is cached, and schedules the statistics to be loaded, or reloaded if they were
+ * cached a while ago, on a background thread for the benefit of later queries. The statistics may
+ * have been updated by another node, and the absence of statistics is cached as well.
+ */
+class CollectionStatisticsCache {
+public:
+    static CollectionStatisticsCache& get(const CollectionPtr& collection);
+
+    /**
+     * Stops loading statistics in the background, and waits for the load in progress, if any. The
+     * statistics cached so far remain available to the query planner.
+     */
+    static void shutdown(ServiceContext* serviceContext);
+
+    /**
+     * Returns the cached statistics of 'path' in 'collection', or nullptr if there are none, or if
+     * the field was never analyzed.
+     */
+    std::shared_ptr<const FieldStatistics> lookup(OperationContext* opCtx,
+                                                  const CollectionPtr& collection,
+                                                  StringData path);
+
+    void set(std::shared_ptr<const FieldStatistics> stats);
+
+private:
+    struct Entry {
+        // Null if the field was not analyzed at the time it was loaded.
+        std::shared_ptr<const FieldStatistics> stats;
+        Date_t loadedAt;
+        bool loading = false;
+    };
+
+    /**
+     * Reads the statistics of 'path' in the collection 'collectionUUID' of 'dbName' from
+     * 'system.statistics' on a background thread, and caches them.
+     */
+    static void scheduleLoad(ServiceContext* serviceContext,
+                             std::string dbName,
+                             UUID collectionUUID,
+                             std::string path);
+
+    /**
+     * Caches the statistics of 'path' read by a load started at 'startedAt', unless they have been
+     * set since. If the load failed, the previous statistics are kept for a while longer.
+     */
+    void finishLoading(StringData path,
+                       StatusWith<std::shared_ptr<const FieldStatistics>> swStats,
+                       Date_t startedAt);
+
+    Mutex _mutex = MONGO_MAKE_LATCH("CollectionStatisticsCache::_mutex");
+    StringMap<Entry> _entries;
+};
+
+}  // namespace mongo
@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cost_based_plan_selection.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo {
+namespace cost_based_plan_selection {
+namespace {
+
+// The relative costs of the units of work done by the stages, with the sequential read of a
+// collection record as the unit.
+constexpr double kIndexKeyCost = 0.5;
+constexpr double kIndexSeekCost = 1.0;
+constexpr double kFetchCost = 1.5;
+constexpr double kSortCost = 0.05;
+
+struct NodeEstimate {
+    double cost;
+    // The number of results the stage is expected to produce. Filters are not taken into
+    // account, so this is an upper bound.
+    double numResults;
+};
+
+class Estimator {
+public:
+    Estimator(long long numRecords, const StatisticsLookupFn& lookupStatistics)
+        : _numRecords(numRecords), _lookupStatistics(lookupStatistics) {}
+
+    boost::optional<NodeEstimate> estimate(const QuerySolutionNode* node) const {
+        switch (node->getType()) {
+            case STAGE_COLLSCAN:
+                return NodeEstimate{static_cast<double>(_numRecords),
+                                    static_cast<double>(_numRecords)};
+            case STAGE_IXSCAN:
+                return estimateIndexScan(static_cast<const IndexScanNode*>(node));
+            case STAGE_FETCH:
+                return addCost(estimate(node->children[0]),
+                               [](double numResults) { return numResults * kFetchCost; });
+            case STAGE_SORT_DEFAULT:
+            case STAGE_SORT_SIMPLE:
+                return addCost(estimate(node->children[0]), [](double numResults) {
+                    return numResults * std::log2(std::max(numResults, 2.0)) * kSortCost;
+                });
+            case STAGE_PROJECTION_DEFAULT:
+            case STAGE_PROJECTION_COVERED:
+            case STAGE_PROJECTION_SIMPLE:
+            case STAGE_SHARDING_FILTER:
+            case STAGE_SKIP:
+            case STAGE_SORT_KEY_GENERATOR:
+                return estimate(node->children[0]);
+            case STAGE_OR:
+            case STAGE_SORT_MERGE: {
+                NodeEstimate total{0, 0};
+                for (auto&& child : node->children) {
+                    auto childEstimate = estimate(child);
+                    if (!childEstimate) {
+                        return boost::none;
+                    }
+                    total.cost += childEstimate->cost;
+                    total.numResults += childEstimate->numResults;
+                }
+                return total;
+            }
+            default:
+                return boost::none;
+        }
+    }
+
+private:
+    template <typename CostFn>
+    static boost::optional<NodeEstimate> addCost(boost::optional<NodeEstimate> childEstimate,
+                                                 CostFn costFn) {
+        if (childEstimate) {
+            childEstimate->cost += costFn(childEstimate->numResults);
+        }
+        return childEstimate;
+    }
+
+    boost::optional<NodeEstimate> estimateIndexScan(const IndexScanNode* node) const {
+        // The statistics are gathered over the values of a field, which are neither the keys of
+        // special indexes nor, for strings, those of indexes with a collation.
+        if (node->index.type != INDEX_BTREE || node->index.collator ||
+            node->bounds.isSimpleRange || node->bounds.fields.empty()) {
+            return boost::none;
+        }
+
+        // Only the bounds on the leading field are estimated, which would overestimate the scan
+        // of a compound index bounded on its other fields as well. The keys of a multikey index
+        // are not the values the statistics count either, as a record may have several of them.
+        if (node->index.multikey ||
+            std::any_of(node->bounds.fields.begin() + 1,
+                        node->bounds.fields.end(),
+                        [](const OrderedIntervalList& oil) { return !oil.isMinToMax(); })) {
+            return boost::none;
+        }
+
+        auto stats = _lookupStatistics(node->index.keyPattern.firstElement().fieldNameStringData());
+        if (!stats || stats->isStale(_numRecords)) {
+            return boost::none;
+        }
+
+        const auto& oil = node->bounds.fields[0];
+        const double numKeys = stats->estimateCardinality(oil, _numRecords);
+        return NodeEstimate{numKeys * kIndexKeyCost + oil.intervals.size() * kIndexSeekCost,
+                            numKeys};
+    }
+
+    const long long _numRecords;
+    const StatisticsLookupFn& _lookupStatistics;
+};
+
+}  // namespace
+
+void pruneSolutions(OperationContext* opCtx,
+                    const CollectionPtr& collection,
+                    const CanonicalQuery& query,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    if (solutions->size() < 2 || collection->ns().isSystemDotStatistics()) {
+        return;
+    }
+
+    pruneSolutions(query,
+                   static_cast<long long>(collection->numRecords(opCtx)),
+                   [&](StringData path) {
+                       return CollectionStatisticsCache::get(collection)
+                           .lookup(opCtx, collection, path);
+                   },
+                   solutions);
+}
+
+void pruneSolutions(const CanonicalQuery& query,
+                    long long numRecords,
+                    const StatisticsLookupFn& lookupStatistics,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    if (solutions->size() < 2 || query.getQueryRequest().getLimit() ||
+        query.getQueryRequest().getNToReturn()) {
+        return;
+    }
+
+    Estimator estimator{numRecords, lookupStatistics};
+    std::vector<boost::optional<double>> costs;
+    boost::optional<double> bestCost;
+    for (auto&& solution : *solutions) {
+        auto estimate = estimator.estimate(solution->root());
+        costs.push_back(estimate ? boost::make_optional(estimate->cost) : boost::none);
+        if (costs.back() && (!bestCost || *costs.back() < *bestCost)) {
+            bestCost = costs.back();
+        }
+    }
+    if (!bestCost) {
+        return;
+    }
+
+    const double maxCost = *bestCost * internalQueryCostBasedPlanSelectionPruneRatio.load();
+    std::vector<std::unique_ptr<QuerySolution>> kept;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (costs[i] && *costs[i] > maxCost) {
+            LOGV2_DEBUG(5300802,
+                        2,
+                        "Discarding candidate plan estimated to be too expensive",
+                        "query"_attr = redact(query.toStringShort()),
+                        "estimatedCost"_attr = *costs[i],
+                        "bestEstimatedCost"_attr = *bestCost,
+                        "solution"_attr = redact((*solutions)[i]->toString()));
+            continue;
+        }
+        kept.push_back(std::move((*solutions)[i]));
+    }
+    *solutions = std::move(kept);
+}
+
+}  // namespace cost_based_plan_selection
+}  // namespace mongo
@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+namespace cost_based_plan_selection {
+
+/**
+ * Returns the statistics gathered by the 'analyze' command about the values of 'path', or nullptr
+ * if there are none.
+ */
+using StatisticsLookupFn = std::function<std::shared_ptr<const FieldStatistics>(StringData path)>;
+
+/**
+ * Discards the candidate 'solutions' of 'query' whose estimated cost is more than
+ * 'internalQueryCostBasedPlanSelectionPruneRatio' times that of the cheapest one, so that they are
+ * not raced against it by the multi-planner. Candidates which cannot be costed are always kept, as
+ * are all the candidates of a query with a limit, whose cost depends on how early the plans
+ * produce their first results rather than on the cardinality of their index scans.
+ */
+void pruneSolutions(OperationContext* opCtx,
+                    const CollectionPtr& collection,
+                    const CanonicalQuery& query,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions);
+
+/**
+ * Same as above, for a collection holding 'numRecords' records whose field statistics are
+ * returned by 'lookupStatistics'.
+ *
+ * The cost of a plan is estimated in units of collection records scanned. Only the leading field
+ * of the bounds of an index scan is taken into account. A plan cannot be costed if it involves a
+ * stage which cannot be costed, a scan of a multikey index, a scan bounded on more than the leading
+ * field of its index, or a scan whose leading field has no up to date statistics.
+ */
+void pruneSolutions(const CanonicalQuery& query,
+                    long long numRecords,
+                    const StatisticsLookupFn& lookupStatistics,
+                    std::vector<std::unique_ptr<QuerySolution>>* solutions);
+
+}  // namespace cost_based_plan_selection
+}  // namespace mongo
@@ -0,0 +1,234 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cost_based_plan_selection.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString nss("test.collection");
+
+constexpr long long kNumRecords = 1000;
+
+std::unique_ptr<CanonicalQuery> canonicalize(StringData filter, long long limit = 0) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    auto qr = std::make_unique<QueryRequest>(nss);
+    qr->setFilter(fromjson(filter.toString()));
+    if (limit) {
+        qr->setLimit(limit);
+    }
+    auto statusWithCQ = CanonicalQuery::canonicalize(opCtx.get(), std::move(qr));
+    ASSERT_OK(statusWithCQ.getStatus());
+    return std::move(statusWithCQ.getValue());
+}
+
+IndexEntry makeIndexEntry(BSONObj keyPattern, bool multikey = false) {
+    return IndexEntry(keyPattern,
+                      INDEX_BTREE,
+                      IndexDescriptor::kLatestIndexVersion,
+                      multikey,
+                      {},
+                      {},
+                      false,  // sparse
+                      false,  // unique
+                      IndexEntry::Identifier{keyPattern.firstElementFieldName()},
+                      nullptr,
+                      BSONObj(),
+                      nullptr,
+                      nullptr);
+}
+
+/**
+ * Returns a fetch of the documents whose single-field index 'keyPattern' keys fall in 'interval'.
+ */
+std::unique_ptr<QuerySolution> makeIndexScanPlan(BSONObj keyPattern,
+                                                 BSONObj interval,
+                                                 bool multikey = false) {
+    auto ixscan = std::make_unique<IndexScanNode>(makeIndexEntry(keyPattern, multikey));
+    OrderedIntervalList oil(keyPattern.firstElementFieldName());
+    oil.intervals.push_back(Interval(interval, true, true));
+    ixscan->bounds.fields.push_back(std::move(oil));
+
+    auto fetch = std::make_unique<FetchNode>();
+    fetch->children.push_back(ixscan.release());
+
+    auto solution = std::make_unique<QuerySolution>();
+    solution->setRoot(std::move(fetch));
+    return solution;
+}
+
+std::unique_ptr<QuerySolution> makeCollScanPlan() {
+    auto solution = std::make_unique<QuerySolution>();
+    solution->setRoot(std::make_unique<CollectionScanNode>());
+    return solution;
+}
+
+/**
+ * Returns the statistics of a field of a collection of 'kNumRecords' records, with one value per
+ * record. 'makeValue' returns the value of the field in the i-th record.
+ */
+template <typename MakeValue>
+std::shared_ptr<const FieldStatistics> makeStatistics(StringData path, MakeValue makeValue) {
+    std::vector<BSONObj> values;
+    std::vector<BSONElement> elements;
+    auto stats = std::make_shared<FieldStatistics>();
+    for (long long i = 0; i < kNumRecords; ++i) {
+        values.push_back(BSON("" << makeValue(i)));
+        elements.push_back(values.back().firstElement());
+        stats->sketch.add(elements.back());
+    }
+    stats->path = path.toString();
+    stats->numRecords = kNumRecords;
+    stats->numValues = kNumRecords;
+    stats->histogram = Histogram::make(std::move(elements), 20);
+    stats->lastUpdated = Date_t::now();
+    return stats;
+}
+
+class CostBasedPlanSelectionTest : public unittest::Test {
+protected:
+    void prune(const CanonicalQuery& query,
+               std::vector<std::unique_ptr<QuerySolution>>* solutions,
+               long long numRecords = kNumRecords) {
+        cost_based_plan_selection::pruneSolutions(
+            query,
+            numRecords,
+            [&](StringData path) -> std::shared_ptr<const FieldStatistics> {
+                if (auto it = _stats.find(path); it != _stats.end()) {
+                    return it->second;
+                }
+                return nullptr;
+            },
+            solutions);
+    }
+
+    static BSONObj keyPatternOf(const QuerySolution& solution) {
+        return static_cast<const IndexScanNode*>(solution.root()->children[0])->index.keyPattern;
+    }
+
+    // Each value of 'a' is unique, while 'b' is 1 in all but 10 records.
+    StringMap<std::shared_ptr<const FieldStatistics>> _stats{
+        {"a", makeStatistics("a", [](long long i) { return i; })},
+        {"b", makeStatistics("b", [](long long i) { return i % 100 == 0 ? i : 1; })}};
+};
+
+TEST_F(CostBasedPlanSelectionTest, DiscardsPlansEstimatedToBeMuchMoreExpensive) {
+    auto query = canonicalize("{a: {$gte: 0, $lte: 9}, b: 1}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 1 << "" << 1)));
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 9)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 1U);
+    ASSERT_BSONOBJ_EQ(keyPatternOf(*solutions[0]), BSON("a" << 1));
+}
+
+TEST_F(CostBasedPlanSelectionTest, DiscardsCollectionScanOfSelectiveQuery) {
+    auto query = canonicalize("{a: 5}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeCollScanPlan());
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 5 << "" << 5)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 1U);
+    ASSERT_EQ(solutions[0]->root()->getType(), STAGE_FETCH);
+}
+
+TEST_F(CostBasedPlanSelectionTest, KeepsPlansOfComparableCost) {
+    auto query = canonicalize("{a: {$gte: 0, $lte: 29}, b: {$gte: 100, $lte: 900}}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 29)));
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 100 << "" << 900)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST_F(CostBasedPlanSelectionTest, KeepsPlansWhichCannotBeCosted) {
+    auto query = canonicalize("{a: {$gte: 0, $lte: 9}, b: 1, c: 1}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    // There are no statistics on 'c'.
+    solutions.push_back(makeIndexScanPlan(BSON("c" << 1), BSON("" << 1 << "" << 1)));
+    // The keys of a multikey index are not the values the statistics count.
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 1 << "" << 1), true));
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 9)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 3U);
+}
+
+TEST_F(CostBasedPlanSelectionTest, IgnoresStaleStatistics) {
+    auto query = canonicalize("{a: {$gte: 0, $lte: 9}, b: 1}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 1 << "" << 1)));
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 9)));
+
+    const auto stalenessRatio = internalQueryCollectionStatisticsStalenessRatio.load();
+    prune(*query, &solutions, static_cast<long long>(kNumRecords * (1 + stalenessRatio)) + 1);
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST_F(CostBasedPlanSelectionTest, KeepsAllPlansOfQueryWithLimit) {
+    auto query = canonicalize("{a: {$gte: 0, $lte: 9}, b: 1}", 1);
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 1 << "" << 1)));
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 9)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST_F(CostBasedPlanSelectionTest, PruneRatioControlsWhichPlansAreDiscarded) {
+    const auto pruneRatio = internalQueryCostBasedPlanSelectionPruneRatio.load();
+    ON_BLOCK_EXIT([&] { internalQueryCostBasedPlanSelectionPruneRatio.store(pruneRatio); });
+    internalQueryCostBasedPlanSelectionPruneRatio.store(1000);
+
+    auto query = canonicalize("{a: {$gte: 0, $lte: 9}, b: 1}");
+    std::vector<std::unique_ptr<QuerySolution>> solutions;
+    solutions.push_back(makeIndexScanPlan(BSON("b" << 1), BSON("" << 1 << "" << 1)));
+    solutions.push_back(makeIndexScanPlan(BSON("a" << 1), BSON("" << 0 << "" << 9)));
+
+    prune(*query, &solutions);
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -61,12 +61,14 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index/wildcard_access_method.h"
 #include "mongo/db/index_names.h"
+#include "mongo/db/matcher/expression_parameterization.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/canonical_query_encoder.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/cost_based_plan_selection.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
@@ -83,6 +85,7 @@
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/query/query_settings_decoration.h"
 #include "mongo/db/query/sbe_cached_solution_planner.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/db/query/sbe_multi_planner.h"
 #include "mongo/db/query/sbe_sub_planner.h"
 #include "mongo/db/query/stage_builder_util.h"
@@ -576,8 +579,10 @@ public:
 
         const IndexDescriptor* idIndexDesc = _collection->getIndexCatalog()->findIdIndex(_opCtx);
 
-        // If we have an _id index we can use an idhack plan.
-        if (idIndexDesc && isIdHackEligibleQuery(_collection, *_cq)) {
+        // If we have an _id index we can use an idhack plan. An idhack plan cannot be extended
+        // with the stages of an aggregation pipeline pushed down into the query.
+        if (idIndexDesc && isIdHackEligibleQuery(_collection, *_cq) &&
+            !_cq->getPushedDownGroup()) {
             LOGV2_DEBUG(
                 20922, 2, "Using idhack", "canonicalQuery"_attr = redact(_cq->toStringShort()));
             // If an IDHACK plan is not supported, we will use the normal plan generation process
@@ -610,10 +615,12 @@ public:
                               .getPlanCache()
                               ->getCacheEntryIfActive(planCacheKey)) {
                 // We have a CachedSolution.  Have the planner turn it into a QuerySolution.
+                prepareForCachedPlan();
                 auto statusWithQs = QueryPlanner::planFromCache(*_cq, plannerParams, *cs);
 
                 if (statusWithQs.isOK()) {
-                    auto querySolution = std::move(statusWithQs.getValue());
+                    auto querySolution = QueryPlanner::extendWithAggPipeline(
+                        *_cq, std::move(statusWithQs.getValue()));
                     if ((plannerParams.options & QueryPlannerParams::IS_COUNT) &&
                         turnIxscanIntoCount(querySolution.get())) {
                         LOGV2_DEBUG(20923,
@@ -623,14 +630,14 @@ public:
                     }
 
                     return buildCachedPlan(
-                        std::move(querySolution), plannerParams, cs->decisionWorks);
+                        std::move(querySolution), plannerParams, planCacheKey, *cs);
                 }
             }
         }
 
 
         if (internalQueryPlanOrChildrenIndependently.load() &&
-            SubplanStage::canUseSubplanning(*_cq)) {
+            SubplanStage::canUseSubplanning(*_cq) && !_cq->getPushedDownGroup()) {
             LOGV2_DEBUG(20924,
                         2,
                         "Running query as sub-queries",
@@ -648,6 +655,10 @@ public:
         // The planner should have returned an error status if there are no solutions.
         invariant(solutions.size() > 0);
 
+        for (auto&& solution : solutions) {
+            solution = QueryPlanner::extendWithAggPipeline(*_cq, std::move(solution));
+        }
+
         // See if one of our solutions is a fast count hack in disguise.
         if (plannerParams.options & QueryPlannerParams::IS_COUNT) {
             for (size_t i = 0; i < solutions.size(); ++i) {
@@ -666,6 +677,12 @@ public:
             }
         }
 
+        // Discard the candidates which the collection statistics show to be much more expensive
+        // than the others before racing them.
+        if (internalQueryEnableCostBasedPlanSelection.load()) {
+            cost_based_plan_selection::pruneSolutions(_opCtx, _collection, *_cq, &solutions);
+        }
+
         if (1 == solutions.size()) {
             auto result = makeResult();
             // Only one possible plan. Run it. Build the stages from the solution.
@@ -706,6 +723,12 @@ protected:
     virtual std::unique_ptr<ResultType> buildIdHackPlan(const IndexDescriptor* descriptor,
                                                         QueryPlannerParams* plannerParams) = 0;
 
+    /**
+     * Called before the planner turns a cached solution into a QuerySolution, so that the query
+     * can be prepared for the reuse of a plan kept in the plan cache.
+     */
+    virtual void prepareForCachedPlan() {}
+
     /**
      * Constructs a PlanStage tree from a cached plan and also:
      *     * Either modifies the constructed tree to run a trial period in order to evaluate the
@@ -716,7 +739,8 @@ protected:
      */
     virtual std::unique_ptr<ResultType> buildCachedPlan(std::unique_ptr<QuerySolution> solution,
                                                         const QueryPlannerParams& plannerParams,
-                                                        size_t decisionWorks) = 0;
+                                                        const PlanCacheKey& planCacheKey,
+                                                        const CachedSolution& cachedSolution) = 0;
 
     /**
      * Constructs a special PlanStage tree for rooted $or queries. Each clause of the $or is planned
@@ -832,7 +856,8 @@ protected:
     std::unique_ptr<ClassicPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution) final {
         auto result = makeResult();
         auto&& root = buildExecutableTree(*solution);
 
@@ -845,7 +870,7 @@ protected:
                                                           _ws,
                                                           _cq,
                                                           plannerParams,
-                                                          decisionWorks,
+                                                          cachedSolution.decisionWorks,
                                                           std::move(root)),
                         std::move(solution));
         return result;
@@ -906,23 +931,78 @@ protected:
 
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildIdHackPlan(
         const IndexDescriptor* descriptor, QueryPlannerParams* plannerParams) final {
-        uassert(4822862,
-                "IDHack plan is not supprted by SBE yet",
-                !(_cq->metadataDeps()[DocumentMetadataFields::kSortKey] ||
-                  _cq->getQueryRequest().returnKey() || _cq->getProj()));
+        // Orphan filtering is not available in SBE, so fall back to normal planning if it's needed.
+        if (plannerParams->options & QueryPlannerParams::INCLUDE_SHARD_FILTER) {
+            return nullptr;
+        }
+
+        auto indexEntry = std::find_if(plannerParams->indices.begin(),
+                                       plannerParams->indices.end(),
+                                       [&](const IndexEntry& entry) {
+                                           return entry.identifier.catalogName ==
+                                               descriptor->indexName();
+                                       });
+        if (indexEntry == plannerParams->indices.end()) {
+            return nullptr;
+        }
 
-        // Fall back to normal planning.
-        return nullptr;
+        // Build a point lookup into the _id index followed by a fetch, bypassing the plan cache and
+        // the multi-planner. Any projection, sort key or returnKey requested by the query are then
+        // added on top of it in the same way as for a regular plan.
+        auto ixn = std::make_unique<IndexScanNode>(*indexEntry);
+        ixn->queryCollator = _cq->getCollator();
+        ixn->bounds.fields.emplace_back("_id");
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translateEquality(_cq->getQueryRequest().getFilter()["_id"],
+                                              *indexEntry,
+                                              false /* isHashed */,
+                                              &ixn->bounds.fields.back(),
+                                              &tightness);
+
+        auto fetch = std::make_unique<FetchNode>();
+        fetch->children.push_back(ixn.release());
+        if (tightness != IndexBoundsBuilder::EXACT) {
+            fetch->filter = _cq->root()->shallowClone();
+        }
+
+        auto solution =
+            QueryPlannerAnalysis::analyzeDataAccess(*_cq, *plannerParams, std::move(fetch));
+        if (!solution) {
+            return nullptr;
+        }
+
+        auto result = makeResult();
+        auto execTree = buildExecutableTree(*solution);
+        result->emplace(std::move(execTree), std::move(solution));
+        return result;
+    }
+
+    void prepareForCachedPlan() final {
+        // Only a plan built from a cached solution is kept in the plan cache and rebound to the
+        // constants of later queries, so the other plans keep their constants inline where they
+        // can be folded.
+        if (internalQueryCacheSbePlans.load()) {
+            expression::parameterize(_cq->root());
+        }
     }
 
     std::unique_ptr<SlotBasedPrepareExecutionResult> buildCachedPlan(
         std::unique_ptr<QuerySolution> solution,
         const QueryPlannerParams& plannerParams,
-        size_t decisionWorks) final {
+        const PlanCacheKey& planCacheKey,
+        const CachedSolution& cachedSolution) final {
         auto result = makeResult();
-        auto execTree = buildExecutableTree(*solution, true);
+        auto sbeYieldPolicy = dynamic_cast<PlanYieldPolicySBE*>(_yieldPolicy);
+        invariant(sbeYieldPolicy);
+        auto execTree = sbe::buildCachedSbePlan(_opCtx,
+                                                _collection,
+                                                *_cq,
+                                                *solution,
+                                                planCacheKey,
+                                                cachedSolution,
+                                                sbeYieldPolicy);
         result->emplace(std::move(execTree), std::move(solution));
-        result->setDecisionWorks(decisionWorks);
+        result->setDecisionWorks(cachedSolution.decisionWorks);
         return result;
     }
 
@@ -1109,7 +1189,11 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutor(
     std::unique_ptr<CanonicalQuery> canonicalQuery,
     PlanYieldPolicy::YieldPolicy yieldPolicy,
     size_t plannerOptions) {
-    return internalQueryEnableSlotBasedExecutionEngine.load()
+    // The stages of an aggregation pipeline pushed down into the query can only be executed by
+    // the slot-based execution engine.
+    const bool useSlotBasedExecutionEngine =
+        internalQueryEnableSlotBasedExecutionEngine.load() || canonicalQuery->getPushedDownGroup();
+    return useSlotBasedExecutionEngine
         ? getSlotBasedExecutor(
               opCtx, collection, std::move(canonicalQuery), yieldPolicy, plannerOptions)
         : getClassicExecutor(
@@ -0,0 +1,270 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/histogram.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonelement_comparator.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+const BSONElementComparator kComparator(BSONElementComparator::FieldNamesMode::kIgnore, nullptr);
+
+constexpr auto kBoundsField = "bounds"_sd;
+constexpr auto kEqualCountsField = "equalCounts"_sd;
+constexpr auto kRangeCountsField = "rangeCounts"_sd;
+constexpr auto kRangeDistinctField = "rangeDistinct"_sd;
+
+/**
+ * Returns the fraction of the range (lower, upper) covered by the range (start, end), assuming
+ * values are spread evenly. Only numbers can be interpolated; otherwise, a partially covered range
+ * is assumed to be half covered.
+ */
+double coveredFraction(const BSONElement& lower,
+                       const BSONElement& upper,
+                       const BSONElement& start,
+                       const BSONElement& end,
+                       bool startsBefore,
+                       bool endsAfter) {
+    if (!lower.isNumber() || !upper.isNumber()) {
+        return startsBefore || endsAfter ? 0.5 : 0.25;
+    }
+
+    auto lo = lower.numberDouble();
+    auto hi = upper.numberDouble();
+    if (!(hi > lo)) {
+        return 0.5;
+    }
+
+    auto from = startsBefore ? lo : (start.isNumber() ? start.numberDouble() : lo);
+    auto to = endsAfter ? hi : (end.isNumber() ? end.numberDouble() : hi);
+    return std::clamp((to - from) / (hi - lo), 0.0, 1.0);
+}
+
+Status parseDoubleArray(const BSONObj& obj, StringData field, std::vector<double>* out) {
+    auto elem = obj[field];
+    if (elem.type() != BSONType::Array) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "histogram field '" << field << "' must be an array"};
+    }
+    for (auto&& value : elem.Obj()) {
+        if (!value.isNumber()) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "histogram field '" << field << "' must hold numbers"};
+        }
+        out->push_back(value.numberDouble());
+    }
+    return Status::OK();
+}
+}  // namespace
+
+Histogram Histogram::make(std::vector<BSONElement> values, size_t maxBuckets) {
+    invariant(maxBuckets >= 2);
+    std::sort(values.begin(), values.end(), kComparator.makeLessThan());
+
+    Histogram histogram;
+    if (values.empty()) {
+        return histogram;
+    }
+
+    // The first bucket only holds the smallest value, so the remaining buckets share the rest.
+    const double depth = std::max(1.0, static_cast<double>(values.size()) / (maxBuckets - 1));
+
+    BSONArrayBuilder bounds;
+    Bucket current;
+    for (size_t idx = 0; idx < values.size();) {
+        // Gather the run of values equal to values[idx].
+        auto runEnd = idx + 1;
+        while (runEnd < values.size() && kComparator.evaluate(values[runEnd] == values[idx])) {
+            ++runEnd;
+        }
+        const double runLength = runEnd - idx;
+        const bool isFirst = idx == 0;
+        const bool isLast = runEnd == values.size();
+
+        if (isFirst || isLast || runLength >= depth ||
+            current.rangeCount + runLength >= depth) {
+            bounds.append(values[idx]);
+            current.equalCount = runLength;
+            histogram._buckets.push_back(current);
+            current = Bucket{};
+        } else {
+            current.rangeCount += runLength;
+            current.rangeDistinct += 1;
+        }
+        idx = runEnd;
+    }
+
+    histogram._bounds = bounds.obj();
+    histogram.bindBounds();
+    return histogram;
+}
+
+StatusWith<Histogram> Histogram::parse(const BSONObj& obj) {
+    auto boundsElem = obj[kBoundsField];
+    if (boundsElem.type() != BSONType::Array) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "histogram field '" << kBoundsField << "' must be an array"};
+    }
+
+    std::vector<double> equalCounts, rangeCounts, rangeDistinct;
+    for (auto&& [field, out] : {std::make_pair(kEqualCountsField, &equalCounts),
+                                std::make_pair(kRangeCountsField, &rangeCounts),
+                                std::make_pair(kRangeDistinctField, &rangeDistinct)}) {
+        if (auto status = parseDoubleArray(obj, field, out); !status.isOK()) {
+            return status;
+        }
+    }
+
+    Histogram histogram;
+    histogram._bounds = boundsElem.Obj().getOwned();
+    auto numBuckets = static_cast<size_t>(histogram._bounds.nFields());
+    if (equalCounts.size() != numBuckets || rangeCounts.size() != numBuckets ||
+        rangeDistinct.size() != numBuckets) {
+        return {ErrorCodes::BadValue, "histogram arrays must all have the same length"};
+    }
+
+    for (size_t idx = 0; idx < numBuckets; ++idx) {
+        histogram._buckets.push_back(
+            Bucket{BSONElement{}, equalCounts[idx], rangeCounts[idx], rangeDistinct[idx]});
+    }
+    histogram.bindBounds();
+    return std::move(histogram);
+}
+
+void Histogram::bindBounds() {
+    size_t idx = 0;
+    for (auto&& bound : _bounds) {
+        _buckets[idx++].upperBound = bound;
+    }
+    invariant(idx == _buckets.size());
+}
+
+BSONObj Histogram::toBSON() const {
+    BSONObjBuilder builder;
+    builder.appendArray(kBoundsField, _bounds);
+    BSONArrayBuilder equalCounts(builder.subarrayStart(kEqualCountsField));
+    for (auto&& bucket : _buckets) {
+        equalCounts.append(bucket.equalCount);
+    }
+    equalCounts.done();
+    BSONArrayBuilder rangeCounts(builder.subarrayStart(kRangeCountsField));
+    for (auto&& bucket : _buckets) {
+        rangeCounts.append(bucket.rangeCount);
+    }
+    rangeCounts.done();
+    BSONArrayBuilder rangeDistinct(builder.subarrayStart(kRangeDistinctField));
+    for (auto&& bucket : _buckets) {
+        rangeDistinct.append(bucket.rangeDistinct);
+    }
+    rangeDistinct.done();
+    return builder.obj();
+}
+
+double Histogram::totalCount() const {
+    double count = 0;
+    for (auto&& bucket : _buckets) {
+        count += bucket.equalCount + bucket.rangeCount;
+    }
+    return count;
+}
+
+double Histogram::distinctCount() const {
+    double count = 0;
+    for (auto&& bucket : _buckets) {
+        count += 1 + bucket.rangeDistinct;
+    }
+    return count;
+}
+
+double Histogram::estimateCardinality(const Interval& interval) const {
+    if (interval.isEmpty() || _buckets.empty()) {
+        return 0;
+    }
+
+    // Index bounds may be oriented in descending order.
+    auto start = interval.start;
+    auto end = interval.end;
+    auto startInclusive = interval.startInclusive;
+    auto endInclusive = interval.endInclusive;
+    if (kComparator.evaluate(start > end)) {
+        std::swap(start, end);
+        std::swap(startInclusive, endInclusive);
+    }
+
+    auto contains = [&](const BSONElement& value) {
+        auto cmpStart = kComparator.compare(value, start);
+        auto cmpEnd = kComparator.compare(value, end);
+        return (cmpStart > 0 || (cmpStart == 0 && startInclusive)) &&
+            (cmpEnd < 0 || (cmpEnd == 0 && endInclusive));
+    };
+    const bool isPoint = interval.isPoint();
+
+    double estimate = 0;
+    for (size_t idx = 0; idx < _buckets.size(); ++idx) {
+        const auto& bucket = _buckets[idx];
+        if (contains(bucket.upperBound)) {
+            estimate += bucket.equalCount;
+        }
+
+        if (idx == 0 || bucket.rangeCount == 0) {
+            continue;
+        }
+
+        // The open range (lower, upper) of the values strictly inside the bucket.
+        const auto& lower = _buckets[idx - 1].upperBound;
+        const auto& upper = bucket.upperBound;
+        if (kComparator.evaluate(end <= lower) || kComparator.evaluate(start >= upper)) {
+            continue;
+        }
+
+        if (isPoint) {
+            estimate += bucket.rangeCount / std::max(1.0, bucket.rangeDistinct);
+            continue;
+        }
+
+        const bool startsBefore = kComparator.evaluate(start <= lower);
+        const bool endsAfter = kComparator.evaluate(end >= upper);
+        auto fraction = startsBefore && endsAfter
+            ? 1.0
+            : coveredFraction(lower, upper, start, end, startsBefore, endsAfter);
+        // A range overlapping the bucket matches at least one of its distinct values.
+        estimate += std::max(fraction * bucket.rangeCount,
+                             bucket.rangeCount / std::max(1.0, bucket.rangeDistinct));
+    }
+
+    return estimate;
+}
+
+}  // namespace mongo
@@ -0,0 +1,104 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/interval.h"
+
+namespace mongo {
+
+/**
+ * An equi-depth histogram over the values of a field. Each bucket covers the values greater than
+ * the upper bound of the previous bucket and less than or equal to its own upper bound, and counts
+ * separately the values equal to its upper bound and those strictly inside its range. Values
+ * repeated at least as often as the target bucket depth always become an upper bound, so that the
+ * cardinality of equality predicates on skewed values is known exactly rather than averaged over a
+ * bucket.
+ *
+ * The first bucket only ever holds the smallest value, so that every other bucket has a known lower
+ * bound.
+ */
+class Histogram {
+public:
+    struct Bucket {
+        // Owned by the histogram.
+        BSONElement upperBound;
+        double equalCount{0};
+        double rangeCount{0};
+        double rangeDistinct{0};
+    };
+
+    /**
+     * Builds a histogram of at most 'maxBuckets' buckets over 'values'. The field names of the
+     * elements are ignored. Expects 'maxBuckets' to be at least 2.
+     */
+    static Histogram make(std::vector<BSONElement> values, size_t maxBuckets);
+
+    /**
+     * Parses a histogram previously serialized by 'toBSON()'.
+     */
+    static StatusWith<Histogram> parse(const BSONObj& obj);
+
+    BSONObj toBSON() const;
+
+    const std::vector<Bucket>& buckets() const {
+        return _buckets;
+    }
+
+    /**
+     * The number of values the histogram was built from.
+     */
+    double totalCount() const;
+
+    /**
+     * The number of distinct values the histogram was built from.
+     */
+    double distinctCount() const;
+
+    /**
+     * Estimates how many of the values the histogram was built from fall in 'interval'. Values
+     * strictly inside a bucket are assumed to be evenly distributed, by numeric value if the
+     * bounds involved are numbers, and by distinct value for point intervals.
+     */
+    double estimateCardinality(const Interval& interval) const;
+
+private:
+    void bindBounds();
+
+    // An array holding the upper bounds of the buckets.
+    BSONObj _bounds;
+    std::vector<Bucket> _buckets;
+};
+
+}  // namespace mongo
@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/histogram.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Builds a histogram over the first elements of 'values', which must outlive it.
+ */
+Histogram makeHistogram(const std::vector<BSONObj>& values, size_t maxBuckets) {
+    std::vector<BSONElement> elements;
+    for (auto&& value : values) {
+        elements.push_back(value.firstElement());
+    }
+    return Histogram::make(std::move(elements), maxBuckets);
+}
+
+std::vector<BSONObj> makeInts(int from, int to) {
+    std::vector<BSONObj> values;
+    for (int i = from; i < to; ++i) {
+        values.push_back(BSON("" << i));
+    }
+    return values;
+}
+
+Interval makeInterval(const BSONObj& bounds, bool startInclusive = true, bool endInclusive = true) {
+    return Interval(bounds, startInclusive, endInclusive);
+}
+
+TEST(HistogramTest, EmptyHistogramEstimatesZero) {
+    auto histogram = makeHistogram({}, 10);
+    ASSERT_EQ(histogram.totalCount(), 0);
+    ASSERT_EQ(histogram.estimateCardinality(makeInterval(BSON("" << MINKEY << "" << MAXKEY))), 0);
+}
+
+TEST(HistogramTest, CountsAllValues) {
+    auto values = makeInts(0, 1000);
+    auto histogram = makeHistogram(values, 11);
+    ASSERT_LTE(histogram.buckets().size(), 11U);
+    ASSERT_EQ(histogram.totalCount(), 1000);
+    ASSERT_EQ(histogram.distinctCount(), 1000);
+    ASSERT_EQ(histogram.estimateCardinality(makeInterval(BSON("" << MINKEY << "" << MAXKEY))),
+              1000);
+}
+
+TEST(HistogramTest, EstimatesNumericRanges) {
+    auto values = makeInts(0, 1000);
+    auto histogram = makeHistogram(values, 11);
+    ASSERT_APPROX_EQUAL(
+        histogram.estimateCardinality(makeInterval(BSON("" << 100 << "" << 300))), 200, 20);
+    ASSERT_APPROX_EQUAL(
+        histogram.estimateCardinality(makeInterval(BSON("" << 950 << "" << 2000))), 50, 10);
+    ASSERT_EQ(histogram.estimateCardinality(makeInterval(BSON("" << 2000 << "" << 3000))), 0);
+}
+
+TEST(HistogramTest, EstimatesDescendingIntervalsLikeAscendingOnes) {
+    auto values = makeInts(0, 1000);
+    auto histogram = makeHistogram(values, 11);
+    auto descending = makeInterval(BSON("" << 300 << "" << 100), true, false);
+    auto ascending = makeInterval(BSON("" << 100 << "" << 300), false, true);
+    ASSERT_EQ(histogram.estimateCardinality(descending), histogram.estimateCardinality(ascending));
+}
+
+TEST(HistogramTest, EstimatesPointsInsideBucketsByDistinctValues) {
+    auto values = makeInts(0, 1000);
+    auto histogram = makeHistogram(values, 11);
+    ASSERT_APPROX_EQUAL(
+        histogram.estimateCardinality(makeInterval(BSON("" << 501 << "" << 501))), 1, 0.5);
+}
+
+TEST(HistogramTest, HeavyHittersAreEstimatedExactly) {
+    auto values = makeInts(0, 1000);
+    for (int i = 0; i < 500; ++i) {
+        values.push_back(BSON("" << 7));
+    }
+    auto histogram = makeHistogram(values, 11);
+    ASSERT_EQ(histogram.estimateCardinality(makeInterval(BSON("" << 7 << "" << 7))), 501);
+}
+
+TEST(HistogramTest, ValuesOfDifferentTypesAreOrderedCanonically) {
+    std::vector<BSONObj> values = makeInts(0, 100);
+    for (int i = 0; i < 100; ++i) {
+        values.push_back(BSON("" << std::to_string(i)));
+    }
+    values.push_back(BSON("" << BSONNULL));
+    auto histogram = makeHistogram(values, 5);
+    ASSERT_EQ(histogram.totalCount(), 201);
+    ASSERT_EQ(histogram.estimateCardinality(makeInterval(BSON("" << BSONNULL << "" << BSONNULL))),
+              1);
+
+    // The bucket straddling numbers and strings cannot be interpolated, so only part of it is
+    // counted.
+    auto allStrings = makeInterval(BSON(""
+                                        << ""
+                                        << "" << BSONObj()),
+                                   true,
+                                   false);
+    ASSERT_APPROX_EQUAL(histogram.estimateCardinality(allStrings), 100, 30);
+}
+
+TEST(HistogramTest, SerializationRoundTrips) {
+    auto values = makeInts(0, 1000);
+    auto histogram = makeHistogram(values, 11);
+
+    auto swParsed = Histogram::parse(histogram.toBSON());
+    ASSERT_OK(swParsed.getStatus());
+    const auto& parsed = swParsed.getValue();
+    ASSERT_BSONOBJ_EQ(parsed.toBSON(), histogram.toBSON());
+    for (auto&& bounds : {BSON("" << 0 << "" << 0), BSON("" << 100 << "" << 300)}) {
+        ASSERT_EQ(parsed.estimateCardinality(makeInterval(bounds)),
+                  histogram.estimateCardinality(makeInterval(bounds)));
+    }
+}
+
+TEST(HistogramTest, ParseRejectsMalformedHistograms) {
+    ASSERT_NOT_OK(Histogram::parse(BSON("bounds" << 1)).getStatus());
+    ASSERT_NOT_OK(Histogram::parse(BSON("bounds" << BSON_ARRAY(1 << 2) << "equalCounts"
+                                                 << BSON_ARRAY(1) << "rangeCounts"
+                                                 << BSON_ARRAY(0 << 0) << "rangeDistinct"
+                                                 << BSON_ARRAY(0 << 0)))
+                      .getStatus());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,123 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/hyperloglog.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonelement_comparator.h"
+#include "mongo/platform/bits.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+namespace {
+/**
+ * The finalizer of MurmurHash3, used to spread the bits of the BSON value hash, which is not
+ * guaranteed to be uniformly distributed.
+ */
+uint64_t mix64(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+}  // namespace
+
+StatusWith<HyperLogLog> HyperLogLog::parse(const BSONElement& elem) {
+    if (elem.type() != BSONType::BinData || elem.binDataType() != BinDataType::BinDataGeneral) {
+        return {ErrorCodes::TypeMismatch,
+                str::stream() << "HyperLogLog sketch '" << elem.fieldNameStringData()
+                              << "' must be general binary data"};
+    }
+
+    int length = 0;
+    auto data = elem.binData(length);
+    if (static_cast<size_t>(length) != kNumRegisters) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "HyperLogLog sketch '" << elem.fieldNameStringData()
+                              << "' must have " << kNumRegisters << " registers, found "
+                              << length};
+    }
+
+    HyperLogLog sketch;
+    std::copy(data, data + length, sketch._registers.begin());
+    return sketch;
+}
+
+void HyperLogLog::add(const BSONElement& elem) {
+    static const BSONElementComparator kComparator(BSONElementComparator::FieldNamesMode::kIgnore,
+                                                   nullptr);
+    addHash(mix64(kComparator.hash(elem)));
+}
+
+void HyperLogLog::addHash(uint64_t hash) {
+    auto idx = hash >> (64 - kPrecision);
+    auto rest = hash << kPrecision;
+    // The position of the leftmost 1-bit among the remaining bits.
+    uint8_t rank = rest == 0 ? (64 - kPrecision + 1) : (countLeadingZeros64(rest) + 1);
+    _registers[idx] = std::max(_registers[idx], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (size_t idx = 0; idx < kNumRegisters; ++idx) {
+        _registers[idx] = std::max(_registers[idx], other._registers[idx]);
+    }
+}
+
+double HyperLogLog::estimate() const {
+    const double m = kNumRegisters;
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0;
+    size_t zeros = 0;
+    for (auto reg : _registers) {
+        sum += std::ldexp(1.0, -static_cast<int>(reg));
+        zeros += reg == 0;
+    }
+
+    auto estimate = alpha * m * m / sum;
+
+    // Small cardinalities are better estimated by linear counting over the empty registers.
+    if (estimate <= 2.5 * m && zeros > 0) {
+        return m * std::log(m / zeros);
+    }
+    return estimate;
+}
+
+void HyperLogLog::serialize(StringData fieldName, BSONObjBuilder* builder) const {
+    builder->appendBinData(
+        fieldName, _registers.size(), BinDataType::BinDataGeneral, _registers.data());
+}
+
+}  // namespace mongo
@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+/**
+ * A HyperLogLog sketch estimating the number of distinct values added to it. The sketch uses
+ * 2^kPrecision registers of one byte each, for a standard error of about 1.6%, regardless of how
+ * many values it has seen.
+ */
+class HyperLogLog {
+public:
+    static constexpr int kPrecision = 12;
+    static constexpr size_t kNumRegisters = size_t{1} << kPrecision;
+
+    HyperLogLog() : _registers(kNumRegisters, 0) {}
+
+    /**
+     * Parses a sketch previously serialized by 'serialize()'.
+     */
+    static StatusWith<HyperLogLog> parse(const BSONElement& elem);
+
+    /**
+     * Adds a BSON value to the sketch. Values which compare equal, ignoring field names, are
+     * counted once; for instance NumberInt(1) and 1.0 are the same value.
+     */
+    void add(const BSONElement& elem);
+
+    /**
+     * Adds a value identified by a 64-bit hash. The hash must be uniformly distributed.
+     */
+    void addHash(uint64_t hash);
+
+    void merge(const HyperLogLog& other);
+
+    /**
+     * Returns the estimated number of distinct values added so far.
+     */
+    double estimate() const;
+
+    void serialize(StringData fieldName, BSONObjBuilder* builder) const;
+
+private:
+    std::vector<uint8_t> _registers;
+};
+
+}  // namespace mongo
@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/hyperloglog.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Three times the standard error of the sketch.
+constexpr double kTolerance = 0.05;
+
+void addInts(HyperLogLog* sketch, int from, int to) {
+    for (int i = from; i < to; ++i) {
+        sketch->add(BSON("" << i).firstElement());
+    }
+}
+
+TEST(HyperLogLogTest, EmptySketchEstimatesZero) {
+    HyperLogLog sketch;
+    ASSERT_EQ(sketch.estimate(), 0);
+}
+
+TEST(HyperLogLogTest, EstimatesSmallCardinalitiesExactly) {
+    HyperLogLog sketch;
+    addInts(&sketch, 0, 10);
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 10, 0.5);
+}
+
+TEST(HyperLogLogTest, EstimatesLargeCardinalities) {
+    HyperLogLog sketch;
+    addInts(&sketch, 0, 100'000);
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 100'000, 100'000 * kTolerance);
+}
+
+TEST(HyperLogLogTest, CountsRepeatedValuesOnce) {
+    HyperLogLog sketch;
+    for (int round = 0; round < 10; ++round) {
+        addInts(&sketch, 0, 1000);
+    }
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 1000, 1000 * kTolerance);
+}
+
+TEST(HyperLogLogTest, ValuesComparingEqualAreTheSame) {
+    HyperLogLog sketch;
+    sketch.add(BSON("a" << 1).firstElement());
+    sketch.add(BSON("b" << 1.0).firstElement());
+    sketch.add(BSON("c" << 1LL).firstElement());
+    sketch.add(BSON("d"
+                    << "1")
+                   .firstElement());
+    ASSERT_APPROX_EQUAL(sketch.estimate(), 2, 0.5);
+}
+
+TEST(HyperLogLogTest, MergeEstimatesTheUnion) {
+    HyperLogLog left, right;
+    addInts(&left, 0, 60'000);
+    addInts(&right, 40'000, 100'000);
+    left.merge(right);
+    ASSERT_APPROX_EQUAL(left.estimate(), 100'000, 100'000 * kTolerance);
+}
+
+TEST(HyperLogLogTest, SerializationRoundTrips) {
+    HyperLogLog sketch;
+    addInts(&sketch, 0, 5000);
+
+    BSONObjBuilder builder;
+    sketch.serialize("sketch", &builder);
+    auto obj = builder.obj();
+
+    auto swParsed = HyperLogLog::parse(obj["sketch"]);
+    ASSERT_OK(swParsed.getStatus());
+    ASSERT_EQ(swParsed.getValue().estimate(), sketch.estimate());
+}
+
+TEST(HyperLogLogTest, ParseRejectsMalformedSketches) {
+    ASSERT_NOT_OK(HyperLogLog::parse(BSON("sketch" << 1).firstElement()).getStatus());
+
+    char registers[16] = {};
+    BSONObjBuilder builder;
+    builder.appendBinData("sketch", sizeof(registers), BinDataGeneral, registers);
+    ASSERT_NOT_OK(HyperLogLog::parse(builder.obj().firstElement()).getStatus());
+}
+
+}  // namespace
+}  // namespace mongo
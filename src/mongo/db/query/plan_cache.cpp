@@ -51,6 +51,7 @@
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/hex.h"
@@ -165,7 +166,9 @@ bool PlanCache::shouldCacheQuery(const CanonicalQuery& query) {
 }
 
 CachedSolution::CachedSolution(const PlanCacheEntry& entry)
-    : plannerData(entry.plannerData->clone()), decisionWorks(entry.works) {}
+    : plannerData(entry.plannerData->clone()),
+      decisionWorks(entry.works),
+      sbePlan(entry.getSbePlan()) {}
 
 //
 // PlanCacheEntry
@@ -261,13 +264,25 @@ std::unique_ptr<PlanCacheEntry> PlanCacheEntry::clone() const {
         debugInfoCopy.emplace(*debugInfo);
     }
 
-    return std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(plannerData->clone(),
-                                                              timeOfCreation,
-                                                              queryHash,
-                                                              planCacheKey,
-                                                              isActive,
-                                                              works,
-                                                              std::move(debugInfoCopy)));
+    auto entry = std::unique_ptr<PlanCacheEntry>(new PlanCacheEntry(plannerData->clone(),
+                                                                    timeOfCreation,
+                                                                    queryHash,
+                                                                    planCacheKey,
+                                                                    isActive,
+                                                                    works,
+                                                                    std::move(debugInfoCopy)));
+    entry->setSbePlan(_sbePlan);
+    return entry;
+}
+
+void PlanCacheEntry::setSbePlan(std::shared_ptr<const sbe::CachedSbePlan> plan) {
+    const uint64_t oldPlanSize = _sbePlan ? _sbePlan->estimatedSizeBytes : 0;
+    const uint64_t newPlanSize = plan ? plan->estimatedSizeBytes : 0;
+    _sbePlan = std::move(plan);
+
+    estimatedEntrySizeBytes = estimatedEntrySizeBytes - oldPlanSize + newPlanSize;
+    planCacheTotalSizeEstimateBytes.decrement(oldPlanSize);
+    planCacheTotalSizeEstimateBytes.increment(newPlanSize);
 }
 
 uint64_t PlanCacheEntry::CreatedFromQuery::estimateObjectSizeInBytes() const {
@@ -419,6 +434,10 @@ std::string SolutionCacheData::toString() const {
                                  << "tree=" << this->tree->toString() << ")";
         case COLLSCAN_SOLN:
             return "(collection scan)";
+        case SKIP_IXSCAN_SOLN:
+            verify(this->tree.get());
+            return str::stream() << "(skip index scan solution: "
+                                 << "tree=" << this->tree->toString() << ")";
         case USE_INDEX_TAGS_SOLN:
             verify(this->tree.get());
             return str::stream() << "(index-tagged expression tree: "
@@ -450,6 +469,21 @@ std::unique_ptr<CachedSolution> PlanCache::getCacheEntryIfActive(const PlanCache
     return std::move(res.cachedSolution);
 }
 
+void PlanCache::setSbePlan(const PlanCacheKey& key,
+                           std::shared_ptr<const sbe::CachedSbePlan> sbePlan) {
+    stdx::lock_guard<Latch> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry = nullptr;
+    Status cacheStatus = _cache.get(key, &entry);
+    if (!cacheStatus.isOK()) {
+        invariant(cacheStatus == ErrorCodes::NoSuchKey);
+        return;
+    }
+    invariant(entry);
+    if (entry->isActive) {
+        entry->setSbePlan(std::move(sbePlan));
+    }
+}
+
 /**
  * Given a query, and an (optional) current cache entry for its shape ('oldEntry'), determine
  * whether:
@@ -635,9 +669,13 @@ Status PlanCache::set(const CanonicalQuery& query,
     return Status::OK();
 }
 
-void PlanCache::deactivate(const CanonicalQuery& query) {
+void PlanCache::deactivate(const CanonicalQuery& query, boost::optional<size_t> observedWorks) {
     if (internalQueryCacheDisableInactiveEntries.load()) {
-        // This is a noop if inactive entries are disabled.
+        // This is a noop if inactive entries are disabled, unless the cached plan was observed to
+        // perform poorly, in which case the entry is evicted.
+        if (observedWorks) {
+            remove(query).ignore();
+        }
         return;
     }
 
@@ -651,6 +689,10 @@ void PlanCache::deactivate(const CanonicalQuery& query) {
     }
     invariant(entry);
     entry->isActive = false;
+    entry->setSbePlan(nullptr);
+    if (observedWorks) {
+        entry->works = std::max(entry->works, *observedWorks);
+    }
 }
 
 PlanCache::GetResult PlanCache::get(const CanonicalQuery& query) const {
@@ -110,6 +110,10 @@ public:
 class QuerySolution;
 struct QuerySolutionNode;
 
+namespace sbe {
+struct CachedSbePlan;
+}  // namespace sbe
+
 /**
  * A PlanCacheIndexTree is the meaty component of the data
  * stored in SolutionCacheData. It is a tree structure with
@@ -247,6 +251,11 @@ struct SolutionCacheData {
         // The cached plan is a collection scan.
         COLLSCAN_SOLN,
 
+        // Indicates that the plan should skip scan
+        // the index in 'tree', whose leading field
+        // the query does not constrain.
+        SKIP_IXSCAN_SOLN,
+
         // Build the solution by using 'tree'
         // to tag the match expression.
         USE_INDEX_TAGS_SOLN
@@ -280,6 +289,9 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     const size_t decisionWorks;
+
+    // The SBE plan built for a previous query of this shape, if any.
+    const std::shared_ptr<const sbe::CachedSbePlan> sbePlan;
 };
 
 /**
@@ -364,6 +376,16 @@ public:
 
     std::string debugString() const;
 
+    /**
+     * Keeps 'plan' as the SBE plan of this entry, or drops the current one if 'plan' is nullptr,
+     * and accounts for the change in the estimated size of the entry.
+     */
+    void setSbePlan(std::shared_ptr<const sbe::CachedSbePlan> plan);
+
+    const std::shared_ptr<const sbe::CachedSbePlan>& getSbePlan() const {
+        return _sbePlan;
+    }
+
     // Data provided to the planner to allow it to recreate the solution this entry represents. In
     // order to return it from the cache for consumption by the 'QueryPlanner', a deep copy is made
     // and returned inside 'CachedSolution'.
@@ -398,8 +420,8 @@ public:
 
     // An estimate of the size in bytes of this plan cache entry. This is the "deep size",
     // calculated by recursively incorporating the size of owned objects, the objects that they in
-    // turn own, and so on.
-    const uint64_t estimatedEntrySizeBytes;
+    // turn own, and so on. It includes the SBE plan of the entry, if any.
+    uint64_t estimatedEntrySizeBytes;
 
     /**
      * Tracks the approximate cumulative size of the plan cache entries across all the collections.
@@ -423,6 +445,11 @@ private:
     PlanCacheEntry& operator=(const PlanCacheEntry&) = delete;
 
     uint64_t _estimateObjectSizeInBytes() const;
+
+    // The SBE plan built for the winning solution of this entry by a previous query of the same
+    // shape, which queries of this shape reuse instead of building their own. Never set on an
+    // inactive entry.
+    std::shared_ptr<const sbe::CachedSbePlan> _sbePlan;
 };
 
 /**
@@ -503,8 +530,14 @@ public:
      * Set a cache entry back to the 'inactive' state. Rather than completely evicting an entry
      * when the associated plan starts to perform poorly, we deactivate it, so that plans which
      * perform even worse than the one already in the cache may not easily take its place.
+     *
+     * If 'observedWorks' is given, it is the number of works the cached plan was observed to need
+     * at runtime, and the entry keeps it as its works value if it is larger, so that plans which
+     * perform better than the cached one currently does can take its place. In this case the
+     * entry is removed if inactive entries are disabled.
      */
-    void deactivate(const CanonicalQuery& query);
+    void deactivate(const CanonicalQuery& query,
+                    boost::optional<size_t> observedWorks = boost::none);
 
     /**
      * Look up the cached data access for the provided 'query'.  Used by the query planner
@@ -530,6 +563,11 @@ public:
      */
     std::unique_ptr<CachedSolution> getCacheEntryIfActive(const PlanCacheKey& key) const;
 
+    /**
+     * Keeps 'sbePlan' along with the cache entry for 'key', if the entry exists and is active.
+     */
+    void setSbePlan(const PlanCacheKey& key, std::shared_ptr<const sbe::CachedSbePlan> sbePlan);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -50,6 +50,7 @@
 #include "mongo/db/query/query_planner_test_lib.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/query/sbe_plan_cache.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/scopeguard.h"
@@ -831,6 +832,50 @@ TEST(PlanCacheTest, DeactivateCacheEntry) {
     ASSERT_EQ(entry->works, 20U);
 }
 
+TEST(PlanCacheTest, DeactivateCacheEntryWithObservedWorks) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 20), Date_t{}));
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 20), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    // The entry keeps the works observed at runtime when they are larger than its own.
+    planCache.deactivate(*cq, 500);
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_FALSE(entry->isActive);
+    ASSERT_EQ(entry->works, 500U);
+
+    // A plan needing fewer works than observed for the deactivated one takes its place.
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 100), Date_t{}));
+    entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_TRUE(entry->isActive);
+    ASSERT_EQ(entry->works, 100U);
+
+    // Smaller observed works do not lower the works of the entry.
+    planCache.deactivate(*cq, 10);
+    entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_FALSE(entry->isActive);
+    ASSERT_EQ(entry->works, 100U);
+}
+
+TEST(PlanCacheTest, DeactivateWithObservedWorksEvictsIfInactiveEntriesDisabled) {
+    internalQueryCacheDisableInactiveEntries.store(true);
+    ON_BLOCK_EXIT([] { internalQueryCacheDisableInactiveEntries.store(false); });
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QueryTestServiceContext serviceContext;
+    addCacheEntryForShape(*cq, &planCache);
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    planCache.deactivate(*cq, 500);
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kNotPresent);
+}
+
 TEST(PlanCacheTest, GetMatchingStatsMatchesAndSerializesCorrectly) {
     PlanCache planCache;
 
@@ -2424,6 +2469,47 @@ TEST(PlanCacheTest, PlanCacheSizeWithEviction) {
     ASSERT_EQ(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get(), originalSize);
 }
 
+TEST(PlanCacheTest, PlanCacheSizeWithSbePlan) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1, b: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+    long long originalSize = PlanCacheEntry::planCacheTotalSizeEstimateBytes.get();
+
+    // Create an active entry, which is the only kind of entry an SBE plan is kept along with.
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 50), Date_t{}));
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 20), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+    long long sizeWithoutSbePlan = PlanCacheEntry::planCacheTotalSizeEstimateBytes.get();
+
+    auto makeSbePlan = [](uint64_t sizeBytes) {
+        auto sbePlan = std::make_shared<sbe::CachedSbePlan>(
+            nullptr,
+            stage_builder::PlanStageData{std::make_unique<sbe::RuntimeEnvironment>()},
+            "");
+        sbePlan->estimatedSizeBytes = sizeBytes;
+        return sbePlan;
+    };
+
+    // Verify that keeping an SBE plan along with the entry accounts for its size.
+    const auto key = planCache.computeKey(*cq);
+    planCache.setSbePlan(key, makeSbePlan(1000));
+    ASSERT_EQ(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get(), sizeWithoutSbePlan + 1000);
+    ASSERT_EQ(assertGet(planCache.getEntry(*cq))->estimatedEntrySizeBytes,
+              sizeWithoutSbePlan - originalSize + 1000);
+
+    // Verify that replacing the SBE plan accounts for the size of the new plan only.
+    planCache.setSbePlan(key, makeSbePlan(400));
+    ASSERT_EQ(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get(), sizeWithoutSbePlan + 400);
+
+    // Verify that deactivating the entry drops the SBE plan and its size.
+    planCache.deactivate(*cq);
+    ASSERT_EQ(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get(), sizeWithoutSbePlan);
+
+    ASSERT_OK(planCache.remove(*cq));
+    ASSERT_EQ(PlanCacheEntry::planCacheTotalSizeEstimateBytes.get(), originalSize);
+}
+
 TEST(PlanCacheTest, PlanCacheSizeWithMultiplePlanCaches) {
     PlanCache planCache1;
     PlanCache planCache2;
@@ -36,6 +36,7 @@
 #include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/query/plan_explainer_factory.h"
 #include "mongo/db/query/plan_insert_listener.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder.h"
 
 namespace mongo {
@@ -88,6 +89,12 @@ PlanExecutorSBE::PlanExecutorSBE(OperationContext* opCtx,
         _root->attachFromOperationContext(_opCtx);
     }
 
+    if (candidates.cachedPlanDecisionReads &&
+        internalQueryEnableCachedPlanRuntimeFeedback.load()) {
+        _cachedPlanFeedback.emplace(
+            *_cq, *candidates.cachedPlanDecisionReads, winner.results.size());
+    }
+
     if (!winner.results.empty()) {
         _stash = std::move(winner.results);
     }
@@ -230,6 +237,10 @@ PlanExecutor::ExecState PlanExecutorSBE::getNext(BSONObj* out, RecordId* dlOut)
 
         auto result = fetchNext(_root.get(), _result, _resultRecordId, out, dlOut);
         if (result == sbe::PlanState::IS_EOF) {
+            if (_cachedPlanFeedback) {
+                _cachedPlanFeedback->onEOF(_opCtx, _nss, _root.get());
+            }
+
             _root->close();
             _state = State::kClosed;
 
@@ -243,6 +254,9 @@ PlanExecutor::ExecState PlanExecutorSBE::getNext(BSONObj* out, RecordId* dlOut)
         }
 
         invariant(result == sbe::PlanState::ADVANCED);
+        if (_cachedPlanFeedback) {
+            _cachedPlanFeedback->onAdvance(_opCtx, _nss, _root.get());
+        }
         return PlanExecutor::ExecState::ADVANCED;
     }
 }
@@ -35,6 +35,7 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/plan_explainer_sbe.h"
 #include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/sbe_cached_solution_planner.h"
 #include "mongo/db/query/sbe_plan_ranker.h"
 #include "mongo/db/query/sbe_runtime_planner.h"
 #include "mongo/db/query/sbe_stage_builder.h"
@@ -158,6 +159,9 @@ private:
     std::unique_ptr<PlanYieldPolicySBE> _yieldPolicy;
 
     std::unique_ptr<PlanExplainer> _planExplainer;
+
+    // Set if the plan was drawn from the plan cache, to keep checking its efficiency.
+    boost::optional<sbe::CachedPlanFeedback> _cachedPlanFeedback;
 };
 
 /**
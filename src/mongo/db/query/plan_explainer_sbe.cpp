@@ -40,6 +40,27 @@
 
 namespace mongo {
 namespace {
+/**
+ * Returns the stats of the first stage of type 'stageType' built for the QuerySolutionNode
+ * 'nodeId' in the stats tree rooted at 'root', or nullptr if there is no such stage.
+ */
+const sbe::PlanStageStats* findStageStats(const sbe::PlanStageStats* root,
+                                          PlanNodeId nodeId,
+                                          StringData stageType) {
+    if (!root) {
+        return nullptr;
+    }
+    if (root->common.nodeId == nodeId && root->common.stageType == stageType) {
+        return root;
+    }
+    for (auto&& child : root->children) {
+        if (auto stats = findStageStats(child.get(), nodeId, stageType)) {
+            return stats;
+        }
+    }
+    return nullptr;
+}
+
 void statsToBSON(const QuerySolutionNode* node,
                  const sbe::PlanStageStats* stats,
                  ExplainOptions::Verbosity verbosity,
@@ -134,6 +155,26 @@ void statsToBSON(const QuerySolutionNode* node,
             }
             break;
         }
+        case STAGE_GROUP: {
+            auto gn = static_cast<const GroupNode*>(node);
+            gn->groupByExpression->serialize(false).addToBsonObj(bob, "groupBy");
+            BSONObjBuilder accumulatorsBob(bob->subobjStart("accumulators"));
+            for (auto&& acc : gn->accumulators) {
+                BSONObjBuilder accumulatorBob(accumulatorsBob.subobjStart(acc.fieldName));
+                acc.expr.argument->serialize(false).addToBsonObj(
+                    &accumulatorBob, acc.makeAccumulator()->getOpName());
+            }
+            accumulatorsBob.doneFast();
+
+            if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
+                if (auto groupStats = findStageStats(stats, node->nodeId(), "group"_sd)) {
+                    auto spec = static_cast<const sbe::HashAggStats*>(groupStats->specific.get());
+                    bob->appendBool("usedDisk", spec->usedDisk);
+                    bob->appendIntOrLL("spilledRecords", spec->spilledRecords);
+                }
+            }
+            break;
+        }
         case STAGE_IXSCAN: {
             auto ixn = static_cast<const IndexScanNode*>(node);
 
@@ -207,7 +248,19 @@ void statsToBSON(const QuerySolutionNode* node,
             bob->append("type", node->getType() == STAGE_SORT_SIMPLE ? "simple" : "default");
 
             if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
-                // TODO SERVER-51409.
+                if (auto sortStats = findStageStats(stats, node->nodeId(), "sort"_sd)) {
+                    auto spec = static_cast<const SortStats*>(sortStats->specific.get());
+                    bob->appendIntOrLL("totalDataSizeSorted", spec->totalDataSizeBytes);
+                    bob->appendBool("usedDisk", spec->wasDiskUsed);
+
+                    // The number of rows sorted is the number of rows the sort stage read from its
+                    // child.
+                    invariant(sortStats->children.size() == 1);
+                    if (auto numRows = sortStats->children[0]->common.advances) {
+                        bob->appendIntOrLL("memUsagePerSortedRow",
+                                           spec->totalDataSizeBytes / numRows);
+                    }
+                }
             }
             break;
         }
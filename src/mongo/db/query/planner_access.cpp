@@ -46,6 +46,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/indexability.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/planner_wildcard_helpers.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
@@ -1376,6 +1377,70 @@ std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::scanWholeIndex(
     return solnRoot;
 }
 
+std::unique_ptr<QuerySolutionNode> QueryPlannerAccess::skipScanIndex(
+    const IndexEntry& index, const CanonicalQuery& query, const QueryPlannerParams& params) {
+    // Bounds over several predicates on one field are only intersected correctly if the field holds
+    // a single value, and a sparse or partial index may lack the documents the query wants.
+    if (index.type != INDEX_BTREE || index.multikey || index.sparse || index.filterExpr ||
+        index.keyPattern.nFields() < 2) {
+        return nullptr;
+    }
+
+    // Rate a copy of the query against the index, to learn which of the predicates ANDed together
+    // at its root can bound each field of the index.
+    unique_ptr<MatchExpression> ratedRoot = query.root()->shallowClone();
+    QueryPlannerIXSelect::rateIndices(ratedRoot.get(), "", {index}, query.getCollator());
+    std::vector<MatchExpression*> preds;
+    if (MatchExpression::AND == ratedRoot->matchType()) {
+        for (size_t i = 0; i < ratedRoot->numChildren(); ++i) {
+            preds.push_back(ratedRoot->getChild(i));
+        }
+    } else {
+        preds.push_back(ratedRoot.get());
+    }
+
+    unique_ptr<IndexScanNode> isn = std::make_unique<IndexScanNode>(index);
+    isn->addKeyMetadata = query.metadataDeps()[DocumentMetadataFields::kIndexKey];
+    isn->queryCollator = query.getCollator();
+    isn->bounds.fields.resize(index.keyPattern.nFields());
+
+    bool hasBoundedField = false;
+    size_t keyPatternIdx = 0;
+    for (auto&& keyPatternElt : index.keyPattern) {
+        OrderedIntervalList* oil = &isn->bounds.fields[keyPatternIdx];
+        IndexBoundsBuilder::allValuesForField(keyPatternElt, oil);
+
+        for (auto pred : preds) {
+            auto rt = static_cast<RelevantTag*>(pred->getTag());
+            if (!rt || rt->path != keyPatternElt.fieldNameStringData() ||
+                (rt->first.empty() && rt->notFirst.empty())) {
+                continue;
+            }
+
+            // An index whose leading field is constrained is planned as any other.
+            if (0 == keyPatternIdx) {
+                return nullptr;
+            }
+
+            IndexBoundsBuilder::BoundsTightness tightness;
+            IndexBoundsBuilder::translateAndIntersect(pred, keyPatternElt, index, oil, &tightness);
+            hasBoundedField = true;
+        }
+        ++keyPatternIdx;
+    }
+
+    if (!hasBoundedField) {
+        return nullptr;
+    }
+    IndexBoundsBuilder::alignBounds(&isn->bounds, index.keyPattern);
+
+    // The bounds may be inexact, so the fetch applies the whole query.
+    unique_ptr<FetchNode> fetch = std::make_unique<FetchNode>();
+    fetch->filter = query.root()->shallowClone();
+    fetch->children.push_back(isn.release());
+    return fetch;
+}
+
 void QueryPlannerAccess::addFilterToSolutionNode(QuerySolutionNode* node,
                                                  MatchExpression* match,
                                                  MatchExpression::MatchType type) {
@@ -110,6 +110,17 @@ public:
                                                              const QueryPlannerParams& params,
                                                              int direction = 1);
 
+    /**
+     * Return a plan that uses the provided compound index to answer a query which does not
+     * constrain the index's leading field, but does constrain some of its other fields. The index
+     * is scanned over all values of the unconstrained fields and the query's bounds on the others,
+     * which lets the scan skip from each distinct prefix of the index to the next matching key.
+     * Returns nullptr if the index cannot be scanned this way.
+     */
+    static std::unique_ptr<QuerySolutionNode> skipScanIndex(const IndexEntry& index,
+                                                            const CanonicalQuery& query,
+                                                            const QueryPlannerParams& params);
+
     /**
      * Return a plan that scans the provided index from [startKey to endKey).
      */
@@ -40,6 +40,9 @@
 #include "mongo/db/index/s2_common.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/matcher/expression_tree.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/logv2/log.h"
@@ -80,6 +83,106 @@ bool isFetchNodeWithIndexScanChild(const QuerySolutionNode* node) {
             STAGE_IXSCAN == node->children[0]->getType());
 }
 
+/**
+ * Returns true if 'expr' gives the same result against the keys of the non-multikey 'index' as
+ * against the documents they were generated from: each path it references is a field of the key
+ * pattern, and each of its leaves is one the index can cover.
+ */
+bool canEvaluateOnIndexKeys(const MatchExpression* expr, const IndexEntry& index) {
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+        case MatchExpression::NOR:
+        case MatchExpression::NOT:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                if (!canEvaluateOnIndexKeys(expr->getChild(i), index)) {
+                    return false;
+                }
+            }
+            return expr->numChildren() > 0;
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::MATCH_IN:
+        case MatchExpression::TYPE_OPERATOR:
+            return index.keyPattern.hasField(expr->path()) &&
+                IndexBoundsBuilder::canUseCoveredMatching(expr, index);
+        default:
+            // Other predicates, such as $exists, cannot tell a missing field from a null one in the
+            // index key, or are not evaluated on a single field.
+            return false;
+    }
+}
+
+/**
+ * Walks the tree 'root' and moves the predicates of the filter of each FETCH over an IXSCAN which
+ * can be evaluated on the index keys alone to the filter of the IXSCAN, so that the documents of
+ * the index keys failing them are never fetched.
+ */
+void pushdownIndexKeyFilters(QuerySolutionNode* root) {
+    for (auto&& child : root->children) {
+        pushdownIndexKeyFilters(child);
+    }
+
+    if (!isFetchNodeWithIndexScanChild(root) || !root->filter) {
+        return;
+    }
+
+    auto ixn = static_cast<IndexScanNode*>(root->children[0]);
+    const IndexEntry& index = ixn->index;
+    // The keys of a multikey index hold a single element of an array, and those of an index with
+    // a collation hold comparison keys rather than strings, so that the predicates on such keys do
+    // not give the results they would on the documents.
+    if (index.type != INDEX_BTREE || index.multikey || index.collator) {
+        return;
+    }
+
+    std::vector<std::unique_ptr<MatchExpression>> keyPredicates;
+    if (MatchExpression::AND == root->filter->matchType()) {
+        auto& children = *root->filter->getChildVector();
+        for (auto it = children.begin(); it != children.end();) {
+            if (canEvaluateOnIndexKeys(*it, index)) {
+                keyPredicates.emplace_back(*it);
+                it = children.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (children.empty()) {
+            root->filter.reset();
+        } else if (children.size() == 1) {
+            // An $and of one thing is that thing.
+            std::unique_ptr<MatchExpression> child(children[0]);
+            children.clear();
+            root->filter = std::move(child);
+        }
+    } else if (canEvaluateOnIndexKeys(root->filter.get(), index)) {
+        keyPredicates.push_back(std::move(root->filter));
+    }
+
+    if (keyPredicates.empty()) {
+        return;
+    }
+
+    if (ixn->filter) {
+        keyPredicates.insert(keyPredicates.begin(), std::move(ixn->filter));
+    }
+    if (keyPredicates.size() == 1) {
+        ixn->filter = std::move(keyPredicates[0]);
+    } else {
+        auto andExpr = std::make_unique<AndMatchExpression>();
+        for (auto&& predicate : keyPredicates) {
+            andExpr->add(predicate.release());
+        }
+        ixn->filter = std::move(andExpr);
+    }
+}
+
 /**
  * Walks the tree 'root' and outputs all nodes that can be considered for explosion for sort.
  * Outputs FETCH nodes with an IXSCAN node as a child as well as singular IXSCAN leaves without a
@@ -561,6 +664,115 @@ bool canUseSimpleSort(const QuerySolutionNode& solnRoot,
         && !splitLimitedSortEligible;
 }
 
+/**
+ * Returns true if the indexes in 'params' prove that no document in the collection holds an array
+ * at the top-level 'field', namely if 'field' is indexed by a btree index which covers every
+ * document and is not multikey on it.
+ */
+bool fieldCannotBeArray(const QueryPlannerParams& params, StringData field) {
+    return std::any_of(params.indices.begin(), params.indices.end(), [&](const IndexEntry& index) {
+        return index.type == INDEX_BTREE && !index.filterExpr &&
+            index.keyPattern.hasField(field) && !index.pathHasMultikeyComponent(field);
+    });
+}
+
+/**
+ * If 'solnRoot' is an OR some of whose branches provide 'sortObj' (possibly by reversing their
+ * scans) and the query has a limit, replaces it with a MERGE_SORT of its branches, giving each
+ * branch which does not provide the sort a top-k SORT of its own. Unlike a single SORT over the
+ * whole OR, this lets the branches which are already in order stop as soon as the limit is
+ * reached, instead of being read to their end.
+ *
+ * Returns the new root on success, or nullptr if the rewrite does not apply, in which case
+ * 'solnRoot' is left untouched.
+ */
+QuerySolutionNode* tryMergeSortOrBranchesWithLimit(const CanonicalQuery& query,
+                                                   const QueryPlannerParams& params,
+                                                   QuerySolutionNode* solnRoot) {
+    const QueryRequest& qr = query.getQueryRequest();
+    const BSONObj& sortObj = qr.getSort();
+
+    if (!internalQueryPlannerMergeLimitedSortOfOrBranches.load() || !qr.getLimit() ||
+        qr.getNToReturn() || STAGE_OR != solnRoot->getType() || solnRoot->filter) {
+        return nullptr;
+    }
+
+    // Text and geo stages are assumed elsewhere to appear only once in a plan, and may not provide
+    // the fields the merge compares.
+    if (QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT) ||
+        QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO) ||
+        QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR)) {
+        return nullptr;
+    }
+
+    // The slot-based merge sort only supports ascending and descending sorts on top-level fields.
+    // Both merge sorts compare an array as a whole, whereas a SORT orders it by its smallest or
+    // largest element, so the merge is only correct if the sort fields cannot hold arrays.
+    for (auto&& elem : sortObj) {
+        if (!elem.isNumber() || elem.fieldNameStringData().find('.') != std::string::npos ||
+            !fieldCannotBeArray(params, elem.fieldNameStringData())) {
+            return nullptr;
+        }
+    }
+
+    const BSONObj reverseSort = QueryPlannerCommon::reverseSortObj(sortObj);
+    std::vector<bool> providesSort;
+    for (auto&& child : solnRoot->children) {
+        auto providedSorts = child->providedSorts();
+        providesSort.push_back(providedSorts.contains(sortObj) ||
+                               providedSorts.contains(reverseSort));
+    }
+
+    // If no branch is in order, a single sort of the whole OR does less work than a sort per
+    // branch. If every branch is in order, the OR would already have been merged when it was
+    // planned.
+    if (std::none_of(providesSort.begin(), providesSort.end(), [](bool b) { return b; }) ||
+        std::all_of(providesSort.begin(), providesSort.end(), [](bool b) { return b; })) {
+        return nullptr;
+    }
+
+    auto orNode = static_cast<OrNode*>(solnRoot);
+    auto merge = std::make_unique<MergeSortNode>();
+    merge->sort = sortObj;
+    merge->dedup = orNode->dedup;
+
+    const size_t sortLimit =
+        static_cast<size_t>(*qr.getLimit()) + static_cast<size_t>(qr.getSkip().value_or(0));
+    for (size_t i = 0; i < orNode->children.size(); ++i) {
+        QuerySolutionNode* child = orNode->children[i];
+        if (providesSort[i] && !child->providedSorts().contains(sortObj)) {
+            QueryPlannerCommon::reverseScans(child);
+        }
+
+        // The merge compares the sort fields of the documents its branches return.
+        if (!child->fetched()) {
+            auto fetch = std::make_unique<FetchNode>();
+            fetch->children.push_back(child);
+            child = fetch.release();
+        }
+
+        if (!providesSort[i]) {
+            // The merge dedups its branches by record id, which the simple sort discards.
+            auto sortNode = std::make_unique<SortNodeDefault>();
+            sortNode->pattern = sortObj;
+            sortNode->limit = sortLimit;
+            sortNode->children.push_back(child);
+            child = sortNode.release();
+        }
+        merge->children.push_back(child);
+    }
+
+    orNode->children.clear();
+    delete orNode;
+
+    merge->computeProperties();
+    LOGV2_DEBUG(5301500,
+                5,
+                "Merging the branches of an OR to provide a limited sort",
+                "newPlan"_attr = redact(merge->toString()));
+    return merge.release();
+}
+
 }  // namespace
 
 // static
@@ -804,6 +1016,12 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         return solnRoot;
     }
 
+    // With a limit, an OR whose branches are partly in order can be merged instead, sorting only
+    // the branches which are not.
+    if (auto merge = tryMergeSortOrBranchesWithLimit(query, params, solnRoot)) {
+        return merge;
+    }
+
     // If we're here, we need to add a sort stage.
 
     if (!solnRoot->fetched()) {
@@ -915,6 +1133,10 @@ std::unique_ptr<QuerySolution> QueryPlannerAnalysis::analyzeDataAccess(
     soln->filterData = query.getQueryObj();
     soln->indexFilterApplied = params.indexFiltersApplied;
 
+    if (internalQueryPlannerEnableIndexKeyFilterPushdown.load()) {
+        pushdownIndexKeyFilters(solnRoot.get());
+    }
+
     solnRoot->computeProperties();
 
     analyzeGeo(params, solnRoot.get());
@@ -971,7 +1193,8 @@ std::unique_ptr<QuerySolution> QueryPlannerAnalysis::analyzeDataAccess(
     // A solution can be blocking if it has a blocking sort stage or
     // a hashed AND stage.
     bool hasAndHashStage = solnRoot->hasNode(STAGE_AND_HASH);
-    soln->hasBlockingStage = hasSortStage || hasAndHashStage;
+    soln->hasBlockingStage = hasSortStage || hasAndHashStage ||
+        solnRoot->hasNode(STAGE_SORT_DEFAULT) || solnRoot->hasNode(STAGE_SORT_SIMPLE);
 
     const QueryRequest& qr = query.getQueryRequest();
 
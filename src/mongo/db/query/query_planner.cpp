@@ -52,6 +52,7 @@
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/logv2/log.h"
@@ -334,6 +335,17 @@ std::unique_ptr<QuerySolution> buildWholeIXSoln(const IndexEntry& index,
     return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
 }
 
+std::unique_ptr<QuerySolution> buildSkipScanSoln(const IndexEntry& index,
+                                                 const CanonicalQuery& query,
+                                                 const QueryPlannerParams& params) {
+    std::unique_ptr<QuerySolutionNode> solnRoot(
+        QueryPlannerAccess::skipScanIndex(index, query, params));
+    if (!solnRoot) {
+        return nullptr;
+    }
+    return QueryPlannerAnalysis::analyzeDataAccess(query, params, std::move(solnRoot));
+}
+
 bool providesSort(const CanonicalQuery& query, const BSONObj& kp) {
     return query.getQueryRequest().getSort().isPrefixOf(kp, SimpleBSONElementComparator::kInstance);
 }
@@ -503,6 +515,14 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
         } else {
             return {std::move(soln)};
         }
+    } else if (SolutionCacheData::SKIP_IXSCAN_SOLN == winnerCacheData.solnType) {
+        auto soln = buildSkipScanSoln(*winnerCacheData.tree->entry, query, params);
+        if (!soln) {
+            return Status(ErrorCodes::NoQueryExecutionPlans,
+                          "plan cache error: soln that skip scans index");
+        } else {
+            return {std::move(soln)};
+        }
     } else if (SolutionCacheData::COLLSCAN_SOLN == winnerCacheData.solnType) {
         // The cached solution is a collection scan. We don't cache collscans
         // with tailable==true, hence the false below.
@@ -944,6 +964,19 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
                 ErrorCodes::NoQueryExecutionPlans,
                 "$hint: refusing to build whole-index solution, because it's a wildcard index");
         }
+        // A hinted index whose leading field is not constrained by the query can still be
+        // skip scanned, examining fewer keys than a scan of the whole index.
+        if (internalQueryPlannerEnableSkipScan.load() &&
+            !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) &&
+            !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+            if (auto soln = buildSkipScanSoln(relevantIndices.front(), query, params)) {
+                LOGV2_DEBUG(5301600, 5, "Planner: outputting soln that skip scans hinted index");
+                std::vector<std::unique_ptr<QuerySolution>> out;
+                out.push_back(std::move(soln));
+                return {std::move(out)};
+            }
+        }
+
         // Return hinted index solution if found.
         auto soln = buildWholeIXSoln(relevantIndices.front(), query, params);
         if (!soln) {
@@ -1081,11 +1114,44 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         }
     }
 
+    // A compound index whose leading field the query does not constrain can still serve the
+    // predicates on its other fields, by skipping from each distinct prefix of the index to the
+    // next. This only pays off when there are few such prefixes, which the planner cannot tell, so
+    // these plans are raced against a collection scan.
+    std::vector<std::unique_ptr<QuerySolution>> skipScans;
+    if (internalQueryPlannerEnableSkipScan.load() && hintedIndex.isEmpty() &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+        for (auto&& index : fullIndexList) {
+            if (out.size() + skipScans.size() >= params.maxIndexedSolutions) {
+                break;
+            }
+
+            auto soln = buildSkipScanSoln(index, query, params);
+            if (soln) {
+                LOGV2_DEBUG(5301601,
+                            5,
+                            "Planner: outputting soln that skip scans index",
+                            "index"_attr = index.identifier);
+                PlanCacheIndexTree* indexTree = new PlanCacheIndexTree();
+                indexTree->setIndexEntry(index);
+                SolutionCacheData* scd = new SolutionCacheData();
+                scd->tree.reset(indexTree);
+                scd->solnType = SolutionCacheData::SKIP_IXSCAN_SOLN;
+
+                soln->cacheData.reset(scd);
+                skipScans.push_back(std::move(soln));
+            }
+        }
+    }
+
     // The caller can explicitly ask for a collscan.
     bool collscanRequested = (params.options & QueryPlannerParams::INCLUDE_COLLSCAN);
 
     // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
-    bool collScanRequired = 0 == out.size();
+    // Skip scans do not count, as they are only worth running if they beat the collscan, unless
+    // table scans are not allowed.
+    bool collScanRequired = 0 == out.size() && (skipScans.empty() || canTableScan);
     if (collScanRequired && !canTableScan) {
         return Status(ErrorCodes::NoQueryExecutionPlans,
                       "No indexed plans available, and running with 'notablescan'");
@@ -1100,6 +1166,10 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         return Status(ErrorCodes::NoQueryExecutionPlans, "No query solutions");
     }
 
+    for (auto&& soln : skipScans) {
+        out.push_back(std::move(soln));
+    }
+
     if (possibleToCollscan && (collscanRequested || collScanRequired)) {
         auto collscan = buildCollscanSoln(query, isTailable, params);
         if (!collscan && collScanRequired) {
@@ -1122,6 +1192,19 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
     return {std::move(out)};
 }
 
+std::unique_ptr<QuerySolution> QueryPlanner::extendWithAggPipeline(
+    const CanonicalQuery& query, std::unique_ptr<QuerySolution> solution) {
+    const auto& group = query.getPushedDownGroup();
+    if (!group) {
+        return solution;
+    }
+
+    auto groupNode = std::make_unique<GroupNode>(group->groupByExpression, group->accumulators);
+    groupNode->children.push_back(solution->extractRoot().release());
+    solution->setRoot(std::move(groupNode));
+    return solution;
+}
+
 StatusWith<QueryPlanner::SubqueriesPlanningResult> QueryPlanner::planSubqueries(
     OperationContext* opCtx,
     const CollectionPtr& collection,
@@ -102,6 +102,14 @@ public:
         const QueryPlannerParams& params,
         const CachedSolution& cachedSoln);
 
+    /**
+     * Returns 'solution' extended with the stages of an aggregation pipeline which 'query' is the
+     * prefix of, and which were pushed down into 'query' to be executed on top of the documents
+     * returned by 'solution'. Returns 'solution' unchanged if there are no such stages.
+     */
+    static std::unique_ptr<QuerySolution> extendWithAggPipeline(
+        const CanonicalQuery& query, std::unique_ptr<QuerySolution> solution);
+
     /**
      * Plan each branch of the rooted $or query independently, and store the resulting
      * lists of query solutions in 'SubqueriesPlanningResult'.
@@ -1426,5 +1426,71 @@ TEST_F(QueryPlannerTest, PlansForWholeIndexScanWithSortAreGenerated) {
         "{proj: {spec: {'b': 1, _id: 0}, node: {fetch: {node: {ixscan: {pattern: {a: 1}}}}}}}");
 }
 
+TEST_F(QueryPlannerTest, SkipScanOfCompoundIndexWithUnconstrainedLeadingField) {
+    const bool defaultSkipScan = internalQueryPlannerEnableSkipScan.load();
+    ON_BLOCK_EXIT([&] { internalQueryPlannerEnableSkipScan.store(defaultSkipScan); });
+    internalQueryPlannerEnableSkipScan.store(true);
+
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, filter: {b: 5}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanBoundsEveryConstrainedTrailingField) {
+    const bool defaultSkipScan = internalQueryPlannerEnableSkipScan.load();
+    ON_BLOCK_EXIT([&] { internalQueryPlannerEnableSkipScan.store(defaultSkipScan); });
+    internalQueryPlannerEnableSkipScan.store(true);
+
+    addIndex(BSON("a" << 1 << "b" << -1 << "c" << 1 << "d" << 1));
+    runQuery(fromjson("{b: {$gt: 2}, d: 3, e: 1}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {e: 1}, node: {ixscan: {pattern: {a: 1, b: -1, c: 1, d: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[Infinity,2,true,false]], "
+        "c: [['MinKey','MaxKey',true,true]], d: [[3,3,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SkipScanOfHintedIndexWithUnconstrainedLeadingField) {
+    const bool defaultSkipScan = internalQueryPlannerEnableSkipScan.load();
+    ON_BLOCK_EXIT([&] { internalQueryPlannerEnableSkipScan.store(defaultSkipScan); });
+    internalQueryPlannerEnableSkipScan.store(true);
+
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQueryHint(fromjson("{b: {$in: [1, 5]}}"), BSON("a" << 1 << "b" << 1));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, bounds: "
+        "{a: [['MinKey','MaxKey',true,true]], b: [[1,1,true,true], [5,5,true,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSkipScanOfMultikeyIndex) {
+    const bool defaultSkipScan = internalQueryPlannerEnableSkipScan.load();
+    ON_BLOCK_EXIT([&] { internalQueryPlannerEnableSkipScan.store(defaultSkipScan); });
+    internalQueryPlannerEnableSkipScan.store(true);
+
+    // true means multikey
+    addIndex(BSON("a" << 1 << "b" << 1), true);
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSkipScanWhenDisabled) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
 }  // namespace
 }  // namespace mongo
@@ -508,6 +508,146 @@ TEST_F(QueryPlannerTest, OrInexactCoveredMultikey) {
         "node: {ixscan: {filter: null, pattern: {names: 1}}}}}");
 }
 
+TEST_F(QueryPlannerTest, ResidualPredicatesOnIndexedFieldsAreEvaluatedOnIndexKeys) {
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+    runQuery(fromjson("{a: {$gt: 1}, $nor: [{b: 1}, {c: /foo/}], d: 2}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {d: 2}, node: {ixscan: {pattern: {a: 1, b: 1, c: 1}, "
+        "filter: {$nor: [{b: 1}, {c: /foo/}]}}}}}");
+}
+
+TEST_F(QueryPlannerTest, ResidualPredicatesOnIndexedFieldsAreNotEvaluatedOnMultikeyIndexKeys) {
+    // true means multikey
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1), true);
+    runQuery(fromjson("{a: {$gt: 1}, $nor: [{b: 1}, {c: /foo/}]}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {$nor: [{b: 1}, {c: /foo/}]}, node: {ixscan: "
+        "{pattern: {a: 1, b: 1, c: 1}, filter: null}}}}");
+}
+
+TEST_F(QueryPlannerTest, ResidualPredicatesOnUnindexedFieldsAreNotEvaluatedOnIndexKeys) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuery(fromjson("{a: {$gt: 1}, $or: [{b: 1}, {c: 2}]}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {$or: [{b: 1}, {c: 2}]}, node: "
+        "{ixscan: {pattern: {a: 1, b: 1}, filter: null}}}}");
+}
+
+TEST_F(QueryPlannerTest, ResidualPredicatesStayInFetchWithoutIndexKeyFilterPushdown) {
+    const bool defaultPushdown = internalQueryPlannerEnableIndexKeyFilterPushdown.load();
+    ON_BLOCK_EXIT(
+        [&] { internalQueryPlannerEnableIndexKeyFilterPushdown.store(defaultPushdown); });
+    internalQueryPlannerEnableIndexKeyFilterPushdown.store(false);
+
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+    runQuery(fromjson("{a: {$gt: 1}, $nor: [{b: 1}, {c: /foo/}]}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists("{cscan: {dir: 1}}");
+    assertSolutionExists(
+        "{fetch: {filter: {$nor: [{b: 1}, {c: /foo/}]}, node: {ixscan: "
+        "{pattern: {a: 1, b: 1, c: 1}, filter: null}}}}");
+}
+
+TEST_F(QueryPlannerTest, LimitedSortOfPartlySortedOrMergesBranches) {
+    addIndex(BSON("a" << 1 << "c" << 1));
+    addIndex(BSON("b" << 1));
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: 1}, limit: 5}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {c: 1}, limit: 5, type: 'simple', node: {cscan: {dir: 1}}}}");
+    assertSolutionExists(
+        "{limit: {n: 5, node: {mergeSort: {nodes: ["
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, c: 1}}}}},"
+        "{sort: {pattern: {c: 1}, limit: 5, type: 'default', node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {b: 1}}}}}}}]}}}}");
+}
+
+TEST_F(QueryPlannerTest, LimitedSortOfPartlySortedOrMergesBranchesWithReversedScans) {
+    addIndex(BSON("a" << 1 << "c" << 1));
+    addIndex(BSON("b" << 1));
+    runQueryAsCommand(fromjson(
+        "{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: -1}, skip: 2, limit: 3}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{limit: {n: 3, node: {skip: {n: 2, node: {mergeSort: {nodes: ["
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, c: 1}, dir: -1}}}},"
+        "{sort: {pattern: {c: -1}, limit: 5, type: 'default', node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {b: 1}}}}}}}]}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SortOfPartlySortedOrWithoutLimitSortsWholeOr) {
+    addIndex(BSON("a" << 1 << "c" << 1));
+    addIndex(BSON("b" << 1));
+    runQueryAsCommand(fromjson("{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: 1}}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {c: 1}, limit: 0, type: 'simple', node: {fetch: {node: {or: {nodes: ["
+        "{ixscan: {pattern: {a: 1, c: 1}}}, {ixscan: {pattern: {b: 1}}}]}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, LimitedSortOfPartlySortedOrIsNotMergedWhenDisabled) {
+    const bool defaultMerge = internalQueryPlannerMergeLimitedSortOfOrBranches.load();
+    ON_BLOCK_EXIT(
+        [&] { internalQueryPlannerMergeLimitedSortOfOrBranches.store(defaultMerge); });
+    internalQueryPlannerMergeLimitedSortOfOrBranches.store(false);
+
+    addIndex(BSON("a" << 1 << "c" << 1));
+    addIndex(BSON("b" << 1));
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: 1}, limit: 5}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {c: 1}, limit: 5, type: 'simple', node: {fetch: {node: {or: {nodes: ["
+        "{ixscan: {pattern: {a: 1, c: 1}}}, {ixscan: {pattern: {b: 1}}}]}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, LimitedSortOfPartlySortedOrIsNotMergedWhenSortFieldMayBeArray) {
+    // The partial index says nothing about the documents it does not cover, whose 'c' may be an
+    // array which the merge would compare differently than the sort of its branch.
+    std::unique_ptr<MatchExpression> filterExpr =
+        parseMatchExpression(fromjson("{a: {$exists: true}}"));
+    addIndex(BSON("a" << 1 << "c" << 1), filterExpr.get());
+    addIndex(BSON("b" << 1));
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: 1}, limit: 5}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {c: 1}, limit: 5, type: 'simple', node: {fetch: {node: {or: {nodes: ["
+        "{ixscan: {pattern: {a: 1, c: 1}}}, {ixscan: {pattern: {b: 1}}}]}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, LimitedSortOfPartlySortedOrIsMergedWhenAnotherIndexProvesSortFieldScalar) {
+    std::unique_ptr<MatchExpression> filterExpr =
+        parseMatchExpression(fromjson("{a: {$exists: true}}"));
+    addIndex(BSON("a" << 1 << "c" << 1), filterExpr.get());
+    addIndex(BSON("b" << 1));
+    addIndex(BSON("d" << 1 << "c" << 1), MultikeyPaths{{0U}, {}});
+    runQueryAsCommand(
+        fromjson("{find: 'testns', filter: {$or: [{a: 1}, {b: 2}]}, sort: {c: 1}, limit: 5}"));
+
+    assertSolutionExists(
+        "{limit: {n: 5, node: {mergeSort: {nodes: ["
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, c: 1}}}}},"
+        "{sort: {pattern: {c: 1}, limit: 5, type: 'default', node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {b: 1}}}}}}}]}}}}");
+}
+
 // SERVER-13960: $elemMatch object with $or.
 TEST_F(QueryPlannerTest, OrElemMatchObject) {
     // true means multikey
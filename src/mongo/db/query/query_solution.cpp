@@ -1337,4 +1337,30 @@ QuerySolutionNode* EofNode::clone() const {
     return copy;
 }
 
+//
+// GroupNode
+//
+
+void GroupNode::appendToString(str::stream* ss, int indent) const {
+    addIndent(ss, indent);
+    *ss << "GROUP\n";
+    addIndent(ss, indent + 1);
+    *ss << "groupBy = " << groupByExpression->serialize(false).toString() << '\n';
+    for (auto&& acc : accumulators) {
+        addIndent(ss, indent + 1);
+        *ss << acc.fieldName << " = " << acc.makeAccumulator()->getOpName() << " "
+            << acc.expr.argument->serialize(false).toString() << '\n';
+    }
+    addCommon(ss, indent);
+    addIndent(ss, indent + 1);
+    *ss << "Child:" << '\n';
+    children[0]->appendToString(ss, indent + 2);
+}
+
+QuerySolutionNode* GroupNode::clone() const {
+    auto copy = new GroupNode(groupByExpression, accumulators);
+    cloneBaseData(copy);
+    return copy;
+}
+
 }  // namespace mongo
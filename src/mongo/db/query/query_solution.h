@@ -36,6 +36,7 @@
 #include "mongo/db/fts/fts_query.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/stage_types.h"
@@ -346,6 +347,14 @@ public:
      */
     void setRoot(std::unique_ptr<QuerySolutionNode> root);
 
+    /**
+     * Releases the ownership of the QuerySolutionNode tree of this QuerySolution, for it to be
+     * extended with more stages and assigned back with setRoot().
+     */
+    std::unique_ptr<QuerySolutionNode> extractRoot() {
+        return std::move(_root);
+    }
+
     // Any filters in root or below point into this object.  Must be owned.
     BSONObj filterData;
 
@@ -1194,4 +1203,39 @@ struct EofNode : public QuerySolutionNodeWithSortSet {
 
     QuerySolutionNode* clone() const;
 };
+
+/**
+ * Groups the documents returned by its child by the value of 'groupByExpression', and returns a
+ * document for each group holding the group key in '_id', and the result of each of the
+ * 'accumulators' in its field. This is a $group stage of an aggregation pipeline pushed down into
+ * the query, see QueryPlanner::extendWithAggPipeline().
+ */
+struct GroupNode : public QuerySolutionNodeWithSortSet {
+    GroupNode(boost::intrusive_ptr<Expression> groupByExpression,
+              std::vector<AccumulationStatement> accumulators)
+        : groupByExpression(std::move(groupByExpression)),
+          accumulators(std::move(accumulators)) {}
+
+    virtual StageType getType() const {
+        return STAGE_GROUP;
+    }
+
+    virtual void appendToString(str::stream* ss, int indent) const;
+
+    // The documents returned are made up by the stage, and hold all of their fields.
+    bool fetched() const {
+        return true;
+    }
+    FieldAvailability getFieldAvailability(const std::string& field) const {
+        return FieldAvailability::kFullyProvided;
+    }
+    bool sortedByDiskLoc() const {
+        return false;
+    }
+
+    QuerySolutionNode* clone() const;
+
+    boost::intrusive_ptr<Expression> groupByExpression;
+    std::vector<AccumulationStatement> accumulators;
+};
 }  // namespace mongo
@@ -32,8 +32,12 @@
 
 #include "mongo/db/query/sbe_cached_solution_planner.h"
 
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/exec/trial_period_utils.h"
 #include "mongo/db/query/collection_query_info.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/sbe_multi_planner.h"
 #include "mongo/db/query/stage_builder_util.h"
@@ -41,6 +45,14 @@
 #include "mongo/logv2/log.h"
 
 namespace mongo::sbe {
+namespace {
+// Counts the plan cache entries deactivated because a plan drawn from them turned out to be much
+// less efficient than anticipated after its trial period.
+Counter64 feedbackDeactivations;
+ServerStatusMetricField<Counter64> displayFeedbackDeactivations(
+    "query.sbe.planCache.feedbackDeactivations", &feedbackDeactivations);
+}  // namespace
+
 CandidatePlans CachedSolutionPlanner::plan(
     std::vector<std::unique_ptr<QuerySolution>> solutions,
     std::vector<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>> roots) {
@@ -72,7 +84,8 @@ CandidatePlans CachedSolutionPlanner::plan(
     if (stats->common.isEOF || numReads <= _decisionReads) {
         return {makeVector<plan_ranker::CandidatePlan>(
                     finalizeExecutionPlan(std::move(stats), std::move(candidate))),
-                0};
+                0,
+                _decisionReads};
     }
 
     // If we're here, the trial period took more than 'maxReadsBeforeReplan' physical reads. This
@@ -117,6 +130,9 @@ CandidatePlans CachedSolutionPlanner::replan(bool shouldCache) const {
 
     // Use the query planning module to plan the whole query.
     auto solutions = uassertStatusOK(QueryPlanner::plan(_cq, _queryParams));
+    for (auto&& solution : solutions) {
+        solution = QueryPlanner::extendWithAggPipeline(_cq, std::move(solution));
+    }
     if (solutions.size() == 1) {
         // Only one possible plan. Build the stages from the solution.
         auto&& [root, data] = stage_builder::buildSlotBasedExecutableTree(
@@ -151,15 +167,97 @@ CandidatePlans CachedSolutionPlanner::replan(bool shouldCache) const {
     const auto cachingMode =
         shouldCache ? PlanCachingMode::AlwaysCache : PlanCachingMode::NeverCache;
     MultiPlanner multiPlanner{_opCtx, _collection, _cq, cachingMode, _yieldPolicy};
-    auto&& [candidates, winnerIdx] = multiPlanner.plan(std::move(solutions), std::move(roots));
-    auto explainer = plan_explainer_factory::make(candidates[winnerIdx].root.get(),
-                                                  candidates[winnerIdx].solution.get());
+    auto candidates = multiPlanner.plan(std::move(solutions), std::move(roots));
+    auto explainer = plan_explainer_factory::make(candidates.winner().root.get(),
+                                                  candidates.winner().solution.get());
     LOGV2_DEBUG(2058201,
                 1,
                 "Query plan after replanning and its cache status",
                 "query"_attr = redact(_cq.toStringShort()),
                 "planSummary"_attr = explainer->getPlanSummary(),
                 "shouldCache"_attr = (shouldCache ? "yes" : "no"));
-    return {std::move(candidates), winnerIdx};
+    return candidates;
+}
+
+CachedPlanFeedback::CachedPlanFeedback(const CanonicalQuery& cq,
+                                       size_t decisionReads,
+                                       size_t numResults)
+    : _cq{cq},
+      _decisionReads{decisionReads},
+      _numTrialResults{std::max<size_t>(trial_period::getTrialPeriodNumToReturn(cq), 1)},
+      _numResults{numResults},
+      _nextCheck{std::max(numResults, _numTrialResults) * 2} {}
+
+void CachedPlanFeedback::onAdvance(OperationContext* opCtx,
+                                   const NamespaceString& nss,
+                                   const PlanStage* root) {
+    if (_done || ++_numResults < _nextCheck) {
+        return;
+    }
+
+    _nextCheck *= 2;
+    check(opCtx, nss, root);
+}
+
+void CachedPlanFeedback::onEOF(OperationContext* opCtx,
+                               const NamespaceString& nss,
+                               const PlanStage* root) {
+    if (_done) {
+        return;
+    }
+
+    _done = true;
+    check(opCtx, nss, root);
+}
+
+boost::optional<size_t> CachedPlanFeedback::evaluate(size_t decisionReads,
+                                                     size_t numTrialResults,
+                                                     size_t numReads,
+                                                     size_t numResults) {
+    // A plan which has produced fewer results than during its trial period is judged by its reads
+    // alone, as the CachedSolutionPlanner does.
+    const auto numTrials =
+        std::max(1.0, static_cast<double>(numResults) / std::max<size_t>(numTrialResults, 1));
+    const auto readsPerTrial = static_cast<size_t>(numReads / numTrials);
+    const auto maxReadsPerTrial =
+        internalQueryCacheEvictionRatio.load() * std::max<size_t>(decisionReads, 1);
+    if (readsPerTrial <= maxReadsPerTrial) {
+        return boost::none;
+    }
+    return readsPerTrial;
+}
+
+void CachedPlanFeedback::check(OperationContext* opCtx,
+                               const NamespaceString& nss,
+                               const PlanStage* root) {
+    const auto numReads = calculateNumberOfReads(root->getStats().get());
+    const auto readsPerTrial = evaluate(_decisionReads, _numTrialResults, numReads, _numResults);
+    if (!readsPerTrial) {
+        return;
+    }
+
+    _done = true;
+
+    // This is called from within PlanExecutorSBE::getNext(), which must not acquire locks on top
+    // of the storage snapshot it reads from. The catalog lookup keeps the collection, and with it
+    // the plan cache, alive for the duration of this call without taking any locks.
+    auto collection = CollectionCatalog::get(opCtx).lookupCollectionByNamespaceForRead(opCtx, nss);
+    if (!collection) {
+        return;
+    }
+
+    LOGV2_DEBUG(5301000,
+                1,
+                "Deactivating cache entry for a query since its plan needs more reads per result "
+                "than anticipated",
+                "numReads"_attr = numReads,
+                "numResults"_attr = _numResults,
+                "readsPerTrial"_attr = *readsPerTrial,
+                "decisionReads"_attr = _decisionReads,
+                "query"_attr = redact(_cq.toStringShort()));
+    CollectionQueryInfo::get(CollectionPtr(collection.get(), CollectionPtr::NoYieldTag{}))
+        .getPlanCache()
+        ->deactivate(_cq, *readsPerTrial);
+    feedbackDeactivations.increment();
 }
 }  // namespace mongo::sbe
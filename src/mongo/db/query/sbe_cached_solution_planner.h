@@ -83,4 +83,56 @@ private:
     // cached.
     const size_t _decisionReads;
 };
+
+/**
+ * Keeps checking a plan kept by the CachedSolutionPlanner for the rest of its execution, and
+ * deactivates its plan cache entry once the plan turns out to need many more physical reads per
+ * result than it did when it was cached. This catches cached plans which only degrade after their
+ * trial period, e.g. because the data they scan has shifted, so that the next query of the same
+ * shape is replanned. The query at hand keeps running with its plan, as the results it has already
+ * returned cannot be taken back.
+ *
+ * The plan is checked each time the number of results it has produced doubles, and once more when
+ * it reaches EOF.
+ */
+class CachedPlanFeedback {
+public:
+    /**
+     * 'numResults' is the number of results the plan has produced during its trial period.
+     */
+    CachedPlanFeedback(const CanonicalQuery& cq, size_t decisionReads, size_t numResults);
+
+    /**
+     * Notifies that the plan rooted at 'root' has produced another result.
+     */
+    void onAdvance(OperationContext* opCtx, const NamespaceString& nss, const PlanStage* root);
+
+    /**
+     * Notifies that the plan rooted at 'root' has been exhausted.
+     */
+    void onEOF(OperationContext* opCtx, const NamespaceString& nss, const PlanStage* root);
+
+    /**
+     * Returns the number of reads a plan which took 'numReads' reads to produce 'numResults'
+     * results needs per 'numTrialResults' results, if this is more than
+     * 'internalQueryCacheEvictionRatio' times the 'decisionReads' it needed when it was cached.
+     * Otherwise returns boost::none.
+     */
+    static boost::optional<size_t> evaluate(size_t decisionReads,
+                                            size_t numTrialResults,
+                                            size_t numReads,
+                                            size_t numResults);
+
+private:
+    void check(OperationContext* opCtx, const NamespaceString& nss, const PlanStage* root);
+
+    const CanonicalQuery& _cq;
+    const size_t _decisionReads;
+    const size_t _numTrialResults;
+    size_t _numResults;
+    size_t _nextCheck;
+
+    // Set once the plan cache entry has been deactivated, or the plan has been checked at EOF.
+    bool _done{false};
+};
 }  // namespace mongo::sbe
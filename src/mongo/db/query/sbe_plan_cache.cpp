@@ -0,0 +1,394 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_plan_cache.h"
+
+#include <set>
+
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/exec/sbe/util/debug_print.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_parameterization.h"
+#include "mongo/db/query/collection_query_info.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+#include "mongo/db/query/sbe_stage_builder_index_scan.h"
+#include "mongo/db/query/stage_builder_util.h"
+#include "mongo/logv2/log.h"
+
+namespace mongo::sbe {
+namespace {
+// The number of plans for queries of a cached shape which were obtained by rebinding the cached SBE
+// plan of the shape, and which had to be built from their solution.
+Counter64 cachedPlanHits;
+ServerStatusMetricField<Counter64> displayCachedPlanHits("query.sbe.planCache.hits",
+                                                         &cachedPlanHits);
+Counter64 cachedPlanMisses;
+ServerStatusMetricField<Counter64> displayCachedPlanMisses("query.sbe.planCache.misses",
+                                                           &cachedPlanMisses);
+
+/**
+ * Replaces the RHS of every parameterized comparison in 'expr' with a placeholder naming its input
+ * parameter, and appends the ids of these parameters to 'paramIds' in pre-order. The placeholders
+ * are owned by 'placeholders'.
+ */
+void replaceParamsWithPlaceholders(MatchExpression* expr,
+                                   std::vector<BSONObj>* placeholders,
+                                   std::vector<InputParamId>* paramIds) {
+    if (ComparisonMatchExpression::isComparisonMatchExpression(expr)) {
+        auto comparison = static_cast<ComparisonMatchExpression*>(expr);
+        if (auto paramId = comparison->getInputParamId()) {
+            placeholders->push_back(BSON("" << BSON("$inputParam" << *paramId)));
+            comparison->setData(placeholders->back().firstElement());
+            paramIds->push_back(*paramId);
+        }
+    }
+
+    for (size_t i = 0; i < expr->numChildren(); ++i) {
+        replaceParamsWithPlaceholders(expr->getChild(i), placeholders, paramIds);
+    }
+}
+
+/**
+ * Appends a description of 'filter' without the values of its input parameters to 'sb'. The ids
+ * of the input parameters are listed separately, so that a placeholder cannot be mistaken for a
+ * constant of the same value.
+ */
+void appendFilter(const MatchExpression& filter,
+                  StringBuilder* sb,
+                  std::vector<InputParamId>* paramIds) {
+    auto clone = filter.shallowClone();
+    std::vector<BSONObj> placeholders;
+    const auto firstParam = paramIds->size();
+    replaceParamsWithPlaceholders(clone.get(), &placeholders, paramIds);
+
+    *sb << " filter: " << clone->serialize().toString() << " params: [";
+    for (auto it = paramIds->begin() + firstParam; it != paramIds->end(); ++it) {
+        *sb << *it << ' ';
+    }
+    *sb << ']';
+}
+
+/**
+ * Appends a description of the subtree rooted at 'node' to 'sb'. Returns false if the subtree
+ * contains a stage whose SBE plan cannot be rebound to the constants of another query.
+ */
+bool appendNode(const QuerySolutionNode* node,
+                StringBuilder* sb,
+                std::vector<InputParamId>* paramIds) {
+    *sb << stageTypeToString(node->getType()) << " {";
+
+    switch (node->getType()) {
+        case STAGE_COLLSCAN: {
+            auto csn = static_cast<const CollectionScanNode*>(node);
+            // Oplog and resumable scans depend on constants which are not parameterized.
+            if (csn->minTs || csn->maxTs || csn->resumeAfterRecordId || csn->requestResumeToken ||
+                csn->tailable || csn->shouldTrackLatestOplogTimestamp ||
+                csn->stopApplyingFilterAfterFirstMatch) {
+                return false;
+            }
+            *sb << "direction: " << csn->direction;
+            break;
+        }
+        case STAGE_IXSCAN: {
+            auto ixn = static_cast<const IndexScanNode*>(node);
+            *sb << "index: " << ixn->index.identifier.catalogName
+                << " direction: " << ixn->direction << " addKeyMetadata: " << ixn->addKeyMetadata
+                << " dedup: " << ixn->shouldDedup;
+            break;
+        }
+        case STAGE_OR:
+            *sb << "dedup: " << static_cast<const OrNode*>(node)->dedup;
+            break;
+        case STAGE_SORT_MERGE: {
+            auto msn = static_cast<const MergeSortNode*>(node);
+            *sb << "sort: " << msn->sort.toString() << " dedup: " << msn->dedup;
+            break;
+        }
+        case STAGE_SORT_DEFAULT:
+        case STAGE_SORT_SIMPLE: {
+            auto sn = static_cast<const SortNode*>(node);
+            *sb << "pattern: " << sn->pattern.toString() << " limit: " << sn->limit
+                << " addSortKeyMetadata: " << sn->addSortKeyMetadata;
+            break;
+        }
+        case STAGE_SORT_KEY_GENERATOR:
+            *sb << "sortSpec: " << static_cast<const SortKeyGeneratorNode*>(node)->sortSpec;
+            break;
+        case STAGE_LIMIT:
+            *sb << "limit: " << static_cast<const LimitNode*>(node)->limit;
+            break;
+        case STAGE_SKIP:
+            *sb << "skip: " << static_cast<const SkipNode*>(node)->skip;
+            break;
+        case STAGE_RETURN_KEY:
+            for (auto&& field : static_cast<const ReturnKeyNode*>(node)->sortKeyMetaFields) {
+                *sb << field.fullPath() << ' ';
+            }
+            break;
+        case STAGE_FETCH:
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_PROJECTION_DEFAULT:
+        case STAGE_PROJECTION_COVERED:
+        case STAGE_PROJECTION_SIMPLE:
+            // Projections are described by the query.
+            break;
+        default:
+            return false;
+    }
+
+    if (node->filter) {
+        appendFilter(*node->filter, sb, paramIds);
+    }
+
+    for (auto&& child : node->children) {
+        *sb << ' ';
+        if (!appendNode(child, sb, paramIds)) {
+            return false;
+        }
+    }
+
+    *sb << '}';
+    return true;
+}
+
+/**
+ * Collects the index scans of the subtree rooted at 'node', in pre-order.
+ */
+void collectIndexScans(const QuerySolutionNode* node, std::vector<const IndexScanNode*>* ixscans) {
+    if (node->getType() == STAGE_IXSCAN) {
+        ixscans->push_back(static_cast<const IndexScanNode*>(node));
+    }
+    for (auto&& child : node->children) {
+        collectIndexScans(child, ixscans);
+    }
+}
+
+/**
+ * Collects the ids of the input parameters used by the filters of the subtree rooted at 'node'.
+ */
+void collectFilterParams(const QuerySolutionNode* node, std::set<InputParamId>* paramIds) {
+    if (node->filter) {
+        auto params = expression::collectInputParams(node->filter.get());
+        for (size_t paramId = 0; paramId < params.size(); ++paramId) {
+            if (!params[paramId].eoo()) {
+                paramIds->insert(paramId);
+            }
+        }
+    }
+    for (auto&& child : node->children) {
+        collectFilterParams(child, paramIds);
+    }
+}
+
+stage_builder::PlanStageData copyPlanStageData(const stage_builder::PlanStageData& data) {
+    stage_builder::PlanStageData copy{data.env->makeDeepCopy()};
+    copy.resultSlot = data.resultSlot;
+    copy.recordIdSlot = data.recordIdSlot;
+    copy.oplogTsSlot = data.oplogTsSlot;
+    copy.shouldTrackLatestOplogTimestamp = data.shouldTrackLatestOplogTimestamp;
+    copy.shouldTrackResumeToken = data.shouldTrackResumeToken;
+    copy.shouldUseTailableScan = data.shouldUseTailableScan;
+    return copy;
+}
+
+/**
+ * Makes a cached plan from the plan built for 'solution', which must not have been prepared yet.
+ * Returns nullptr if some of the constants of 'solution' were not lowered into runtime
+ * environment slots.
+ */
+std::shared_ptr<const CachedSbePlan> makeCachedSbePlan(const QuerySolution& solution,
+                                                       std::string solutionSignature,
+                                                       const PlanStage& root,
+                                                       const stage_builder::PlanStageData& data) {
+    auto cachedPlan = std::make_shared<CachedSbePlan>(
+        root.clone(), copyPlanStageData(data), std::move(solutionSignature));
+    cachedPlan->root->attachToTrialRunTracker(nullptr);
+
+    // Every constant which can differ between queries of this shape must have been lowered into
+    // the runtime environment, otherwise the plan would keep the constants of this query.
+    std::set<InputParamId> paramIds;
+    collectFilterParams(solution.root(), &paramIds);
+    for (auto&& paramId : paramIds) {
+        auto slot = cachedPlan->data.env->getSlotIfExists(
+            stage_builder::makeInputParamSlotName(paramId));
+        if (!slot) {
+            return nullptr;
+        }
+        cachedPlan->inputParamSlots.emplace_back(paramId, *slot);
+    }
+
+    std::vector<const IndexScanNode*> ixscans;
+    collectIndexScans(solution.root(), &ixscans);
+    for (auto&& ixn : ixscans) {
+        auto slot = cachedPlan->data.env->getSlotIfExists(
+            stage_builder::makeIndexBoundsSlotName(ixn->nodeId()));
+        if (!slot) {
+            return nullptr;
+        }
+        cachedPlan->indexBoundsSlots.emplace_back(ixn->nodeId(), *slot);
+    }
+
+    // SBE stages do not report their sizes, so the tree and its runtime environment are accounted
+    // for by the length of their textual forms, which list every stage, expression and constant.
+    cachedPlan->estimatedSizeBytes = sizeof(CachedSbePlan) +
+        cachedPlan->solutionSignature.size() +
+        DebugPrinter{}.print(cachedPlan->root.get()).size() +
+        cachedPlan->data.debugString().size() +
+        cachedPlan->inputParamSlots.capacity() * sizeof(cachedPlan->inputParamSlots[0]) +
+        cachedPlan->indexBoundsSlots.capacity() * sizeof(cachedPlan->indexBoundsSlots[0]);
+
+    return cachedPlan;
+}
+
+/**
+ * Clones 'cachedPlan' and binds the clone to the input parameters of 'cq' and to the index bounds
+ * of 'solution', which must have the signature of the cached plan. Returns boost::none if the
+ * constants of the query cannot be bound to the cached plan.
+ */
+boost::optional<std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData>>
+bindCachedSbePlan(OperationContext* opCtx,
+                  const CollectionPtr& collection,
+                  const CanonicalQuery& cq,
+                  const QuerySolution& solution,
+                  const CachedSbePlan& cachedPlan,
+                  PlanYieldPolicySBE* yieldPolicy) {
+    auto data = copyPlanStageData(cachedPlan.data);
+
+    auto params = expression::collectInputParams(cq.root());
+    for (auto&& [paramId, slot] : cachedPlan.inputParamSlots) {
+        if (static_cast<size_t>(paramId) >= params.size() || params[paramId].eoo()) {
+            return boost::none;
+        }
+
+        const auto& elem = params[paramId];
+        auto [tagView, valView] = bson::convertFrom(
+            true, elem.rawdata(), elem.rawdata() + elem.size(), elem.fieldNameSize() - 1);
+        auto [tag, val] = value::copyValue(tagView, valView);
+        data.env->resetSlot(slot, tag, val, true);
+    }
+
+    std::vector<const IndexScanNode*> ixscans;
+    collectIndexScans(solution.root(), &ixscans);
+    if (ixscans.size() != cachedPlan.indexBoundsSlots.size()) {
+        return boost::none;
+    }
+    for (size_t i = 0; i < ixscans.size(); ++i) {
+        auto [nodeId, slot] = cachedPlan.indexBoundsSlots[i];
+        auto intervals = stage_builder::makeIndexScanIntervals(opCtx, collection, ixscans[i]);
+        if (ixscans[i]->nodeId() != nodeId || !intervals) {
+            return boost::none;
+        }
+        data.env->resetSlot(slot, intervals->first, intervals->second, true);
+    }
+
+    auto root = cachedPlan.root->clone();
+    root->attachNewYieldPolicy(yieldPolicy);
+    data.trialRunProgressTracker = std::make_unique<TrialRunProgressTracker>(
+        trial_period::getTrialPeriodNumToReturn(cq),
+        trial_period::getTrialPeriodMaxWorks(opCtx, collection));
+    root->attachToTrialRunTracker(data.trialRunProgressTracker.get());
+    yieldPolicy->registerPlan(root.get());
+
+    LOGV2_DEBUG(5300900,
+                5,
+                "Reusing cached SBE plan",
+                "query"_attr = redact(cq.toStringShort()),
+                "slots"_attr = data.debugString());
+    return std::make_pair(std::move(root), std::move(data));
+}
+}  // namespace
+
+boost::optional<std::string> computeSolutionSignature(const CanonicalQuery& cq,
+                                                      const QuerySolution& solution) {
+    const auto& qr = cq.getQueryRequest();
+    if (qr.isTailable()) {
+        return boost::none;
+    }
+
+    StringBuilder sb;
+    sb << "proj: " << qr.getProj().toString() << " sort: " << qr.getSort().toString()
+       << " collation: " << qr.getCollation().toString()
+       << " skip: " << qr.getSkip().value_or(0) << " limit: " << qr.getLimit().value_or(0)
+       << " ntoreturn: " << qr.getNToReturn().value_or(0) << " returnKey: " << qr.returnKey()
+       << " showRecordId: " << qr.showRecordId() << " allowDiskUse: " << qr.allowDiskUse()
+       << " plan: ";
+
+    std::vector<InputParamId> paramIds;
+    if (!appendNode(solution.root(), &sb, &paramIds)) {
+        return boost::none;
+    }
+    return sb.str();
+}
+
+std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData> buildCachedSbePlan(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const CanonicalQuery& cq,
+    const QuerySolution& solution,
+    const PlanCacheKey& planCacheKey,
+    const CachedSolution& cachedSolution,
+    PlanYieldPolicySBE* yieldPolicy) {
+    if (!internalQueryCacheSbePlans.load()) {
+        return stage_builder::buildSlotBasedExecutableTree(
+            opCtx, collection, cq, solution, yieldPolicy, true);
+    }
+
+    auto signature = computeSolutionSignature(cq, solution);
+    if (signature && cachedSolution.sbePlan &&
+        cachedSolution.sbePlan->solutionSignature == *signature) {
+        if (auto execTree = bindCachedSbePlan(
+                opCtx, collection, cq, solution, *cachedSolution.sbePlan, yieldPolicy)) {
+            cachedPlanHits.increment();
+            return std::move(*execTree);
+        }
+    }
+
+    // Only a plan which will be kept in the plan cache needs its index bounds to be rebindable.
+    cachedPlanMisses.increment();
+    auto execTree = stage_builder::buildSlotBasedExecutableTree(
+        opCtx, collection, cq, solution, yieldPolicy, true, signature.has_value());
+    if (signature) {
+        if (auto cachedPlan = makeCachedSbePlan(
+                solution, std::move(*signature), *execTree.first, execTree.second)) {
+            CollectionQueryInfo::get(collection)
+                .getPlanCache()
+                ->setSbePlan(planCacheKey, std::move(cachedPlan));
+        }
+    }
+    return execTree;
+}
+
+}  // namespace mongo::sbe
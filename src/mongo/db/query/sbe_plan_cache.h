@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_yield_policy_sbe.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+
+namespace mongo::sbe {
+
+/**
+ * The SBE plan built for the winning solution of a plan cache entry, kept along with the entry so
+ * that later queries of the same shape do not need to build it again. All the constants of the
+ * query which can differ between queries of the same shape are held in slots of the runtime
+ * environment of the plan:
+ *   - the input parameters of the filters, see expression_parameterization.h;
+ *   - the intervals scanned by each index scan.
+ *
+ * Neither the tree nor its runtime environment are ever prepared or executed. Each query clones
+ * them and binds the clone to its own constants.
+ */
+struct CachedSbePlan {
+    CachedSbePlan(std::unique_ptr<PlanStage> root,
+                  stage_builder::PlanStageData data,
+                  std::string solutionSignature)
+        : root(std::move(root)),
+          data(std::move(data)),
+          solutionSignature(std::move(solutionSignature)) {}
+
+    // The yield policy of the stages of this tree is that of the query the plan was built for,
+    // and is only used to tell whether the stage yields. Stages do not track trial run progress.
+    const std::unique_ptr<PlanStage> root;
+    const stage_builder::PlanStageData data;
+
+    // The signature of the solution the plan was built for. The plan can only be reused for a
+    // solution with the same signature.
+    const std::string solutionSignature;
+
+    // The runtime environment slots holding the values of the input parameters used by the plan.
+    std::vector<std::pair<InputParamId, value::SlotId>> inputParamSlots;
+
+    // The runtime environment slots holding the intervals scanned by each index scan of the plan,
+    // keyed by the node id of the IndexScanNode.
+    std::vector<std::pair<PlanNodeId, value::SlotId>> indexBoundsSlots;
+
+    // An estimate of the memory held by this plan in bytes, which is accounted for in the size of
+    // the plan cache entry keeping it.
+    uint64_t estimatedSizeBytes{0};
+};
+
+/**
+ * Returns a description of everything 'solution' and the query 'cq' it was planned for contribute
+ * to an SBE plan, except for the values of the input parameters of 'cq' and for the index bounds.
+ * Two solutions with the same signature are lowered to the same SBE plan, up to the values of the
+ * runtime environment slots holding these constants. Returns boost::none if 'solution' contains
+ * stages whose SBE plan cannot be rebound that way.
+ */
+boost::optional<std::string> computeSolutionSignature(const CanonicalQuery& cq,
+                                                      const QuerySolution& solution);
+
+/**
+ * Builds the SBE plan of 'solution', which was planned from 'cachedSolution', the active entry of
+ * the plan cache for 'planCacheKey'. If the entry holds an SBE plan built for a solution with the
+ * same signature, that plan is cloned and bound to the constants of 'cq' and 'solution' instead.
+ * Otherwise the plan is built from 'solution' and kept in the plan cache entry for the next queries
+ * of the same shape.
+ *
+ * The plan yields according to 'yieldPolicy' and reports its progress to the trial run progress
+ * tracker of the returned PlanStageData.
+ */
+std::pair<std::unique_ptr<PlanStage>, stage_builder::PlanStageData> buildCachedSbePlan(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const CanonicalQuery& cq,
+    const QuerySolution& solution,
+    const PlanCacheKey& planCacheKey,
+    const CachedSolution& cachedSolution,
+    PlanYieldPolicySBE* yieldPolicy);
+
+}  // namespace mongo::sbe
@@ -45,6 +45,10 @@ struct CandidatePlans {
     std::vector<plan_ranker::CandidatePlan> plans;
     size_t winnerIdx;
 
+    // Set if the winning plan was drawn from the plan cache and kept after its trial period, to
+    // the number of physical reads it took to decide on this plan when it was first cached.
+    boost::optional<size_t> cachedPlanDecisionReads;
+
     auto& winner() {
         invariant(winnerIdx < plans.size());
         return plans[winnerIdx];
@@ -35,9 +35,11 @@
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
 #include "mongo/db/exec/sbe/stages/loop_join.h"
 #include "mongo/db/exec/sbe/stages/makeobj.h"
+#include "mongo/db/exec/sbe/stages/merge_join.h"
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/sort.h"
@@ -50,8 +52,11 @@
 #include "mongo/db/fts/fts_query_impl.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/fts_access_method.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
+#include "mongo/db/query/sbe_stage_builder_expression.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/sbe_stage_builder_index_scan.h"
 #include "mongo/db/query/sbe_stage_builder_projection.h"
 #include "mongo/db/query/util/make_data_structure.h"
@@ -70,9 +75,71 @@ std::unique_ptr<sbe::RuntimeEnvironment> makeRuntimeEnvironment(
     return env;
 }
 
+namespace {
+// The accumulators of a $group stage which are lowered to aggregate functions of a HashAggStage.
+const std::set<StringData> kSbeGroupAccumulators{"$addToSet"_sd,
+                                                 "$avg"_sd,
+                                                 "$first"_sd,
+                                                 "$last"_sd,
+                                                 "$max"_sd,
+                                                 "$min"_sd,
+                                                 "$push"_sd,
+                                                 "$sum"_sd};
+
+// The output document and a compound group key are built by a single 'newObj' call, which takes
+// a name and a value argument for each field.
+constexpr size_t kMaxNewObjFields = std::numeric_limits<uint8_t>::max() / 2;
+
+/**
+ * Returns true if 'expr', the group key or the argument of an accumulator of a $group stage, is
+ * a constant or a path of the input document.
+ */
+bool isSupportedGroupOperand(const Expression* expr) {
+    if (dynamic_cast<const ExpressionConstant*>(expr)) {
+        return true;
+    }
+    auto fieldPath = dynamic_cast<const ExpressionFieldPath*>(expr);
+    return fieldPath && fieldPath->isRootFieldPath();
+}
+}  // namespace
+
+bool isGroupSupportedBySbe(const Expression* groupByExpression,
+                           const std::vector<AccumulationStatement>& accumulators) {
+    if (auto idObject = dynamic_cast<const ExpressionObject*>(groupByExpression)) {
+        const auto& idFields = idObject->getChildExpressions();
+        if (idFields.size() > kMaxNewObjFields ||
+            !std::all_of(idFields.begin(), idFields.end(), [](auto&& field) {
+                return isSupportedGroupOperand(field.second.get());
+            })) {
+            return false;
+        }
+    } else if (!isSupportedGroupOperand(groupByExpression)) {
+        return false;
+    }
+
+    return accumulators.size() < kMaxNewObjFields &&
+        std::all_of(accumulators.begin(), accumulators.end(), [](auto&& acc) {
+               return kSbeGroupAccumulators.count(acc.makeAccumulator()->getOpName()) &&
+                   isSupportedGroupOperand(acc.expr.argument.get());
+           });
+}
+
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildCollScan(
     const QuerySolutionNode* root) {
     auto csn = static_cast<const CollectionScanNode*>(root);
+
+    // The scan may only be split across threads if the query cannot observe the order in which it
+    // returns documents.
+    const size_t degreeOfParallelism = [&]() {
+        const auto& qr = _cq.getQueryRequest();
+        if (qr.getLimit() || qr.getSkip() || qr.getNToReturn() || qr.isTailable() ||
+            qr.getSort().hasField(QueryRequest::kNaturalSortField) ||
+            qr.getHint().hasField(QueryRequest::kNaturalSortField)) {
+            return 1;
+        }
+        return internalQuerySlotBasedExecutionParallelScanDegree.load();
+    }();
+
     auto [resultSlot, recordIdSlot, oplogTsSlot, stage] =
         generateCollScan(_opCtx,
                          _collection,
@@ -82,7 +149,9 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildCollScan(
                          _yieldPolicy,
                          _data.env,
                          _isTailableCollScanResumeBranch,
-                         _data.trialRunProgressTracker.get());
+                         _data.trialRunProgressTracker.get(),
+                         degreeOfParallelism,
+                         internalQuerySlotBasedExecutionBlockSize.load());
     _data.resultSlot = resultSlot;
     _data.recordIdSlot = recordIdSlot;
     _data.oplogTsSlot = oplogTsSlot;
@@ -113,7 +182,10 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildIndexScan(
                           &_slotIdGenerator,
                           &_spoolIdGenerator,
                           _yieldPolicy,
-                          _data.trialRunProgressTracker.get());
+                          _data.trialRunProgressTracker.get(),
+                          &_frameIdGenerator,
+                          _data.env,
+                          _parameterizeIndexBounds);
 
     _data.recordIdSlot = recordIdSlot;
 
@@ -764,9 +836,235 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildEof(const QuerySolut
         sbe::makeS<sbe::CoScanStage>(root->nodeId()), 0, boost::none, root->nodeId());
 }
 
+std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildIndexIntersection(
+    const QuerySolutionNode* root) {
+    uassert(5300500, "Index intersection with returnKey is not supported in SBE", !_returnKeySlot);
+    invariant(root->children.size() >= 2);
+
+    // Translate each child and join it with the intersection of the previous children on the
+    // recordId. For AND_HASH, just like the classic stage, the previous children are loaded into a
+    // hash table which is then probed with the rows of the next child. The children of AND_SORTED
+    // all return their rows in recordId order, so they are intersected with streaming merge joins
+    // which don't need to hold the intersection in memory. Children which fetch the document
+    // produce a 'resultSlot', and the last one of them is propagated.
+    const bool isSorted = root->getType() == STAGE_AND_SORTED;
+    _data.resultSlot = boost::none;
+    auto stage = build(root->children[0]);
+    invariant(_data.recordIdSlot);
+    auto recordIdSlot = *_data.recordIdSlot;
+    auto resultSlot = _data.resultSlot;
+
+    for (size_t idx = 1; idx < root->children.size(); ++idx) {
+        _data.resultSlot = boost::none;
+        auto innerStage = build(root->children[idx]);
+        invariant(_data.recordIdSlot);
+        auto innerRecordIdSlot = *_data.recordIdSlot;
+        auto innerResultSlot = _data.resultSlot;
+
+        if (isSorted) {
+            stage = sbe::makeS<sbe::MergeJoinStage>(
+                std::move(stage),
+                std::move(innerStage),
+                sbe::makeSV(recordIdSlot),
+                resultSlot ? sbe::makeSV(*resultSlot) : sbe::makeSV(),
+                sbe::makeSV(innerRecordIdSlot),
+                innerResultSlot ? sbe::makeSV(*innerResultSlot) : sbe::makeSV(),
+                std::vector<sbe::value::SortDirection>{sbe::value::SortDirection::Ascending},
+                root->nodeId());
+        } else {
+            stage = sbe::makeS<sbe::HashJoinStage>(
+                std::move(stage),
+                std::move(innerStage),
+                sbe::makeSV(recordIdSlot),
+                resultSlot ? sbe::makeSV(*resultSlot) : sbe::makeSV(),
+                sbe::makeSV(innerRecordIdSlot),
+                innerResultSlot ? sbe::makeSV(*innerResultSlot) : sbe::makeSV(),
+                static_cast<size_t>(internalQuerySlotBasedExecutionHashJoinMaxMemoryBytes.load()),
+                _cq.getExpCtx()->allowDiskUse,
+                root->nodeId());
+        }
+
+        recordIdSlot = innerRecordIdSlot;
+        if (innerResultSlot) {
+            resultSlot = innerResultSlot;
+        }
+    }
+
+    _data.recordIdSlot = recordIdSlot;
+    _data.resultSlot = resultSlot;
+
+    if (root->filter) {
+        uassert(5300501, "Index intersection filter requires a fetched document", resultSlot);
+        auto relevantSlots = sbe::makeSV(*_data.resultSlot, *_data.recordIdSlot);
+        stage = generateFilter(_opCtx,
+                               root->filter.get(),
+                               std::move(stage),
+                               &_slotIdGenerator,
+                               &_frameIdGenerator,
+                               *_data.resultSlot,
+                               _data.env,
+                               std::move(relevantSlots),
+                               root->nodeId());
+    }
+
+    return stage;
+}
+
+std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::buildGroup(const QuerySolutionNode* root) {
+    using namespace std::literals;
+
+    auto gn = static_cast<const GroupNode*>(root);
+    uassert(5301800,
+            "Group with unsupported group key or accumulators is not supported in SBE",
+            isGroupSupportedBySbe(gn->groupByExpression.get(), gn->accumulators));
+    uassert(5301801, "Group with returnKey is not supported in SBE", !_returnKeySlot);
+
+    auto inputStage = build(gn->children[0]);
+    invariant(_data.resultSlot);
+
+    // Evaluates 'expr' over the input document into a new slot. The slots evaluated so far are
+    // forwarded by the stages evaluating the next ones.
+    auto relevantSlots = sbe::makeSV(*_data.resultSlot);
+    auto projectExpression = [&](Expression* expr) {
+        auto [slot, sbeExpr, stage] = generateExpression(_opCtx,
+                                                         expr,
+                                                         std::move(inputStage),
+                                                         &_slotIdGenerator,
+                                                         &_frameIdGenerator,
+                                                         *_data.resultSlot,
+                                                         _data.env,
+                                                         root->nodeId(),
+                                                         &relevantSlots);
+        inputStage =
+            sbe::makeProjectStage(std::move(stage), root->nodeId(), slot, std::move(sbeExpr));
+        relevantSlots.push_back(slot);
+        return slot;
+    };
+    auto makeNull = [] { return sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::Null, 0); };
+    auto makeNothing = [] { return sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::Nothing, 0); };
+    auto makeFillEmpty = [](std::unique_ptr<sbe::EExpression> expr,
+                            std::unique_ptr<sbe::EExpression> fill) {
+        return sbe::makeE<sbe::EFunction>("fillEmpty"sv,
+                                          sbe::makeEs(std::move(expr), std::move(fill)));
+    };
+
+    // The group key. A compound key is made up as an object by hand, since $object expressions are
+    // not supported in SBE. Like in a $group, its missing fields are left out, whereas a missing
+    // single key is null.
+    auto keySlot = _slotIdGenerator.generate();
+    std::unique_ptr<sbe::EExpression> keyExpr;
+    if (auto idObject = dynamic_cast<ExpressionObject*>(gn->groupByExpression.get())) {
+        std::vector<std::unique_ptr<sbe::EExpression>> newObjArgs;
+        for (auto&& [fieldName, fieldExpr] : idObject->getChildExpressions()) {
+            auto fieldSlot = projectExpression(fieldExpr.get());
+            newObjArgs.push_back(sbe::makeE<sbe::EConstant>(fieldName));
+            newObjArgs.push_back(sbe::makeE<sbe::EVariable>(fieldSlot));
+        }
+        keyExpr = sbe::makeE<sbe::EFunction>("newObj"sv, std::move(newObjArgs));
+    } else {
+        keyExpr = makeFillEmpty(
+            sbe::makeE<sbe::EVariable>(projectExpression(gn->groupByExpression.get())), makeNull());
+    }
+    inputStage =
+        sbe::makeProjectStage(std::move(inputStage), root->nodeId(), keySlot, std::move(keyExpr));
+
+    // Each accumulator is lowered to one or two aggregate functions, with their input arranged for
+    // the aggregate function to skip the values the accumulator ignores, and to an expression
+    // computing the value of the accumulator from the aggregated values of a group.
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs;
+    auto addAgg = [&](std::string_view function, std::unique_ptr<sbe::EExpression> input) {
+        auto aggSlot = _slotIdGenerator.generate();
+        aggs.emplace(aggSlot, sbe::makeE<sbe::EFunction>(function, sbe::makeEs(std::move(input))));
+        return aggSlot;
+    };
+    std::vector<std::unique_ptr<sbe::EExpression>> outputArgs;
+    outputArgs.push_back(sbe::makeE<sbe::EConstant>("_id"sv));
+    outputArgs.push_back(sbe::makeE<sbe::EVariable>(keySlot));
+    for (auto&& acc : gn->accumulators) {
+        const sbe::EVariable arg{projectExpression(acc.expr.argument.get())};
+        auto numericArgOrNothing = [&] {
+            return sbe::makeE<sbe::EIf>(
+                sbe::makeE<sbe::EFunction>("isNumber"sv, sbe::makeEs(arg.clone())),
+                arg.clone(),
+                makeNothing());
+        };
+
+        const StringData opName = acc.makeAccumulator()->getOpName();
+        std::unique_ptr<sbe::EExpression> output;
+        // Sums are compensated, and promoted to a wider type on overflow, as by AccumulatorSum.
+        auto sumOf = [](sbe::value::SlotId aggSlot) {
+            return sbe::makeE<sbe::EFunction>(
+                "doubleDoubleSumFinalize"sv, sbe::makeEs(sbe::makeE<sbe::EVariable>(aggSlot)));
+        };
+        if (opName == "$sum"_sd) {
+            // The sum of no numbers is the integer zero.
+            output = makeFillEmpty(sumOf(addAgg("aggDoubleDoubleSum"sv, numericArgOrNothing())),
+                                   sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::NumberInt32,
+                                                              sbe::value::bitcastFrom<int32_t>(0)));
+        } else if (opName == "$avg"_sd) {
+            auto sumSlot = addAgg("aggDoubleDoubleSum"sv, numericArgOrNothing());
+            auto countSlot = addAgg(
+                "sum"sv,
+                sbe::makeE<sbe::EIf>(
+                    sbe::makeE<sbe::EFunction>("isNumber"sv, sbe::makeEs(arg.clone())),
+                    sbe::makeE<sbe::EConstant>(sbe::value::TypeTags::NumberInt64,
+                                               sbe::value::bitcastFrom<int64_t>(1)),
+                    makeNothing()));
+            // The average of no numbers is null.
+            output = sbe::makeE<sbe::EIf>(
+                sbe::makeE<sbe::EFunction>("exists"sv,
+                                           sbe::makeEs(sbe::makeE<sbe::EVariable>(countSlot))),
+                sbe::makeE<sbe::EPrimBinary>(sbe::EPrimBinary::div,
+                                             sumOf(sumSlot),
+                                             sbe::makeE<sbe::EVariable>(countSlot)),
+                makeNull());
+        } else if (opName == "$min"_sd || opName == "$max"_sd) {
+            // Null and missing values are ignored, and the result is null if there are only such.
+            auto input =
+                sbe::makeE<sbe::EIf>(generateNullOrMissing(arg), makeNothing(), arg.clone());
+            output = makeFillEmpty(
+                sbe::makeE<sbe::EVariable>(addAgg(opName == "$min"_sd ? "min"sv : "max"sv,
+                                                  std::move(input))),
+                makeNull());
+        } else if (opName == "$first"_sd || opName == "$last"_sd) {
+            // A missing value is kept as null, rather than skipped.
+            output = sbe::makeE<sbe::EVariable>(addAgg(opName == "$first"_sd ? "first"sv : "last"sv,
+                                                       makeFillEmpty(arg.clone(), makeNull())));
+        } else if (opName == "$push"_sd || opName == "$addToSet"_sd) {
+            // The arrays ignore missing values.
+            output = sbe::makeE<sbe::EVariable>(
+                addAgg(opName == "$push"_sd ? "addToArray"sv : "addToSet"sv, arg.clone()));
+        } else {
+            MONGO_UNREACHABLE;
+        }
+
+        outputArgs.push_back(sbe::makeE<sbe::EConstant>(acc.fieldName));
+        outputArgs.push_back(std::move(output));
+    }
+
+    auto stage =
+        sbe::makeS<sbe::HashAggStage>(std::move(inputStage),
+                                      sbe::makeSV(keySlot),
+                                      std::move(aggs),
+                                      internalQuerySlotBasedExecutionHashAggMaxMemoryBytes.load(),
+                                      _cq.getExpCtx()->allowDiskUse,
+                                      _data.trialRunProgressTracker.get(),
+                                      root->nodeId());
+
+    // The documents returned are those of the groups, which are not records of the collection.
+    _data.resultSlot = _slotIdGenerator.generate();
+    _data.recordIdSlot = boost::none;
+    return sbe::makeProjectStage(std::move(stage),
+                                 root->nodeId(),
+                                 *_data.resultSlot,
+                                 sbe::makeE<sbe::EFunction>("newObj"sv, std::move(outputArgs)));
+}
+
 // Returns a non-null pointer to the root of a plan tree, or a non-OK status if the PlanStage tree
 // could not be constructed.
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolutionNode* root) {
+    // COUNT_SCAN and DISTINCT_SCAN have no translation: the count and distinct commands, which are
+    // the only producers of these nodes, always build classic executors.
     static const stdx::unordered_map<StageType,
                                      std::function<std::unique_ptr<sbe::PlanStage>(
                                          SlotBasedStageBuilder&, const QuerySolutionNode* root)>>
@@ -786,7 +1084,10 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolution
             {STAGE_TEXT, &SlotBasedStageBuilder::buildText},
             {STAGE_RETURN_KEY, &SlotBasedStageBuilder::buildReturnKey},
             {STAGE_EOF, &SlotBasedStageBuilder::buildEof},
-            {STAGE_SORT_MERGE, &SlotBasedStageBuilder::buildSortMerge}};
+            {STAGE_SORT_MERGE, &SlotBasedStageBuilder::buildSortMerge},
+            {STAGE_AND_HASH, &SlotBasedStageBuilder::buildIndexIntersection},
+            {STAGE_AND_SORTED, &SlotBasedStageBuilder::buildIndexIntersection},
+            {STAGE_GROUP, &SlotBasedStageBuilder::buildGroup}};
 
     uassert(4822884,
             str::stream() << "Can't build exec tree for node: " << root->toString(),
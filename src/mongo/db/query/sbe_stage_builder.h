@@ -45,6 +45,13 @@ namespace mongo::stage_builder {
 std::unique_ptr<sbe::RuntimeEnvironment> makeRuntimeEnvironment(
     OperationContext* opCtx, sbe::value::SlotIdGenerator* slotIdGenerator);
 
+/**
+ * Returns true if a $group stage grouping by 'groupByExpression' and computing 'accumulators' can
+ * be executed by the slot-based execution engine, once pushed down into the query as a GroupNode.
+ */
+bool isGroupSupportedBySbe(const Expression* groupByExpression,
+                           const std::vector<AccumulationStatement>& accumulators);
+
 /**
  * Some auxiliary data returned by a 'SlotBasedStageBuilder' along with a PlanStage tree root, which
  * is needed to execute the PlanStage tree.
@@ -93,8 +100,11 @@ public:
                           const CanonicalQuery& cq,
                           const QuerySolution& solution,
                           PlanYieldPolicySBE* yieldPolicy,
-                          bool needsTrialRunProgressTracker)
-        : StageBuilder(opCtx, collection, cq, solution), _yieldPolicy(yieldPolicy) {
+                          bool needsTrialRunProgressTracker,
+                          bool parameterizeIndexBounds = false)
+        : StageBuilder(opCtx, collection, cq, solution),
+          _yieldPolicy(yieldPolicy),
+          _parameterizeIndexBounds(parameterizeIndexBounds) {
         if (needsTrialRunProgressTracker) {
             const auto maxNumResults{trial_period::getTrialPeriodNumToReturn(_cq)};
             const auto maxNumReads{trial_period::getTrialPeriodMaxWorks(_opCtx, _collection)};
@@ -125,6 +135,8 @@ private:
     std::unique_ptr<sbe::PlanStage> buildText(const QuerySolutionNode* root);
     std::unique_ptr<sbe::PlanStage> buildReturnKey(const QuerySolutionNode* root);
     std::unique_ptr<sbe::PlanStage> buildEof(const QuerySolutionNode* root);
+    std::unique_ptr<sbe::PlanStage> buildIndexIntersection(const QuerySolutionNode* root);
+    std::unique_ptr<sbe::PlanStage> buildGroup(const QuerySolutionNode* root);
 
     std::unique_ptr<sbe::PlanStage> makeLoopJoinForFetch(
         std::unique_ptr<sbe::PlanStage> inputStage,
@@ -163,6 +175,10 @@ private:
 
     PlanYieldPolicySBE* const _yieldPolicy;
 
+    // Whether index scans read their bounds from runtime environment slots, so that the plan can be
+    // kept in the plan cache and rebound to the bounds of later queries of the same shape.
+    const bool _parameterizeIndexBounds;
+
     // Apart from generating just an execution tree, this builder will also produce some auxiliary
     // data which is needed to execute the tree, such as a result slot, or a recordId slot.
     PlanStageData _data{makeRuntimeEnvironment(_opCtx, &_slotIdGenerator)};
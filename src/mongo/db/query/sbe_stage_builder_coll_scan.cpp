@@ -34,6 +34,7 @@
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/sbe/stages/block.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
 #include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
@@ -42,9 +43,13 @@
 #include "mongo/db/exec/sbe/stages/project.h"
 #include "mongo/db/exec/sbe/stages/scan.h"
 #include "mongo/db/exec/sbe/stages/union.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/matcher/expression_leaf.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
 
@@ -99,6 +104,181 @@ makeOplogTimestampSlotsIfNeeded(const CollectionPtr& collection,
     return {};
 };
 
+/**
+ * Returns true if 'expr' can be evaluated a block at a time by 'generateBlockFilterExpr()', which
+ * is the case for the comparisons of a top-level field with a number, and for the $and, $or and
+ * $not of such comparisons.
+ */
+bool canFilterBlockAtATime(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            auto cmp = static_cast<const ComparisonMatchExpression*>(expr);
+            // The block builtins compare with a constant, so a parameterized value, which the plan
+            // cache may rebind to a value of another type, cannot be used.
+            return !cmp->getInputParamId() && !cmp->path().empty() &&
+                cmp->path().find('.') == std::string::npos && cmp->getData().isNumber();
+        }
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+            if (expr->numChildren() == 0) {
+                return false;
+            }
+            for (size_t idx = 0; idx < expr->numChildren(); ++idx) {
+                if (!canFilterBlockAtATime(expr->getChild(idx))) {
+                    return false;
+                }
+            }
+            return true;
+        case MatchExpression::NOT:
+            return canFilterBlockAtATime(expr->getChild(0));
+        default:
+            return false;
+    }
+}
+
+/**
+ * Appends the top-level fields compared by 'expr' to 'fields', skipping those already there.
+ */
+void collectBlockFilterFields(const MatchExpression* expr, std::vector<std::string>* fields) {
+    if (expr->numChildren() == 0) {
+        auto path = expr->path().toString();
+        if (std::find(fields->begin(), fields->end(), path) == fields->end()) {
+            fields->push_back(std::move(path));
+        }
+        return;
+    }
+    for (size_t idx = 0; idx < expr->numChildren(); ++idx) {
+        collectBlockFilterFields(expr->getChild(idx), fields);
+    }
+}
+
+/**
+ * Translates 'expr', for which 'canFilterBlockAtATime()' holds, into an expression over the blocks
+ * of the compared fields, which are held in the 'fieldBlockSlots' at the same position as the field
+ * in 'fields'. The expression produces a block of booleans holding whether each row matches.
+ */
+std::unique_ptr<sbe::EExpression> generateBlockFilterExpr(
+    const MatchExpression* expr,
+    const std::vector<std::string>& fields,
+    const sbe::value::SlotVector& fieldBlockSlots) {
+    const auto combineChildren = [&](const char* builtin) {
+        auto result = generateBlockFilterExpr(expr->getChild(0), fields, fieldBlockSlots);
+        for (size_t idx = 1; idx < expr->numChildren(); ++idx) {
+            result = sbe::makeE<sbe::EFunction>(
+                builtin,
+                sbe::makeEs(
+                    std::move(result),
+                    generateBlockFilterExpr(expr->getChild(idx), fields, fieldBlockSlots)));
+        }
+        return result;
+    };
+
+    const auto builtin = [&]() -> const char* {
+        switch (expr->matchType()) {
+            case MatchExpression::EQ:
+                return "valueBlockMatchEq";
+            case MatchExpression::LT:
+                return "valueBlockMatchLt";
+            case MatchExpression::LTE:
+                return "valueBlockMatchLte";
+            case MatchExpression::GT:
+                return "valueBlockMatchGt";
+            case MatchExpression::GTE:
+                return "valueBlockMatchGte";
+            case MatchExpression::AND:
+                return "valueBlockLogicalAnd";
+            case MatchExpression::OR:
+                return "valueBlockLogicalOr";
+            case MatchExpression::NOT:
+                return "valueBlockLogicalNot";
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }();
+
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+        case MatchExpression::OR:
+            return combineChildren(builtin);
+        case MatchExpression::NOT:
+            return sbe::makeE<sbe::EFunction>(
+                builtin,
+                sbe::makeEs(generateBlockFilterExpr(expr->getChild(0), fields, fieldBlockSlots)));
+        default:
+            break;
+    }
+
+    auto cmp = static_cast<const ComparisonMatchExpression*>(expr);
+    const auto fieldPos =
+        std::find(fields.begin(), fields.end(), cmp->path().toString()) - fields.begin();
+    const auto& rhs = cmp->getData();
+    auto [tagView, valView] = sbe::bson::convertFrom(
+        true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
+    // SBE EConstant assumes ownership of the value so we have to make a copy here.
+    auto [tag, val] = sbe::value::copyValue(tagView, valView);
+    return sbe::makeE<sbe::EFunction>(
+        builtin,
+        sbe::makeEs(sbe::makeE<sbe::EVariable>(fieldBlockSlots[fieldPos]),
+                    sbe::makeE<sbe::EConstant>(tag, val)));
+}
+
+/**
+ * Applies 'filter' to the rows of 'stage' a block of 'blockSize' rows at a time, where the scan
+ * underneath 'stage' exposes the values of the compared 'fields' in 'fieldSlots':
+ *
+ *   unblock [resultSlotOut, recordIdSlotOut] [resultBlock, recordIdBlock] selectionBlock
+ *   project [selectionBlock = <filter over fieldBlocks>]
+ *   block blockSize [resultBlock, recordIdBlock, fieldBlocks...]
+ *                   [resultSlot, recordIdSlot, fieldSlots...]
+ *   stage
+ *
+ * Returns the slots holding the document and the RecordId of the matching rows, and the sub-tree.
+ */
+std::tuple<sbe::value::SlotId, sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
+generateBlockFilter(const MatchExpression* filter,
+                    std::unique_ptr<sbe::PlanStage> stage,
+                    sbe::value::SlotIdGenerator* slotIdGenerator,
+                    sbe::value::SlotId resultSlot,
+                    sbe::value::SlotId recordIdSlot,
+                    const std::vector<std::string>& fields,
+                    const sbe::value::SlotVector& fieldSlots,
+                    size_t blockSize,
+                    PlanNodeId planNodeId) {
+    auto resultBlockSlot = slotIdGenerator->generate();
+    auto recordIdBlockSlot = slotIdGenerator->generate();
+    sbe::value::SlotVector fieldBlockSlots;
+    for (size_t idx = 0; idx < fieldSlots.size(); ++idx) {
+        fieldBlockSlots.push_back(slotIdGenerator->generate());
+    }
+
+    auto inSlots = sbe::makeSV(resultSlot, recordIdSlot);
+    inSlots.insert(inSlots.end(), fieldSlots.begin(), fieldSlots.end());
+    auto outSlots = sbe::makeSV(resultBlockSlot, recordIdBlockSlot);
+    outSlots.insert(outSlots.end(), fieldBlockSlots.begin(), fieldBlockSlots.end());
+    stage = sbe::makeS<sbe::BlockStage>(
+        std::move(stage), std::move(inSlots), std::move(outSlots), blockSize, planNodeId);
+
+    auto selectionSlot = slotIdGenerator->generate();
+    stage = sbe::makeProjectStage(std::move(stage),
+                                  planNodeId,
+                                  selectionSlot,
+                                  generateBlockFilterExpr(filter, fields, fieldBlockSlots));
+
+    auto resultSlotOut = slotIdGenerator->generate();
+    auto recordIdSlotOut = slotIdGenerator->generate();
+    stage = sbe::makeS<sbe::UnblockStage>(std::move(stage),
+                                          sbe::makeSV(resultBlockSlot, recordIdBlockSlot),
+                                          sbe::makeSV(resultSlotOut, recordIdSlotOut),
+                                          selectionSlot,
+                                          planNodeId);
+
+    return {resultSlotOut, recordIdSlotOut, std::move(stage)};
+}
+
 /**
  * Creates a collection scan sub-tree optimized for oplog scans. We can built an optimized scan
  * when there is a predicted on the 'ts' field of the oplog collection.
@@ -309,7 +489,8 @@ generateGenericCollScan(OperationContext* opCtx,
                         PlanYieldPolicy* yieldPolicy,
                         sbe::RuntimeEnvironment* env,
                         bool isTailableResumeBranch,
-                        TrialRunProgressTracker* tracker) {
+                        TrialRunProgressTracker* tracker,
+                        size_t blockSize) {
     const auto forward = csn->direction == CollectionScanParams::FORWARD;
 
     invariant(!csn->shouldTrackLatestOplogTimestamp || collection->ns().isOplog());
@@ -333,6 +514,21 @@ generateGenericCollScan(OperationContext* opCtx,
     auto&& [fields, slots, tsSlot] = makeOplogTimestampSlotsIfNeeded(
         collection, slotIdGenerator, csn->shouldTrackLatestOplogTimestamp);
 
+    // A block is only handed to the stages above once it is full, so the filter is not evaluated a
+    // block at a time when the scan has to report the position it has reached, or when it resumes.
+    const bool filterBlockAtATime = blockSize > 0 && csn->filter && !tsSlot && !seekRecordIdSlot &&
+        !csn->tailable && !csn->requestResumeToken && canFilterBlockAtATime(csn->filter.get());
+    std::vector<std::string> blockFilterFields;
+    sbe::value::SlotVector blockFilterFieldSlots;
+    if (filterBlockAtATime) {
+        collectBlockFilterFields(csn->filter.get(), &blockFilterFields);
+        for (size_t idx = 0; idx < blockFilterFields.size(); ++idx) {
+            blockFilterFieldSlots.push_back(slotIdGenerator->generate());
+        }
+        fields = blockFilterFields;
+        slots = blockFilterFieldSlots;
+    }
+
     NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
     auto stage = sbe::makeS<sbe::ScanStage>(nss,
                                             resultSlot,
@@ -419,7 +615,19 @@ generateGenericCollScan(OperationContext* opCtx,
             csn->nodeId());
     }
 
-    if (csn->filter) {
+    if (filterBlockAtATime) {
+        invariant(!csn->stopApplyingFilterAfterFirstMatch);
+
+        std::tie(resultSlot, recordIdSlot, stage) = generateBlockFilter(csn->filter.get(),
+                                                                       std::move(stage),
+                                                                       slotIdGenerator,
+                                                                       resultSlot,
+                                                                       recordIdSlot,
+                                                                       blockFilterFields,
+                                                                       blockFilterFieldSlots,
+                                                                       blockSize,
+                                                                       csn->nodeId());
+    } else if (csn->filter) {
         // The 'stopApplyingFilterAfterFirstMatch' optimization is only applicable when the 'ts'
         // lower bound is also provided for an oplog scan, and is handled in
         // 'generateOptimizedOplogScan()'.
@@ -443,6 +651,97 @@ generateGenericCollScan(OperationContext* opCtx,
 
     return {resultSlot, recordIdSlot, tsSlot, std::move(stage)};
 }
+
+/**
+ * Returns true if the collection scan described by 'csn' can be split into RecordId ranges scanned
+ * concurrently, which is only possible for a plain forward scan over a large enough collection.
+ *
+ * The producers read through recovery units of their own, so the scan must not be part of a
+ * multi-document transaction, and must not ask for a read concern other than "local" or for a
+ * point in time that their snapshots could not honor. They also open the collection lock-free,
+ * which is only supported when lock-free reads are enabled.
+ */
+bool canScanInParallel(OperationContext* opCtx,
+                       const CollectionPtr& collection,
+                       const CollectionScanNode* csn,
+                       bool isTailableResumeBranch,
+                       TrialRunProgressTracker* tracker) {
+    // A trial run needs the work done by the scan to be accounted for on the calling thread.
+    if (tracker || isTailableResumeBranch || csn->tailable) {
+        return false;
+    }
+    if (opCtx->inMultiDocumentTransaction() || opCtx->getClient()->isInDirectClient() ||
+        storageGlobalParams.disableLockFreeReads) {
+        return false;
+    }
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    if (readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsAtClusterTime() || readConcernArgs.getArgsAfterClusterTime() ||
+        readConcernArgs.getArgsOpTime()) {
+        return false;
+    }
+    if (csn->direction != CollectionScanParams::FORWARD || csn->minTs || csn->maxTs ||
+        csn->resumeAfterRecordId || csn->requestResumeToken ||
+        csn->shouldTrackLatestOplogTimestamp || collection->ns().isOplog()) {
+        return false;
+    }
+    return collection->getRecordStore()->numRecords(opCtx) >=
+        2 * sbe::ParallelScanStage::kRecordsPerRange;
+}
+
+/**
+ * Generates a collection scan over RecordId ranges which 'degreeOfParallelism' producer threads
+ * claim from a list shared between them. Each producer applies the filter to the records of its
+ * ranges, and an exchange gathers their results in no particular order.
+ */
+std::tuple<sbe::value::SlotId,
+           sbe::value::SlotId,
+           boost::optional<sbe::value::SlotId>,
+           std::unique_ptr<sbe::PlanStage>>
+generateParallelCollScan(OperationContext* opCtx,
+                         const CollectionPtr& collection,
+                         const CollectionScanNode* csn,
+                         sbe::value::SlotIdGenerator* slotIdGenerator,
+                         sbe::value::FrameIdGenerator* frameIdGenerator,
+                         sbe::RuntimeEnvironment* env,
+                         size_t degreeOfParallelism) {
+    auto resultSlot = slotIdGenerator->generate();
+    auto recordIdSlot = slotIdGenerator->generate();
+
+    // The producers run under operation contexts of their own, so they must not use the yield
+    // policy of the calling thread.
+    NamespaceStringOrUUID nss{collection->ns().db().toString(), collection->uuid()};
+    std::unique_ptr<sbe::PlanStage> stage =
+        sbe::makeS<sbe::ParallelScanStage>(nss,
+                                           resultSlot,
+                                           recordIdSlot,
+                                           std::vector<std::string>{},
+                                           sbe::makeSV(),
+                                           nullptr,
+                                           csn->nodeId());
+
+    if (csn->filter) {
+        stage = generateFilter(opCtx,
+                               csn->filter.get(),
+                               std::move(stage),
+                               slotIdGenerator,
+                               frameIdGenerator,
+                               resultSlot,
+                               env,
+                               sbe::makeSV(resultSlot, recordIdSlot),
+                               csn->nodeId());
+    }
+
+    stage = sbe::makeS<sbe::ExchangeConsumer>(std::move(stage),
+                                              degreeOfParallelism,
+                                              sbe::makeSV(resultSlot, recordIdSlot),
+                                              sbe::ExchangePolicy::roundrobin,
+                                              nullptr,
+                                              nullptr,
+                                              csn->nodeId());
+
+    return {resultSlot, recordIdSlot, boost::none, std::move(stage)};
+}
 }  // namespace
 
 std::tuple<sbe::value::SlotId,
@@ -457,10 +756,21 @@ generateCollScan(OperationContext* opCtx,
                  PlanYieldPolicy* yieldPolicy,
                  sbe::RuntimeEnvironment* env,
                  bool isTailableResumeBranch,
-                 TrialRunProgressTracker* tracker) {
+                 TrialRunProgressTracker* tracker,
+                 size_t degreeOfParallelism,
+                 size_t blockSize) {
 
     auto [resultSlot, recordIdSlot, oplogTsSlot, stage] = [&]() {
-        if (csn->minTs || csn->maxTs) {
+        if (degreeOfParallelism > 1 &&
+            canScanInParallel(opCtx, collection, csn, isTailableResumeBranch, tracker)) {
+            return generateParallelCollScan(opCtx,
+                                            collection,
+                                            csn,
+                                            slotIdGenerator,
+                                            frameIdGenerator,
+                                            env,
+                                            degreeOfParallelism);
+        } else if (csn->minTs || csn->maxTs) {
             return generateOptimizedOplogScan(opCtx,
                                               collection,
                                               csn,
@@ -479,7 +789,8 @@ generateCollScan(OperationContext* opCtx,
                                            yieldPolicy,
                                            env,
                                            isTailableResumeBranch,
-                                           tracker);
+                                           tracker,
+                                           blockSize);
         }
     }();
 
@@ -46,6 +46,14 @@ namespace mongo::stage_builder {
  *     were requested to track this data.
  *   * A generated PlanStage sub-tree.
  *
+ * If 'degreeOfParallelism' is greater than one and the scan is eligible, the sub-tree splits the
+ * collection into RecordId ranges scanned by that many producer threads, and the documents are
+ * returned in no particular order. The caller is responsible for only requesting this when the
+ * order of the results is not observable.
+ *
+ * If 'blockSize' is not zero and the filter of a scan on the calling thread only compares top-level
+ * fields with numbers, the filter is evaluated over blocks of up to 'blockSize' rows at a time.
+ *
  * In cases of an error, throws.
  */
 std::tuple<sbe::value::SlotId,
@@ -60,5 +68,7 @@ generateCollScan(OperationContext* opCtx,
                  PlanYieldPolicy* yieldPolicy,
                  sbe::RuntimeEnvironment* env,
                  bool isTailableResumeBranch,
-                 TrialRunProgressTracker* tracker);
+                 TrialRunProgressTracker* tracker,
+                 size_t degreeOfParallelism = 1,
+                 size_t blockSize = 0);
 }  // namespace mongo::stage_builder
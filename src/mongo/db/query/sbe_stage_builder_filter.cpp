@@ -404,20 +404,33 @@ void generateArraySize(MatchExpressionVisitorContext* context,
 void generateComparison(MatchExpressionVisitorContext* context,
                         const ComparisonMatchExpression* expr,
                         sbe::EPrimBinary::Op binaryOp) {
-    auto makePredicate = [expr, binaryOp](sbe::value::SlotId inputSlot,
-                                          EvalStage inputStage) -> EvalExprStagePair {
+    auto makePredicate = [context, expr, binaryOp](sbe::value::SlotId inputSlot,
+                                                   EvalStage inputStage) -> EvalExprStagePair {
         const auto& rhs = expr->getData();
         auto [tagView, valView] = sbe::bson::convertFrom(
             true, rhs.rawdata(), rhs.rawdata() + rhs.size(), rhs.fieldNameSize() - 1);
 
-        // SBE EConstant assumes ownership of the value so we have to make a copy here.
-        auto [tag, val] = sbe::value::copyValue(tagView, valView);
+        // A parameterized RHS is read from the runtime environment, so that the plan can be
+        // rebound to the values of another query of the same shape.
+        std::unique_ptr<sbe::EExpression> rhsExpr;
+        if (auto paramId = expr->getInputParamId(); paramId && context->env) {
+            auto slotName = makeInputParamSlotName(*paramId);
+            auto slot = context->env->getSlotIfExists(slotName);
+            if (!slot) {
+                auto [tag, val] = sbe::value::copyValue(tagView, valView);
+                slot =
+                    context->env->registerSlot(slotName, tag, val, true, context->slotIdGenerator);
+            }
+            rhsExpr = sbe::makeE<sbe::EVariable>(*slot);
+        } else {
+            // SBE EConstant assumes ownership of the value so we have to make a copy here.
+            auto [tag, val] = sbe::value::copyValue(tagView, valView);
+            rhsExpr = sbe::makeE<sbe::EConstant>(tag, val);
+        }
 
-        return {
-            makeFillEmptyFalse(sbe::makeE<sbe::EPrimBinary>(binaryOp,
-                                                            sbe::makeE<sbe::EVariable>(inputSlot),
-                                                            sbe::makeE<sbe::EConstant>(tag, val))),
-            std::move(inputStage)};
+        return {makeFillEmptyFalse(sbe::makeE<sbe::EPrimBinary>(
+                    binaryOp, sbe::makeE<sbe::EVariable>(inputSlot), std::move(rhsExpr))),
+                std::move(inputStage)};
     };
 
     generatePredicate(context, expr->path(), std::move(makePredicate));
@@ -316,4 +316,12 @@ EvalExprStagePair generateShortCircuitingLogicalOp(sbe::EPrimBinary::Op logicOp,
     return generateSingleResultUnion(std::move(branches), branchFn, planNodeId, slotIdGenerator);
 }
 
+std::string makeInputParamSlotName(InputParamId paramId) {
+    return str::stream() << "inputParam" << paramId;
+}
+
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId) {
+    return str::stream() << "indexBounds" << nodeId;
+}
+
 }  // namespace mongo::stage_builder
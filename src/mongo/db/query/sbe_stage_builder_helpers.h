@@ -37,6 +37,7 @@
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/project.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/sbe_stage_builder_eval_frame.h"
 #include "mongo/db/query/stage_types.h"
 
@@ -237,4 +238,16 @@ EvalExprStagePair generateShortCircuitingLogicalOp(sbe::EPrimBinary::Op logicOp,
                                                    PlanNodeId planNodeId,
                                                    sbe::value::SlotIdGenerator* slotIdGenerator);
 
+/**
+ * Returns the name of the runtime environment slot holding the value of the input parameter
+ * 'paramId' of the query.
+ */
+std::string makeInputParamSlotName(InputParamId paramId);
+
+/**
+ * Returns the name of the runtime environment slot holding the intervals scanned by the index scan
+ * built for the QuerySolutionNode 'nodeId'.
+ */
+std::string makeIndexBoundsSlotName(PlanNodeId nodeId);
+
 }  // namespace mongo::stage_builder
@@ -47,9 +47,12 @@
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unique.h"
 #include "mongo/db/exec/sbe/stages/unwind.h"
+#include "mongo/db/field_ref.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sbe_stage_builder_filter.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/util/make_data_structure.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/str.h"
@@ -242,6 +245,34 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
     return result;
 }
 
+/**
+ * Constructs an array containing objects with the low and high keys for each interval. E.g.,
+ *    [ {l: KS(...), h: KS(...)},
+ *      {l: KS(...), h: KS(...)}, ... ]
+ *
+ * The caller owns the returned value.
+ */
+std::pair<sbe::value::TypeTags, sbe::value::Value> makeIntervalsArray(
+    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+        intervals) {
+    using namespace std::literals;
+
+    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
+    auto arr = sbe::value::getArrayView(boundsVal);
+    for (auto&& [lowKey, highKey] : intervals) {
+        auto [tag, val] = sbe::value::makeNewObject();
+        auto obj = sbe::value::getObjectView(val);
+        obj->push_back("l"sv,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
+        obj->push_back("h"sv,
+                       sbe::value::TypeTags::ksValue,
+                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
+        arr->push_back(tag, val);
+    }
+    return {boundsTag, boundsVal};
+}
+
 /**
  * Constructs an optimized version of an index scan for multi-interval index bounds for the case
  * when the bounds can be decomposed in a number of single-interval bounds. In this case, instead
@@ -264,14 +295,16 @@ makeIntervalsFromIndexBounds(const IndexBounds& bounds,
  * This subtree is similar to the single-interval subtree with the only difference that instead
  * of projecting a single pair of the low/high keys, we project an array of such pairs and then
  * use the unwind stage to flatten the array and generate multiple input intervals to the ixscan.
+ *
+ * The array of intervals is computed by 'boundsExpr', which is either a constant built by
+ * 'makeIntervalsArray()' or a runtime environment slot holding such an array.
  */
 std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>>
 generateOptimizedMultiIntervalIndexScan(
     const CollectionPtr& collection,
     const std::string& indexName,
     bool forward,
-    std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
-        intervals,
+    std::unique_ptr<sbe::EExpression> boundsExpr,
     sbe::IndexKeysInclusionSet indexKeysToInclude,
     sbe::value::SlotVector indexKeySlots,
     sbe::value::SlotIdGenerator* slotIdGenerator,
@@ -284,35 +317,17 @@ generateOptimizedMultiIntervalIndexScan(
     auto lowKeySlot = slotIdGenerator->generate();
     auto highKeySlot = slotIdGenerator->generate();
 
-    // Construct an array containing objects with the low and high keys for each interval. E.g.,
-    //    [ {l: KS(...), h: KS(...)},
-    //      {l: KS(...), h: KS(...)}, ... ]
-    auto [boundsTag, boundsVal] = sbe::value::makeNewArray();
-    auto arr = sbe::value::getArrayView(boundsVal);
-    for (auto&& [lowKey, highKey] : intervals) {
-        auto [tag, val] = sbe::value::makeNewObject();
-        auto obj = sbe::value::getObjectView(val);
-        obj->push_back("l"sv,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(lowKey.release()));
-        obj->push_back("h"sv,
-                       sbe::value::TypeTags::ksValue,
-                       sbe::value::bitcastFrom<KeyString::Value*>(highKey.release()));
-        arr->push_back(tag, val);
-    }
-
     auto boundsSlot = slotIdGenerator->generate();
     auto unwindSlot = slotIdGenerator->generate();
 
-    // Project out the constructed array as a constant value and add an unwind stage on top to
-    // flatten the array.
+    // Project out the array of intervals and add an unwind stage on top to flatten it.
     auto unwind = sbe::makeS<sbe::UnwindStage>(
         sbe::makeProjectStage(
             sbe::makeS<sbe::LimitSkipStage>(
                 sbe::makeS<sbe::CoScanStage>(planNodeId), 1, boost::none, planNodeId),
             planNodeId,
             boundsSlot,
-            sbe::makeE<sbe::EConstant>(boundsTag, boundsVal)),
+            std::move(boundsExpr)),
         boundsSlot,
         unwindSlot,
         slotIdGenerator->generate(), /* We don't need an index slot but must to provide it. */
@@ -674,6 +689,170 @@ std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateSingleInt
                                            planNodeId)};
 }
 
+namespace {
+/**
+ * Returns the intervals scanned by 'ixn' as low/high KeyString pairs, or an empty vector if the
+ * bounds cannot be represented that way.
+ */
+std::vector<std::pair<std::unique_ptr<KeyString::Value>, std::unique_ptr<KeyString::Value>>>
+makeIntervalsForNode(OperationContext* opCtx,
+                     const CollectionPtr& collection,
+                     const IndexScanNode* ixn) {
+    auto descriptor =
+        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
+    auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+    return makeIntervalsFromIndexBounds(
+        ixn->bounds,
+        ixn->direction == 1,
+        accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+        accessMethod->getSortedDataInterface()->getOrdering());
+}
+
+/**
+ * Builds the sub-tree scanning the index bounds of 'ixn', using the simplest shape the bounds can
+ * be represented with.
+ *
+ * If 'parameterizeBounds' is true, bounds which can be represented as low/high key intervals are
+ * read from a slot of 'env' rather than embedded in the plan, so that the plan can be rebound to
+ * the bounds of another query of the same shape. This always builds the multi-interval shape, so
+ * it is only worth doing for a plan which is kept in the plan cache.
+ */
+std::pair<sbe::value::SlotId, std::unique_ptr<sbe::PlanStage>> generateIndexScanForBounds(
+    OperationContext* opCtx,
+    const CollectionPtr& collection,
+    const IndexScanNode* ixn,
+    sbe::IndexKeysInclusionSet indexKeyBitset,
+    sbe::value::SlotVector indexKeySlots,
+    sbe::value::SlotIdGenerator* slotIdGenerator,
+    sbe::value::SpoolIdGenerator* spoolIdGenerator,
+    PlanYieldPolicy* yieldPolicy,
+    TrialRunProgressTracker* tracker,
+    sbe::RuntimeEnvironment* env,
+    bool parameterizeBounds) {
+    auto intervals = makeIntervalsForNode(opCtx, collection, ixn);
+
+    if (parameterizeBounds && !intervals.empty()) {
+        invariant(env);
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
+        auto boundsSlot = env->registerSlot(makeIndexBoundsSlotName(ixn->nodeId()),
+                                            boundsTag,
+                                            boundsVal,
+                                            true,
+                                            slotIdGenerator);
+        return generateOptimizedMultiIntervalIndexScan(collection,
+                                                       ixn->index.identifier.catalogName,
+                                                       ixn->direction == 1,
+                                                       sbe::makeE<sbe::EVariable>(boundsSlot),
+                                                       indexKeyBitset,
+                                                       indexKeySlots,
+                                                       slotIdGenerator,
+                                                       yieldPolicy,
+                                                       tracker,
+                                                       ixn->nodeId());
+    } else if (intervals.size() == 1) {
+        // If we have just a single interval, we can construct a simplified sub-tree.
+        auto&& [lowKey, highKey] = intervals[0];
+        return generateSingleIntervalIndexScan(collection,
+                                               ixn->index.identifier.catalogName,
+                                               ixn->direction == 1,
+                                               std::move(lowKey),
+                                               std::move(highKey),
+                                               indexKeyBitset,
+                                               indexKeySlots,
+                                               boost::none,  // recordSlot
+                                               slotIdGenerator,
+                                               yieldPolicy,
+                                               tracker,
+                                               ixn->nodeId());
+    } else if (intervals.size() > 1) {
+        // Or, if we were able to decompose multi-interval index bounds into a number of
+        // single-interval bounds, we can also built an optimized sub-tree to perform an index
+        // scan.
+        auto [boundsTag, boundsVal] = makeIntervalsArray(std::move(intervals));
+        return generateOptimizedMultiIntervalIndexScan(collection,
+                                                       ixn->index.identifier.catalogName,
+                                                       ixn->direction == 1,
+                                                       sbe::makeE<sbe::EConstant>(boundsTag,
+                                                                                  boundsVal),
+                                                       indexKeyBitset,
+                                                       indexKeySlots,
+                                                       slotIdGenerator,
+                                                       yieldPolicy,
+                                                       tracker,
+                                                       ixn->nodeId());
+    } else {
+        // Otherwise, build a generic index scan for multi-interval index bounds.
+        auto descriptor = collection->getIndexCatalog()->findIndexByName(
+            opCtx, ixn->index.identifier.catalogName);
+        auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
+        return generateGenericMultiIntervalIndexScan(
+            collection,
+            ixn,
+            accessMethod->getSortedDataInterface()->getKeyStringVersion(),
+            accessMethod->getSortedDataInterface()->getOrdering(),
+            indexKeyBitset,
+            indexKeySlots,
+            slotIdGenerator,
+            spoolIdGenerator,
+            yieldPolicy,
+            tracker);
+    }
+}
+/**
+ * Returns an expression building an object out of the parts of an index key held in 'keySlots',
+ * with each part at the path of the matching field of 'keyPattern', so that a filter over the
+ * fields of the key pattern can be evaluated against it. Returns nullptr if a field of the key
+ * pattern is a prefix of another, as no object can hold both.
+ */
+std::unique_ptr<sbe::EExpression> makeIndexKeyObjectExpr(const BSONObj& keyPattern,
+                                                         const sbe::value::SlotVector& keySlots) {
+    struct PathNode {
+        boost::optional<sbe::value::SlotId> slot;
+        std::vector<std::pair<std::string, std::unique_ptr<PathNode>>> children;
+    };
+
+    PathNode root;
+    size_t keyIndex = 0;
+    for (auto&& elem : keyPattern) {
+        PathNode* node = &root;
+        FieldRef path{elem.fieldNameStringData()};
+        for (size_t i = 0; i < path.numParts(); ++i) {
+            if (node->slot) {
+                return nullptr;
+            }
+            auto part = path.getPart(i).toString();
+            auto it = std::find_if(node->children.begin(),
+                                   node->children.end(),
+                                   [&](auto&& child) { return child.first == part; });
+            if (it == node->children.end()) {
+                node->children.emplace_back(part, std::make_unique<PathNode>());
+                it = std::prev(node->children.end());
+            }
+            node = it->second.get();
+        }
+        if (node->slot || !node->children.empty()) {
+            return nullptr;
+        }
+        node->slot = keySlots[keyIndex++];
+    }
+
+    std::function<std::unique_ptr<sbe::EExpression>(const PathNode&)> makeExpr =
+        [&](const PathNode& node) -> std::unique_ptr<sbe::EExpression> {
+        if (node.slot) {
+            return sbe::makeE<sbe::EVariable>(*node.slot);
+        }
+        std::vector<std::unique_ptr<sbe::EExpression>> args;
+        for (auto&& [name, child] : node.children) {
+            args.emplace_back(
+                sbe::makeE<sbe::EConstant>(std::string_view{name.data(), name.size()}));
+            args.emplace_back(makeExpr(*child));
+        }
+        return sbe::makeE<sbe::EFunction>("newObj", std::move(args));
+    };
+    return makeExpr(root);
+}
+}  // namespace
+
 std::tuple<sbe::value::SlotId, sbe::value::SlotVector, std::unique_ptr<sbe::PlanStage>>
 generateIndexScan(OperationContext* opCtx,
                   const CollectionPtr& collection,
@@ -683,24 +862,18 @@ generateIndexScan(OperationContext* opCtx,
                   sbe::value::SlotIdGenerator* slotIdGenerator,
                   sbe::value::SpoolIdGenerator* spoolIdGenerator,
                   PlanYieldPolicy* yieldPolicy,
-                  TrialRunProgressTracker* tracker) {
+                  TrialRunProgressTracker* tracker,
+                  sbe::value::FrameIdGenerator* frameIdGenerator,
+                  sbe::RuntimeEnvironment* env,
+                  bool parameterizeBounds) {
     invariant(returnKeySlot || !ixn->addKeyMetadata);
-    uassert(4822864, "Index scans with a filter are not supported in SBE", !ixn->filter);
-
-    auto descriptor =
-        collection->getIndexCatalog()->findIndexByName(opCtx, ixn->index.identifier.catalogName);
-    auto accessMethod = collection->getIndexCatalog()->getEntry(descriptor)->accessMethod();
-    auto intervals =
-        makeIntervalsFromIndexBounds(ixn->bounds,
-                                     ixn->direction == 1,
-                                     accessMethod->getSortedDataInterface()->getKeyStringVersion(),
-                                     accessMethod->getSortedDataInterface()->getOrdering());
 
     std::unique_ptr<sbe::EExpression> returnKeyExpr;
     sbe::value::SlotVector indexKeySlots;
     auto indexKeyBitset = indexKeysToInclude;
 
-    if (returnKeySlot) {
+    // Both the returned key and a filter on the index keys need every part of the key.
+    if (returnKeySlot || ixn->filter) {
         std::vector<std::unique_ptr<sbe::EExpression>> mkObjArgs;
 
         for (auto&& elem : ixn->index.keyPattern) {
@@ -714,7 +887,9 @@ generateIndexScan(OperationContext* opCtx,
             mkObjArgs.emplace_back(sbe::makeE<sbe::EVariable>(slot));
         }
 
-        returnKeyExpr = sbe::makeE<sbe::EFunction>("newObj", std::move(mkObjArgs));
+        if (returnKeySlot) {
+            returnKeyExpr = sbe::makeE<sbe::EFunction>("newObj", std::move(mkObjArgs));
+        }
 
         invariant(indexKeySlots.size() <= indexKeyBitset.size());
 
@@ -728,61 +903,55 @@ generateIndexScan(OperationContext* opCtx,
         }
     }
 
-    auto [recordIdSlot, stage] = [&]() {
-        if (intervals.size() == 1) {
-            // If we have just a single interval, we can construct a simplified sub-tree.
-            auto&& [lowKey, highKey] = intervals[0];
-            return generateSingleIntervalIndexScan(collection,
-                                                   ixn->index.identifier.catalogName,
-                                                   ixn->direction == 1,
-                                                   std::move(lowKey),
-                                                   std::move(highKey),
-                                                   indexKeyBitset,
-                                                   indexKeySlots,
-                                                   boost::none,  // recordSlot
-                                                   slotIdGenerator,
-                                                   yieldPolicy,
-                                                   tracker,
-                                                   ixn->nodeId());
-        } else if (intervals.size() > 1) {
-            // Or, if we were able to decompose multi-interval index bounds into a number of
-            // single-interval bounds, we can also built an optimized sub-tree to perform an index
-            // scan.
-            return generateOptimizedMultiIntervalIndexScan(collection,
-                                                           ixn->index.identifier.catalogName,
-                                                           ixn->direction == 1,
-                                                           std::move(intervals),
-                                                           indexKeyBitset,
-                                                           indexKeySlots,
-                                                           slotIdGenerator,
-                                                           yieldPolicy,
-                                                           tracker,
-                                                           ixn->nodeId());
-        } else {
-            // Otherwise, build a generic index scan for multi-interval index bounds.
-            return generateGenericMultiIntervalIndexScan(
-                collection,
-                ixn,
-                accessMethod->getSortedDataInterface()->getKeyStringVersion(),
-                accessMethod->getSortedDataInterface()->getOrdering(),
-                indexKeyBitset,
-                indexKeySlots,
-                slotIdGenerator,
-                spoolIdGenerator,
-                yieldPolicy,
-                tracker);
-        }
-    }();
+    auto [recordIdSlot, stage] = generateIndexScanForBounds(opCtx,
+                                                            collection,
+                                                            ixn,
+                                                            indexKeyBitset,
+                                                            indexKeySlots,
+                                                            slotIdGenerator,
+                                                            spoolIdGenerator,
+                                                            yieldPolicy,
+                                                            tracker,
+                                                            env,
+                                                            parameterizeBounds);
 
     if (ixn->shouldDedup) {
         stage = sbe::makeS<sbe::UniqueStage>(
             std::move(stage), sbe::makeSV(recordIdSlot), ixn->nodeId());
     }
 
+    if (ixn->filter) {
+        // The filter is evaluated against an object rebuilt from the parts of the index key, so
+        // that the records of the keys which fail it are never fetched.
+        auto keyObjExpr = makeIndexKeyObjectExpr(ixn->index.keyPattern, indexKeySlots);
+        uassert(5301400,
+                str::stream() << "Index scan filters are not supported in SBE over the key pattern "
+                              << ixn->index.keyPattern,
+                keyObjExpr);
+
+        auto keyObjSlot = slotIdGenerator->generate();
+        stage = sbe::makeProjectStage(
+            std::move(stage), ixn->nodeId(), keyObjSlot, std::move(keyObjExpr));
+
+        auto relevantSlots = sbe::makeSV(recordIdSlot);
+        relevantSlots.insert(relevantSlots.end(), indexKeySlots.begin(), indexKeySlots.end());
+        stage = generateFilter(opCtx,
+                               ixn->filter.get(),
+                               std::move(stage),
+                               slotIdGenerator,
+                               frameIdGenerator,
+                               keyObjSlot,
+                               env,
+                               std::move(relevantSlots),
+                               ixn->nodeId());
+    }
+
     if (returnKeySlot) {
         stage = sbe::makeProjectStage(
             std::move(stage), ixn->nodeId(), *returnKeySlot, std::move(returnKeyExpr));
+    }
 
+    if (returnKeySlot || ixn->filter) {
         // At this point, 'indexKeySlots' holds slots for all parts of the index key. We only want
         // to return slots for the parts of the index key specified by 'indexKeysToInclude'.
         auto allIndexKeySlots = std::move(indexKeySlots);
@@ -796,4 +965,13 @@ generateIndexScan(OperationContext* opCtx,
 
     return {recordIdSlot, std::move(indexKeySlots), std::move(stage)};
 }
+
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexScanIntervals(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn) {
+    auto intervals = makeIntervalsForNode(opCtx, collection, ixn);
+    if (intervals.empty()) {
+        return boost::none;
+    }
+    return makeIntervalsArray(std::move(intervals));
+}
 }  // namespace mongo::stage_builder
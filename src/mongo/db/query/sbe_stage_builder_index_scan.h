@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/trial_run_progress_tracker.h"
@@ -44,6 +45,14 @@ namespace mongo::stage_builder {
  *
  * If the caller provides a slot ID for the 'returnKeySlot' parameter, this method will populate
  * the specified slot with the rehydrated index key for each record.
+ *
+ * A filter on 'ixn' is evaluated against the parts of each index key, before the record it points
+ * to is fetched.
+ *
+ * If 'parameterizeBounds' is true, and the index bounds can be represented as low/high key
+ * intervals, the intervals are held in the slot of 'env' named after the node id of 'ixn' (see
+ * 'makeIndexBoundsSlotName()'), so that the plan can be rebound to the bounds of another query of
+ * the same shape with 'makeIndexScanIntervals()'. Otherwise they are embedded in the plan.
  */
 std::tuple<sbe::value::SlotId, sbe::value::SlotVector, std::unique_ptr<sbe::PlanStage>>
 generateIndexScan(OperationContext* opCtx,
@@ -54,7 +63,18 @@ generateIndexScan(OperationContext* opCtx,
                   sbe::value::SlotIdGenerator* slotIdGenerator,
                   sbe::value::SpoolIdGenerator* spoolIdGenerator,
                   PlanYieldPolicy* yieldPolicy,
-                  TrialRunProgressTracker* tracker);
+                  TrialRunProgressTracker* tracker,
+                  sbe::value::FrameIdGenerator* frameIdGenerator,
+                  sbe::RuntimeEnvironment* env,
+                  bool parameterizeBounds);
+
+/**
+ * Returns the intervals scanned by 'ixn', in the form held by the runtime environment slot of an
+ * index scan generated with a runtime environment, or boost::none if the bounds of 'ixn' cannot be
+ * represented as low/high key intervals. The caller owns the returned value.
+ */
+boost::optional<std::pair<sbe::value::TypeTags, sbe::value::Value>> makeIndexScanIntervals(
+    OperationContext* opCtx, const CollectionPtr& collection, const IndexScanNode* ixn);
 
 /**
  * Constructs the most simple version of an index scan from the single interval index bounds. The
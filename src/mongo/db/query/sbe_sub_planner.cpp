@@ -73,9 +73,8 @@ CandidatePlans SubPlanner::plan(
         // conservative about putting a potentially bad plan into the cache in the subplan path.
         MultiPlanner multiPlanner{
             _opCtx, _collection, *cq, PlanCachingMode::SometimesCache, _yieldPolicy};
-        auto&& [candidates, winnerIdx] = multiPlanner.plan(std::move(solutions), std::move(roots));
-        invariant(winnerIdx < candidates.size());
-        return std::move(candidates[winnerIdx].solution);
+        auto candidates = multiPlanner.plan(std::move(solutions), std::move(roots));
+        return std::move(candidates.winner().solution);
     };
 
     auto subplanSelectStat = QueryPlanner::choosePlanForSubqueries(
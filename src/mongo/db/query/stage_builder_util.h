@@ -50,12 +50,18 @@ std::unique_ptr<PlanStage> buildClassicExecutableTree(OperationContext* opCtx,
                                                       const QuerySolution& solution,
                                                       WorkingSet* ws);
 
+/**
+ * Builds the SBE execution tree of 'solution'. If 'parameterizeIndexBounds' is true, the index
+ * scans of the tree read their bounds from runtime environment slots, so that the tree can be kept
+ * in the plan cache and rebound to the bounds of other queries of the same shape.
+ */
 std::pair<std::unique_ptr<sbe::PlanStage>, stage_builder::PlanStageData>
 buildSlotBasedExecutableTree(OperationContext* opCtx,
                              const CollectionPtr& collection,
                              const CanonicalQuery& cq,
                              const QuerySolution& solution,
                              PlanYieldPolicy* yieldPolicy,
-                             bool needsTrialRunProgressTracker);
+                             bool needsTrialRunProgressTracker,
+                             bool parameterizeIndexBounds = false);
 
 }  // namespace mongo::stage_builder
@@ -77,6 +77,9 @@ enum StageType {
     STAGE_GEO_NEAR_2D,
     STAGE_GEO_NEAR_2DSPHERE,
 
+    // A $group stage of an aggregation pipeline pushed down into the slot-based execution engine.
+    STAGE_GROUP,
+
     STAGE_IDHACK,
 
     STAGE_IXSCAN,
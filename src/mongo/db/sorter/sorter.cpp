@@ -48,7 +48,9 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
+#include <deque>
 #include <snappy.h>
 #include <vector>
 
@@ -56,6 +58,7 @@
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_worker_pool.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
@@ -142,6 +145,44 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+// The fewest elements worth sorting on a thread of their own.
+constexpr size_t kMinElementsPerSortThread = 1024;
+
+/**
+ * Sorts 'data' like std::stable_sort, on up to 'maxThreads' threads. The data is split into as
+ * many ranges, which are sorted concurrently, and then merged pairwise, with the merges of each
+ * round also running concurrently. Merging only adjacent ranges keeps the sort stable. The threads
+ * other than the calling one are workers shared by all sorters, so fewer may be available.
+ */
+template <typename Container, typename Less>
+void stableSortOnThreads(Container& data, const Less& less, size_t maxThreads) {
+    const size_t numRanges = std::min(maxThreads, data.size() / kMinElementsPerSortThread);
+    if (numRanges < 2) {
+        std::stable_sort(data.begin(), data.end(), less);
+        return;
+    }
+
+    // The i-th range spans [bounds[i], bounds[i + 1]).
+    std::vector<typename Container::iterator> bounds;
+    bounds.reserve(numRanges + 1);
+    for (size_t i = 0; i <= numRanges; ++i) {
+        bounds.push_back(data.begin() + data.size() * i / numRanges);
+    }
+
+    runConcurrently(numRanges,
+                    [&](size_t i) { std::stable_sort(bounds[i], bounds[i + 1], less); });
+
+    for (size_t width = 1; width < numRanges; width *= 2) {
+        const size_t numMerges = (numRanges + 2 * width - 1) / (2 * width);
+        runConcurrently(numMerges, [&](size_t i) {
+            const size_t first = 2 * i * width;
+            const size_t middle = std::min(first + width, numRanges);
+            const size_t last = std::min(first + 2 * width, numRanges);
+            std::inplace_merge(bounds[first], bounds[middle], bounds[last], less);
+        });
+    }
+}
+
 /**
  * Returns results from sorted in-memory storage.
  */
@@ -537,6 +578,131 @@ private:
     STLComparator _greater;                      // named so calls make sense
 };
 
+// The fewest spilled runs worth merging on a thread of their own.
+constexpr size_t kMinRunsPerMergeThread = 2;
+
+/**
+ * Merges sorted runs on several threads. The runs are split into as many contiguous groups as
+ * there are threads, and the runs of each group are merged by a MergeIterator of their own. Their
+ * outputs are buffered, and merged in turn by the MergeIterator the caller reads from. Whenever it
+ * needs the next element of a group whose buffer is empty, the buffers of all the groups are
+ * topped up concurrently, so that the runs of different groups are read, decoded and merged in
+ * parallel. The buffers share the memory limit of the sort.
+ *
+ * As the groups are contiguous and the MergeIterator breaks ties by the position of its inputs,
+ * elements which compare equal come out in the order of their runs, as with a single MergeIterator.
+ */
+template <typename Key, typename Value, typename Comparator>
+class ParallelMergeGroups {
+public:
+    typedef SortIteratorInterface<Key, Value> Input;
+    typedef std::pair<Key, Value> Data;
+
+    ParallelMergeGroups(const std::vector<std::shared_ptr<Input>>& iters,
+                        size_t numGroups,
+                        const SortOptions& opts,
+                        const Comparator& comp)
+        : _opts(opts),
+          _comp(comp),
+          _maxBufferedBytes(std::max<size_t>(opts.maxMemoryUsageBytes / numGroups, 1)),
+          _groups(numGroups) {
+        for (size_t i = 0; i < numGroups; ++i) {
+            _groups[i].runs.assign(iters.begin() + iters.size() * i / numGroups,
+                                   iters.begin() + iters.size() * (i + 1) / numGroups);
+        }
+    }
+
+    bool more(size_t group) {
+        if (_groups[group].buffer.empty() && !_groups[group].exhausted) {
+            refill();
+        }
+        return !_groups[group].buffer.empty();
+    }
+
+    Data next(size_t group) {
+        invariant(more(group));
+        auto& buffer = _groups[group].buffer;
+        Data data = std::move(buffer.front());
+        buffer.pop_front();
+        _groups[group].bufferedBytes -= memUsage(data);
+        return data;
+    }
+
+private:
+    struct Group {
+        std::vector<std::shared_ptr<Input>> runs;
+        std::unique_ptr<Input> merge;
+        std::deque<Data> buffer;
+        size_t bufferedBytes = 0;
+        bool exhausted = false;
+    };
+
+    static size_t memUsage(const Data& data) {
+        return data.first.memUsageForSorter() + data.second.memUsageForSorter();
+    }
+
+    /**
+     * Tops up the buffer of every group which is not exhausted, one group per thread.
+     */
+    void refill() {
+        runConcurrently(_groups.size(), [&](size_t i) {
+            auto& group = _groups[i];
+            if (group.exhausted) {
+                return;
+            }
+            if (!group.merge) {
+                group.merge = std::make_unique<MergeIterator<Key, Value, Comparator>>(
+                    group.runs, _opts, _comp);
+            }
+
+            while (group.bufferedBytes < _maxBufferedBytes && group.merge->more()) {
+                group.buffer.push_back(group.merge->next());
+                group.bufferedBytes += memUsage(group.buffer.back());
+            }
+
+            if (!group.merge->more()) {
+                // Closes the runs of the group as soon as they have been read.
+                group.exhausted = true;
+                group.merge.reset();
+                group.runs.clear();
+            }
+        });
+    }
+
+    const SortOptions _opts;
+    const Comparator _comp;
+    const size_t _maxBufferedBytes;
+    std::vector<Group> _groups;
+};
+
+/**
+ * Returns the elements of one group of a ParallelMergeGroups.
+ */
+template <typename Key, typename Value, typename Comparator>
+class ParallelMergeGroupIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef std::pair<Key, Value> Data;
+
+    ParallelMergeGroupIterator(std::shared_ptr<ParallelMergeGroups<Key, Value, Comparator>> groups,
+                               size_t group)
+        : _groups(std::move(groups)), _group(group) {}
+
+    void openSource() {}
+    void closeSource() {}
+
+    bool more() {
+        return _groups->more(_group);
+    }
+
+    Data next() {
+        return _groups->next(_group);
+    }
+
+private:
+    std::shared_ptr<ParallelMergeGroups<Key, Value, Comparator>> _groups;
+    const size_t _group;
+};
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -637,7 +803,7 @@ private:
 
     void sort() {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        stableSortOnThreads(_data, less, this->_opts.maxWorkerThreads);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
@@ -1147,7 +1313,21 @@ SortIteratorInterface<Key, Value>* SortIteratorInterface<Key, Value>::merge(
     const std::vector<std::shared_ptr<SortIteratorInterface>>& iters,
     const SortOptions& opts,
     const Comparator& comp) {
-    return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    const size_t numGroups =
+        std::min(opts.maxWorkerThreads, iters.size() / sorter::kMinRunsPerMergeThread);
+    if (numGroups < 2) {
+        return new sorter::MergeIterator<Key, Value, Comparator>(iters, opts, comp);
+    }
+
+    auto groups = std::make_shared<sorter::ParallelMergeGroups<Key, Value, Comparator>>(
+        iters, numGroups, opts, comp);
+    std::vector<std::shared_ptr<SortIteratorInterface>> groupIters;
+    for (size_t i = 0; i < numGroups; ++i) {
+        groupIters.push_back(
+            std::make_shared<sorter::ParallelMergeGroupIterator<Key, Value, Comparator>>(groups,
+                                                                                          i));
+    }
+    return new sorter::MergeIterator<Key, Value, Comparator>(groupIters, opts, comp);
 }
 
 template <typename Key, typename Value>
@@ -108,7 +108,16 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The maximum number of threads which sort the in-memory data concurrently, before it is
+    // spilled or returned, and which merge the runs spilled to disk. Must only be more than one if
+    // the keys and values can be compared and moved on several threads at once.
+    size_t maxWorkerThreads;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          maxWorkerThreads(1) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -131,6 +140,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& MaxWorkerThreads(size_t newMaxWorkerThreads) {
+        maxWorkerThreads = newMaxWorkerThreads;
+        return *this;
+    }
 };
 
 /**
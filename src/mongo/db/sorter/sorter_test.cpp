@@ -38,13 +38,18 @@
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
+#include "mongo/db/bounded_worker_pool.h"
+#include "mongo/db/service_context_test_fixture.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/sorter/sorter_gen.h"
+#include "mongo/db/sorter/sorter_worker_pool.h"
 #include "mongo/logv2/log.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 
 namespace mongo {
@@ -362,6 +367,25 @@ public:
     }
 };
 
+/**
+ * Provides a global service context, whose pool of worker threads the sorts of the test share, and
+ * lets them use up to 'maxWorkers' of its workers at once.
+ */
+class ScopedSorterWorkers : public ScopedGlobalServiceContextForTest {
+protected:
+    explicit ScopedSorterWorkers(int maxWorkers)
+        : _oldMaxWorkers(internalSorterMaxWorkerThreads.load()) {
+        internalSorterMaxWorkerThreads.store(maxWorkers);
+    }
+
+    ~ScopedSorterWorkers() {
+        internalSorterMaxWorkerThreads.store(_oldMaxWorkers);
+    }
+
+private:
+    const int _oldMaxWorkers;
+};
+
 namespace SorterTests {
 class Basic {
 public:
@@ -604,6 +628,34 @@ public:
     PseudoRandom _random;
 };
 
+template <bool Random = true>
+class LotsOfDataOnWorkerThreads : public LotsOfDataLittleMemory<Random>,
+                                  private ScopedSorterWorkers {
+public:
+    LotsOfDataOnWorkerThreads() : ScopedSorterWorkers(4) {}
+
+private:
+    // Both the runs and their merge are on worker threads.
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).MaxWorkerThreads(4);
+    }
+};
+
+template <bool Random = true>
+class LotsOfDataInMemoryOnWorkerThreads : public LotsOfDataLittleMemory<Random>,
+                                          private ScopedSorterWorkers {
+public:
+    LotsOfDataInMemoryOnWorkerThreads() : ScopedSorterWorkers(4) {}
+
+private:
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return opts.MaxMemoryUsageBytes(std::numeric_limits<size_t>::max()).MaxWorkerThreads(5);
+    }
+    size_t correctNumRanges() const override {
+        return 0;
+    }
+};
+
 
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -651,6 +703,10 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataOnWorkerThreads</*random=*/false>>();
+        add<SorterTests::LotsOfDataOnWorkerThreads</*random=*/true>>();
+        add<SorterTests::LotsOfDataInMemoryOnWorkerThreads</*random=*/false>>();
+        add<SorterTests::LotsOfDataInMemoryOnWorkerThreads</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -842,6 +898,75 @@ TEST_F(SorterMakeFromExistingRangesTest, RoundTrip) {
     }
 }
 
+class SorterWorkerPoolTest : public unittest::Test, public ScopedSorterWorkers {
+public:
+    SorterWorkerPoolTest() : ScopedSorterWorkers(4) {}
+};
+
+TEST_F(SorterWorkerPoolTest, RunsEveryTaskExactlyOnce) {
+    const size_t numTasks = 100;
+    std::vector<AtomicWord<int>> runs(numTasks);
+    runConcurrently(numTasks, [&](size_t i) { runs[i].fetchAndAdd(1); });
+    for (size_t i = 0; i < numTasks; ++i) {
+        ASSERT_EQ(runs[i].load(), 1) << "task " << i;
+    }
+}
+
+TEST_F(SorterWorkerPoolTest, RunsOnCallingThreadWithoutWorkers) {
+    // Other work holds every worker of the pool.
+    auto otherWork = BoundedWorkerPool::get(getServiceContext())
+                         ->reserve("other"_sd,
+                                   BoundedWorkerPool::kMaxThreads,
+                                   BoundedWorkerPool::kMaxThreads);
+    ASSERT_EQ(otherWork.size(), BoundedWorkerPool::kMaxThreads);
+
+    const auto caller = stdx::this_thread::get_id();
+    size_t ran = 0;
+    runConcurrently(10, [&](size_t) {
+        ASSERT(stdx::this_thread::get_id() == caller);
+        ++ran;
+    });
+    ASSERT_EQ(ran, 10U);
+}
+
+TEST_F(SorterWorkerPoolTest, RethrowsTaskException) {
+    ASSERT_THROWS_CODE(runConcurrently(8,
+                                       [](size_t i) {
+                                           if (i == 5) {
+                                               uasserted(ErrorCodes::InternalError, "task failed");
+                                           }
+                                       }),
+                       DBException,
+                       ErrorCodes::InternalError);
+}
+
+TEST_F(SorterWorkerPoolTest, ParallelMergeKeepsEqualKeysInTheOrderOfTheirRuns) {
+    // Every run holds the same keys, with the number of the run as their value.
+    const int numRuns = 9;
+    const int numKeys = 1000;
+    std::vector<std::shared_ptr<IWIterator>> runs;
+    for (int run = 0; run < numRuns; ++run) {
+        std::vector<IWPair> data;
+        for (int key = 0; key < numKeys; ++key) {
+            data.emplace_back(key, run);
+        }
+        runs.push_back(std::make_shared<InMemIterator<IntWrapper, IntWrapper>>(data));
+    }
+
+    // The small memory limit makes the merge refill the buffers of its groups many times.
+    const auto opts = SortOptions().MaxWorkerThreads(4).MaxMemoryUsageBytes(1024);
+    std::unique_ptr<IWIterator> merge(IWIterator::merge(runs, opts, IWComparator()));
+    for (int key = 0; key < numKeys; ++key) {
+        for (int run = 0; run < numRuns; ++run) {
+            ASSERT_TRUE(merge->more());
+            const auto next = merge->next();
+            ASSERT_EQ(next.first, key);
+            ASSERT_EQ(next.second, run);
+        }
+    }
+    ASSERT_FALSE(merge->more());
+}
+
 }  // namespace
 }  // namespace sorter
 }  // namespace mongo
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_worker_pool.h"
+
+#include <exception>
+#include <vector>
+
+#include "mongo/db/bounded_worker_pool.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/sorter/sorter_gen.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+/**
+ * Reserves up to 'wanted' workers of the shared pool, without ever exceeding
+ * internalSorterMaxWorkerThreads workers in use by sorts.
+ */
+BoundedWorkerPool::Reservation reserveWorkers(size_t wanted) {
+    if (wanted == 0 || !hasGlobalServiceContext()) {
+        return {};
+    }
+    return BoundedWorkerPool::get(getGlobalServiceContext())
+        ->reserve("sorter"_sd, internalSorterMaxWorkerThreads.load(), wanted);
+}
+
+}  // namespace
+
+void runConcurrently(size_t numTasks, const std::function<void(size_t)>& task) {
+    std::vector<std::exception_ptr> errors(numTasks);
+    AtomicWord<size_t> nextTask{0};
+
+    // Makes the calls nobody has started yet, until there are none left.
+    auto runTasks = [&] {
+        for (auto i = nextTask.fetchAndAdd(1); i < numTasks; i = nextTask.fetchAndAdd(1)) {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+
+    // The calling thread makes calls as well, so it needs one worker less than there are calls.
+    auto workers = reserveWorkers(numTasks > 1 ? numTasks - 1 : 0);
+
+    auto mutex = MONGO_MAKE_LATCH("sorter::runConcurrently::mutex");
+    stdx::condition_variable allWorkersDone;
+    auto numRunning = workers.size();
+    for (int i = 0; i < workers.size(); ++i) {
+        workers.schedule([&](Status status) {
+            // If the pool is shutting down, the calling thread makes the calls instead.
+            if (status.isOK()) {
+                runTasks();
+            }
+
+            stdx::lock_guard<Latch> lk(mutex);
+            if (--numRunning == 0) {
+                allWorkersDone.notify_all();
+            }
+        });
+    }
+
+    runTasks();
+    {
+        stdx::unique_lock<Latch> lk(mutex);
+        allWorkersDone.wait(lk, [&] { return numRunning == 0; });
+    }
+
+    for (auto&& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace sorter
+}  // namespace mongo
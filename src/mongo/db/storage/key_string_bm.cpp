@@ -48,6 +48,8 @@ const int kStrLenMultiplier = 100;
 const int kArrLenMultiplier = 40;
 
 const Ordering ALL_ASCENDING = Ordering::make(BSONObj());
+const Ordering ALL_DESCENDING =
+    Ordering::make(BSON("a" << -1 << "b" << -1 << "c" << -1 << "d" << -1));
 
 struct BsonsAndKeyStrings {
     int bsonSize = 0;
@@ -65,6 +67,7 @@ enum BsonValueType {
     STRING,
     ARRAY,
     DECIMAL,
+    COMPOUND,
 };
 
 BSONObj generateBson(BsonValueType bsonValueType) {
@@ -92,6 +95,15 @@ BSONObj generateBson(BsonValueType bsonValueType) {
                                          Decimal128::kRoundTo34Digits,
                                          Decimal128::kRoundTiesToAway)
                                   .quantize(Decimal128("0.01", Decimal128::kRoundTiesToAway)));
+        case COMPOUND: {
+            // A key of a compound index, whose leading fields are shared by many keys so that
+            // comparisons have to look past a common prefix.
+            std::uniform_int_distribution<int> tenant(0, 3);
+            return BSON("" << ("tenant" + std::to_string(tenant(gen))) << ""
+                           << static_cast<long long>(expReal(gen) / 100) << ""
+                           << std::string(expDist(gen) * kStrLenMultiplier / 10, 'x') << ""
+                           << expReal(gen));
+        }
     }
     MONGO_UNREACHABLE;
 }
@@ -133,6 +145,38 @@ void BM_BSONToKeyString(benchmark::State& state,
     state.SetItemsProcessed(state.iterations() * kSampleSize);
 }
 
+void BM_BSONToKeyStringDescending(benchmark::State& state,
+                                  const KeyString::Version version,
+                                  BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (auto bson : bsonsAndKeyStrings.bsons) {
+            benchmark::DoNotOptimize(KeyString::Builder(version, bson, ALL_DESCENDING));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.bsonSize);
+    state.SetItemsProcessed(state.iterations() * kSampleSize);
+}
+
+void BM_KeyStringCompare(benchmark::State& state,
+                         const KeyString::Version version,
+                         BsonValueType bsonType) {
+    const BsonsAndKeyStrings bsonsAndKeyStrings = generateBsonsAndKeyStrings(bsonType, version);
+    for (auto _ : state) {
+        benchmark::ClobberMemory();
+        for (size_t i = 1; i < kSampleSize; i++) {
+            benchmark::DoNotOptimize(
+                KeyString::compare(bsonsAndKeyStrings.keystrings[i - 1].get(),
+                                   bsonsAndKeyStrings.keystrings[i].get(),
+                                   bsonsAndKeyStrings.keystringLens[i - 1],
+                                   bsonsAndKeyStrings.keystringLens[i]));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bsonsAndKeyStrings.keystringSize);
+    state.SetItemsProcessed(state.iterations() * (kSampleSize - 1));
+}
+
 void BM_KeyStringToBSON(benchmark::State& state,
                         const KeyString::Version version,
                         BsonValueType bsonType) {
@@ -234,6 +278,10 @@ BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_BSONToKeyString, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_BSONToKeyStringDescending, V1_Compound, KeyString::Version::V1, COMPOUND);
 
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Int, KeyString::Version::V0, INT);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Int, KeyString::Version::V1, INT);
@@ -244,6 +292,11 @@ BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_String, KeyString::Version::V0, STRING)
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_String, KeyString::Version::V1, STRING);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V0_Array, KeyString::Version::V0, ARRAY);
 BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Array, KeyString::Version::V1, ARRAY);
+BENCHMARK_CAPTURE(BM_KeyStringToBSON, V1_Compound, KeyString::Version::V1, COMPOUND);
+
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Int, KeyString::Version::V1, INT);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_String, KeyString::Version::V1, STRING);
+BENCHMARK_CAPTURE(BM_KeyStringCompare, V1_Compound, KeyString::Version::V1, COMPOUND);
 
 }  // namespace
 }  // namespace mongo
@@ -1663,6 +1663,57 @@ TEST_F(KeyStringBuilderTest, VeryLargeString) {
     ROUNDTRIP(version, obj);
 }
 
+TEST_F(KeyStringBuilderTest, StringsAroundWordBoundaries) {
+    // Strings of every length around a few machine words, with and without NUL bytes, exercise
+    // both the word-at-a-time and the bytewise parts of encoding and decoding inverted strings.
+    for (size_t len = 0; len <= 40; ++len) {
+        std::string str;
+        for (size_t i = 0; i < len; ++i) {
+            str.push_back('a' + i % 26);
+        }
+        ROUNDTRIP(version, BSON("" << str));
+        ROUNDTRIP(version, BSON("" << str << "" << (str + '\0' + str)));
+        ROUNDTRIP(version, BSON(str << 1));
+
+        std::string prefixed = str + 'b';
+        COMPARES_SAME(version, BSON("" << (str + 'a')), BSON("" << prefixed));
+        COMPARES_SAME(version, BSON("" << str), BSON("" << prefixed));
+    }
+}
+
+TEST(KeyStringCompareTest, MatchesMemcmp) {
+    // Compare buffers sharing prefixes of every length up to a few machine words against the
+    // bytewise ordering of memcmp, for differences on both sides of each byte's high bit.
+    const auto sign = [](int cmp) { return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0); };
+    const auto reference = [&](const std::string& lhs, const std::string& rhs) {
+        const int cmp = memcmp(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+        if (cmp) {
+            return sign(cmp);
+        }
+        return sign(static_cast<int>(lhs.size()) - static_cast<int>(rhs.size()));
+    };
+
+    for (size_t prefixLen = 0; prefixLen <= 40; ++prefixLen) {
+        const std::string prefix(prefixLen, '\x7f');
+        for (const char lhsByte : {'\x00', '\x01', '\x7f', '\x80', '\xff'}) {
+            for (const char rhsByte : {'\x00', '\x01', '\x7f', '\x80', '\xff'}) {
+                for (size_t suffixLen : {0, 1, 7, 8, 9, 20}) {
+                    const std::string lhs = prefix + lhsByte + std::string(suffixLen, 'x');
+                    const std::string rhs = prefix + rhsByte + std::string(suffixLen, 'y');
+                    for (const auto& [left, right] :
+                         {std::make_pair(lhs, rhs), std::make_pair(lhs, prefix), {prefix, rhs}}) {
+                        ASSERT_EQ(reference(left, right),
+                                  KeyString::compare(
+                                      left.data(), right.data(), left.size(), right.size()))
+                            << "left: " << hexblob::encode(left.data(), left.size())
+                            << ", right: " << hexblob::encode(right.data(), right.size());
+                    }
+                }
+            }
+        }
+    }
+}
+
 TEST_F(KeyStringBuilderTest, ToBsonSafeShouldNotTerminate) {
     KeyString::TypeBits typeBits(KeyString::Version::V1);
 
@@ -0,0 +1,178 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/expression_context.h"
+
+namespace mongo {
+namespace {
+
+Value negate(const Value& value) {
+    switch (value.getType()) {
+        case NumberInt:
+            return Value::createIntOrLong(-static_cast<long long>(value.getInt()));
+        case NumberLong:
+            return value.getLong() == std::numeric_limits<long long>::min()
+                ? Value(-static_cast<double>(value.getLong()))
+                : Value(-value.getLong());
+        case NumberDouble:
+            return Value(-value.getDouble());
+        case NumberDecimal:
+            return Value(value.getDecimal().negate());
+        default:
+            // $sum ignores non-numeric values, whichever way they are counted.
+            return value;
+    }
+}
+
+bool isZero(const Value& value) {
+    return value.getType() == NumberDecimal ? value.getDecimal().isZero()
+                                            : value.coerceToDouble() == 0;
+}
+
+}  // namespace
+
+MaterializedViewDelta::MaterializedViewDelta(
+    std::shared_ptr<const MaterializedViewPipeline> pipeline)
+    : _pipeline(std::move(pipeline)),
+      _groups(_pipeline->getContext()->getValueComparator().makeUnorderedValueMap<GroupDelta>()) {}
+
+void MaterializedViewDelta::_add(const BSONObj& doc, bool remove) {
+    if (!_pipeline->matches(doc)) {
+        return;
+    }
+
+    const auto& accumulatedFields = _pipeline->getAccumulatedFields();
+    const Document document(doc);
+
+    Variables variables = _pipeline->getContext()->variables;
+    auto& group = _groups[_pipeline->computeGroupKey(document, &variables)];
+    if (group.sums.size() != accumulatedFields.size()) {
+        for (auto&& accumulatedField : accumulatedFields) {
+            group.sums.push_back(accumulatedField.makeAccumulator());
+        }
+    }
+
+    group.docCount += remove ? -1 : 1;
+    for (size_t i = 0; i < accumulatedFields.size(); ++i) {
+        Value value = accumulatedFields[i].expr.argument->evaluate(document, &variables);
+        group.sums[i]->process(remove ? negate(value) : value, false);
+    }
+}
+
+void MaterializedViewDelta::apply(OperationContext* opCtx, const CollectionPtr& materializedColl) {
+    const auto& accumulatedFields = _pipeline->getAccumulatedFields();
+    for (auto&& [groupKey, delta] : _groups) {
+        // Writes which leave a group as it was, such as updates of fields the view does not use,
+        // need not rewrite it.
+        if (delta.docCount == 0 &&
+            std::all_of(delta.sums.begin(), delta.sums.end(), [](auto&& sum) {
+                return isZero(sum->getValue(false));
+            })) {
+            continue;
+        }
+
+        BSONObjBuilder idBuilder;
+        idBuilder << "_id" << groupKey;
+        const BSONObj idQuery = idBuilder.obj();
+
+        Snapshotted<BSONObj> oldGroup;
+        const RecordId rid = Helpers::findById(opCtx, materializedColl, idQuery);
+        const bool exists = !rid.isNull() && materializedColl->findDoc(opCtx, rid, &oldGroup);
+
+        const long long docCount = delta.docCount +
+            (exists ? oldGroup.value()[MaterializedViewPipeline::kDocCountFieldName].numberLong()
+                    : 0);
+        if (docCount <= 0) {
+            if (exists) {
+                materializedColl->deleteDocument(opCtx, kUninitializedStmtId, rid, nullptr);
+            }
+            continue;
+        }
+
+        BSONObjBuilder groupBuilder;
+        groupBuilder.appendElements(idQuery);
+        for (size_t i = 0; i < accumulatedFields.size(); ++i) {
+            const auto& fieldName = accumulatedFields[i].fieldName;
+            if (exists) {
+                delta.sums[i]->process(Value(oldGroup.value()[fieldName]), false);
+            }
+
+            // Adding and taking out doubles rounds differently each time, so the groups would
+            // drift away from the sums over the documents. The sums are kept exact instead, which
+            // fails the writes of doubles, and of integers whose sum overflows to a double.
+            const auto sum = delta.sums[i]->getValue(false);
+            uassert(5302203,
+                    str::stream() << "Cannot keep the $sum of " << fieldName
+                                  << " in a materialized view exact, only integers and decimals "
+                                     "can be summed",
+                    sum.getType() != NumberDouble);
+            sum.addToBsonObj(&groupBuilder, fieldName);
+        }
+        groupBuilder.append(MaterializedViewPipeline::kDocCountFieldName, docCount);
+        const BSONObj newGroup = groupBuilder.obj();
+
+        if (exists) {
+            CollectionUpdateArgs args;
+            args.update = newGroup;
+            args.criteria = idQuery;
+            const bool indexesAffected = true;
+            materializedColl->updateDocument(
+                opCtx, rid, oldGroup, newGroup, indexesAffected, nullptr, &args);
+        } else {
+            uassertStatusOK(
+                materializedColl->insertDocument(opCtx, InsertStatement(newGroup), nullptr));
+        }
+    }
+    _groups.clear();
+}
+
+void populateMaterializedView(OperationContext* opCtx,
+                              const ViewDefinition& view,
+                              const CollectionPtr& sourceColl,
+                              const CollectionPtr& materializedColl) {
+    MaterializedViewDelta delta(MaterializedViewPipeline::parseView(opCtx, view));
+    auto cursor = sourceColl->getCursor(opCtx);
+    while (auto record = cursor->next()) {
+        opCtx->checkForInterrupt();
+        delta.addDocument(record->data.toBson().getOwned());
+    }
+    delta.apply(opCtx, materializedColl);
+}
+
+}  // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/exec/document_value/value_comparator.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/views/materialized_view_pipeline.h"
+#include "mongo/db/views/view.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * The changes made to the groups of a materialized view by a set of writes to the collection the
+ * view is defined on. The changes are gathered in memory and then applied to the collection
+ * holding the groups, so that a group touched by several of the writes is only rewritten once.
+ */
+class MaterializedViewDelta {
+public:
+    explicit MaterializedViewDelta(std::shared_ptr<const MaterializedViewPipeline> pipeline);
+
+    /**
+     * Adds the contribution of 'doc' to its group.
+     */
+    void addDocument(const BSONObj& doc) {
+        _add(doc, false);
+    }
+
+    /**
+     * Takes the contribution of 'doc' out of its group.
+     */
+    void removeDocument(const BSONObj& doc) {
+        _add(doc, true);
+    }
+
+    /**
+     * Applies the changes to the groups stored in 'materializedColl', inserting the groups which
+     * gain their first document and deleting those which lose their last one, and then forgets
+     * them. Must be called in a WriteUnitOfWork, with 'materializedColl' locked in MODE_IX.
+     * Throws if a $sum of a group would become a double, which could not be kept exact.
+     */
+    void apply(OperationContext* opCtx, const CollectionPtr& materializedColl);
+
+private:
+    struct GroupDelta {
+        long long docCount = 0;
+
+        // The change to each $sum of the group, in the order of the accumulated fields.
+        std::vector<boost::intrusive_ptr<AccumulatorState>> sums;
+    };
+
+    void _add(const BSONObj& doc, bool remove);
+
+    const std::shared_ptr<const MaterializedViewPipeline> _pipeline;
+    ValueUnorderedMap<GroupDelta> _groups;
+};
+
+/**
+ * Stores the groups of the materialized view 'view' over all the documents of 'sourceColl' in the
+ * empty collection 'materializedColl'. Must be called in a WriteUnitOfWork, with 'sourceColl'
+ * locked so that it cannot change until the view is maintained by the writes to it.
+ */
+void populateMaterializedView(OperationContext* opCtx,
+                              const ViewDefinition& view,
+                              const CollectionPtr& sourceColl,
+                              const CollectionPtr& materializedColl);
+
+}  // namespace mongo
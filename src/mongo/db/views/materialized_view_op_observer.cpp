@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_op_observer.h"
+
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/views/materialized_view.h"
+
+namespace mongo {
+namespace {
+
+// The document being deleted, kept from aboutToDelete() until onDelete() for the deletes from
+// collections with materialized views. The groups are only rewritten in onDelete(), since a
+// delete made in between would take the place of the one being observed.
+const auto deletedDocDecoration = OperationContext::declareDecoration<boost::optional<BSONObj>>();
+
+}  // namespace
+
+std::shared_ptr<const ViewCatalog::MaterializedViews> MaterializedViewOpObserver::_lookupViewsOn(
+    OperationContext* opCtx, const NamespaceString& nss) {
+    // The collections holding the groups of the views are system collections, so that rewriting
+    // them does not recurse.
+    if (!opCtx->writesAreReplicated() || nss.isSystem()) {
+        return nullptr;
+    }
+
+    auto db = DatabaseHolder::get(opCtx)->getDb(opCtx, nss.db());
+    if (!db) {
+        return nullptr;
+    }
+    return ViewCatalog::get(db)->lookupMaterializedViewsOn(opCtx, nss);
+}
+
+void MaterializedViewOpObserver::_maintainViews(
+    OperationContext* opCtx,
+    const std::shared_ptr<const ViewCatalog::MaterializedViews>& views,
+    const std::function<void(MaterializedViewDelta*)>& addChanges) {
+    if (!views) {
+        return;
+    }
+
+    // The writes to the groups would be recorded as statements of a retryable write, which would
+    // then no longer be retried correctly.
+    uassert(5302201,
+            str::stream() << "Retryable writes are not supported on "
+                          << views->front().view->viewOn()
+                          << ", which has materialized views defined on it",
+            !opCtx->getTxnNumber() || opCtx->inMultiDocumentTransaction());
+
+    for (auto&& [view, pipeline] : *views) {
+        const auto materializedNss = view->materializedNss();
+        Lock::CollectionLock materializedCollLock(opCtx, materializedNss, MODE_IX);
+        const auto& materializedColl =
+            CollectionCatalog::get(opCtx).lookupCollectionByNamespace(opCtx, materializedNss);
+        if (!materializedColl) {
+            // The view is being dropped.
+            continue;
+        }
+
+        MaterializedViewDelta delta(pipeline);
+        addChanges(&delta);
+        delta.apply(opCtx, materializedColl);
+    }
+}
+
+void MaterializedViewOpObserver::onInserts(OperationContext* opCtx,
+                                           const NamespaceString& nss,
+                                           OptionalCollectionUUID uuid,
+                                           std::vector<InsertStatement>::const_iterator first,
+                                           std::vector<InsertStatement>::const_iterator last,
+                                           bool fromMigrate) {
+    _maintainViews(opCtx, _lookupViewsOn(opCtx, nss), [&](MaterializedViewDelta* delta) {
+        for (auto it = first; it != last; ++it) {
+            delta->addDocument(it->doc);
+        }
+    });
+}
+
+void MaterializedViewOpObserver::onUpdate(OperationContext* opCtx,
+                                          const OplogUpdateEntryArgs& args) {
+    if (args.updateArgs.update.isEmpty()) {
+        return;
+    }
+
+    _maintainViews(opCtx, _lookupViewsOn(opCtx, args.nss), [&](MaterializedViewDelta* delta) {
+        uassert(5302200,
+                str::stream() << "Cannot maintain the materialized views on " << args.nss
+                              << " without the pre-image of the updated document",
+                args.updateArgs.preImageDoc);
+        delta->removeDocument(*args.updateArgs.preImageDoc);
+        delta->addDocument(args.updateArgs.updatedDoc);
+    });
+}
+
+void MaterializedViewOpObserver::aboutToDelete(OperationContext* opCtx,
+                                               const NamespaceString& nss,
+                                               const BSONObj& doc) {
+    if (_lookupViewsOn(opCtx, nss)) {
+        deletedDocDecoration(opCtx) = doc.getOwned();
+    }
+}
+
+void MaterializedViewOpObserver::onDelete(OperationContext* opCtx,
+                                          const NamespaceString& nss,
+                                          OptionalCollectionUUID uuid,
+                                          StmtId stmtId,
+                                          bool fromMigrate,
+                                          const boost::optional<BSONObj>& deletedDoc) {
+    auto doc = std::exchange(deletedDocDecoration(opCtx), boost::none);
+    if (!doc) {
+        return;
+    }
+
+    _maintainViews(opCtx, _lookupViewsOn(opCtx, nss), [&](MaterializedViewDelta* delta) {
+        delta->removeDocument(*doc);
+    });
+}
+
+}  // namespace mongo
@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/views/materialized_view_pipeline.h"
+
+#include <algorithm>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/views/view.h"
+#include "mongo/util/str.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Returns the name of an expression or system variable used in 'spec' whose value is not
+ * determined by the document it is evaluated on, or an empty string if there is none.
+ */
+StringData findNondeterministicExpression(const BSONObj& spec) {
+    static const StringDataSet kNondeterministicNames{
+        "$rand", "$sampleRate", "$function", "$accumulator", "$where"};
+    for (auto&& elem : spec) {
+        if (kNondeterministicNames.count(elem.fieldNameStringData())) {
+            return elem.fieldNameStringData();
+        }
+        if (elem.type() == BSONType::String) {
+            for (auto&& variable : {"$$NOW"_sd, "$$CLUSTER_TIME"_sd}) {
+                if (elem.valueStringData().startsWith(variable)) {
+                    return variable;
+                }
+            }
+        }
+        if (elem.isABSONObj()) {
+            if (auto name = findNondeterministicExpression(elem.Obj()); !name.empty()) {
+                return name;
+            }
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+MaterializedViewPipeline::MaterializedViewPipeline(
+    boost::intrusive_ptr<ExpressionContext> expCtx,
+    std::vector<boost::intrusive_ptr<DocumentSourceMatch>> matches,
+    boost::intrusive_ptr<DocumentSourceGroup> group)
+    : _expCtx(std::move(expCtx)),
+      _matches(std::move(matches)),
+      _group(std::move(group)),
+      _idExpression(_group->getIdExpression()) {}
+
+MaterializedViewPipeline MaterializedViewPipeline::parse(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, const std::vector<BSONObj>& pipeline) {
+    std::vector<boost::intrusive_ptr<DocumentSourceMatch>> matches;
+    for (auto&& stageSpec : pipeline) {
+        // Stages are told apart by name rather than by what they parse into, since some aliases
+        // such as $count expand into a $group followed by other stages.
+        const auto stageName = stageSpec.firstElementFieldNameStringData();
+        uassert(ErrorCodes::OptionNotSupportedOnView,
+                str::stream() << "The pipeline of a materialized view must consist of $match "
+                                 "stages followed by a $group, but found "
+                              << stageName,
+                stageName == DocumentSourceMatch::kStageName ||
+                    stageName == DocumentSourceGroup::kStageName);
+
+        // The groups are computed over time, so an expression evaluating to something else on
+        // each write would leave them inconsistent with any single evaluation of the pipeline.
+        const auto nondeterministicName = findNondeterministicExpression(stageSpec);
+        uassert(ErrorCodes::OptionNotSupportedOnView,
+                str::stream() << nondeterministicName
+                              << " cannot be used in the pipeline of a materialized view",
+                nondeterministicName.empty());
+
+        auto sources = DocumentSource::parse(expCtx, stageSpec);
+        invariant(sources.size() == 1);
+        if (auto match = dynamic_cast<DocumentSourceMatch*>(sources.front().get())) {
+            uassert(ErrorCodes::OptionNotSupportedOnView,
+                    "A $text query cannot be used in the pipeline of a materialized view",
+                    !match->isTextQuery());
+            matches.emplace_back(match);
+            continue;
+        }
+
+        boost::intrusive_ptr<DocumentSourceGroup> group =
+            static_cast<DocumentSourceGroup*>(sources.front().get());
+        for (auto&& accumulatedField : group->getAccumulatedFields()) {
+            uassert(ErrorCodes::OptionNotSupportedOnView,
+                    str::stream() << "The $group of a materialized view can only use $sum, but "
+                                  << accumulatedField.fieldName << " uses "
+                                  << accumulatedField.makeAccumulator()->getOpName(),
+                    accumulatedField.makeAccumulator()->getOpName() == "$sum"_sd);
+            uassert(ErrorCodes::OptionNotSupportedOnView,
+                    str::stream() << "The field name " << kDocCountFieldName
+                                  << " is reserved in the $group of a materialized view",
+                    accumulatedField.fieldName != kDocCountFieldName);
+        }
+        return {expCtx, std::move(matches), std::move(group)};
+    }
+
+    uasserted(ErrorCodes::OptionNotSupportedOnView,
+              "The pipeline of a materialized view must contain a $group");
+}
+
+std::shared_ptr<const MaterializedViewPipeline> MaterializedViewPipeline::parseView(
+    OperationContext* opCtx, const ViewDefinition& view) {
+    auto expCtx = make_intrusive<ExpressionContext>(
+        opCtx, CollatorInterface::cloneCollator(view.defaultCollator()), view.viewOn());
+    auto pipeline =
+        std::make_shared<const MaterializedViewPipeline>(parse(expCtx, view.pipeline()));
+
+    // The pipeline outlives the operation parsing it.
+    expCtx->opCtx = nullptr;
+    return pipeline;
+}
+
+std::vector<BSONObj> MaterializedViewPipeline::makeReadPipeline(
+    const std::vector<BSONObj>& pipeline) {
+    auto group = std::find_if(pipeline.begin(), pipeline.end(), [](auto&& stageSpec) {
+        return stageSpec.firstElementFieldNameStringData() == DocumentSourceGroup::kStageName;
+    });
+    invariant(group != pipeline.end());
+
+    std::vector<BSONObj> readPipeline{BSON("$project" << BSON(kDocCountFieldName << 0))};
+    readPipeline.insert(readPipeline.end(), std::next(group), pipeline.end());
+    return readPipeline;
+}
+
+bool MaterializedViewPipeline::matches(const BSONObj& doc) const {
+    return std::all_of(_matches.begin(), _matches.end(), [&](auto&& match) {
+        return match->getMatchExpression()->matchesBSON(doc);
+    });
+}
+
+Value MaterializedViewPipeline::computeGroupKey(const Document& doc, Variables* variables) const {
+    // Documents without a group key are grouped under null, as they are by $group.
+    Value key = _idExpression->evaluate(doc, variables);
+    return key.missing() ? Value(BSONNULL) : key;
+}
+
+}  // namespace mongo
@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/expression_context.h"
+
+namespace mongo {
+
+class OperationContext;
+class ViewDefinition;
+
+/**
+ * The pipeline of a materialized view, which is kept up to date as the documents of the collection
+ * the view is defined on are inserted, updated and deleted. This restricts the pipeline to any
+ * number of $match stages followed by a $group whose accumulators are all $sum, since the
+ * contribution of a document to such a group can be taken out again when the document changes.
+ * The stages after the $group run when the view is read, over the stored groups.
+ */
+class MaterializedViewPipeline {
+public:
+    // The field of each stored group holding the number of documents in the group, so that the
+    // group can be removed along with its last document.
+    static constexpr StringData kDocCountFieldName = "__docCount"_sd;
+
+    /**
+     * Parses the stages of 'pipeline' up to and including its $group. Throws
+     * OptionNotSupportedOnView if they cannot be kept up to date, including when they use an
+     * expression such as $rand or $$NOW whose value changes between the writes.
+     */
+    static MaterializedViewPipeline parse(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                          const std::vector<BSONObj>& pipeline);
+
+    /**
+     * Parses the pipeline of the materialized view 'view', to be shared by all the writes keeping
+     * the view up to date. The result does not refer to 'opCtx', which is only used for parsing.
+     */
+    static std::shared_ptr<const MaterializedViewPipeline> parseView(OperationContext* opCtx,
+                                                                     const ViewDefinition& view);
+
+    /**
+     * Returns the pipeline which reads a materialized view defined by 'pipeline' from the
+     * collection holding its groups.
+     */
+    static std::vector<BSONObj> makeReadPipeline(const std::vector<BSONObj>& pipeline);
+
+    /**
+     * Returns true if 'doc' passes the $match stages of the pipeline.
+     */
+    bool matches(const BSONObj& doc) const;
+
+    /**
+     * Returns the key of the group 'doc' belongs to. The pipeline may be shared by concurrent
+     * writes, so the expressions are evaluated with the caller's copy of the 'variables' of the
+     * context, which some expressions modify.
+     */
+    Value computeGroupKey(const Document& doc, Variables* variables) const;
+
+    const std::vector<AccumulationStatement>& getAccumulatedFields() const {
+        return _group->getAccumulatedFields();
+    }
+
+    const boost::intrusive_ptr<ExpressionContext>& getContext() const {
+        return _expCtx;
+    }
+
+private:
+    MaterializedViewPipeline(boost::intrusive_ptr<ExpressionContext> expCtx,
+                             std::vector<boost::intrusive_ptr<DocumentSourceMatch>> matches,
+                             boost::intrusive_ptr<DocumentSourceGroup> group);
+
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+    std::vector<boost::intrusive_ptr<DocumentSourceMatch>> _matches;
+    boost::intrusive_ptr<DocumentSourceGroup> _group;
+    boost::intrusive_ptr<Expression> _idExpression;
+};
+
+}  // namespace mongo
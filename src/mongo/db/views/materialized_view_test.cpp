@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/bson/bsonmisc.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/views/materialized_view_pipeline.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+MaterializedViewPipeline parse(const std::vector<BSONObj>& pipeline) {
+    return MaterializedViewPipeline::parse(make_intrusive<ExpressionContextForTest>(), pipeline);
+}
+
+void assertNotSupported(const std::vector<BSONObj>& pipeline) {
+    ASSERT_THROWS_CODE(parse(pipeline), AssertionException, ErrorCodes::OptionNotSupportedOnView);
+}
+
+TEST(MaterializedViewPipelineTest, ParsesMatchStagesFollowedByGroup) {
+    auto pipeline = parse({fromjson("{$match: {a: {$gt: 1}}}"),
+                           fromjson("{$match: {b: 'x'}}"),
+                           fromjson("{$group: {_id: '$c', n: {$sum: 1}, total: {$sum: '$d'}}}"),
+                           fromjson("{$sort: {_id: 1}}")});
+
+    ASSERT_EQ(pipeline.getAccumulatedFields().size(), 2U);
+    ASSERT_EQ(pipeline.getAccumulatedFields()[0].fieldName, "n");
+    ASSERT_EQ(pipeline.getAccumulatedFields()[1].fieldName, "total");
+
+    ASSERT_TRUE(pipeline.matches(fromjson("{a: 2, b: 'x'}")));
+    ASSERT_FALSE(pipeline.matches(fromjson("{a: 1, b: 'x'}")));
+    ASSERT_FALSE(pipeline.matches(fromjson("{a: 2, b: 'y'}")));
+}
+
+TEST(MaterializedViewPipelineTest, ComputesGroupKey) {
+    auto pipeline = parse({fromjson("{$group: {_id: {c: '$c', d: '$d'}, n: {$sum: 1}}}")});
+    Variables variables = pipeline.getContext()->variables;
+    ASSERT_VALUE_EQ(pipeline.computeGroupKey(Document{{"c", 1}, {"d", 2}}, &variables),
+                    Value(Document{{"c", 1}, {"d", 2}}));
+
+    // A document without a group key belongs to the null group, as it does with $group.
+    pipeline = parse({fromjson("{$group: {_id: '$c', n: {$sum: 1}}}")});
+    ASSERT_VALUE_EQ(pipeline.computeGroupKey(Document{{"d", 2}}, &variables), Value(BSONNULL));
+}
+
+TEST(MaterializedViewPipelineTest, RejectsPipelinesWhichCannotBeMaintained) {
+    // A $group is required.
+    assertNotSupported({fromjson("{$match: {a: 1}}")});
+
+    // Only $match stages may come before the $group.
+    assertNotSupported({fromjson("{$sort: {a: 1}}"), fromjson("{$group: {_id: '$a'}}")});
+    assertNotSupported({fromjson("{$count: 'n'}")});
+
+    // Only $sum can be taken out of a group when a document changes.
+    assertNotSupported({fromjson("{$group: {_id: '$a', m: {$max: '$b'}}}")});
+    assertNotSupported({fromjson("{$group: {_id: '$a', n: {$sum: 1}, m: {$avg: '$b'}}}")});
+
+    // The field holding the number of documents in a group is reserved.
+    assertNotSupported({fromjson("{$group: {_id: '$a', __docCount: {$sum: 1}}}")});
+
+    // The groups would depend on when each document was written.
+    assertNotSupported({fromjson("{$match: {$expr: {$lt: [{$rand: {}}, 0.5]}}}"),
+                        fromjson("{$group: {_id: '$a'}}")});
+    assertNotSupported({fromjson("{$group: {_id: '$$NOW', n: {$sum: 1}}}")});
+    assertNotSupported({fromjson("{$group: {_id: '$a', t: {$sum: '$$CLUSTER_TIME'}}}")});
+}
+
+TEST(MaterializedViewPipelineTest, ReadPipelineRunsTheStagesAfterTheGroup) {
+    const std::vector<BSONObj> pipeline = {fromjson("{$match: {a: 1}}"),
+                                           fromjson("{$group: {_id: '$b', n: {$sum: 1}}}"),
+                                           fromjson("{$match: {n: {$gt: 2}}}"),
+                                           fromjson("{$sort: {n: -1}}")};
+    const std::vector<BSONObj> expected = {fromjson("{$project: {__docCount: 0}}"),
+                                           fromjson("{$match: {n: {$gt: 2}}}"),
+                                           fromjson("{$sort: {n: -1}}")};
+
+    auto readPipeline = MaterializedViewPipeline::makeReadPipeline(pipeline);
+    ASSERT_EQ(readPipeline.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(readPipeline[i], expected[i]);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -47,12 +47,15 @@ public:
     /**
      * In the database 'dbName', create a new view 'viewName' on the view or collection
      * 'viewOnName'. Neither 'viewName' nor 'viewOnName' should include the name of the database.
+     * A 'materialized' view is read from a collection holding the result of its pipeline, which is
+     * kept up to date as 'viewOnName' changes.
      */
     ViewDefinition(StringData dbName,
                    StringData viewName,
                    StringData viewOnName,
                    const BSONObj& pipeline,
-                   std::unique_ptr<CollatorInterface> collation);
+                   std::unique_ptr<CollatorInterface> collation,
+                   bool materialized = false);
 
     /**
      * Copying a view 'other' clones its collator and does a simple copy of all other fields.
@@ -95,6 +98,22 @@ public:
      */
     bool isTimeseries() const;
 
+    /**
+     * Returns true if this view is read from a collection holding the result of its pipeline.
+     */
+    bool isMaterialized() const {
+        return _materialized;
+    }
+
+    /**
+     * Returns the namespace of the collection holding the result of this materialized view's
+     * pipeline.
+     */
+    NamespaceString materializedNss() const {
+        invariant(_materialized);
+        return _viewNss.makeMaterializedViewNamespace();
+    }
+
     void setViewOn(const NamespaceString& viewOnNss);
 
     /**
@@ -107,5 +126,6 @@ private:
     NamespaceString _viewOnNss;
     std::unique_ptr<CollatorInterface> _collator;
     std::vector<BSONObj> _pipeline;
+    bool _materialized;
 };
 }  // namespace mongo
@@ -51,6 +51,7 @@
 #include "mongo/db/pipeline/process_interface/stub_mongo_process_interface.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/views/materialized_view_pipeline.h"
 #include "mongo/db/views/resolved_view.h"
 #include "mongo/db/views/view.h"
 #include "mongo/db/views/view_graph.h"
@@ -102,6 +103,7 @@ Status ViewCatalog::_reload(WithLock,
     _viewMap.clear();
     _valid = false;
     _viewGraphNeedsRefresh = true;
+    ++_viewMapVersion;
 
     auto reloadCallback = [&](const BSONObj& view) -> Status {
         BSONObj collationSpec = view.hasField("collation") ? view["collation"].Obj() : BSONObj();
@@ -122,11 +124,13 @@ Status ViewCatalog::_reload(WithLock,
             }
         }
 
-        _viewMap[viewName.ns()] = std::make_shared<ViewDefinition>(viewName.db(),
-                                                                   viewName.coll(),
-                                                                   view["viewOn"].str(),
-                                                                   pipeline,
-                                                                   std::move(collator.getValue()));
+        _viewMap[viewName.ns()] =
+            std::make_shared<ViewDefinition>(viewName.db(),
+                                             viewName.coll(),
+                                             view["viewOn"].str(),
+                                             pipeline,
+                                             std::move(collator.getValue()),
+                                             view["materialized"].trueValue());
         return Status::OK();
     };
 
@@ -158,6 +162,7 @@ void ViewCatalog::clear() {
     _viewGraph.clear();
     _valid = true;
     _viewGraphNeedsRefresh = false;
+    ++_viewMapVersion;
 }
 
 bool ViewCatalog::shouldIgnoreExternalChange(OperationContext* opCtx,
@@ -185,7 +190,8 @@ Status ViewCatalog::_createOrUpdateView(WithLock lk,
                                         const NamespaceString& viewName,
                                         const NamespaceString& viewOn,
                                         const BSONArray& pipeline,
-                                        std::unique_ptr<CollatorInterface> collator) {
+                                        std::unique_ptr<CollatorInterface> collator,
+                                        bool materialized) {
     invariant(opCtx->lockState()->isDbLockedForMode(viewName.db(), MODE_IX));
     invariant(opCtx->lockState()->isCollectionLockedForMode(viewName, MODE_IX));
     invariant(opCtx->lockState()->isCollectionLockedForMode(
@@ -206,10 +212,17 @@ Status ViewCatalog::_createOrUpdateView(WithLock lk,
     if (collator) {
         viewDefBuilder.append("collation", collator->getSpec().toBSON());
     }
+    if (materialized) {
+        viewDefBuilder.append("materialized", true);
+    }
 
     BSONObj ownedPipeline = pipeline.getOwned();
-    auto view = std::make_shared<ViewDefinition>(
-        viewName.db(), viewName.coll(), viewOn.coll(), ownedPipeline, std::move(collator));
+    auto view = std::make_shared<ViewDefinition>(viewName.db(),
+                                                 viewName.coll(),
+                                                 viewOn.coll(),
+                                                 ownedPipeline,
+                                                 std::move(collator),
+                                                 materialized);
 
     // Check that the resulting dependency graph is acyclic and within the maximum depth.
     Status graphStatus = _upsertIntoGraph(lk, opCtx, *(view.get()));
@@ -230,6 +243,7 @@ Status ViewCatalog::_createOrUpdateView(WithLock lk,
             stdx::lock_guard<Latch> lk(_mutex);
             this->_viewMap.erase(viewName.ns());
             this->_viewGraphNeedsRefresh = true;
+            ++this->_viewMapVersion;
         }
 
         CollectionCatalog& catalog = CollectionCatalog::get(opCtx);
@@ -343,7 +357,7 @@ StatusWith<stdx::unordered_set<NamespaceString>> ViewCatalog::_validatePipeline(
 
     try {
         auto pipeline =
-            Pipeline::parse(viewDef.pipeline(), std::move(expCtx), [&](const Pipeline& pipeline) {
+            Pipeline::parse(viewDef.pipeline(), expCtx, [&](const Pipeline& pipeline) {
                 // Validate that the view pipeline does not contain any ineligible stages.
                 const auto& sources = pipeline.getSources();
                 const auto firstPersistentStage =
@@ -371,6 +385,12 @@ StatusWith<stdx::unordered_set<NamespaceString>> ViewCatalog::_validatePipeline(
                             !stage->constraints().isIndependentOfAnyCollection);
                 });
             });
+
+        // A materialized view must also be one which can be kept up to date as the collection it
+        // is defined on changes.
+        if (viewDef.isMaterialized()) {
+            MaterializedViewPipeline::parse(expCtx, viewDef.pipeline());
+        }
     } catch (const DBException& ex) {
         return ex.toStatus();
     }
@@ -401,7 +421,8 @@ Status ViewCatalog::createView(OperationContext* opCtx,
                                const NamespaceString& viewName,
                                const NamespaceString& viewOn,
                                const BSONArray& pipeline,
-                               const BSONObj& collation) {
+                               const BSONObj& collation,
+                               bool materialized) {
     invariant(opCtx->lockState()->isDbLockedForMode(viewName.db(), MODE_IX));
     invariant(opCtx->lockState()->isCollectionLockedForMode(viewName, MODE_IX));
     invariant(opCtx->lockState()->isCollectionLockedForMode(
@@ -421,12 +442,20 @@ Status ViewCatalog::createView(OperationContext* opCtx,
         return Status(ErrorCodes::InvalidNamespace,
                       str::stream() << "invalid name for 'viewOn': " << viewOn.coll());
 
+    if (materialized &&
+        (viewOn.isSystem() ||
+         _lookup(lk, opCtx, viewOn.ns(), ViewCatalogLookupBehavior::kValidateDurableViews)))
+        return Status(ErrorCodes::OptionNotSupportedOnView,
+                      str::stream() << "A materialized view must be defined on a user collection, "
+                                       "but 'viewOn' is "
+                                    << viewOn.coll());
+
     auto collator = parseCollator(opCtx, collation);
     if (!collator.isOK())
         return collator.getStatus();
 
     return _createOrUpdateView(
-        lk, opCtx, viewName, viewOn, pipeline, std::move(collator.getValue()));
+        lk, opCtx, viewName, viewOn, pipeline, std::move(collator.getValue()), materialized);
 }
 
 Status ViewCatalog::modifyView(OperationContext* opCtx,
@@ -449,6 +478,10 @@ Status ViewCatalog::modifyView(OperationContext* opCtx,
         return Status(ErrorCodes::NamespaceNotFound,
                       str::stream() << "cannot modify missing view " << viewName.ns());
 
+    if (viewPtr->isMaterialized())
+        return Status(ErrorCodes::OptionNotSupportedOnView,
+                      str::stream() << "cannot modify materialized view " << viewName.ns());
+
     if (!NamespaceString::validCollectionName(viewOn.coll()))
         return Status(ErrorCodes::InvalidNamespace,
                       str::stream() << "invalid name for 'viewOn': " << viewOn.coll());
@@ -460,6 +493,7 @@ Status ViewCatalog::modifyView(OperationContext* opCtx,
         {
             stdx::lock_guard<Latch> lk(_mutex);
             this->_viewMap[viewName.ns()] = std::move(definition);
+            ++this->_viewMapVersion;
         }
         auto viewRid = ResourceId(RESOURCE_COLLECTION, viewName.ns());
         CollectionCatalog& catalog = CollectionCatalog::get(opCtx);
@@ -471,7 +505,8 @@ Status ViewCatalog::modifyView(OperationContext* opCtx,
                                viewName,
                                viewOn,
                                pipeline,
-                               CollatorInterface::cloneCollator(savedDefinition.defaultCollator()));
+                               CollatorInterface::cloneCollator(savedDefinition.defaultCollator()),
+                               false);
 }
 
 Status ViewCatalog::dropView(OperationContext* opCtx, const NamespaceString& viewName) {
@@ -508,6 +543,7 @@ Status ViewCatalog::dropView(OperationContext* opCtx, const NamespaceString& vie
 
     opCtx->recoveryUnit()->onRollback([this, viewName, savedDefinition, opCtx, viewRid]() {
         this->_viewGraphNeedsRefresh = true;
+        ++this->_viewMapVersion;
         this->_viewMap[viewName.ns()] = std::make_shared<ViewDefinition>(savedDefinition);
         CollectionCatalog& catalog = CollectionCatalog::get(opCtx);
         catalog.addResource(viewRid, viewName.ns());
@@ -551,6 +587,68 @@ std::shared_ptr<ViewDefinition> ViewCatalog::lookupWithoutValidatingDurableViews
     return _lookup(lk, opCtx, ns, ViewCatalogLookupBehavior::kAllowInvalidDurableViews);
 }
 
+std::shared_ptr<const ViewCatalog::MaterializedViews> ViewCatalog::lookupMaterializedViewsOn(
+    OperationContext* opCtx, const NamespaceString& nss) {
+    std::vector<std::shared_ptr<ViewDefinition>> definitions;
+    uint64_t viewMapVersion;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        // The writes to the collection must not fail over a bad view definition, which leaves the
+        // catalog invalid until it is removed. The materialized views are not maintained meanwhile.
+        if (!_valid) {
+            return nullptr;
+        }
+
+        if (_materializedViewsVersion == _viewMapVersion) {
+            auto it = _materializedViewsOn.find(nss.ns());
+            return it != _materializedViewsOn.end() ? it->second : nullptr;
+        }
+
+        for (auto&& [viewName, view] : _viewMap) {
+            if (view->isMaterialized()) {
+                definitions.push_back(view);
+            }
+        }
+        viewMapVersion = _viewMapVersion;
+    }
+
+    // The pipelines are parsed without holding '_mutex', since parsing may look up the catalog.
+    auto materializedViewsOn = _parseMaterializedViews(opCtx, definitions);
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (viewMapVersion == _viewMapVersion) {
+        _materializedViewsOn = materializedViewsOn;
+        _materializedViewsVersion = viewMapVersion;
+    }
+
+    auto it = materializedViewsOn.find(nss.ns());
+    return it != materializedViewsOn.end() ? it->second : nullptr;
+}
+
+StringMap<std::shared_ptr<const ViewCatalog::MaterializedViews>>
+ViewCatalog::_parseMaterializedViews(
+    OperationContext* opCtx, const std::vector<std::shared_ptr<ViewDefinition>>& definitions) {
+    StringMap<MaterializedViews> materializedViewsOn;
+    for (auto&& view : definitions) {
+        try {
+            materializedViewsOn[view->viewOn().ns()].push_back(
+                {view, MaterializedViewPipeline::parseView(opCtx, *view)});
+        } catch (const DBException& ex) {
+            LOGV2_WARNING(5302202,
+                          "Not maintaining a materialized view whose pipeline cannot be parsed",
+                          "view"_attr = view->name(),
+                          "viewOn"_attr = view->viewOn(),
+                          "error"_attr = ex.toStatus());
+        }
+    }
+
+    StringMap<std::shared_ptr<const MaterializedViews>> result;
+    for (auto&& [viewOn, views] : materializedViewsOn) {
+        result[viewOn] = std::make_shared<const MaterializedViews>(std::move(views));
+    }
+    return result;
+}
+
 StatusWith<ResolvedView> ViewCatalog::resolveView(OperationContext* opCtx,
                                                   const NamespaceString& nss) {
     stdx::unique_lock<Latch> lock(_mutex);
@@ -601,6 +699,18 @@ StatusWith<ResolvedView> ViewCatalog::resolveView(OperationContext* opCtx,
                                                     : CollationSpec::kSimpleSpec;
             }
 
+            // A materialized view is read from the collection holding the groups of its pipeline,
+            // which needs only the stages after the $group to run.
+            if (view->isMaterialized()) {
+                const auto readPipeline =
+                    MaterializedViewPipeline::makeReadPipeline(view->pipeline());
+                resolvedPipeline.insert(
+                    resolvedPipeline.begin(), readPipeline.begin(), readPipeline.end());
+                return StatusWith<ResolvedView>({view->materializedNss(),
+                                                 std::move(resolvedPipeline),
+                                                 std::move(collation.get())});
+            }
+
             // Prepend the underlying view's pipeline to the current working pipeline.
             const std::vector<BSONObj>& toPrepend = view->pipeline();
             resolvedPipeline.insert(resolvedPipeline.begin(), toPrepend.begin(), toPrepend.end());
@@ -51,6 +51,7 @@
 namespace mongo {
 class OperationContext;
 class Database;
+class MaterializedViewPipeline;
 
 /**
  * In-memory data structure for view definitions. This data structure is thread-safe -- this is
@@ -67,6 +68,15 @@ public:
     using ViewMap = StringMap<std::shared_ptr<ViewDefinition>>;
     using ViewIteratorCallback = std::function<void(const ViewDefinition& view)>;
 
+    /**
+     * A materialized view, with its pipeline parsed once for all the writes keeping it up to date.
+     */
+    struct MaterializedView {
+        std::shared_ptr<ViewDefinition> view;
+        std::shared_ptr<const MaterializedViewPipeline> pipeline;
+    };
+    using MaterializedViews = std::vector<MaterializedView>;
+
     /**
      * This getter should only be used when not holding a database lock. Otherwise the regular get()
      * is appropriate and safe.
@@ -94,7 +104,8 @@ public:
      * 'pipeline' with collation 'collation' on a collection or view 'viewOn'. This method will
      * check correctness with respect to the view catalog, but will not check for conflicts with the
      * database's catalog, so the check for an existing collection with the same name must be done
-     * before calling createView.
+     * before calling createView. A 'materialized' view must be defined on a collection, and the
+     * collection holding its result must be created and populated by the caller.
      *
      * Must be in WriteUnitOfWork. View creation rolls back if the unit of work aborts.
      */
@@ -102,7 +113,8 @@ public:
                       const NamespaceString& viewName,
                       const NamespaceString& viewOn,
                       const BSONArray& pipeline,
-                      const BSONObj& collation);
+                      const BSONObj& collation,
+                      bool materialized = false);
 
     /**
      * Drop the view named 'viewName'.
@@ -134,6 +146,16 @@ public:
     std::shared_ptr<ViewDefinition> lookupWithoutValidatingDurableViews(OperationContext* opCtx,
                                                                         StringData nss);
 
+    /**
+     * Returns the materialized views defined on the collection 'nss', which are to be kept up to
+     * date as it is written to, or nullptr if there are none. The views are indexed by the
+     * collection they are defined on, which is rebuilt after the catalog changes. Never throws:
+     * returns nullptr while the catalog is invalid, and leaves out the views whose pipeline cannot
+     * be parsed.
+     */
+    std::shared_ptr<const MaterializedViews> lookupMaterializedViewsOn(OperationContext* opCtx,
+                                                                       const NamespaceString& nss);
+
     /**
      * Resolve the views on 'nss', transforming the pipeline appropriately. This function returns a
      * fully-resolved view definition containing the backing namespace, the resolved pipeline and
@@ -168,7 +190,8 @@ private:
                                const NamespaceString& viewName,
                                const NamespaceString& viewOn,
                                const BSONArray& pipeline,
-                               std::unique_ptr<CollatorInterface> collator);
+                               std::unique_ptr<CollatorInterface> collator,
+                               bool materialized);
     /**
      * Parses the view definition pipeline, attempts to upsert into the view graph, and refreshes
      * the graph if necessary. Returns an error status if the resulting graph would be invalid.
@@ -205,6 +228,14 @@ private:
      */
     void _requireValidCatalog(WithLock);
 
+    /**
+     * Parses the pipelines of the materialized views 'definitions' and indexes them by the
+     * namespace of the collection they are defined on. A view whose pipeline cannot be parsed is
+     * logged and left out.
+     */
+    static StringMap<std::shared_ptr<const MaterializedViews>> _parseMaterializedViews(
+        OperationContext* opCtx, const std::vector<std::shared_ptr<ViewDefinition>>& definitions);
+
     Mutex _mutex = MONGO_MAKE_LATCH("ViewCatalog::_mutex");  // Protects all members.
     ViewMap _viewMap;
     ViewMap _viewMapBackup;
@@ -213,5 +244,11 @@ private:
     ViewGraph _viewGraph;
     bool _viewGraphNeedsRefresh;
     bool _ignoreExternalChange;
+
+    // The materialized views in '_viewMap', by the namespace of the collection they are defined
+    // on. Rebuilt on the first lookup after '_viewMap' changes, which bumps '_viewMapVersion'.
+    StringMap<std::shared_ptr<const MaterializedViews>> _materializedViewsOn;
+    uint64_t _viewMapVersion = 1;
+    uint64_t _materializedViewsVersion = 0;
 };
 }  // namespace mongo
@@ -52,6 +52,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/views/durable_view_catalog.h"
+#include "mongo/db/views/materialized_view_pipeline.h"
 #include "mongo/db/views/view.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/db/views/view_graph.h"
@@ -114,7 +115,8 @@ public:
                       const NamespaceString& viewName,
                       const NamespaceString& viewOn,
                       const BSONArray& pipeline,
-                      const BSONObj& collation) {
+                      const BSONObj& collation,
+                      bool materialized = false) {
         Lock::DBLock dbLock(operationContext(), viewName.db(), MODE_IX);
         Lock::CollectionLock collLock(operationContext(), viewName, MODE_IX);
         Lock::CollectionLock sysCollLock(
@@ -123,7 +125,8 @@ public:
             MODE_X);
 
         WriteUnitOfWork wuow(opCtx);
-        Status s = _viewCatalog->createView(opCtx, viewName, viewOn, pipeline, collation);
+        Status s =
+            _viewCatalog->createView(opCtx, viewName, viewOn, pipeline, collation, materialized);
         wuow.commit();
 
         return s;
@@ -162,6 +165,26 @@ public:
         return s;
     }
 
+    void upsertDurableView(OperationContext* opCtx,
+                           const NamespaceString& viewName,
+                           const BSONObj& view) {
+        Lock::DBLock dbLock(operationContext(), viewName.db(), MODE_IX);
+        Lock::CollectionLock collLock(operationContext(), viewName, MODE_IX);
+        Lock::CollectionLock sysCollLock(
+            operationContext(),
+            NamespaceString(viewName.db(), NamespaceString::kSystemDotViewsCollectionName),
+            MODE_X);
+
+        WriteUnitOfWork wuow(opCtx);
+        DurableViewCatalogImpl(_db).upsert(opCtx, viewName, view);
+        wuow.commit();
+    }
+
+    Status reload(OperationContext* opCtx) {
+        Lock::DBLock dbLock(operationContext(), "db", MODE_IS);
+        return _viewCatalog->reload(opCtx, ViewCatalogLookupBehavior::kValidateDurableViews);
+    }
+
     std::shared_ptr<ViewDefinition> lookup(OperationContext* opCtx, StringData ns) {
         Lock::DBLock dbLock(operationContext(), NamespaceString(ns).db(), MODE_IS);
         return _viewCatalog->lookup(operationContext(), ns);
@@ -693,6 +716,172 @@ TEST_F(ViewCatalogFixture, ResolveViewOnCollectionNamespace) {
     ASSERT_EQ(resolvedView.getPipeline().size(), 0U);
 }
 
+TEST_F(ViewCatalogFixture, ResolveViewOnMaterializedView) {
+    const NamespaceString materializedView("db.materialized");
+    const NamespaceString view("db.view");
+    const NamespaceString viewOn("db.coll");
+
+    auto materializedPipeline = BSON_ARRAY(BSON("$match" << BSON("foo" << 1))
+                                           << BSON("$group" << BSON("_id"
+                                                                    << "$bar"
+                                                                    << "n" << BSON("$sum" << 1)))
+                                           << BSON("$sort" << BSON("n" << 1)));
+    auto pipeline = BSON_ARRAY(BSON("$match" << BSON("n" << 2)));
+
+    ASSERT_OK(createView(operationContext(),
+                         materializedView,
+                         viewOn,
+                         materializedPipeline,
+                         emptyCollation,
+                         true /* materialized */));
+    ASSERT_OK(createView(operationContext(), view, materializedView, pipeline, emptyCollation));
+    ASSERT(lookup(operationContext(), materializedView.ns())->isMaterialized());
+
+    Lock::DBLock dbLock(operationContext(), "db", MODE_IS);
+    auto resolvedView = uassertStatusOK(getViewCatalog()->resolveView(operationContext(), view));
+
+    // The groups are read from the collection holding them, without the stages before the $group.
+    ASSERT_EQ(resolvedView.getNamespace(), NamespaceString("db.system.materialized.materialized"));
+
+    std::vector<BSONObj> expected = {BSON("$project" << BSON("__docCount" << 0)),
+                                     BSON("$sort" << BSON("n" << 1)),
+                                     BSON("$match" << BSON("n" << 2))};
+    std::vector<BSONObj> result = resolvedView.getPipeline();
+
+    ASSERT_EQ(expected.size(), result.size());
+    for (uint32_t i = 0; i < expected.size(); i++) {
+        ASSERT_BSONOBJ_EQ(expected[i], result[i]);
+    }
+}
+
+TEST_F(ViewCatalogFixture, CannotCreateMaterializedViewWithPipelineWhichCannotBeMaintained) {
+    const NamespaceString viewName("db.view");
+    const NamespaceString viewOn("db.coll");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "avg"
+                                                     << BSON("$avg"
+                                                             << "$foo"))));
+    ASSERT_THROWS_CODE(createView(operationContext(),
+                                  viewName,
+                                  viewOn,
+                                  pipeline,
+                                  emptyCollation,
+                                  true /* materialized */),
+                       AssertionException,
+                       ErrorCodes::OptionNotSupportedOnView);
+
+    // The same pipeline is fine for a view which is not materialized.
+    ASSERT_OK(createView(operationContext(), viewName, viewOn, pipeline, emptyCollation));
+}
+
+TEST_F(ViewCatalogFixture, CannotCreateMaterializedViewOnView) {
+    const NamespaceString view1("db.view1");
+    const NamespaceString view2("db.view2");
+    const NamespaceString viewOn("db.coll");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "n" << BSON("$sum" << 1))));
+    ASSERT_OK(createView(operationContext(), view1, viewOn, emptyPipeline, emptyCollation));
+    ASSERT_EQ(createView(operationContext(),
+                         view2,
+                         view1,
+                         pipeline,
+                         emptyCollation,
+                         true /* materialized */),
+              ErrorCodes::OptionNotSupportedOnView);
+}
+
+TEST_F(ViewCatalogFixture, CannotModifyMaterializedView) {
+    const NamespaceString viewName("db.view");
+    const NamespaceString viewOn("db.coll");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "n" << BSON("$sum" << 1))));
+    ASSERT_OK(createView(
+        operationContext(), viewName, viewOn, pipeline, emptyCollation, true /* materialized */));
+    ASSERT_EQ(modifyView(operationContext(), viewName, viewOn, pipeline),
+              ErrorCodes::OptionNotSupportedOnView);
+}
+
+TEST_F(ViewCatalogFixture, LookupMaterializedViewsOnReturnsTheViewsDefinedOnTheCollection) {
+    const NamespaceString view1("db.view1");
+    const NamespaceString view2("db.view2");
+    const NamespaceString view3("db.view3");
+    const NamespaceString viewOn("db.coll");
+    const NamespaceString otherViewOn("db.other");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "n" << BSON("$sum" << 1))));
+    ASSERT_OK(createView(
+        operationContext(), view1, viewOn, pipeline, emptyCollation, true /* materialized */));
+    ASSERT_OK(createView(
+        operationContext(), view2, otherViewOn, pipeline, emptyCollation, true /* materialized */));
+    ASSERT_OK(createView(operationContext(), view3, viewOn, pipeline, emptyCollation));
+
+    auto views = getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn);
+    ASSERT(views);
+    ASSERT_EQ(views->size(), 1U);
+    ASSERT_EQ(views->front().view->name(), view1);
+    ASSERT_EQ(views->front().pipeline->getAccumulatedFields().size(), 1U);
+
+    // The pipeline is parsed once, and shared by the lookups until the catalog changes.
+    ASSERT_EQ(getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn), views);
+
+    ASSERT_OK(dropView(operationContext(), view1));
+    ASSERT_FALSE(getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn));
+    ASSERT(getViewCatalog()->lookupMaterializedViewsOn(operationContext(), otherViewOn));
+}
+
+TEST_F(ViewCatalogFixture, LookupMaterializedViewsOnSkipsViewsWhosePipelineCannotBeParsed) {
+    const NamespaceString view1("db.view1");
+    const NamespaceString view2("db.view2");
+    const NamespaceString viewOn("db.coll");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "n" << BSON("$sum" << 1))));
+    ASSERT_OK(createView(
+        operationContext(), view1, viewOn, pipeline, emptyCollation, true /* materialized */));
+
+    // A materialized view without a $group can only be written to 'system.views' directly.
+    upsertDurableView(operationContext(),
+                      view2,
+                      BSON("_id" << view2.ns() << "viewOn" << viewOn.coll() << "pipeline"
+                                 << emptyPipeline << "materialized" << true));
+    ASSERT_OK(reload(operationContext()));
+
+    auto views = getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn);
+    ASSERT(views);
+    ASSERT_EQ(views->size(), 1U);
+    ASSERT_EQ(views->front().view->name(), view1);
+}
+
+TEST_F(ViewCatalogFixture, LookupMaterializedViewsOnReturnsNoViewsWhileTheCatalogIsInvalid) {
+    const NamespaceString view1("db.view1");
+    const NamespaceString view2("db.view2");
+    const NamespaceString viewOn("db.coll");
+
+    auto pipeline = BSON_ARRAY(BSON("$group" << BSON("_id"
+                                                     << "$bar"
+                                                     << "n" << BSON("$sum" << 1))));
+    ASSERT_OK(createView(
+        operationContext(), view1, viewOn, pipeline, emptyCollation, true /* materialized */));
+    ASSERT(getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn));
+
+    // The writes to the collection go on without maintaining the views, rather than failing.
+    upsertDurableView(operationContext(),
+                      view2,
+                      BSON("_id" << view2.ns() << "viewOn" << viewOn.coll() << "pipeline"
+                                 << BSON_ARRAY(1)));
+    ASSERT_NOT_OK(reload(operationContext()));
+    ASSERT_FALSE(getViewCatalog()->lookupMaterializedViewsOn(operationContext(), viewOn));
+}
+
 TEST_F(ViewCatalogFixture, ResolveViewCorrectlyExtractsDefaultCollation) {
     const NamespaceString view1("db.view1");
     const NamespaceString view2("db.view2");
@@ -226,6 +226,73 @@ public:
     }
 };
 
+//
+// Test that fetching in batches returns the members in the order of the child, whichever the order
+// of their RecordIds, and drops those whose record is gone.
+//
+class FetchStageBatched : public QueryStageFetchBase {
+public:
+    void run() {
+        dbtests::WriteContextForTests ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        CollectionPtr coll =
+            CollectionCatalog::get(&_opCtx).lookupCollectionByNamespace(&_opCtx, nss());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, nss());
+            wuow.commit();
+        }
+
+        WorkingSet ws;
+
+        const int kNumDocs = 7;
+        for (int i = 0; i < kNumDocs; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIdSet;
+        getRecordIds(&recordIdSet, coll);
+        ASSERT_EQUALS(size_t(kNumDocs), recordIdSet.size());
+        std::vector<RecordId> recordIds(recordIdSet.begin(), recordIdSet.end());
+
+        // The child returns the members in decreasing RecordId order, as an index scan on a field
+        // with no correlation to insertion order would.
+        auto mockStage = std::make_unique<QueuedDataStage>(_expCtx.get(), &ws);
+        for (auto it = recordIds.rbegin(); it != recordIds.rend(); ++it) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = *it;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        // Remove a document whose index entry the child still returns.
+        remove(BSON("foo" << 3));
+
+        auto fetchStage = std::make_unique<FetchStage>(
+            _expCtx.get(), &ws, std::move(mockStage), nullptr, coll, 3 /* batchSize */);
+
+        std::vector<int> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state;
+        while ((state = fetchStage->work(&id)) != PlanStage::IS_EOF) {
+            if (state == PlanStage::ADVANCED) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_EQUALS(WorkingSetMember::RID_AND_OBJ, member->getState());
+                ASSERT_TRUE(member->doc.value().isOwned());
+                results.push_back(member->doc.value()["foo"].getInt());
+            } else {
+                ASSERT_EQUALS(PlanStage::NEED_TIME, state);
+            }
+        }
+
+        ASSERT(std::vector<int>({6, 5, 4, 2, 1, 0}) == results);
+
+        auto stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(3), stats->batchesFetched);
+        ASSERT_EQUALS(size_t(6), stats->docsExamined);
+    }
+};
+
 class All : public OldStyleSuiteSpecification {
 public:
     All() : OldStyleSuiteSpecification("query_stage_fetch") {}
@@ -233,6 +300,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageBatched>();
     }
 };
 
@@ -48,6 +48,18 @@ using DoubleDouble = std::pair<double, double>;
  */
 class DoubleDoubleSummation {
 public:
+    /**
+     * Returns a summation resuming from the 'sum', 'addend' and 'special' members of a summation,
+     * as returned by getState(), so that a partial sum can be kept outside of this class.
+     */
+    static DoubleDoubleSummation create(double sum, double addend, double special) {
+        DoubleDoubleSummation summation;
+        summation._sum = sum;
+        summation._addend = addend;
+        summation._special = special;
+        return summation;
+    }
+
     /**
      * Adds x to the sum, keeping track of a compensation amount to be subtracted later.
      */
@@ -113,6 +125,13 @@ public:
      */
     long long getLong() const;
 
+    /**
+     * Returns the 'sum', 'addend' and 'special' members, from which create() resumes the summation.
+     */
+    std::tuple<double, double, double> getState() const {
+        return {_sum, _addend, _special};
+    }
+
 private:
     /**
      * Assuming |b| <= |a|, returns exact unevaluated sum of a and b, where the first member is the